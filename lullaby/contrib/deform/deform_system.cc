@@ -16,11 +16,14 @@ limitations under the License.
 
 #include "lullaby/contrib/deform/deform_system.h"
 
+#include <cstring>
+
 #include "lullaby/modules/dispatcher/dispatcher.h"
 #include "lullaby/modules/flatbuffers/mathfu_fb_conversions.h"
 #include "lullaby/modules/render/mesh_util.h"
 #include "lullaby/systems/render/render_system.h"
 #include "lullaby/systems/transform/transform_system.h"
+#include "lullaby/util/hash.h"
 #include "lullaby/util/math.h"
 
 namespace lull {
@@ -49,6 +52,30 @@ Sqt CalculateLocalSqt(const mathfu::mat4& world_from_entity_mat,
   }
 }
 
+// Returns true if the xyz triplets in |positions| are bitwise identical to the
+// tightly packed |packed| positions.
+bool EqualPositions(const float* positions, size_t num_positions,
+                    size_t stride, const std::vector<float>& packed) {
+  if (packed.size() != 3 * num_positions) {
+    return false;
+  }
+  for (size_t i = 0; i < num_positions; ++i) {
+    if (memcmp(positions + i * stride, &packed[3 * i], 3 * sizeof(float))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Copies the xyz triplets in |positions| into the tightly packed |packed|.
+void PackPositions(const float* positions, size_t num_positions, size_t stride,
+                   std::vector<float>* packed) {
+  packed->resize(3 * num_positions);
+  for (size_t i = 0; i < num_positions; ++i) {
+    memcpy(&(*packed)[3 * i], positions + i * stride, 3 * sizeof(float));
+  }
+}
+
 }  // namespace
 
 DeformSystem::DeformSystem(Registry* registry)
@@ -215,6 +242,23 @@ void DeformSystem::SetDeformStrength(Entity e, float strength) {
   transform_system.RecalculateWorldFromEntityMatrix(e);
 }
 
+void DeformSystem::SetDeformStrengths(Span<Entity> entities,
+                                      Span<float> strengths) {
+  DCHECK_EQ(entities.size(), strengths.size());
+  changed_deformers_.clear();
+  for (size_t i = 0; i < entities.size(); ++i) {
+    Deformer* deformer = deformers_.Get(entities[i]);
+    if (!deformer) {
+      LOG(WARNING) << entities[i] << " is not a deformer";
+      continue;
+    }
+    deformer->deform_strength = strengths[i];
+    changed_deformers_.push_back(entities[i]);
+  }
+  auto& transform_system = *registry_->Get<TransformSystem>();
+  transform_system.RecalculateWorldFromEntityMatrices(changed_deformers_);
+}
+
 const Aabb* DeformSystem::UndeformedBoundingBox(Entity entity) const {
   const auto* deformed = deformed_.Get(entity);
   if (!deformed) {
@@ -332,8 +376,7 @@ void DeformSystem::DeformMesh(Entity e, MeshData* mesh) {
   if (deformed) {
     const Deformer* deformer = deformers_.Get(deformed->deformer);
     if (deformer != nullptr && deformer->mode == DeformMode_CylinderBend) {
-      deformed->undeformed_aabb = GetBoundingBox(*mesh);
-      CylinderBendDeformMesh(*deformed, *deformer, mesh);
+      CylinderBendDeformMesh(deformed, *deformer, mesh);
     } else if (deformer != nullptr && deformer->mode == DeformMode_Waypoint) {
       // Waypoint deformation deliberately does not deform mesh
     } else {
@@ -478,16 +521,17 @@ mathfu::mat4 DeformSystem::CalculateWaypointTransformMatrix(
                                             deformed_world_from_deformer);
 }
 
-void DeformSystem::CylinderBendDeformMesh(const Deformed& deformed,
+void DeformSystem::CylinderBendDeformMesh(Deformed* deformed,
                                           const Deformer& deformer,
                                           MeshData* mesh) const {
   const TransformSystem& transform_system = *registry_->Get<TransformSystem>();
   const mathfu::mat4* world_from_entity_deformed_space =
-      transform_system.GetWorldFromEntityMatrix(deformed.GetEntity());
+      transform_system.GetWorldFromEntityMatrix(deformed->GetEntity());
   const mathfu::mat4* world_from_deformer_deformed_space =
       transform_system.GetWorldFromEntityMatrix(deformer.GetEntity());
   if (!world_from_entity_deformed_space ||
       !world_from_deformer_deformed_space) {
+    deformed->undeformed_aabb = GetBoundingBox(*mesh);
     return;
   }
 
@@ -498,19 +542,62 @@ void DeformSystem::CylinderBendDeformMesh(const Deformed& deformed,
   const float radius = deformer.radius;
   const mathfu::mat4 root_from_entity_undeformed_space =
       mathfu::mat4::FromTranslationVector(-radius * mathfu::kAxisZ3f) *
-      deformed.deformer_from_entity_undeformed_space;
+      deformed->deformer_from_entity_undeformed_space;
 
   const mathfu::mat4 entity_from_root_deformed_space =
       world_from_entity_deformed_space->Inverse() *
       (*world_from_deformer_deformed_space) *
       mathfu::mat4::FromTranslationVector(radius * mathfu::kAxisZ3f);
 
-  ApplyDeformation(
-      mesh, [&radius, &root_from_entity_undeformed_space,
-             &entity_from_root_deformed_space](const mathfu::vec3& pos) {
-        return entity_from_root_deformed_space *
-               DeformPoint(root_from_entity_undeformed_space * pos, radius);
-      });
+  ApplyBatchDeformation(mesh, [&](float* positions, size_t num_positions,
+                                  size_t stride) {
+    // Meshes are often regenerated without their positions changing (eg. when
+    // only their color changes), so reuse the previous result if possible.
+    DeformedMeshCache& cache = deformed->mesh_cache;
+    if (cache.valid && cache.radius == radius &&
+        memcmp(&cache.root_from_entity_undeformed_space,
+               &root_from_entity_undeformed_space,
+               sizeof(root_from_entity_undeformed_space)) == 0 &&
+        memcmp(&cache.entity_from_root_deformed_space,
+               &entity_from_root_deformed_space,
+               sizeof(entity_from_root_deformed_space)) == 0 &&
+        EqualPositions(positions, num_positions, stride,
+                       cache.undeformed_positions)) {
+      for (size_t i = 0; i < num_positions; ++i) {
+        memcpy(positions + i * stride, &cache.deformed_positions[3 * i],
+               3 * sizeof(float));
+      }
+      deformed->undeformed_aabb = cache.undeformed_aabb;
+      return;
+    }
+
+    Aabb aabb;
+    if (num_positions > 0) {
+      aabb.min = aabb.max =
+          mathfu::vec3(positions[0], positions[1], positions[2]);
+    }
+    for (size_t i = 1; i < num_positions; ++i) {
+      const mathfu::vec3 position(positions[i * stride],
+                                  positions[i * stride + 1],
+                                  positions[i * stride + 2]);
+      aabb.min = mathfu::vec3::Min(aabb.min, position);
+      aabb.max = mathfu::vec3::Max(aabb.max, position);
+    }
+    deformed->undeformed_aabb = aabb;
+    PackPositions(positions, num_positions, stride,
+                  &cache.undeformed_positions);
+
+    CylinderBendPositions(positions, num_positions, stride,
+                          root_from_entity_undeformed_space, radius,
+                          entity_from_root_deformed_space);
+
+    PackPositions(positions, num_positions, stride, &cache.deformed_positions);
+    cache.valid = true;
+    cache.radius = radius;
+    cache.root_from_entity_undeformed_space = root_from_entity_undeformed_space;
+    cache.entity_from_root_deformed_space = entity_from_root_deformed_space;
+    cache.undeformed_aabb = aabb;
+  });
 }
 
 void DeformSystem::OnParentChanged(const ParentChangedEvent& ev) {
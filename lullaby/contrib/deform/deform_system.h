@@ -18,6 +18,7 @@ limitations under the License.
 #define LULLABY_SYSTEMS_DEFORM_DEFORM_SYSTEM_H_
 
 #include <unordered_map>
+#include <vector>
 
 #include "lullaby/generated/deform_def_generated.h"
 #include "lullaby/events/entity_events.h"
@@ -26,6 +27,7 @@ limitations under the License.
 #include "lullaby/modules/render/mesh_data.h"
 #include "lullaby/util/math.h"
 #include "lullaby/util/optional.h"
+#include "lullaby/util/span.h"
 #include "lullaby/util/string_view.h"
 
 namespace lull {
@@ -96,6 +98,11 @@ class DeformSystem : public System {
   // applied and 1 meaning that the deformer's children are all fully deformed.
   void SetDeformStrength(Entity e, float strength);
 
+  // Sets the strength of the deformation for each of the |entities| to the
+  // corresponding value in |strengths|, recalculating the affected transforms
+  // in a single pass.
+  void SetDeformStrengths(Span<Entity> entities, Span<float> strengths);
+
   // Returns the bounding box of the entity before deformation was applied.
   const Aabb* UndeformedBoundingBox(Entity entity) const;
 
@@ -156,6 +163,18 @@ class DeformSystem : public System {
     float deform_strength = 1.0f;
   };
 
+  // The deform parameters, undeformed positions, and results of a cylinder bend
+  // mesh deformation.  Positions are tightly packed xyz triplets.
+  struct DeformedMeshCache {
+    bool valid = false;
+    float radius = 0.f;
+    mathfu::mat4 root_from_entity_undeformed_space;
+    mathfu::mat4 entity_from_root_deformed_space;
+    std::vector<float> undeformed_positions;
+    std::vector<float> deformed_positions;
+    Aabb undeformed_aabb;
+  };
+
   struct Deformed : Component {
     explicit Deformed(Entity e) : Component(e), deformer(kNullEntity) {}
     Deformed(Entity e, const Deformed& prototype)
@@ -168,6 +187,10 @@ class DeformSystem : public System {
     // If the path that path_id points uses aabb anchors, Deformed needs to
     // keep a cached version that offsets based on its entity's aabb.
     std::unique_ptr<WaypointPath> anchored_path;
+
+    // The inputs and outputs of the last mesh deformation.  Used to skip
+    // deforming an identical mesh again.
+    DeformedMeshCache mesh_cache;
   };
 
   // Builds a WaypointPath from its def.
@@ -211,10 +234,11 @@ class DeformSystem : public System {
       const mathfu::mat4* world_from_parent_mat) const;
 
   // Deforms the given deformed component entity's mesh according to the radius
-  // and position of the given deformer entity. We expect this function to be
-  // called whenever someone updates the mesh of the deformed component.
-  void CylinderBendDeformMesh(const Deformed& deformed,
-                              const Deformer& deformer, MeshData* mesh) const;
+  // and position of the given deformer entity, and updates its undeformed
+  // aabb. We expect this function to be called whenever someone updates the
+  // mesh of the deformed component.
+  void CylinderBendDeformMesh(Deformed* deformed, const Deformer& deformer,
+                              MeshData* mesh) const;
 
   void OnParentChanged(const ParentChangedEvent& ev);
 
@@ -247,6 +271,9 @@ class DeformSystem : public System {
   ComponentPool<Deformer> deformers_;
   ComponentPool<Deformed> deformed_;
 
+  // Scratch buffer used by SetDeformStrengths().
+  std::vector<Entity> changed_deformers_;
+
   DeformSystem(const DeformSystem&);
   DeformSystem& operator=(const DeformSystem&);
 };
@@ -16,6 +16,9 @@ limitations under the License.
 
 #include "lullaby/contrib/layout/layout_system.h"
 
+#include <algorithm>
+#include <functional>
+
 #include "lullaby/events/render_events.h"
 #include "lullaby/modules/animation_channels/transform_channels.h"
 #include "lullaby/modules/dispatcher/dispatcher.h"
@@ -29,6 +32,7 @@ limitations under the License.
 #include "lullaby/systems/transform/transform_system.h"
 #include "lullaby/util/logging.h"
 #include "lullaby/util/math.h"
+#include "lullaby/util/span.h"
 #include "lullaby/util/time.h"
 
 namespace {
@@ -467,7 +471,14 @@ void LayoutSystem::SetLayoutPosition(Entity entity,
 
   if (!animation_system || layout_element.first ||
       layout_element.duration <= Clock::duration::zero()) {
-    transform_system->SetLocalTranslation(entity, translation);
+    // Children that are already in place are skipped so that their world
+    // matrices are not needlessly recalculated.
+    const Sqt* sqt = transform_system->GetSqt(entity);
+    if (sqt && !(sqt->translation == translation)) {
+      moved_entities_.push_back(entity);
+      moved_sqts_.push_back(*sqt);
+      moved_sqts_.back().translation = translation;
+    }
   } else {
     animation_system->SetTarget(entity, PositionChannel::kChannelName,
                                 &translation[0], 3, layout_element.duration);
@@ -475,6 +486,18 @@ void LayoutSystem::SetLayoutPosition(Entity entity,
   layout_element.first = false;
 }
 
+void LayoutSystem::ApplyLayoutPositions(size_t first) {
+  if (moved_entities_.size() > first) {
+    auto* transform_system = registry_->Get<TransformSystem>();
+    transform_system->SetSqts(
+        Span<Entity>(moved_entities_.data() + first,
+                     moved_entities_.size() - first),
+        Span<Sqt>(moved_sqts_.data() + first, moved_sqts_.size() - first));
+  }
+  moved_entities_.resize(first);
+  moved_sqts_.resize(first);
+}
+
 // When the parameters for determining a Layout change, e.g.
 // OriginalBoxChanged, ParentChangedEvent, or any change in LayoutParams, then
 // the Layout will set its original_size and its children's desired_size.
@@ -556,9 +579,13 @@ void LayoutSystem::LayoutImpl(const DirtyLayout& dirty_layout) {
     const auto set_pos_fn = [this](Entity entity, const mathfu::vec2& pos) {
       SetLayoutPosition(entity, pos);
     };
+    // Nested layouts may run while ApplyLayout() resizes the children, so only
+    // write the positions queued by this layout.
+    const size_t first_moved = moved_entities_.size();
     const Aabb aabb = ApplyLayout(registry_, params, elements, set_pos_fn,
                                   dirty_layout.GetChildrensDesiredSource(),
                                   &layout->cached_positions);
+    ApplyLayoutPositions(first_moved);
     transform_system->SetAabb(e, aabb);
 
     if (dirty_layout.ShouldSetActualBox()) {
@@ -587,17 +614,51 @@ LayoutElement& LayoutSystem::GetLayoutElement(Entity e) {
   }
 }
 
+size_t LayoutSystem::GetDepth(Entity e) const {
+  const auto* transform_system = registry_->Get<TransformSystem>();
+  size_t depth = 0;
+  for (Entity parent = transform_system->GetParent(e); parent != kNullEntity;
+       parent = transform_system->GetParent(parent)) {
+    ++depth;
+  }
+  return depth;
+}
+
 void LayoutSystem::ProcessDirty() {
-  // Copy dirty layouts in case the Dispatcher is not Queued.
-  std::unordered_map<Entity, DirtyLayout> dirty_layouts_copy;
-  using std::swap;
-  swap(dirty_layouts_copy, dirty_layouts_);
-  for (const auto& pair : dirty_layouts_copy) {
-    LayoutImpl(pair.second);
+  // Move dirty layouts to the pending set in case the Dispatcher is not Queued,
+  // since processing a layout may then dirty other layouts immediately.
+  std::vector<std::pair<size_t, Entity>> order;
+  order.reserve(dirty_layouts_.size());
+  for (const auto& pair : dirty_layouts_) {
+    order.emplace_back(GetDepth(pair.first), pair.first);
+    pending_layouts_.emplace(pair.first, pair.second);
+  }
+  dirty_layouts_.clear();
+
+  // Process the deepest layouts first, so that a parent measures its children
+  // after they have been resized instead of having to lay them out again.
+  std::sort(order.begin(), order.end(),
+            std::greater<std::pair<size_t, Entity>>());
+  for (const auto& entry : order) {
+    auto iter = pending_layouts_.find(entry.second);
+    if (iter == pending_layouts_.end()) {
+      continue;
+    }
+    const DirtyLayout dirty_layout = iter->second;
+    pending_layouts_.erase(iter);
+    LayoutImpl(dirty_layout);
   }
 }
 
 void LayoutSystem::SetDirty(Entity e, LayoutPass pass, Entity source) {
+  // A layout that is still waiting to be processed by ProcessDirty() will pick
+  // up the new pass when it gets there.
+  auto pending = pending_layouts_.find(e);
+  if (pending != pending_layouts_.end()) {
+    pending->second.Update(registry_, pass, source);
+    return;
+  }
+
   const bool was_clean = dirty_layouts_.empty();
   // Insert this before sending event in case the Dispatcher is not Queued.
   auto iter = dirty_layouts_.find(e);
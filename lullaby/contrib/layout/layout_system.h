@@ -20,6 +20,7 @@ limitations under the License.
 #include <queue>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include "lullaby/generated/layout_def_generated.h"
 #include "lullaby/events/entity_events.h"
@@ -157,9 +158,15 @@ class LayoutSystem : public System {
     Entity actual_source_ = kNullEntity;
   };
 
+  // Queues the new position of a child, which is written to the
+  // TransformSystem together with its siblings by ApplyLayoutPositions().
   void SetLayoutPosition(Entity entity, const mathfu::vec2& position);
+  // Writes all positions queued since |first| in a single SetSqts() call.
+  void ApplyLayoutPositions(size_t first);
   void LayoutImpl(const DirtyLayout& dirty_layout);
   LayoutElement& GetLayoutElement(Entity e);
+  // Returns the number of ancestors of |e| in the transform hierarchy.
+  size_t GetDepth(Entity e) const;
   void ProcessDirty();
   void SetDirty(Entity e, LayoutPass pass, Entity source = kNullEntity);
   void SetParentDirty(Entity e, LayoutPass pass, Entity source = kNullEntity);
@@ -180,6 +187,13 @@ class LayoutSystem : public System {
   std::unordered_set<Entity> ignored_layout_elements_;
   std::unordered_map<Entity, LayoutElement> layout_elements_;
   std::unordered_map<Entity, DirtyLayout> dirty_layouts_;
+  // Layouts taken from |dirty_layouts_| by ProcessDirty() that have not been
+  // processed yet.  Dirtying one of these again merges into the existing entry
+  // so that it is still only laid out once.
+  std::unordered_map<Entity, DirtyLayout> pending_layouts_;
+  // Positions queued by SetLayoutPosition() for the bulk transform write.
+  std::vector<Entity> moved_entities_;
+  std::vector<Sqt> moved_sqts_;
 
   LayoutSystem(const LayoutSystem&) = delete;
   LayoutSystem& operator=(const LayoutSystem&) = delete;
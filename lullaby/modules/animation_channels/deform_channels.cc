@@ -58,4 +58,19 @@ void DeformStrengthChannel::Set(Entity entity, const float* values,
   deform_system_->SetDeformStrength(entity, values[0]);
 }
 
+void DeformStrengthChannel::SetBatch(Span<Entity> entities, Span<float> values,
+                                     Span<size_t> lengths) {
+  batch_entities_.clear();
+  batch_strengths_.clear();
+  const float* data = values.data();
+  for (size_t i = 0; i < entities.size(); ++i) {
+    if (lengths[i] >= 1) {
+      batch_entities_.push_back(entities[i]);
+      batch_strengths_.push_back(data[0]);
+    }
+    data += lengths[i];
+  }
+  deform_system_->SetDeformStrengths(batch_entities_, batch_strengths_);
+}
+
 }  // namespace lull
@@ -17,6 +17,8 @@ limitations under the License.
 #ifndef LULLABY_UTIL_DEFORM_CHANNELS_H_
 #define LULLABY_UTIL_DEFORM_CHANNELS_H_
 
+#include <vector>
+
 #include "lullaby/systems/animation/animation_channel.h"
 #include "lullaby/util/registry.h"
 
@@ -36,7 +38,11 @@ class DeformStrengthChannel : public AnimationChannel {
  private:
   bool Get(Entity entity, float* values, size_t length) const override;
   void Set(Entity entity, const float* values, size_t length) override;
+  void SetBatch(Span<Entity> entities, Span<float> values,
+                Span<size_t> lengths) override;
   DeformSystem* deform_system_;
+  std::vector<Entity> batch_entities_;
+  std::vector<float> batch_strengths_;
 };
 
 }  // namespace lull
@@ -50,6 +50,67 @@ const motive::MatrixOperationType kRotateOps[] = {
 const motive::MatrixOperationType kScaleOps[] = {
     motive::kScaleX, motive::kScaleY, motive::kScaleZ};
 
+void SetTranslation(const float* values, Sqt* sqt) {
+  sqt->translation.x = values[0];
+  sqt->translation.y = values[1];
+  sqt->translation.z = values[2];
+}
+
+void SetTranslationX(const float* values, Sqt* sqt) {
+  sqt->translation.x = values[0];
+}
+
+void SetTranslationY(const float* values, Sqt* sqt) {
+  sqt->translation.y = values[0];
+}
+
+void SetTranslationZ(const float* values, Sqt* sqt) {
+  sqt->translation.z = values[0];
+}
+
+void SetRotation(const float* values, Sqt* sqt) {
+  const mathfu::vec3 angles(values[0], values[1], values[2]);
+  sqt->rotation = mathfu::quat::FromEulerAngles(angles);
+}
+
+void SetScale(const float* values, Sqt* sqt) {
+  sqt->scale.x = values[0];
+  sqt->scale.y = values[1];
+  sqt->scale.z = values[2];
+}
+
+// Updates the Sqt of |entity| using |fn|.
+void UpdateSqt(TransformSystem* transform_system, Entity entity,
+               const float* values, void (*fn)(const float*, Sqt*)) {
+  const Sqt* sqt = transform_system->GetSqt(entity);
+  if (sqt == nullptr) {
+    return;
+  }
+  Sqt updated_sqt = *sqt;
+  fn(values, &updated_sqt);
+  transform_system->SetSqt(entity, updated_sqt);
+}
+
+// Updates the Sqts of all |entities| using |fn| and applies them with a single
+// call to TransformSystem::SetSqts().
+void UpdateSqts(TransformSystem* transform_system, Span<Entity> entities,
+                Span<float> values, Span<size_t> lengths,
+                detail::SqtBatch* batch, void (*fn)(const float*, Sqt*)) {
+  batch->entities.clear();
+  batch->sqts.clear();
+  const float* data = values.data();
+  for (size_t i = 0; i < entities.size(); ++i) {
+    const Sqt* sqt = transform_system->GetSqt(entities[i]);
+    if (sqt) {
+      batch->entities.push_back(entities[i]);
+      batch->sqts.push_back(*sqt);
+      fn(data, &batch->sqts.back());
+    }
+    data += lengths[i];
+  }
+  transform_system->SetSqts(batch->entities, batch->sqts);
+}
+
 }  // namespace
 
 PositionChannel::PositionChannel(Registry* registry, size_t pool_size)
@@ -93,15 +154,13 @@ bool PositionChannel::Get(Entity e, float* values, size_t len) const {
 }
 
 void PositionChannel::Set(Entity e, const float* values, size_t len) {
-  const Sqt* sqt = transform_system_->GetSqt(e);
-  if (sqt == nullptr) {
-    return;
-  }
-  Sqt updated_sqt = *sqt;
-  updated_sqt.translation.x = values[0];
-  updated_sqt.translation.y = values[1];
-  updated_sqt.translation.z = values[2];
-  transform_system_->SetSqt(e, updated_sqt);
+  UpdateSqt(transform_system_, e, values, SetTranslation);
+}
+
+void PositionChannel::SetBatch(Span<Entity> entities, Span<float> values,
+                               Span<size_t> lengths) {
+  UpdateSqts(transform_system_, entities, values, lengths, &batch_,
+             SetTranslation);
 }
 
 PositionXChannel::PositionXChannel(Registry* registry, size_t pool_size)
@@ -132,13 +191,13 @@ bool PositionXChannel::Get(Entity e, float* values, size_t len) const {
 }
 
 void PositionXChannel::Set(Entity e, const float* values, size_t len) {
-  const Sqt* sqt = transform_system_->GetSqt(e);
-  if (sqt == nullptr) {
-    return;
-  }
-  Sqt updated_sqt = *sqt;
-  updated_sqt.translation.x = values[0];
-  transform_system_->SetSqt(e, updated_sqt);
+  UpdateSqt(transform_system_, e, values, SetTranslationX);
+}
+
+void PositionXChannel::SetBatch(Span<Entity> entities, Span<float> values,
+                                Span<size_t> lengths) {
+  UpdateSqts(transform_system_, entities, values, lengths, &batch_,
+             SetTranslationX);
 }
 
 PositionYChannel::PositionYChannel(Registry* registry, size_t pool_size)
@@ -169,13 +228,13 @@ bool PositionYChannel::Get(Entity e, float* values, size_t len) const {
 }
 
 void PositionYChannel::Set(Entity e, const float* values, size_t len) {
-  const Sqt* sqt = transform_system_->GetSqt(e);
-  if (sqt == nullptr) {
-    return;
-  }
-  Sqt updated_sqt = *sqt;
-  updated_sqt.translation.y = values[0];
-  transform_system_->SetSqt(e, updated_sqt);
+  UpdateSqt(transform_system_, e, values, SetTranslationY);
+}
+
+void PositionYChannel::SetBatch(Span<Entity> entities, Span<float> values,
+                                Span<size_t> lengths) {
+  UpdateSqts(transform_system_, entities, values, lengths, &batch_,
+             SetTranslationY);
 }
 
 PositionZChannel::PositionZChannel(Registry* registry, size_t pool_size)
@@ -206,13 +265,13 @@ bool PositionZChannel::Get(Entity e, float* values, size_t len) const {
 }
 
 void PositionZChannel::Set(Entity e, const float* values, size_t len) {
-  const Sqt* sqt = transform_system_->GetSqt(e);
-  if (sqt == nullptr) {
-    return;
-  }
-  Sqt updated_sqt = *sqt;
-  updated_sqt.translation.z = values[0];
-  transform_system_->SetSqt(e, updated_sqt);
+  UpdateSqt(transform_system_, e, values, SetTranslationZ);
+}
+
+void PositionZChannel::SetBatch(Span<Entity> entities, Span<float> values,
+                                Span<size_t> lengths) {
+  UpdateSqts(transform_system_, entities, values, lengths, &batch_,
+             SetTranslationZ);
 }
 
 RotationChannel::RotationChannel(Registry* registry, size_t pool_size)
@@ -259,14 +318,13 @@ bool RotationChannel::Get(Entity e, float* values, size_t len) const {
 }
 
 void RotationChannel::Set(Entity e, const float* values, size_t len) {
-  const Sqt* sqt = transform_system_->GetSqt(e);
-  if (sqt) {
-    const mathfu::vec3 angles(values[0], values[1], values[2]);
+  UpdateSqt(transform_system_, e, values, SetRotation);
+}
 
-    Sqt updated_sqt = *sqt;
-    updated_sqt.rotation = mathfu::quat::FromEulerAngles(angles);
-    transform_system_->SetSqt(e, updated_sqt);
-  }
+void RotationChannel::SetBatch(Span<Entity> entities, Span<float> values,
+                               Span<size_t> lengths) {
+  UpdateSqts(transform_system_, entities, values, lengths, &batch_,
+             SetRotation);
 }
 
 ScaleChannel::ScaleChannel(Registry* registry, size_t pool_size)
@@ -311,14 +369,13 @@ bool ScaleChannel::Get(Entity e, float* values, size_t len) const {
 }
 
 void ScaleChannel::Set(Entity e, const float* values, size_t len) {
-  const Sqt* sqt = transform_system_->GetSqt(e);
-  if (sqt) {
-    Sqt updated_sqt = *sqt;
-    updated_sqt.scale.x = values[0];
-    updated_sqt.scale.y = values[1];
-    updated_sqt.scale.z = values[2];
-    transform_system_->SetSqt(e, updated_sqt);
-  }
+  UpdateSqt(transform_system_, e, values, SetScale);
+}
+
+void ScaleChannel::SetBatch(Span<Entity> entities, Span<float> values,
+                            Span<size_t> lengths) {
+  UpdateSqts(transform_system_, entities, values, lengths, &batch_,
+             SetScale);
 }
 
 ScaleFromRigChannel::ScaleFromRigChannel(Registry* registry, size_t pool_size)
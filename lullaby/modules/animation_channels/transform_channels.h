@@ -17,13 +17,27 @@ limitations under the License.
 #ifndef LULLABY_MODULES_ANIMATION_CHANNELS_TRANSFORM_CHANNELS_H_
 #define LULLABY_MODULES_ANIMATION_CHANNELS_TRANSFORM_CHANNELS_H_
 
+#include <vector>
+
 #include "lullaby/systems/animation/animation_channel.h"
+#include "lullaby/util/math.h"
 #include "lullaby/util/registry.h"
 
 namespace lull {
 
 class TransformSystem;
 
+namespace detail {
+
+// Scratch buffers used by the transform channels to apply the values of all
+// their animations with a single call to TransformSystem::SetSqts().
+struct SqtBatch {
+  std::vector<Entity> entities;
+  std::vector<Sqt> sqts;
+};
+
+}  // namespace detail
+
 // Channel for animating Transform position.
 class PositionChannel : public AnimationChannel {
  public:
@@ -38,7 +52,10 @@ class PositionChannel : public AnimationChannel {
  private:
   bool Get(Entity e, float* values, size_t len) const override;
   void Set(Entity e, const float* values, size_t len) override;
+  void SetBatch(Span<Entity> entities, Span<float> values,
+                Span<size_t> lengths) override;
   TransformSystem* transform_system_;
+  detail::SqtBatch batch_;
 };
 
 // Channel for animating only the x-position of an entity.
@@ -55,7 +72,10 @@ class PositionXChannel : public AnimationChannel {
  private:
   bool Get(Entity e, float* values, size_t len) const override;
   void Set(Entity e, const float* values, size_t len) override;
+  void SetBatch(Span<Entity> entities, Span<float> values,
+                Span<size_t> lengths) override;
   TransformSystem* transform_system_;
+  detail::SqtBatch batch_;
 };
 
 // Channel for animating only the y-position of an entity.
@@ -72,7 +92,10 @@ class PositionYChannel : public AnimationChannel {
  private:
   bool Get(Entity e, float* values, size_t len) const override;
   void Set(Entity e, const float* values, size_t len) override;
+  void SetBatch(Span<Entity> entities, Span<float> values,
+                Span<size_t> lengths) override;
   TransformSystem* transform_system_;
+  detail::SqtBatch batch_;
 };
 
 // Channel for animating only the z-position of an entity.
@@ -89,7 +112,10 @@ class PositionZChannel : public AnimationChannel {
  private:
   bool Get(Entity e, float* values, size_t len) const override;
   void Set(Entity e, const float* values, size_t len) override;
+  void SetBatch(Span<Entity> entities, Span<float> values,
+                Span<size_t> lengths) override;
   TransformSystem* transform_system_;
+  detail::SqtBatch batch_;
 };
 
 // Channel for animating Transform rotation.
@@ -106,7 +132,10 @@ class RotationChannel : public AnimationChannel {
  private:
   bool Get(Entity e, float* values, size_t len) const override;
   void Set(Entity e, const float* values, size_t len) override;
+  void SetBatch(Span<Entity> entities, Span<float> values,
+                Span<size_t> lengths) override;
   TransformSystem* transform_system_;
+  detail::SqtBatch batch_;
 };
 
 // Channel for animating Transform scale.
@@ -123,7 +152,10 @@ class ScaleChannel : public AnimationChannel {
  private:
   bool Get(Entity e, float* values, size_t len) const override;
   void Set(Entity e, const float* values, size_t len) override;
+  void SetBatch(Span<Entity> entities, Span<float> values,
+                Span<size_t> lengths) override;
   TransformSystem* transform_system_;
+  detail::SqtBatch batch_;
 };
 
 // Channel for animating Transform scale from an fbx.
@@ -32,7 +32,7 @@ namespace lull {
 //
 // This class is not thread-safe.  All calls to an instance of this class must
 // be done synchronously.
-class Dispatcher::EventHandlerMap {
+class Dispatcher::EventHandlerMap : public Dispatcher::HandlerStore {
  public:
   EventHandlerMap();
 
@@ -41,7 +41,7 @@ class Dispatcher::EventHandlerMap {
 
   // Removes an EventHandler that matches the given parameters as best as
   // possible.
-  void Remove(TypeId type, ConnectionId id, const void* owner);
+  void Remove(TypeId type, ConnectionId id, const void* owner) override;
 
   // Pass the |event| to all EventHandlers associated with the same TypeId as
   // the |event|.
@@ -138,8 +138,9 @@ size_t Dispatcher::GetHandlerCount(TypeId type) const {
 
 Dispatcher::Connection::Connection() : type_(0), id_(0), handlers_() {}
 
-Dispatcher::Connection::Connection(const EventHandlerMapPtr& handlers,
-                                   TypeId type, ConnectionId id)
+Dispatcher::Connection::Connection(
+    const std::shared_ptr<HandlerStore>& handlers, TypeId type,
+    ConnectionId id)
     : type_(type), id_(id), handlers_(handlers) {}
 
 void Dispatcher::Connection::Disconnect() {
@@ -99,7 +99,6 @@ class Dispatcher {
   /// associated typedefs).
   class EventHandlerMap;
   typedef std::shared_ptr<EventHandlerMap> EventHandlerMapPtr;
-  typedef std::weak_ptr<EventHandlerMap> EventHandlerMapWeakPtr;
 
  public:
   /// Unique identifier given to each connection.
@@ -107,12 +106,26 @@ class Dispatcher {
   /// The underlying functor used for handling events.
   using EventHandler = std::function<void(const EventWrapper&)>;
 
+  /// Interface for the storage of connected EventHandlers.  Connections hold a
+  /// weak reference to the store so that they can be safely disconnected after
+  /// the store has been destroyed.  This allows classes other than the
+  /// Dispatcher (eg. the DispatcherSystem) to hand out Connections.
+  class HandlerStore {
+   public:
+    virtual ~HandlerStore() {}
+
+    /// Removes the EventHandler of the given |type| and |id|.  If |id| is 0,
+    /// removes all EventHandlers of the given |type| associated with |owner|.
+    /// A |type| of 0 matches all types.
+    virtual void Remove(TypeId type, ConnectionId id, const void* owner) = 0;
+  };
+
   /// Connection object returned by Dispatcher::Connect which must be explicitly
   /// disconnected by calling Connection::Disconnect().
   class Connection {
    public:
     Connection();
-    Connection(const EventHandlerMapPtr& handlers, TypeId type,
+    Connection(const std::shared_ptr<HandlerStore>& handlers, TypeId type,
                ConnectionId id);
 
     /// Disconnect event handler from the dispatcher.  It is safe to call this
@@ -125,7 +138,7 @@ class Dispatcher {
    private:
     TypeId type_;
     ConnectionId id_;
-    EventHandlerMapWeakPtr handlers_;
+    std::weak_ptr<HandlerStore> handlers_;
   };
 
   /// ScopedConnection object returned by Dispatcher::Connect which will
@@ -228,6 +241,11 @@ class Dispatcher {
   /// Returns the number of functions listening for an event of |type|.
   size_t GetHandlerCount(TypeId type) const;
 
+  /// Wraps a |handler| that takes a concrete Event (ie. void(const Event&)) in
+  /// an EventHandler.  The TypeId of the Event is written to |type|.
+  template <typename Fn>
+  static EventHandler WrapHandler(Fn&& handler, TypeId* type);
+
   /// Helper function declaration that is used to extract the Event type from
   /// an event handler.
   template <typename Fn, typename Arg>
@@ -279,14 +297,21 @@ Dispatcher::ScopedConnection Dispatcher::Connect(Fn&& handler) {
 
 template <typename Fn>
 Dispatcher::Connection Dispatcher::Connect(const void* owner, Fn&& handler) {
+  TypeId type = 0;
+  EventHandler fn = WrapHandler(std::forward<Fn>(handler), &type);
+  return ConnectImpl(type, owner, std::move(fn));
+}
+
+template <typename Fn>
+Dispatcher::EventHandler Dispatcher::WrapHandler(Fn&& handler, TypeId* type) {
   using FnType = typename std::remove_reference<Fn>::type;
   using Event = decltype(ConnectHelper(&FnType::operator()));
 
-  const TypeId type = GetTypeId<Event>();
-  return ConnectImpl(type, owner, [handler](const EventWrapper& event) mutable {
+  *type = GetTypeId<Event>();
+  return [handler](const EventWrapper& event) mutable {
     const Event* obj = event.Get<Event>();
     handler(*obj);
-  });
+  };
 }
 
 template <typename Event>
@@ -0,0 +1,143 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/modules/dispatcher/event_payload.h"
+
+#include <algorithm>
+#include <mutex>
+#include <new>
+
+#include "lullaby/util/aligned_alloc.h"
+#include "lullaby/util/logging.h"
+
+namespace lull {
+namespace detail {
+namespace {
+
+// Payloads are pooled in blocks of 64, 128, 256, 512 and 1024 bytes (including
+// the EventPayload header).  Larger or over-aligned payloads are allocated
+// directly.
+constexpr size_t kNumSizeClasses = 5;
+constexpr size_t kSmallestBlockSize = 64;
+constexpr uint8_t kUnpooled = 0xff;
+
+// Maximum number of unused blocks kept around per size class.
+constexpr size_t kMaxFreeBlocks = 256;
+
+size_t GetBlockSize(size_t size_class) {
+  return kSmallestBlockSize << size_class;
+}
+
+// Thread-safe free lists of payload blocks, one per size class.  Unused blocks
+// are linked together through their first bytes.
+class PayloadPool {
+ public:
+  void* Allocate(uint8_t size_class) {
+    FreeList& list = lists_[size_class];
+    {
+      std::lock_guard<std::mutex> lock(list.mutex);
+      if (list.head) {
+        FreeBlock* block = list.head;
+        list.head = block->next;
+        --list.count;
+        return block;
+      }
+    }
+    return ::operator new(GetBlockSize(size_class));
+  }
+
+  void Free(void* ptr, uint8_t size_class) {
+    FreeList& list = lists_[size_class];
+    {
+      std::lock_guard<std::mutex> lock(list.mutex);
+      if (list.count < kMaxFreeBlocks) {
+        FreeBlock* block = new (ptr) FreeBlock();
+        block->next = list.head;
+        list.head = block;
+        ++list.count;
+        return;
+      }
+    }
+    ::operator delete(ptr);
+  }
+
+ private:
+  struct FreeBlock {
+    FreeBlock* next = nullptr;
+  };
+
+  struct FreeList {
+    std::mutex mutex;
+    FreeBlock* head = nullptr;
+    size_t count = 0;
+  };
+
+  FreeList lists_[kNumSizeClasses];
+};
+
+PayloadPool* GetPool() {
+  // Intentionally leaked so that events destroyed during static destruction
+  // can still return their payloads.
+  static PayloadPool* pool = new PayloadPool();
+  return pool;
+}
+
+}  // namespace
+
+EventPayload* EventPayload::Create(size_t size, size_t align,
+                                   DestroyFn destroy) {
+  // The object is stored directly after the header, aligned as required.
+  const size_t offset = std::max(sizeof(EventPayload), align);
+  const size_t total_size = offset + size;
+  DCHECK_LE(offset, static_cast<size_t>(UINT16_MAX));
+
+  uint8_t size_class = kUnpooled;
+  if (align <= alignof(std::max_align_t)) {
+    for (uint8_t i = 0; i < kNumSizeClasses; ++i) {
+      if (total_size <= GetBlockSize(i)) {
+        size_class = i;
+        break;
+      }
+    }
+  }
+
+  void* block = nullptr;
+  if (size_class != kUnpooled) {
+    block = GetPool()->Allocate(size_class);
+  } else {
+    block = AlignedAlloc(total_size, std::max(align, alignof(EventPayload)));
+  }
+  return new (block)
+      EventPayload(static_cast<uint16_t>(offset), size_class, destroy);
+}
+
+void EventPayload::Release() {
+  if (refs_.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+    return;
+  }
+
+  destroy_(Data());
+  const uint8_t size_class = size_class_;
+  this->~EventPayload();
+  if (size_class != kUnpooled) {
+    GetPool()->Free(this, size_class);
+  } else {
+    AlignedFree(this);
+  }
+}
+
+}  // namespace detail
+}  // namespace lull
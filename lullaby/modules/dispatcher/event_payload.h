@@ -0,0 +1,79 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef LULLABY_MODULES_DISPATCHER_EVENT_PAYLOAD_H_
+#define LULLABY_MODULES_DISPATCHER_EVENT_PAYLOAD_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace lull {
+namespace detail {
+
+/// A reference-counted block of memory that stores the data of an Event, ie.
+/// either a copy of a concrete Event or the values of a runtime Event.
+///
+/// Payloads are immutable while they are shared, which allows copies of an
+/// EventWrapper to share a single payload instead of copying the Event data.
+/// Small payloads are allocated from per-size-class free lists, so once an
+/// application has warmed up, creating and destroying events does not require
+/// any heap allocations.  Payloads may be released from any thread.
+class EventPayload {
+ public:
+  /// Function used to destroy the object stored in a payload.
+  using DestroyFn = void (*)(void*);
+
+  /// Allocates a payload with a single reference that can store an object of
+  /// the given |size| and |align|.  The object itself must be constructed in
+  /// Data() by the caller, and is destroyed using |destroy| once the last
+  /// reference to the payload is released.
+  static EventPayload* Create(size_t size, size_t align, DestroyFn destroy);
+
+  /// Returns the memory in which the object is stored.
+  void* Data() { return reinterpret_cast<uint8_t*>(this) + offset_; }
+  const void* Data() const {
+    return reinterpret_cast<const uint8_t*>(this) + offset_;
+  }
+
+  /// Adds a reference to the payload.
+  void AddRef() { refs_.fetch_add(1, std::memory_order_relaxed); }
+
+  /// Removes a reference from the payload.  Once the last reference is removed,
+  /// the stored object is destroyed and the memory is returned to its pool.
+  void Release();
+
+  /// Returns true if more than one owner references the payload, in which case
+  /// the stored object must not be modified.
+  bool IsShared() const { return refs_.load(std::memory_order_acquire) > 1; }
+
+ private:
+  EventPayload(uint16_t offset, uint8_t size_class, DestroyFn destroy)
+      : refs_(1), offset_(offset), size_class_(size_class), destroy_(destroy) {}
+
+  EventPayload(const EventPayload&) = delete;
+  EventPayload& operator=(const EventPayload&) = delete;
+
+  std::atomic<int> refs_;
+  uint16_t offset_;
+  uint8_t size_class_;
+  DestroyFn destroy_;
+};
+
+}  // namespace detail
+}  // namespace lull
+
+#endif  // LULLABY_MODULES_DISPATCHER_EVENT_PAYLOAD_H_
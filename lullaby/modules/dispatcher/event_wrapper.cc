@@ -23,9 +23,10 @@ EventWrapper::EventWrapper(TypeId type, string_view name)
       size_(0),
       align_(0),
       ptr_(nullptr),
-      data_(new VariantMap()),
+      event_payload_(nullptr),
+      data_(CreateValues(nullptr)),
       handler_(nullptr),
-      owned_(kDoNotOwn),
+      destroy_(nullptr),
       serializable_(true) {
 #if LULLABY_TRACK_EVENT_NAMES
   name_ = std::string(name);
@@ -37,20 +38,25 @@ EventWrapper::EventWrapper(const EventWrapper& rhs)
       size_(rhs.size_),
       align_(rhs.align_),
       ptr_(nullptr),
-      data_(nullptr),
+      event_payload_(rhs.event_payload_),
+      data_(rhs.data_),
       handler_(rhs.handler_),
-      owned_(kDoNotOwn),
+      destroy_(rhs.destroy_),
       serializable_(rhs.serializable_) {
 #if LULLABY_TRACK_EVENT_NAMES
   name_ = std::move(rhs.name_);
 #endif
-  if (rhs.ptr_) {
-    ptr_ = AlignedAlloc(size_, align_);
-    owned_ = kTakeOwnership;
+  if (event_payload_) {
+    // The concrete event is already owned by |rhs|, so just share it.
+    event_payload_->AddRef();
+    ptr_ = rhs.ptr_;
+  } else if (rhs.ptr_) {
+    event_payload_ = detail::EventPayload::Create(size_, align_, destroy_);
+    ptr_ = event_payload_->Data();
     handler_(kCopy, ptr_, rhs.ptr_);
   }
-  if (rhs.data_) {
-    data_.reset(new VariantMap(*rhs.data_));
+  if (data_) {
+    data_->AddRef();
   }
 }
 
@@ -59,9 +65,10 @@ EventWrapper::EventWrapper(EventWrapper&& rhs)
       size_(rhs.size_),
       align_(rhs.align_),
       ptr_(nullptr),
+      event_payload_(nullptr),
       data_(nullptr),
       handler_(nullptr),
-      owned_(kDoNotOwn),
+      destroy_(nullptr),
       serializable_(rhs.serializable_) {
 #if LULLABY_TRACK_EVENT_NAMES
   name_ = rhs.name_;
@@ -79,9 +86,10 @@ EventWrapper& EventWrapper::operator=(EventWrapper&& rhs) {
   swap(size_, rhs.size_);
   swap(align_, rhs.align_);
   swap(ptr_, rhs.ptr_);
+  swap(event_payload_, rhs.event_payload_);
   swap(data_, rhs.data_);
   swap(handler_, rhs.handler_);
-  swap(owned_, rhs.owned_);
+  swap(destroy_, rhs.destroy_);
   swap(serializable_, rhs.serializable_);
 #if LULLABY_TRACK_EVENT_NAMES
   swap(name_, rhs.name_);
@@ -90,9 +98,11 @@ EventWrapper& EventWrapper::operator=(EventWrapper&& rhs) {
 }
 
 EventWrapper::~EventWrapper() {
-  if (owned_ == kTakeOwnership) {
-    handler_(kDestroy, ptr_, nullptr);
-    AlignedFree(ptr_);
+  if (event_payload_) {
+    event_payload_->Release();
+  }
+  if (data_) {
+    data_->Release();
   }
 }
 
@@ -103,7 +113,7 @@ void EventWrapper::SetValue(HashValue key, const Variant& value) {
   }
 
   if (data_) {
-    data_->emplace(key, value);
+    MutableValues()->emplace(key, value);
   }
 }
 
@@ -114,7 +124,7 @@ void EventWrapper::SetValues(const VariantMap& values) {
   }
 
   if (data_) {
-    *data_ = values;
+    MutableValues()->assign(values.begin(), values.end());
   }
 }
 
@@ -125,13 +135,75 @@ void EventWrapper::SetValues(VariantMap&& values) {
   }
 
   if (data_) {
-    *data_ = std::move(values);
+    SmallVariantMap* data = MutableValues();
+    data->clear();
+    data->reserve(values.size());
+    for (auto& iter : values) {
+      data->emplace(iter.first, std::move(iter.second));
+    }
+  }
+}
+
+void EventWrapper::SetValues(const SmallVariantMap& values) {
+  if (ptr_) {
+    LOG(ERROR) << "Cannot set value on a concrete event.";
+    return;
+  }
+
+  if (data_) {
+    *MutableValues() = values;
+  }
+}
+
+void EventWrapper::SetValues(SmallVariantMap&& values) {
+  if (ptr_) {
+    LOG(ERROR) << "Cannot set value on a concrete event.";
+    return;
+  }
+
+  if (data_) {
+    *MutableValues() = std::move(values);
   }
 }
 
-const VariantMap* EventWrapper::GetValues() const {
+const SmallVariantMap* EventWrapper::GetValues() const {
   EnsureRuntimeEventAvailable();
-  return data_ ? data_.get() : nullptr;
+  return Values();
+}
+
+VariantMap EventWrapper::GetValuesAsVariantMap() const {
+  const SmallVariantMap* values = GetValues();
+  return values ? VariantMap(values->begin(), values->end()) : VariantMap();
+}
+
+static void DestroyValues(void* ptr) {
+  reinterpret_cast<SmallVariantMap*>(ptr)->~SmallVariantMap();
+}
+
+detail::EventPayload* EventWrapper::CreateValues(
+    const SmallVariantMap* values) {
+  detail::EventPayload* payload = detail::EventPayload::Create(
+      sizeof(SmallVariantMap), alignof(SmallVariantMap), &DestroyValues);
+  if (values) {
+    new (payload->Data()) SmallVariantMap(*values);
+  } else {
+    new (payload->Data()) SmallVariantMap();
+  }
+  return payload;
+}
+
+const SmallVariantMap* EventWrapper::Values() const {
+  return data_ ? reinterpret_cast<const SmallVariantMap*>(data_->Data())
+               : nullptr;
+}
+
+SmallVariantMap* EventWrapper::MutableValues() {
+  if (data_->IsShared()) {
+    detail::EventPayload* copy = CreateValues(Values());
+    data_->Release();
+    data_ = copy;
+  }
+  return reinterpret_cast<SmallVariantMap*>(data_->Data());
 }
 
 }  // namespace lull
@@ -20,10 +20,10 @@ limitations under the License.
 #include <cstddef>
 #include <unordered_map>
 
+#include "lullaby/modules/dispatcher/event_payload.h"
 #include "lullaby/modules/serialize/serialize.h"
 #include "lullaby/modules/serialize/serialize_traits.h"
 #include "lullaby/modules/serialize/variant_serializer.h"
-#include "lullaby/util/aligned_alloc.h"
 #include "lullaby/util/string_view.h"
 #include "lullaby/util/typeid.h"
 #include "lullaby/util/variant.h"
@@ -75,6 +75,12 @@ namespace lull {
 /// wrapped Event.  However, copying the EventWrapper results in the Concrete
 /// event being copied and, furthermore, the copied Event is now owned by the
 /// copied EventWrapper.
+///
+/// Owned Event data (both concrete Events and runtime values) is stored in
+/// reference-counted, pooled EventPayloads.  Copying an EventWrapper that owns
+/// its data simply shares the payloads, so events can be cheaply copied into
+/// queues and across script bridges.  Runtime values are copied-on-write if
+/// they are modified while shared.
 class EventWrapper {
  public:
   /// Default constructor.
@@ -88,8 +94,8 @@ class EventWrapper {
   /// Creates an EventWrapper for a runtime Event representing |type|.
   explicit EventWrapper(TypeId type, string_view name = "");
 
-  /// Clones the Event wrapped in |rhs| such that |this| now owns a copy of the
-  /// Event.
+  /// Clones the Event wrapped in |rhs| such that |this| now owns (or shares
+  /// ownership of) a copy of the Event.
   EventWrapper(const EventWrapper& rhs);
 
   /// Takes ownership of the Event in |rhs|.
@@ -98,8 +104,8 @@ class EventWrapper {
   /// Destroys all owned Event data.
   ~EventWrapper();
 
-  /// Clones the Event wrapped in |rhs| such that |this| now owns a copy of the
-  /// Event.
+  /// Clones the Event wrapped in |rhs| such that |this| now owns (or shares
+  /// ownership of) a copy of the Event.
   EventWrapper& operator=(const EventWrapper& rhs);
 
   /// Swaps ownership of the Events in |this| and |rhs|.
@@ -119,6 +125,12 @@ class EventWrapper {
   /// Same as above but with move assignment.
   void SetValues(VariantMap&& values);
 
+  /// Sets the Runtime Event values directly from a SmallVariantMap.
+  void SetValues(const SmallVariantMap& values);
+
+  /// Same as above but with move assignment.
+  void SetValues(SmallVariantMap&& values);
+
   /// Gets the TypeId of the wrapped Event.
   TypeId GetTypeId() const { return type_; }
 
@@ -158,35 +170,50 @@ class EventWrapper {
   template <typename T>
   const T& GetValueWithDefault(HashValue key, const T& default_value) const;
 
-  /// Gets the underlying VariantMap that stores the values for a Runtime Event.
-  const VariantMap* GetValues() const;
+  /// Gets the underlying map that stores the values for a Runtime Event.  The
+  /// values are stored in a SmallVariantMap since most events only have a few
+  /// of them; use GetValuesAsVariantMap() if a VariantMap is required.
+  const SmallVariantMap* GetValues() const;
+
+  /// Returns a copy of the values for a Runtime Event as a VariantMap.
+  VariantMap GetValuesAsVariantMap() const;
 
  private:
   enum Operation {
     kCopy,
-    kDestroy,
     kSaveToVariant,
     kLoadFromVariant,
   };
 
-  enum OwnershipFlag {
-    kDoNotOwn,
-    kTakeOwnership,
-  };
-
   using HandlerFn = void (*)(Operation, void*, const void*);
 
   /// Performs the specified Operation on the provided pointers.  Specifically,
   /// if |op| is:
   ///   kCopy: copies an |Event| from |dst| to |src| using the Event copy
   ///     constructor.
-  ///   kDestroy: destroys the |Event| in |dst| using the Event destructor.
-  ///   kSaveToVariant: serializes the |Event| in |src| to the VariantMap |dst|.
-  ///   kLoadFromVariant: serializes the VariantMap |src| to the |Event| in
+  ///   kSaveToVariant: serializes the |Event| in |src| to the SmallVariantMap
+  ///     |dst|.
+  ///   kLoadFromVariant: serializes the SmallVariantMap |src| to the |Event| in
   ///     |dst|.
   template <typename Event>
   static void Handler(Operation op, void* dst, const void* src);
 
+  /// Destroys the |Event| in |ptr| using the Event destructor.
+  template <typename Event>
+  static void Destroy(void* ptr);
+
+  /// Creates a payload storing a copy of |values|, or an empty SmallVariantMap
+  /// if |values| is null.
+  static detail::EventPayload* CreateValues(const SmallVariantMap* values);
+
+  /// Returns the values of the runtime event, or nullptr if not available.
+  const SmallVariantMap* Values() const;
+
+  /// Returns the values of the runtime event for modification, first making a
+  /// private copy of them if they are shared with another EventWrapper.  Must
+  /// only be called if the runtime event is available.
+  SmallVariantMap* MutableValues();
+
   /// Ensures the EventWrapper has a Concrete Event which may require converting
   /// a Runtime Event into a Concrete Event.
   template <typename Event>
@@ -208,15 +235,19 @@ class EventWrapper {
   /// Pointer to the wrapped concrete event.
   mutable void* ptr_ = nullptr;
 
-  /// Data associated with the wrapped runtime event.
-  mutable std::unique_ptr<VariantMap> data_ = nullptr;
+  /// The payload storing the concrete event if it is owned by the
+  /// EventWrapper, in which case |ptr_| points into it.
+  mutable detail::EventPayload* event_payload_ = nullptr;
+
+  /// The payload storing the SmallVariantMap associated with the wrapped
+  /// runtime event.
+  mutable detail::EventPayload* data_ = nullptr;
 
   /// Function that performs the specified Operation on the wrapped event.
   mutable HandlerFn handler_ = nullptr;
 
-  /// Determines whether or not |ptr_| should be deleted when the EventWrapper
-  /// is destroyed.
-  mutable OwnershipFlag owned_ = kDoNotOwn;
+  /// Function that destroys the wrapped concrete event.
+  mutable detail::EventPayload::DestroyFn destroy_ = nullptr;
 
   /// Tracks whether the event can safely be serialized.
   bool serializable_ = false;
@@ -233,9 +264,10 @@ EventWrapper::EventWrapper(const Event& event)
       size_(sizeof(Event)),
       align_(alignof(Event)),
       ptr_(const_cast<Event*>(&event)),
+      event_payload_(nullptr),
       data_(nullptr),
       handler_(&Handler<Event>),
-      owned_(kDoNotOwn),
+      destroy_(&Destroy<Event>),
       serializable_(detail::IsSerializable<Event, SaveToVariant>::kValue) {
   assert(ptr_ != nullptr);
 #if LULLABY_TRACK_EVENT_NAMES
@@ -261,15 +293,16 @@ void EventWrapper::SetValue(HashValue key, const T& value) {
   }
 
   if (data_) {
-    data_->emplace(key, Variant(value));
+    MutableValues()->emplace(key, Variant(value));
   }
 }
 
 template <typename T>
 const T* EventWrapper::GetValue(HashValue key) const {
   EnsureRuntimeEventAvailable();
-  auto iter = data_->find(key);
-  if (iter != data_->end()) {
+  const SmallVariantMap* values = Values();
+  auto iter = values->find(key);
+  if (iter != values->end()) {
     return iter->second.Get<T>();
   }
   return nullptr;
@@ -290,32 +323,33 @@ void EventWrapper::Handler(Operation op, void* dst, const void* src) {
       new (dst) Event(*other);
       break;
     }
-    case kDestroy: {
-      Event* event = reinterpret_cast<Event*>(dst);
-      event->~Event();
-      // On certain toolchains, ~Event() is a no-op and thus |event| is
-      // considered an unused variable.  The following will prevent the compiler
-      // from warning about an unused variable.
-      (void)event;
-      break;
-    }
     case kSaveToVariant: {
-      VariantMap* map = reinterpret_cast<VariantMap*>(dst);
+      SmallVariantMap* map = reinterpret_cast<SmallVariantMap*>(dst);
       const Event* event = reinterpret_cast<const Event*>(src);
       SaveToVariant serializer(map);
       Serialize(&serializer, const_cast<Event*>(event), 0);
       break;
     }
     case kLoadFromVariant: {
-      const VariantMap* map = reinterpret_cast<const VariantMap*>(src);
+      const auto* map = reinterpret_cast<const SmallVariantMap*>(src);
       Event* event = reinterpret_cast<Event*>(dst);
-      LoadFromVariant serializer(const_cast<VariantMap*>(map));
+      LoadFromVariant serializer(map);
       Serialize(&serializer, event, 0);
       break;
     }
   }
 }
 
+template <typename Event>
+void EventWrapper::Destroy(void* ptr) {
+  Event* event = reinterpret_cast<Event*>(ptr);
+  event->~Event();
+  // On certain toolchains, ~Event() is a no-op and thus |event| is
+  // considered an unused variable.  The following will prevent the compiler
+  // from warning about an unused variable.
+  (void)event;
+}
+
 template <typename Event>
 void EventWrapper::EnsureConcreteEventAvailable() const {
   if (ptr_) {
@@ -324,13 +358,14 @@ void EventWrapper::EnsureConcreteEventAvailable() const {
 
   size_ = sizeof(Event);
   align_ = alignof(Event);
-  ptr_ = AlignedAlloc(size_, align_);
-  owned_ = kTakeOwnership;
   handler_ = &Handler<Event>;
+  destroy_ = &Destroy<Event>;
+  event_payload_ = detail::EventPayload::Create(size_, align_, destroy_);
+  ptr_ = event_payload_->Data();
 
   new (ptr_) Event();
   if (data_) {
-    handler_(kLoadFromVariant, ptr_, data_.get());
+    handler_(kLoadFromVariant, ptr_, Values());
   }
 }
 
@@ -338,10 +373,10 @@ inline void EventWrapper::EnsureRuntimeEventAvailable() const {
   if (data_) {
     return;
   }
-  data_.reset(new VariantMap());
+  data_ = CreateValues(nullptr);
 
   if (handler_) {
-    handler_(kSaveToVariant, data_.get(), ptr_);
+    handler_(kSaveToVariant, data_->Data(), ptr_);
   }
 }
 
@@ -19,21 +19,37 @@ limitations under the License.
 namespace lull {
 
 void QueuedDispatcher::Dispatch() {
-  std::unique_ptr<EventWrapper> event;
-  while (queue_.Dequeue(&event)) {
-    Dispatcher::SendImpl(*event);
+  // Take ownership of the spare buffer so that recursive calls to Dispatch()
+  // from within an event handler do not use the same buffer.
+  std::vector<EventWrapper> events = std::move(spare_);
+  while (true) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (queue_.empty()) {
+        break;
+      }
+      queue_.swap(events);
+    }
+
+    // Events sent by the handlers will be dispatched by the next iteration.
+    for (const EventWrapper& event : events) {
+      Dispatcher::SendImpl(event);
+    }
+    events.clear();
   }
+  spare_ = std::move(events);
 }
 
 bool QueuedDispatcher::Empty() const {
-  return queue_.Empty();
+  std::lock_guard<std::mutex> lock(mutex_);
+  return queue_.empty();
 }
 
 void QueuedDispatcher::SendImpl(const EventWrapper& event) {
   // Copy the event in order to increase the lifetime of the event until it
   // is dispatched.  The original event can now safely go out-of-scope.
-  std::unique_ptr<EventWrapper> clone(new EventWrapper(event));
-  queue_.Enqueue(std::move(clone));
+  std::lock_guard<std::mutex> lock(mutex_);
+  queue_.emplace_back(event);
 }
 
 }  // namespace lull
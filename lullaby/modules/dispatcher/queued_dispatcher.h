@@ -17,9 +17,9 @@ limitations under the License.
 #ifndef LULLABY_MODULES_DISPATCHER_QUEUED_DISPATCHER_H_
 #define LULLABY_MODULES_DISPATCHER_QUEUED_DISPATCHER_H_
 
-#include <memory>
+#include <mutex>
+#include <vector>
 #include "lullaby/modules/dispatcher/dispatcher.h"
-#include "lullaby/util/thread_safe_queue.h"
 
 namespace lull {
 
@@ -27,10 +27,12 @@ namespace lull {
 // rather than "sending" them immediately.  Instead, the sending of the events
 // only occurs when the QueuedDispatcher::Dispatch() member function is called.
 //
-// Internally, the QueuedDispatcher uses a ThreadSafeQueue for storing the
-// events.  This allows Events to be sent from multiple threads simultaneously
-// and allows the owner of the QueuedDispatcher to control when those Events are
-// actually handled by the owning thread.
+// Internally, the QueuedDispatcher stores the events in a mutex-guarded buffer.
+// This allows Events to be sent from multiple threads simultaneously and allows
+// the owner of the QueuedDispatcher to control when those Events are actually
+// handled by the owning thread.  The buffers are reused between calls to
+// Dispatch() so queuing events does not allocate once they have grown to fit
+// the number of events sent per frame.
 //
 // On destruction, any events that have been queued but not yet dispatched will
 // be lost.
@@ -52,8 +54,15 @@ class QueuedDispatcher : public Dispatcher {
   // registered handlers.
   void SendImpl(const EventWrapper& event) override;
 
-  typedef ThreadSafeQueue<std::unique_ptr<EventWrapper>> EventQueue;
-  EventQueue queue_;
+  // Guards |queue_|.
+  mutable std::mutex mutex_;
+
+  // The events waiting to be dispatched.
+  std::vector<EventWrapper> queue_;
+
+  // Spare buffer that is swapped with |queue_| during Dispatch().  Only
+  // accessed by the dispatching thread.
+  std::vector<EventWrapper> spare_;
 
   QueuedDispatcher(const QueuedDispatcher&) = delete;
   QueuedDispatcher& operator=(const QueuedDispatcher&) = delete;
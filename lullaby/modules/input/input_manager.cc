@@ -73,6 +73,9 @@ const InputManager::TouchId InputManager::kPrimaryTouchId =
 
 const uint8_t InputManager::kInvalidBatteryCharge = 255;
 
+const Clock::duration InputManager::kMaxPoseExtrapolation =
+    std::chrono::milliseconds(100);
+
 InputManager::DeviceParams::DeviceParams()
     : has_position_dof(false),
       is_position_fake(false),
@@ -440,6 +443,11 @@ void InputManager::UpdateScroll(DeviceType device, int delta) {
 
 void InputManager::UpdatePosition(DeviceType device,
                                   const mathfu::vec3& value) {
+  UpdatePosition(device, value, Clock::now());
+}
+
+void InputManager::UpdatePosition(DeviceType device, const mathfu::vec3& value,
+                                  Clock::time_point sample_time) {
   std::unique_lock<std::mutex> lock(mutex_);
   DeviceState* state = GetDeviceStateForWriteLocked(device);
   if (state == nullptr) {
@@ -448,7 +456,9 @@ void InputManager::UpdatePosition(DeviceType device,
   }
 
   if (state->position.size() == 1) {
-    state->position[0] = value;
+    if (devices_[device].GetPositionHistory()->Add(sample_time, value)) {
+      state->position[0] = value;
+    }
   } else {
     LOG(DFATAL) << "Position DOF not enabled for device: "
                 << GetDeviceName(device);
@@ -457,6 +467,11 @@ void InputManager::UpdatePosition(DeviceType device,
 
 void InputManager::UpdateRotation(DeviceType device,
                                   const mathfu::quat& value) {
+  UpdateRotation(device, value, Clock::now());
+}
+
+void InputManager::UpdateRotation(DeviceType device, const mathfu::quat& value,
+                                  Clock::time_point sample_time) {
   std::unique_lock<std::mutex> lock(mutex_);
   DeviceState* state = GetDeviceStateForWriteLocked(device);
   if (state == nullptr) {
@@ -465,7 +480,9 @@ void InputManager::UpdateRotation(DeviceType device,
   }
 
   if (state->rotation.size() == 1) {
-    state->rotation[0] = value;
+    if (devices_[device].GetRotationHistory()->Add(sample_time, value)) {
+      state->rotation[0] = value;
+    }
   } else {
     LOG(DFATAL) << "Rotation DOF not enabled for device: "
                 << GetDeviceName(device);
@@ -1071,6 +1088,92 @@ mathfu::mat4 InputManager::GetDofWorldFromObjectMatrix(
   return CalculateTransformMatrix(pos, rot, mathfu::kOnes3f);
 }
 
+mathfu::vec3 InputManager::GetPositionAt(DeviceType device,
+                                         Clock::time_point time) const {
+  const DataBuffer* buffer = GetConnectedDataBuffer(device);
+  if (buffer == nullptr) {
+    LOG(DFATAL) << "Invalid buffer for device: " << GetDeviceName(device);
+    return mathfu::kZeros3f;
+  }
+
+  const DeviceProfile* profile = GetDeviceProfile(device);
+  if (!profile || profile->position_dof == DeviceProfile::kUnavailableDof) {
+    LOG(DFATAL) << "Position DOF not setup for device: "
+                << GetDeviceName(device);
+    return mathfu::kZeros3f;
+  }
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  return SamplePosition(*devices_[device].GetPositionHistory(), time,
+                        buffer->GetCurrent().position[0]);
+}
+
+mathfu::quat InputManager::GetRotationAt(DeviceType device,
+                                         Clock::time_point time) const {
+  const DataBuffer* buffer = GetConnectedDataBuffer(device);
+  if (buffer == nullptr) {
+    LOG(DFATAL) << "Invalid buffer for device: " << GetDeviceName(device);
+    return mathfu::quat();
+  }
+
+  const DeviceProfile* profile = GetDeviceProfile(device);
+  if (!profile || profile->rotation_dof == DeviceProfile::kUnavailableDof) {
+    LOG(DFATAL) << "Rotation DOF not setup for device: "
+                << GetDeviceName(device);
+    return mathfu::quat();
+  }
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  return SampleRotation(*devices_[device].GetRotationHistory(), time,
+                        buffer->GetCurrent().rotation[0]);
+}
+
+mathfu::mat4 InputManager::GetPredictedDofWorldFromObjectMatrix(
+    DeviceType device, Clock::duration latency) const {
+  const DataBuffer* buffer = GetConnectedDataBuffer(device);
+  if (buffer == nullptr) {
+    LOG(DFATAL) << "Invalid buffer for device: " << GetDeviceName(device);
+    return mathfu::mat4::Identity();
+  }
+
+  const DeviceProfile* profile = GetDeviceProfile(device);
+  if (!profile || (profile->rotation_dof == DeviceProfile::kUnavailableDof &&
+                   profile->position_dof == DeviceProfile::kUnavailableDof)) {
+    LOG(DFATAL) << "WorldFromObjectMatrix not setup for device: "
+                << GetDeviceName(device);
+    return mathfu::mat4::Identity();
+  }
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  const SampleHistory<mathfu::vec3>& positions =
+      *devices_[device].GetPositionHistory();
+  const SampleHistory<mathfu::quat>& rotations =
+      *devices_[device].GetRotationHistory();
+
+  // Predict from whichever degree of freedom was sampled most recently so that
+  // both are evaluated at the same point in time.
+  Clock::time_point newest = kInvalidSampleTime;
+  if (!positions.IsEmpty()) {
+    newest = std::max(newest, positions.GetNewest().time);
+  }
+  if (!rotations.IsEmpty()) {
+    newest = std::max(newest, rotations.GetNewest().time);
+  }
+  const Clock::time_point time = newest + latency;
+
+  const DeviceState& state = buffer->GetCurrent();
+  const mathfu::quat rot =
+      profile->rotation_dof != DeviceProfile::kUnavailableDof
+          ? SampleRotation(rotations, time, state.rotation[0])
+          : mathfu::quat::identity;
+  const mathfu::vec3 pos =
+      profile->position_dof != DeviceProfile::kUnavailableDof
+          ? SamplePosition(positions, time, state.position[0])
+          : mathfu::kZeros3f;
+
+  return CalculateTransformMatrix(pos, rot, mathfu::kOnes3f);
+}
+
 int InputManager::GetScrollDelta(DeviceType device) const {
   const DataBuffer* buffer = GetConnectedDataBuffer(device);
   if (buffer == nullptr) {
@@ -1339,6 +1442,34 @@ InputManager::DeviceState* InputManager::GetDeviceStateForWriteLocked(
   return &buffer->GetMutable();
 }
 
+mathfu::vec3 InputManager::SamplePosition(
+    const SampleHistory<mathfu::vec3>& history, Clock::time_point time,
+    const mathfu::vec3& fallback) {
+  const SampleHistory<mathfu::vec3>::Sample* a = nullptr;
+  const SampleHistory<mathfu::vec3>::Sample* b = nullptr;
+  float factor = 0.f;
+  if (!history.Find(time, kMaxPoseExtrapolation, &a, &b, &factor)) {
+    return fallback;
+  }
+  return a->value + factor * (b->value - a->value);
+}
+
+mathfu::quat InputManager::SampleRotation(
+    const SampleHistory<mathfu::quat>& history, Clock::time_point time,
+    const mathfu::quat& fallback) {
+  const SampleHistory<mathfu::quat>::Sample* a = nullptr;
+  const SampleHistory<mathfu::quat>::Sample* b = nullptr;
+  float factor = 0.f;
+  if (!history.Find(time, kMaxPoseExtrapolation, &a, &b, &factor)) {
+    return fallback;
+  }
+  if (a == b) {
+    return a->value;
+  }
+  // Slerp continues along the same arc for factors greater than 1.
+  return mathfu::quat::Slerp(a->value, b->value, factor).Normalized();
+}
+
 InputManager::ButtonState InputManager::GetButtonState(
     bool curr, bool prev, bool repeat, Clock::duration long_press_time,
     Clock::time_point curr_time_stamp, Clock::time_point prev_time_stamp,
@@ -1389,6 +1520,71 @@ InputManager::ButtonState InputManager::GetButtonState(
   return state;
 }
 
+template <typename T>
+bool InputManager::SampleHistory<T>::Add(Clock::time_point time,
+                                         const T& value) {
+  if (count_ > 0) {
+    Sample& newest = samples_[(head_ + kCapacity - 1) % kCapacity];
+    if (time < newest.time) {
+      return false;
+    } else if (time == newest.time) {
+      newest.value = value;
+      return true;
+    }
+  }
+
+  samples_[head_].time = time;
+  samples_[head_].value = value;
+  head_ = (head_ + 1) % kCapacity;
+  if (count_ < kCapacity) {
+    ++count_;
+  }
+  return true;
+}
+
+template <typename T>
+bool InputManager::SampleHistory<T>::Find(Clock::time_point time,
+                                          Clock::duration max_extrapolation,
+                                          const Sample** a, const Sample** b,
+                                          float* factor) const {
+  if (count_ == 0) {
+    return false;
+  }
+
+  const Sample& oldest = GetSample(0);
+  if (count_ == 1 || time <= oldest.time) {
+    *a = &oldest;
+    *b = &oldest;
+    *factor = 0.f;
+    return true;
+  }
+
+  // Sample times are strictly increasing, so binary search for the first
+  // sample newer than |time|.  Times past the newest sample use the last two
+  // samples.
+  size_t lo = 1;
+  size_t hi = count_ - 1;
+  const Sample& newest = GetSample(hi);
+  if (time >= newest.time) {
+    time = std::min(time, newest.time + max_extrapolation);
+  } else {
+    while (lo < hi) {
+      const size_t mid = lo + (hi - lo) / 2;
+      if (GetSample(mid).time > time) {
+        hi = mid;
+      } else {
+        lo = mid + 1;
+      }
+    }
+  }
+
+  *a = &GetSample(hi - 1);
+  *b = &GetSample(hi);
+  *factor = SecondsFromDuration(time - (*a)->time) /
+            SecondsFromDuration((*b)->time - (*a)->time);
+  return true;
+}
+
 InputManager::Device::Device() : connected_(false) {}
 
 void InputManager::Device::Connect(const DeviceProfile& profile) {
@@ -1418,6 +1614,8 @@ void InputManager::Device::Connect(const DeviceProfile& profile) {
   state.battery_charge.resize(profile.battery ? 1 : 0, kInvalidBatteryCharge);
   buffer_.reset(new DataBuffer(state));
   info_.clear();
+  position_history_.Clear();
+  rotation_history_.Clear();
 }
 
 void InputManager::Device::Disconnect() {
@@ -1426,6 +1624,8 @@ void InputManager::Device::Disconnect() {
   connected_ = false;
   buffer_.reset();
   info_.clear();
+  position_history_.Clear();
+  rotation_history_.Clear();
 }
 
 void InputManager::Device::Advance(Clock::duration delta_time) {
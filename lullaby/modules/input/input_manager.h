@@ -172,6 +172,10 @@ class InputManager {
   // supported
   static const uint8_t kInvalidBatteryCharge;
 
+  // Maximum amount of time past the most recent pose sample that
+  // GetPositionAt and GetRotationAt will extrapolate.
+  static const Clock::duration kMaxPoseExtrapolation;
+
   static const char* GetDeviceName(DeviceType device);
 
   // Gets the current state of a keyboard's |key|.
@@ -302,6 +306,24 @@ class InputManager {
   // those degrees of freedom).
   mathfu::mat4 GetDofWorldFromObjectMatrix(DeviceType device) const;
 
+  // Gets the position of a |device| with a positional sensor at |time|.  The
+  // value is interpolated from the most recent UpdatePosition samples, or
+  // extrapolated from the last two samples if |time| is newer than all of
+  // them.  Returns the current position if no samples have been recorded.
+  // Unlike the other queries, this is safe to call while the device is being
+  // updated from another thread.
+  mathfu::vec3 GetPositionAt(DeviceType device, Clock::time_point time) const;
+
+  // Gets the rotation of a |device| with a rotational sensor at |time|.  See
+  // GetPositionAt for details.
+  mathfu::quat GetRotationAt(DeviceType device, Clock::time_point time) const;
+
+  // Gets the world from object matrix of a |device| predicted |latency| past
+  // its most recent pose sample.  Rendering tracked devices with the expected
+  // motion-to-photon latency hides the time between sampling and display.
+  mathfu::mat4 GetPredictedDofWorldFromObjectMatrix(
+      DeviceType device, Clock::duration latency) const;
+
   // Gets the delta value for a |device| with a scroll wheel.
   int GetScrollDelta(DeviceType device) const;
 
@@ -422,11 +444,19 @@ class InputManager {
   // Updates the scroll value for the |device|.
   void UpdateScroll(DeviceType device, int delta);
 
-  // Updates position of the |device|.
+  // Updates position of the |device|.  The optional |sample_time| is when the
+  // sensor reading was taken and defaults to now.  Samples older than the
+  // newest one are ignored.
   void UpdatePosition(DeviceType device, const mathfu::vec3& value);
+  void UpdatePosition(DeviceType device, const mathfu::vec3& value,
+                      Clock::time_point sample_time);
 
-  // Updates rotation of the |device|.
+  // Updates rotation of the |device|.  The optional |sample_time| is when the
+  // sensor reading was taken and defaults to now.  Samples older than the
+  // newest one are ignored.
   void UpdateRotation(DeviceType device, const mathfu::quat& value);
+  void UpdateRotation(DeviceType device, const mathfu::quat& value,
+                      Clock::time_point sample_time);
 
   // Updates the "eye from head", "screen from eye", "field of view", and
   // "viewport" settings for the |device| and |eye|.
@@ -531,6 +561,47 @@ class InputManager {
     int curr_index_;
   };
 
+  // Fixed-capacity ring of timestamped samples for a single degree of freedom.
+  // Once full, new samples overwrite the oldest ones.
+  template <typename T>
+  class SampleHistory {
+   public:
+    struct Sample {
+      Clock::time_point time;
+      T value;
+    };
+
+    // Records |value| as sampled at |time|.  Returns false and drops the
+    // sample if it is older than the newest recorded sample.
+    bool Add(Clock::time_point time, const T& value);
+
+    void Clear() { count_ = 0; }
+
+    bool IsEmpty() const { return count_ == 0; }
+
+    // Gets the newest recorded sample.  The history must not be empty.
+    const Sample& GetNewest() const { return GetSample(count_ - 1); }
+
+    // Finds the samples |a| and |b| to blend between for |time| and the blend
+    // |factor| from |a| to |b|.  The factor is greater than 1 when |time| is
+    // newer than all samples, clamped to |max_extrapolation| past the newest.
+    // Returns false if the history is empty.
+    bool Find(Clock::time_point time, Clock::duration max_extrapolation,
+              const Sample** a, const Sample** b, float* factor) const;
+
+   private:
+    static const size_t kCapacity = 64;
+
+    // Gets the |index|th oldest sample.
+    const Sample& GetSample(size_t index) const {
+      return samples_[(head_ + kCapacity - count_ + index) % kCapacity];
+    }
+
+    Sample samples_[kCapacity];
+    size_t head_ = 0;
+    size_t count_ = 0;
+  };
+
   // Class representing a single input device.
   class Device {
    public:
@@ -553,11 +624,27 @@ class InputManager {
     VariantMap& GetDeviceInfo() { return info_; }
     const VariantMap& GetDeviceInfo() const { return info_; }
 
+    SampleHistory<mathfu::vec3>* GetPositionHistory() {
+      return &position_history_;
+    }
+    const SampleHistory<mathfu::vec3>* GetPositionHistory() const {
+      return &position_history_;
+    }
+
+    SampleHistory<mathfu::quat>* GetRotationHistory() {
+      return &rotation_history_;
+    }
+    const SampleHistory<mathfu::quat>* GetRotationHistory() const {
+      return &rotation_history_;
+    }
+
    private:
     bool connected_;
     DeviceProfile profile_;
     std::unique_ptr<DataBuffer> buffer_;
     VariantMap info_;
+    SampleHistory<mathfu::vec3> position_history_;
+    SampleHistory<mathfu::quat> rotation_history_;
   };
 
   static const ButtonState kInvalidButtonState = 0;
@@ -572,6 +659,12 @@ class InputManager {
   const DataBuffer* GetDataBuffer(DeviceType device) const;
   const DataBuffer* GetConnectedDataBuffer(DeviceType device) const;
   DeviceState* GetDeviceStateForWriteLocked(DeviceType device);
+  static mathfu::vec3 SamplePosition(
+      const SampleHistory<mathfu::vec3>& history, Clock::time_point time,
+      const mathfu::vec3& fallback);
+  static mathfu::quat SampleRotation(
+      const SampleHistory<mathfu::quat>& history, Clock::time_point time,
+      const mathfu::quat& fallback);
   const TouchGesture* GetTouchGesturePtr(DeviceType device,
                                          TouchpadId touchpad_id) const;
   const Touch* GetTouchPtr(DeviceType device, TouchpadId touchpad_id,
@@ -579,7 +672,7 @@ class InputManager {
   const Touch* GetPreviousTouchPtr(DeviceType device, TouchpadId touchpad_id,
                                    TouchId touch_id) const;
 
-  std::mutex mutex_;
+  mutable std::mutex mutex_;
   Device devices_[kMaxNumDeviceTypes];
 };
 
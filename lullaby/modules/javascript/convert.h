@@ -1449,7 +1449,8 @@ struct Convert<EventWrapper, false> {
     v8::Local<v8::Object> obj = v8::Object::New(isolate);
     obj->Set(type_key, Convert<HashValue>::CppToJs(isolate, value.GetTypeId()));
     obj->Set(data_key,
-             Convert<VariantMap>::CppToJs(isolate, *value.GetValues()));
+             Convert<VariantMap>::CppToJs(isolate,
+                                          value.GetValuesAsVariantMap()));
     return obj;
   }
 
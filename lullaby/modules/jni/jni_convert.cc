@@ -378,7 +378,7 @@ jobject ConvertToJniObject(JniContext* ctx, const Variant& value) {
 ComGoogleLullabyEvent ConvertToJniEvent(JniContext* ctx,
                                         const EventWrapper& event_wrapper) {
   Variant v = event_wrapper;
-  auto jmap = ConvertToJniMap(ctx, *event_wrapper.GetValues());
+  auto jmap = ConvertToJniMap(ctx, event_wrapper.GetValuesAsVariantMap());
   return ctx->CallJniStaticMethod<ComGoogleLullabyEvent>(
       "com/google/lullaby/Event", "createWithData",
       static_cast<jlong>(event_wrapper.GetTypeId()), jmap);
@@ -626,7 +626,7 @@ struct Convert<EventWrapper, false, false, false> {
   static inline void PushFromCppToLua(const ConvertContext& context,
                                       const EventWrapper& value) {
     detail::PushStructFromCppToLua(context, nullptr, "type", value.GetTypeId(),
-                                   "data", *value.GetValues());
+                                   "data", value.GetValuesAsVariantMap());
   }
 };
 
@@ -62,8 +62,7 @@ namespace lull {
 namespace {
 
 Variant GetValue(ScriptArgList* args) {
-  const ScriptValue value = args->EvalNext();
-  return value.IsNil() ? Variant() : *value.GetVariant();
+  return args->EvalNext().ToVariant();
 }
 
 void ArrayCreate(ScriptFrame* frame) {
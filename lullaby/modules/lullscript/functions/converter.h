@@ -24,11 +24,13 @@ namespace lull {
 namespace detail {
 
 // ScriptConverter is a wrapper around the normal Variant based conversion to
-// allow some special cases.
+// allow some special cases.  The ScriptValue is passed by reference since
+// scalar values are stored inside the ScriptValue itself, so pointers to them
+// are only valid for as long as the ScriptValue.
 template <typename T>
 struct ScriptConverter {
-  static bool Convert(ScriptValue src, T* dest) {
-    T* value_ptr = src.Get<T>();
+  static bool Convert(const ScriptValue& src, T* dest) {
+    const T* value_ptr = src.Get<T>();
     if (!value_ptr) return false;
     *dest = *value_ptr;
     return true;
@@ -41,7 +43,7 @@ struct ScriptConverter {
 // For example, in the map and array manipulation functions.
 template <typename T>
 struct ScriptConverter<T*> {
-  static bool Convert(ScriptValue src, T** dest) {
+  static bool Convert(ScriptValue& src, T** dest) {
     T* value_ptr = src.Get<T>();
     if (!value_ptr) return false;
     *dest = value_ptr;
@@ -53,7 +55,7 @@ struct ScriptConverter<T*> {
 
 template <typename T>
 struct ScriptConverter<const T*> {
-  static bool Convert(ScriptValue src, const T** dest) {
+  static bool Convert(ScriptValue& src, const T** dest) {
     T* value_ptr = src.Get<T>();
     if (!value_ptr) return false;
     *dest = value_ptr;
@@ -67,7 +69,7 @@ struct ScriptConverter<const T*> {
 // example in the map and array manipulation functions.
 template <>
 struct ScriptConverter<Variant*> {
-  static bool Convert(ScriptValue src, Variant** dest) {
+  static bool Convert(ScriptValue& src, Variant** dest) {
     Variant* value_ptr = src.GetVariant();
     if (!value_ptr) return false;
     *dest = value_ptr;
@@ -79,7 +81,7 @@ struct ScriptConverter<Variant*> {
 
 template <>
 struct ScriptConverter<const Variant*> {
-  static bool Convert(ScriptValue src, const Variant** dest) {
+  static bool Convert(ScriptValue& src, const Variant** dest) {
     const Variant* value_ptr = src.GetVariant();
     if (!value_ptr) return false;
     *dest = value_ptr;
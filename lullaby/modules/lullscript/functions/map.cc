@@ -66,8 +66,7 @@ Optional<HashValue> GetKey(ScriptArgList* args) {
 }
 
 Variant GetValue(ScriptArgList* args) {
-  const ScriptValue value = args->EvalNext();
-  return value.IsNil() ? Variant() : *value.GetVariant();
+  return args->EvalNext().ToVariant();
 }
 
 void MapCreate(ScriptFrame* frame) {
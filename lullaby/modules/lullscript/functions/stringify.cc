@@ -36,7 +36,8 @@ std::string StringifyVariantArray(const VariantArray& array) {
   return ss.str();
 }
 
-std::string StringifyVariantMap(const VariantMap& map) {
+template <typename Map>
+std::string StringifyVariantMap(const Map& map) {
   std::stringstream ss;
   for (const auto& kvp : map) {
     ss << "(" << StringifyVariant(kvp.first) << ": "
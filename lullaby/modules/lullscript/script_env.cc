@@ -120,12 +120,7 @@ void ScriptEnv::Register(string_view id,
 
     ScriptArgList arg_list(frame->GetEnv(), frame->GetArgs());
     while (arg_list.HasNext()) {
-      ScriptValue value = arg_list.EvalNext();
-      if (!value.IsNil()) {
-        call.AddArg(*value.GetVariant());
-      } else {
-        call.AddArg(Variant());
-      }
+      call.AddArg(arg_list.EvalNext().ToVariant());
     }
 
     if (fn(&call) > 0) {
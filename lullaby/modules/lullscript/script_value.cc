@@ -16,16 +16,115 @@ limitations under the License.
 
 #include "lullaby/modules/lullscript/script_value.h"
 
+#include <utility>
+
 namespace lull {
+namespace {
+
+// The maximum number of unused Impls kept around by each thread.
+constexpr size_t kMaxFreeImpls = 1024;
+
+// A list of unused blocks of memory of the same size.
+class FreeList {
+ public:
+  ~FreeList();
+
+  void* Allocate(size_t size);
+  void Free(void* ptr);
+
+ private:
+  struct Node {
+    Node* next;
+  };
+
+  Node* head_ = nullptr;
+  size_t count_ = 0;
+};
+
+// Scripts are evaluated on the thread that owns them, so each thread recycles
+// the Impls it releases.  Since any thread may release an Impl, the memory
+// comes from the global allocator and can be freely passed between threads.
+thread_local FreeList g_free_list;
+
+// Set once |g_free_list| is destroyed so that ScriptValues that outlive it
+// (eg. in thread-local or static variables) release their memory directly.
+thread_local bool g_free_list_destroyed = false;
+
+FreeList::~FreeList() {
+  while (head_) {
+    Node* node = head_;
+    head_ = node->next;
+    ::operator delete(node);
+  }
+  count_ = 0;
+  g_free_list_destroyed = true;
+}
+
+void* FreeList::Allocate(size_t size) {
+  if (head_ == nullptr) {
+    return ::operator new(size);
+  }
+  Node* node = head_;
+  head_ = node->next;
+  --count_;
+  return node;
+}
+
+void FreeList::Free(void* ptr) {
+  if (count_ >= kMaxFreeImpls) {
+    ::operator delete(ptr);
+    return;
+  }
+  Node* node = static_cast<Node*>(ptr);
+  node->next = head_;
+  head_ = node;
+  ++count_;
+}
+
+template <typename... Types>
+using TypeList = detail::ScriptTypeList<Types...>;
+
+bool ImmediateToVariant(TypeList<>, TypeId type, const void* data,
+                        Variant* out) {
+  return false;
+}
+
+// Copies the immediate value of the given |type| in |data| into |out|.
+template <typename T, typename... Rest>
+bool ImmediateToVariant(TypeList<T, Rest...>, TypeId type, const void* data,
+                        Variant* out) {
+  if (type == GetTypeId<T>()) {
+    *out = *static_cast<const T*>(data);
+    return true;
+  }
+  return ImmediateToVariant(TypeList<Rest...>(), type, data, out);
+}
+
+TypeId ImmediateFromVariant(TypeList<>, const Variant& variant, void* data) {
+  return 0;
+}
+
+// Copies the value in |variant| into |data| if it is an immediate type,
+// returning the TypeId of the copied value (or 0 if nothing was copied).
+template <typename T, typename... Rest>
+TypeId ImmediateFromVariant(TypeList<T, Rest...>, const Variant& variant,
+                            void* data) {
+  if (const T* value = variant.Get<T>()) {
+    new (data) T(*value);
+    return GetTypeId<T>();
+  }
+  return ImmediateFromVariant(TypeList<Rest...>(), variant, data);
+}
+
+}  // namespace
 
-ScriptValue::ScriptValue(ScriptValue&& rhs) { std::swap(impl_, rhs.impl_); }
+ScriptValue::ScriptValue(ScriptValue&& rhs) { Swap(&rhs); }
 
-ScriptValue::ScriptValue(const ScriptValue& rhs) { Acquire(rhs.impl_); }
+ScriptValue::ScriptValue(const ScriptValue& rhs) { CopyFrom(rhs); }
 
 ScriptValue& ScriptValue::operator=(const ScriptValue& rhs) {
   if (this != &rhs) {
-    Release();
-    Acquire(rhs.impl_);
+    CopyFrom(rhs);
   }
   return *this;
 }
@@ -33,11 +132,64 @@ ScriptValue& ScriptValue::operator=(const ScriptValue& rhs) {
 ScriptValue& ScriptValue::operator=(ScriptValue&& rhs) {
   if (this != &rhs) {
     Release();
-    std::swap(impl_, rhs.impl_);
+    Swap(&rhs);
   }
   return *this;
 }
 
+Variant ScriptValue::ToVariant() const {
+  Variant var;
+  if (impl_) {
+    var = impl_->var;
+  } else if (type_ != 0) {
+    ImmediateToVariant(detail::ScriptImmediateTypes(), type_, &immediate_,
+                       &var);
+  }
+  return var;
+}
+
+bool ScriptValue::SetImmediateFromVariant(const Variant& variant) {
+  Immediate immediate;
+  const TypeId type = ImmediateFromVariant(detail::ScriptImmediateTypes(),
+                                           variant, &immediate);
+  if (type == 0) {
+    return false;
+  }
+  Release();
+  immediate_ = immediate;
+  type_ = type;
+  return true;
+}
+
+void ScriptValue::PromoteToImpl() const {
+  if (impl_ == nullptr && type_ != 0) {
+    Impl* impl = NewImpl(ToVariant());
+    ++impl->count;
+    impl_ = impl;
+    type_ = 0;
+  }
+}
+
+void ScriptValue::CopyFrom(const ScriptValue& rhs) {
+  if (rhs.impl_) {
+    // A scalar may have been moved into an Impl by GetVariant(), but it is
+    // still copied by value.
+    if (!SetImmediateFromVariant(rhs.impl_->var)) {
+      Acquire(rhs.impl_);
+    }
+  } else {
+    Release();
+    immediate_ = rhs.immediate_;
+    type_ = rhs.type_;
+  }
+}
+
+void ScriptValue::Swap(ScriptValue* rhs) {
+  std::swap(impl_, rhs->impl_);
+  std::swap(type_, rhs->type_);
+  std::swap(immediate_, rhs->immediate_);
+}
+
 void ScriptValue::Acquire(Impl* other) {
   Release();
   if (other) {
@@ -50,10 +202,27 @@ void ScriptValue::Release() {
   if (impl_) {
     --impl_->count;
     if (impl_->count == 0) {
-      delete impl_;
+      DeleteImpl(impl_);
     }
     impl_ = nullptr;
   }
+  type_ = 0;
+}
+
+void* ScriptValue::AllocateImpl() {
+  if (g_free_list_destroyed) {
+    return ::operator new(sizeof(Impl));
+  }
+  return g_free_list.Allocate(sizeof(Impl));
+}
+
+void ScriptValue::DeleteImpl(Impl* impl) {
+  impl->~Impl();
+  if (g_free_list_destroyed) {
+    ::operator delete(impl);
+  } else {
+    g_free_list.Free(impl);
+  }
 }
 
 }  // namespace lull
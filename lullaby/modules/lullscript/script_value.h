@@ -17,24 +17,67 @@ limitations under the License.
 #ifndef LULLABY_MODULES_LULLSCRIPT_SCRIPT_VALUE_H_
 #define LULLABY_MODULES_LULLSCRIPT_SCRIPT_VALUE_H_
 
+#include <new>
+#include <type_traits>
 #include "lullaby/util/common_types.h"
 #include "lullaby/util/variant.h"
 
 namespace lull {
 
+namespace detail {
+
+template <typename... Types>
+struct ScriptTypeList {};
+
+// The scalar types that are stored inline in a ScriptValue.
+using ScriptImmediateTypes =
+    ScriptTypeList<bool, int8_t, uint8_t, int16_t, uint16_t, int32_t, uint32_t,
+                   int64_t, uint64_t, float, double>;
+
+template <typename T, typename List>
+struct IsInScriptTypeList : std::false_type {};
+
+template <typename T, typename... Rest>
+struct IsInScriptTypeList<T, ScriptTypeList<T, Rest...>> : std::true_type {};
+
+template <typename T, typename U, typename... Rest>
+struct IsInScriptTypeList<T, ScriptTypeList<U, Rest...>>
+    : IsInScriptTypeList<T, ScriptTypeList<Rest...>> {};
+
+template <typename T>
+using IsScriptImmediate =
+    IsInScriptTypeList<typename std::decay<T>::type, ScriptImmediateTypes>;
+
+}  // namespace detail
+
 // Represents a "value-type" in LullScript, eg. int, float, vec3, list, map,
 // AstNode, etc.
 //
-// It is basically an intrusive shared pointer to a lull::Variant.  This allows
-// the ScriptValue to be copied/shared with no overhead.  However, one must be
-// aware that changing a ScriptValue will result in changing all other
-// ScriptValues referencing it.
+// Scalar values (ie. bools, integers and floating-point numbers) are stored
+// inline in the ScriptValue itself, so creating and copying them never
+// allocates.  All other values are stored in an intrusive shared pointer to a
+// lull::Variant.  This allows the ScriptValue to be copied/shared with no
+// overhead.
+//
+// The rule for sharing is that scalars are never shared:
+// * Copying a ScriptValue that holds a scalar copies the scalar.
+// * Setting a scalar (with Set() or SetFromVariant()) only changes this
+//   ScriptValue, even if it previously shared a non-scalar value.
+// * Setting a non-scalar on a ScriptValue that shares a non-scalar value
+//   changes all the ScriptValues sharing it.
+// This holds regardless of how a value was created or whether GetVariant() has
+// been called on it.  Use Clone() to get a copy of a non-scalar value that is
+// not shared.
 //
 // In order to create a new ScriptValue instance, you must use either the
 // Create or Clone static function.  This helps easily identify callsites where
 // a new ScriptValue is being created vs. just a new value being set on the
 // ScriptValue.
 //
+// ScriptValues are not thread-safe.  In particular, the const GetVariant()
+// may modify the ScriptValue, so it must not be called while the same
+// ScriptValue is used on another thread.
+//
 // IMPORTANT: Because we are using reference-counting, it is possible to create
 // cycles (eg. map[key] = map).  The current expectation with LullScript is that
 // it is for simple "one-off" scripts whose lifetimes are closely associated
@@ -73,11 +116,14 @@ class ScriptValue {
   template <typename T>
   bool Is() const;
 
-  // Sets the stored value to |t|.
+  // Sets the stored value to |t|.  Does nothing on a default-constructed or
+  // Reset() ScriptValue.
   template <typename T>
   void Set(T&& t);
 
   // Gets a pointer to the stored value if of type T, or nullptr otherwise.
+  // Scalar values are stored inside the ScriptValue, so the pointer is only
+  // valid for as long as this ScriptValue.
   template <typename T>
   T* Get();
 
@@ -91,11 +137,19 @@ class ScriptValue {
   template <typename T>
   Optional<T> ImplicitCast() const;
 
-  // Returns a pointer to the underlying variant (if available).
+  // Returns a pointer to the underlying variant (if available).  Scalar values
+  // are moved into a separately allocated Variant the first time this is
+  // called, so prefer ToVariant() when a copy of the value is sufficient.
+  // This does not change which copies share the value.  The pointer is
+  // invalidated when a scalar is next set on this ScriptValue.
   Variant* GetVariant();
   const Variant* GetVariant() const;
 
-  // Sets a value directly from a variant rather than a value-type.
+  // Returns a copy of the stored value as a Variant.
+  Variant ToVariant() const;
+
+  // Sets a value directly from a variant rather than a value-type.  Like Set(),
+  // does nothing on a default-constructed or Reset() ScriptValue.
   void SetFromVariant(Variant&& variant);
   void SetFromVariant(const Variant& variant);
 
@@ -109,17 +163,50 @@ class ScriptValue {
     int count;
   };
 
+  // Storage for scalar values.
+  using Immediate = std::aligned_storage<8, 8>::type;
+
   explicit ScriptValue(Impl* impl) { Acquire(impl); }
 
+  // Impls are allocated from a free list to reduce the cost of the many short
+  // lived values created while evaluating a script.
+  template <typename T>
+  static Impl* NewImpl(T&& t) {
+    return new (AllocateImpl()) Impl(std::forward<T>(t));
+  }
+  static void* AllocateImpl();
+  static void DeleteImpl(Impl* impl);
+
+  template <typename T>
+  void Emplace(T&& t, std::true_type /* immediate */);
+  template <typename T>
+  void Emplace(T&& t, std::false_type /* immediate */);
+
+  template <typename T>
+  T* GetImmediate(std::true_type /* immediate */) const;
+  template <typename T>
+  T* GetImmediate(std::false_type /* immediate */) const;
+
+  bool SetImmediateFromVariant(const Variant& variant);
+  void PromoteToImpl() const;
+  void CopyFrom(const ScriptValue& rhs);
+  void Swap(ScriptValue* rhs);
   void Acquire(Impl* other);
   void Release();
 
-  Impl* impl_ = nullptr;
+  // Either |impl_| points to the stored value, or |type_| is the TypeId of the
+  // value stored in |immediate_| (or 0 if there is no value).  These are
+  // mutable so that a scalar value can be moved into an Impl by GetVariant().
+  mutable Impl* impl_ = nullptr;
+  mutable TypeId type_ = 0;
+  mutable Immediate immediate_;
 };
 
 template <typename T>
 ScriptValue ScriptValue::Create(T&& t) {
-  return ScriptValue(new Impl(std::forward<T>(t)));
+  ScriptValue value;
+  value.Emplace(std::forward<T>(t), detail::IsScriptImmediate<T>());
+  return value;
 }
 
 inline ScriptValue ScriptValue::CreateFromVariant(Variant var) {
@@ -129,61 +216,107 @@ inline ScriptValue ScriptValue::CreateFromVariant(Variant var) {
 }
 
 inline ScriptValue ScriptValue::Clone(ScriptValue rhs) {
-  return ScriptValue(new Impl(rhs.impl_->var));
+  // Scalar values are already copied by value.
+  return rhs.impl_ ? ScriptValue(NewImpl(rhs.impl_->var)) : rhs;
+}
+
+template <typename T>
+void ScriptValue::Emplace(T&& t, std::true_type) {
+  using Type = typename std::decay<T>::type;
+  Release();
+  new (&immediate_) Type(t);
+  type_ = lull::GetTypeId<Type>();
+}
+
+template <typename T>
+void ScriptValue::Emplace(T&& t, std::false_type) {
+  Acquire(NewImpl(std::forward<T>(t)));
+}
+
+template <typename T>
+T* ScriptValue::GetImmediate(std::true_type) const {
+  return type_ == lull::GetTypeId<T>() ? reinterpret_cast<T*>(&immediate_)
+                                       : nullptr;
+}
+
+template <typename T>
+T* ScriptValue::GetImmediate(std::false_type) const {
+  return nullptr;
 }
 
 template <typename T>
 bool ScriptValue::Is() const {
-  return impl_ ? impl_->var.GetTypeId() == lull::GetTypeId<T>() : false;
+  return GetTypeId() == lull::GetTypeId<T>();
 }
 
 template <typename T>
 void ScriptValue::Set(T&& t) {
-  if (impl_) {
+  if (impl_ && !detail::IsScriptImmediate<T>::value) {
     impl_->var = std::forward<T>(t);
+  } else if (impl_ || type_ != 0) {
+    Emplace(std::forward<T>(t), detail::IsScriptImmediate<T>());
   }
 }
 
 template <typename T>
 T* ScriptValue::Get() {
-  return impl_ ? impl_->var.Get<T>() : nullptr;
+  return impl_ ? impl_->var.Get<T>()
+               : GetImmediate<T>(detail::IsScriptImmediate<T>());
 }
 
 template <typename T>
 const T* ScriptValue::Get() const {
-  return impl_ ? impl_->var.Get<T>() : nullptr;
+  return impl_ ? impl_->var.Get<T>()
+               : GetImmediate<T>(detail::IsScriptImmediate<T>());
 }
 
 template <typename T>
 Optional<T> ScriptValue::ImplicitCast() const {
-  return impl_ ? impl_->var.ImplicitCast<T>() : NullOpt;
+  if (impl_) {
+    return impl_->var.ImplicitCast<T>();
+  } else if (type_ == 0) {
+    return NullOpt;
+  } else if (const T* ptr = Get<T>()) {
+    return *ptr;
+  }
+  return ToVariant().ImplicitCast<T>();
 }
 
 inline bool ScriptValue::IsNil() const {
-  return impl_ == nullptr || impl_->var.GetTypeId() == TypeId();
+  return impl_ ? impl_->var.GetTypeId() == TypeId() : type_ == TypeId();
 }
 
 inline TypeId ScriptValue::GetTypeId() const {
-  return impl_ ? impl_->var.GetTypeId() : 0;
+  return impl_ ? impl_->var.GetTypeId() : type_;
 }
 
 inline Variant* ScriptValue::GetVariant() {
+  PromoteToImpl();
   return impl_ ? &impl_->var : nullptr;
 }
 
 inline const Variant* ScriptValue::GetVariant() const {
+  PromoteToImpl();
   return impl_ ? &impl_->var : nullptr;
 }
 
 inline void ScriptValue::SetFromVariant(Variant&& variant) {
-  if (impl_) {
+  if ((impl_ == nullptr && type_ == 0) || SetImmediateFromVariant(variant)) {
+    return;
+  } else if (impl_) {
     impl_->var = std::move(variant);
+  } else {
+    Acquire(NewImpl(std::move(variant)));
   }
 }
 
 inline void ScriptValue::SetFromVariant(const Variant& variant) {
-  if (impl_) {
+  if ((impl_ == nullptr && type_ == 0) || SetImmediateFromVariant(variant)) {
+    return;
+  } else if (impl_) {
     impl_->var = variant;
+  } else {
+    Acquire(NewImpl(variant));
   }
 }
 
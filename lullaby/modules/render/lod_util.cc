@@ -0,0 +1,77 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/modules/render/lod_util.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace lull {
+
+Sphere GetWorldBoundingSphere(const Aabb& aabb,
+                              const mathfu::mat4& world_from_local) {
+  float scale = 0.f;
+  for (int i = 0; i < 3; ++i) {
+    const mathfu::vec3 axis(world_from_local(0, i), world_from_local(1, i),
+                            world_from_local(2, i));
+    scale = std::max(scale, axis.Length());
+  }
+  const mathfu::vec3 center = world_from_local * aabb.Center();
+  return Sphere(center, 0.5f * aabb.Size().Length() * scale);
+}
+
+float GetScreenSize(const Sphere& sphere, Span<RenderView> views) {
+  float screen_size = 0.f;
+  for (const RenderView& view : views) {
+    // The projected diameter in NDC is 2 * r * P[1][1] / w, while the
+    // viewport is 2 units high.  For orthographic projections w is 1.
+    const mathfu::mat4& clip_from_eye = view.clip_from_eye_matrix;
+    const mathfu::vec3 eye = view.eye_from_world_matrix * sphere.position;
+    const float w = clip_from_eye(3, 0) * eye.x + clip_from_eye(3, 1) * eye.y +
+                    clip_from_eye(3, 2) * eye.z + clip_from_eye(3, 3);
+    // For perspective projections w is the distance along the view axis, so a
+    // sphere reaching the eye plane fills the view.  Orthographic projections
+    // have a constant w and no such case.
+    const bool perspective = clip_from_eye(3, 2) != 0.f;
+    if (perspective && w <= sphere.radius) {
+      return std::numeric_limits<float>::max();
+    }
+    const float size = sphere.radius * std::fabs(clip_from_eye(1, 1)) / w;
+    screen_size = std::max(screen_size, size);
+  }
+  return screen_size;
+}
+
+int SelectLod(Span<float> thresholds, float screen_size, int current_lod,
+              float hysteresis) {
+  const int num_lods = static_cast<int>(thresholds.size());
+  if (num_lods == 0) {
+    return 0;
+  }
+
+  int lod = std::max(0, std::min(current_lod, num_lods - 1));
+  while (lod > 0 && screen_size >= thresholds[lod - 1] * (1.f + hysteresis)) {
+    --lod;
+  }
+  while (lod + 1 < num_lods &&
+         screen_size < thresholds[lod] * (1.f - hysteresis)) {
+    ++lod;
+  }
+  return lod;
+}
+
+}  // namespace lull
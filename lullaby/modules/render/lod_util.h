@@ -0,0 +1,48 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef LULLABY_MODULES_RENDER_LOD_UTIL_H_
+#define LULLABY_MODULES_RENDER_LOD_UTIL_H_
+
+#include "lullaby/modules/render/render_view.h"
+#include "lullaby/util/math.h"
+#include "lullaby/util/span.h"
+#include "mathfu/glsl_mappings.h"
+
+namespace lull {
+
+/// Returns the bounding sphere of |aabb| after it has been transformed by
+/// |world_from_local|.  Non-uniform scales result in a conservative sphere.
+Sphere GetWorldBoundingSphere(const Aabb& aabb,
+                              const mathfu::mat4& world_from_local);
+
+/// Returns the fraction of the viewport height covered by |sphere| (in world
+/// space) in the view that sees it the largest.  Returns a very large value
+/// if the sphere reaches the eye of any perspective view, and 0 if |views| is
+/// empty.
+float GetScreenSize(const Sphere& sphere, Span<RenderView> views);
+
+/// Selects the level of detail to use for an object with the given
+/// |screen_size|.  |thresholds| holds the minimum screen size of each LOD, in
+/// decreasing order.  |hysteresis| is the fraction by which the screen size
+/// must pass a threshold before switching away from |current_lod|, which
+/// prevents LODs from popping back and forth on small changes.
+int SelectLod(Span<float> thresholds, float screen_size, int current_lod,
+              float hysteresis);
+
+}  // namespace lull
+
+#endif  // LULLABY_MODULES_RENDER_LOD_UTIL_H_
@@ -24,29 +24,63 @@ limitations under the License.
 
 namespace lull {
 
-void ApplyDeformation(MeshData* mesh, const PositionDeformation& deform) {
+namespace {
+
+// Returns a pointer to the first position in |mesh| and sets |stride| to the
+// number of floats between consecutive positions.  Returns nullptr if the
+// positions can't be modified.
+float* GetMutablePositions(MeshData* mesh, size_t* stride) {
   const VertexFormat& format = mesh->GetVertexFormat();
   const VertexAttribute* position =
       format.GetAttributeWithUsage(VertexAttributeUsage_Position);
   if (!position || position->type() != VertexAttributeType_Vec3f) {
     LOG(DFATAL) << "Vertex format doesn't have pos3f";
-    return;
+    return nullptr;
   }
 
   float* vertex_data = reinterpret_cast<float*>(mesh->GetMutableVertexBytes());
   if (!vertex_data) {
     LOG(DFATAL) << "Can't deform mesh without read+write";
-    return;
+    return nullptr;
   }
 
   // Formats are always padded out to 4 bytes, so this is safe.
   DCHECK_EQ(format.GetVertexSize() % sizeof(float), 0);
-  const size_t stride_in_floats = format.GetVertexSize() / sizeof(float);
-  const size_t length_in_floats = mesh->GetNumVertices() * stride_in_floats;
+  *stride = format.GetVertexSize() / sizeof(float);
 
   DCHECK_EQ(format.GetAttributeOffset(position) % sizeof(float), 0);
-  vertex_data += format.GetAttributeOffset(position) / sizeof(float);
+  return vertex_data + format.GetAttributeOffset(position) / sizeof(float);
+}
+
+// Number of positions processed at once by CylinderBendPositions().
+constexpr size_t kDeformBlockSize = 64;
+
+// Applies the upper 3x4 part of the column-major |mat| to the points in |x|,
+// |y| and |z|, writing the results to |out_x|, |out_y| and |out_z|.
+void TransformPoints(const mathfu::mat4& mat, const float* x, const float* y,
+                     const float* z, size_t count, float* out_x, float* out_y,
+                     float* out_z) {
+  const float m00 = mat(0, 0), m01 = mat(0, 1), m02 = mat(0, 2);
+  const float m10 = mat(1, 0), m11 = mat(1, 1), m12 = mat(1, 2);
+  const float m20 = mat(2, 0), m21 = mat(2, 1), m22 = mat(2, 2);
+  const float t0 = mat(0, 3), t1 = mat(1, 3), t2 = mat(2, 3);
+  for (size_t i = 0; i < count; ++i) {
+    out_x[i] = m00 * x[i] + m01 * y[i] + m02 * z[i] + t0;
+    out_y[i] = m10 * x[i] + m11 * y[i] + m12 * z[i] + t1;
+    out_z[i] = m20 * x[i] + m21 * y[i] + m22 * z[i] + t2;
+  }
+}
+
+}  // namespace
+
+void ApplyDeformation(MeshData* mesh, const PositionDeformation& deform) {
+  size_t stride_in_floats = 0;
+  float* vertex_data = GetMutablePositions(mesh, &stride_in_floats);
+  if (!vertex_data) {
+    return;
+  }
 
+  const size_t length_in_floats = mesh->GetNumVertices() * stride_in_floats;
   for (size_t i = 0; i < length_in_floats; i += stride_in_floats) {
     const mathfu::vec3 original_position(vertex_data[i], vertex_data[i + 1],
                                          vertex_data[i + 2]);
@@ -57,6 +91,57 @@ void ApplyDeformation(MeshData* mesh, const PositionDeformation& deform) {
   }
 }
 
+void ApplyBatchDeformation(MeshData* mesh,
+                           const PositionBatchDeformation& deform) {
+  size_t stride = 0;
+  float* positions = GetMutablePositions(mesh, &stride);
+  if (!positions) {
+    return;
+  }
+  deform(positions, mesh->GetNumVertices(), stride);
+}
+
+void CylinderBendPositions(float* positions, size_t num_positions,
+                           size_t stride, const mathfu::mat4& pre_mat,
+                           float radius, const mathfu::mat4& post_mat) {
+  const float inv_radius = 1.f / radius;
+  float x[kDeformBlockSize];
+  float y[kDeformBlockSize];
+  float z[kDeformBlockSize];
+  float bent_x[kDeformBlockSize];
+  float bent_y[kDeformBlockSize];
+  float bent_z[kDeformBlockSize];
+
+  for (size_t begin = 0; begin < num_positions; begin += kDeformBlockSize) {
+    const size_t count = std::min(kDeformBlockSize, num_positions - begin);
+    float* block = positions + begin * stride;
+
+    for (size_t i = 0; i < count; ++i) {
+      x[i] = block[i * stride];
+      y[i] = block[i * stride + 1];
+      z[i] = block[i * stride + 2];
+    }
+
+    TransformPoints(pre_mat, x, y, z, count, bent_x, bent_y, bent_z);
+
+    // Same as DeformPoint(), see math.h.
+    for (size_t i = 0; i < count; ++i) {
+      const float angle = bent_x[i] * inv_radius;
+      const float depth = bent_z[i];
+      bent_x[i] = -depth * sinf(angle);
+      bent_z[i] = depth * cosf(angle);
+    }
+
+    TransformPoints(post_mat, bent_x, bent_y, bent_z, count, x, y, z);
+
+    for (size_t i = 0; i < count; ++i) {
+      block[i * stride] = x[i];
+      block[i * stride + 1] = y[i];
+      block[i * stride + 2] = z[i];
+    }
+  }
+}
+
 MeshData CreateLatLonSphere(float radius, int num_parallels,
                             int num_meridians) {
   CHECK_GE(num_parallels, 1);
@@ -35,6 +35,26 @@ using PositionDeformation = std::function<mathfu::vec3(const mathfu::vec3&)>;
 // with a DFATAL if |mesh| doesn't have read+write access.
 void ApplyDeformation(MeshData* mesh, const PositionDeformation& deform);
 
+// Deforms |num_positions| vec3 positions in-place.  The first position starts
+// at |positions| and each subsequent position starts |stride| floats after the
+// previous one.
+using PositionBatchDeformation =
+    std::function<void(float* positions, size_t num_positions, size_t stride)>;
+
+// Deforms |mesh| in-place by applying |deform| once to all of its vertex
+// positions.  Fails with a DFATAL if |mesh| doesn't have read+write access.
+void ApplyBatchDeformation(MeshData* mesh,
+                           const PositionBatchDeformation& deform);
+
+// Applies the cylinder bend of DeformPoint() to a batch of positions laid out
+// as described by PositionBatchDeformation.  Each position is transformed by
+// |pre_mat|, bent around the cylinder of |radius|, and transformed by
+// |post_mat|.  Positions are processed in fixed-size blocks of separate x, y
+// and z arrays so that the compiler can vectorize the math.
+void CylinderBendPositions(float* positions, size_t num_positions,
+                           size_t stride, const mathfu::mat4& pre_mat,
+                           float radius, const mathfu::mat4& post_mat);
+
 // Creates a VertexPT sphere mesh using latitude-longitude tessellation. The
 // sphere will be external-facing unless |radius| is negative. The mesh will
 // always use 32-bit indices. The 'u' texture coordinate tracks longitude; the
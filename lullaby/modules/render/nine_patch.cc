@@ -111,7 +111,58 @@ void ComputeVertexValues(float size, float original_size, float low_slice,
   }
 }
 
+namespace {
+
+// Computes the position and texture coordinate of each row (or column) of
+// vertices along one dimension of the nine patch.  All vertices in a column
+// share their x values and all vertices in a row share their y values, so these
+// are computed once per row and column instead of once per vertex.
+void ComputeAxisValues(float size, float original_size, float low_slice,
+                       int low_slice_index, float low_patch_width,
+                       float high_slice, int high_slice_index,
+                       float high_patch_width, float middle_patch_size,
+                       float middle_patch_uv_size, int vertex_count,
+                       float vertex_step, float* p, float* u) {
+  float vertex_interval = 0.0f;
+  for (int vertex_index = 0; vertex_index < vertex_count; ++vertex_index) {
+    ComputeVertexValues(size, original_size, low_slice, low_slice_index,
+                        low_patch_width, high_slice, high_slice_index,
+                        high_patch_width, middle_patch_size,
+                        middle_patch_uv_size, vertex_index, vertex_interval,
+                        &p[vertex_index], &u[vertex_index]);
+    if (vertex_index != low_slice_index && vertex_index != high_slice_index) {
+      vertex_interval += vertex_step;
+    }
+  }
+}
+
+}  // namespace
+
+bool operator==(const NinePatch& lhs, const NinePatch& rhs) {
+  return lhs.size == rhs.size && lhs.left_slice == rhs.left_slice &&
+         lhs.right_slice == rhs.right_slice &&
+         lhs.bottom_slice == rhs.bottom_slice &&
+         lhs.top_slice == rhs.top_slice &&
+         lhs.original_size == rhs.original_size &&
+         lhs.subdivisions == rhs.subdivisions &&
+         lhs.texture_alt_min == rhs.texture_alt_min &&
+         lhs.texture_alt_max == rhs.texture_alt_max;
+}
+
 void GenerateNinePatchMesh(const NinePatch& nine_patch, MeshData* mesh) {
+  // Save the current number of vertices to use later as a base index during
+  // index generation.  This allows a nine patch mesh to be tacked on to the end
+  // of an existing mesh.
+  const uint32_t num_verts = static_cast<uint32_t>(mesh->GetNumVertices());
+
+  std::vector<VertexPTT> vertices;
+  GenerateNinePatchVertices(nine_patch, &vertices);
+  mesh->AddVertices(vertices.data(), vertices.size());
+  GenerateNinePatchIndices(nine_patch, num_verts, mesh);
+}
+
+void GenerateNinePatchVertices(const NinePatch& nine_patch,
+                               std::vector<VertexPTT>* vertices) {
   const mathfu::vec2 half_size = nine_patch.size * .5f;
 
   // The + 2 + 1 here is to add 2 extra rows/columns for the slices and one more
@@ -175,65 +226,75 @@ void GenerateNinePatchMesh(const NinePatch& nine_patch, MeshData* mesh) {
                                     (bottom_patch_width + middle_patch_size.y)),
                col_vert_count - 2);
 
-  // Save the current number of vertices to use later as a base index during
-  // index generation.  This allows a nine patch mesh to be tacked on to the end
-  // of an existing mesh.
-  const uint32_t num_verts = static_cast<uint32_t>(mesh->GetNumVertices());
+  // Compute the values of each column (x) and row (y) of vertices.
+  std::vector<float> axis_values(3 * (col_vert_count + row_vert_count));
+  float* x = axis_values.data();
+  float* u0 = x + col_vert_count;
+  float* u1 = u0 + col_vert_count;
+  float* y = u1 + col_vert_count;
+  float* v0 = y + row_vert_count;
+  float* v1 = v0 + row_vert_count;
+
+  ComputeAxisValues(nine_patch.size.x, nine_patch.original_size.x,
+                    nine_patch.left_slice, left_slice_index, left_patch_width,
+                    nine_patch.right_slice, right_slice_index,
+                    right_patch_width, middle_patch_size.x,
+                    middle_patch_uv_size.x, col_vert_count, x_step, x, u0);
+  for (int x_index = 0; x_index < col_vert_count; ++x_index) {
+    u1[x_index] = mathfu::Lerp(nine_patch.texture_alt_min.x,
+                               nine_patch.texture_alt_max.x,
+                               SafeDiv(x[x_index], nine_patch.size.x));
+    x[x_index] -= half_size.x;
+  }
+
+  ComputeAxisValues(nine_patch.size.y, nine_patch.original_size.y,
+                    nine_patch.bottom_slice, bottom_slice_index,
+                    bottom_patch_width, nine_patch.top_slice, top_slice_index,
+                    top_patch_width, middle_patch_size.y,
+                    middle_patch_uv_size.y, row_vert_count, y_step, y, v0);
+  for (int y_index = 0; y_index < row_vert_count; ++y_index) {
+    v1[y_index] = mathfu::Lerp(1.f - nine_patch.texture_alt_min.y,
+                               1.f - nine_patch.texture_alt_max.y,
+                               SafeDiv(y[y_index], nine_patch.size.y));
+    v0[y_index] = 1.0f - v0[y_index];
+    y[y_index] -= half_size.y;
+  }
 
   // Now generate the mesh.  It is nothing more than a tessellated quad with
   // some fancy positioning of vertices and UVs.
-  float interval_y = 0.0f;
+  const size_t first_vertex = vertices->size();
+  vertices->resize(first_vertex + col_vert_count * row_vert_count);
+  VertexPTT* vertex = vertices->data() + first_vertex;
   for (int y_index = 0; y_index < row_vert_count; ++y_index) {
-    float interval_x = 0.0f;
-
-    float y, v0, v1;
-
-    ComputeVertexValues(nine_patch.size.y, nine_patch.original_size.y,
-                        nine_patch.bottom_slice, bottom_slice_index,
-                        bottom_patch_width, nine_patch.top_slice,
-                        top_slice_index, top_patch_width, middle_patch_size.y,
-                        middle_patch_uv_size.y, y_index, interval_y, &y, &v0);
-    v1 = mathfu::Lerp(1.f - nine_patch.texture_alt_min.y,
-                      1.f - nine_patch.texture_alt_max.y,
-                      SafeDiv(y, nine_patch.size.y));
-
-    if (y_index != bottom_slice_index && y_index != top_slice_index) {
-      interval_y += y_step;
-    }
-
     for (int x_index = 0; x_index < col_vert_count; ++x_index) {
-      float x, u0, u1;
-
-      ComputeVertexValues(
-          nine_patch.size.x, nine_patch.original_size.x, nine_patch.left_slice,
-          left_slice_index, left_patch_width, nine_patch.right_slice,
-          right_slice_index, right_patch_width, middle_patch_size.x,
-          middle_patch_uv_size.x, x_index, interval_x, &x, &u0);
-      u1 = mathfu::Lerp(nine_patch.texture_alt_min.x,
-                        nine_patch.texture_alt_max.x,
-                        SafeDiv(x, nine_patch.size.x));
-
-      if (x_index != left_slice_index && x_index != right_slice_index) {
-        interval_x += x_step;
-      }
-
-      mesh->AddVertex<VertexPTT>(x - half_size.x, y - half_size.y, 0.0f, u0,
-                                 1.0f - v0, u1, v1);
+      vertex->x = x[x_index];
+      vertex->y = y[y_index];
+      vertex->z = 0.0f;
+      vertex->u0 = u0[x_index];
+      vertex->v0 = v0[y_index];
+      vertex->u1 = u1[x_index];
+      vertex->v1 = v1[y_index];
+      ++vertex;
     }
   }
+}
+
+void GenerateNinePatchIndices(const NinePatch& nine_patch, uint32_t base_vertex,
+                              MeshData* mesh) {
+  const int col_vert_count = nine_patch.subdivisions.x + 2 + 1;
+  const int row_vert_count = nine_patch.subdivisions.y + 2 + 1;
 
-  // Generate indices for the nine-patch mesh.
   for (int y_index = 1; y_index < row_vert_count; ++y_index) {
     const int row = col_vert_count * y_index;
     const int last_row = row - col_vert_count;
 
     for (int x_index = 1; x_index < col_vert_count; ++x_index) {
-      mesh->AddIndex(num_verts + last_row + x_index - 1);
-      mesh->AddIndex(num_verts + last_row + x_index);
-      mesh->AddIndex(num_verts + row + x_index - 1);
-      mesh->AddIndex(num_verts + last_row + x_index);
-      mesh->AddIndex(num_verts + row + x_index);
-      mesh->AddIndex(num_verts + row + x_index - 1);
+      mesh->AddIndex(base_vertex + last_row + x_index - 1);
+      mesh->AddIndex(base_vertex + last_row + x_index);
+      mesh->AddIndex(base_vertex + row + x_index - 1);
+      mesh->AddIndex(base_vertex + last_row + x_index);
+      mesh->AddIndex(base_vertex + row + x_index);
+      mesh->AddIndex(base_vertex + row + x_index - 1);
     }
   }
 }
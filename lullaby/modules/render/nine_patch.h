@@ -17,7 +17,10 @@ limitations under the License.
 #ifndef LULLABY_UTIL_NINE_PATCH_H_
 #define LULLABY_UTIL_NINE_PATCH_H_
 
+#include <vector>
+
 #include "lullaby/modules/render/mesh_data.h"
+#include "lullaby/modules/render/vertex.h"
 #include "lullaby/generated/nine_patch_def_generated.h"
 #include "mathfu/constants.h"
 #include "mathfu/glsl_mappings.h"
@@ -50,11 +53,27 @@ struct NinePatch {
   }
 };
 
+/// Returns true if |lhs| and |rhs| generate the same mesh.
+bool operator==(const NinePatch& lhs, const NinePatch& rhs);
+inline bool operator!=(const NinePatch& lhs, const NinePatch& rhs) {
+  return !(lhs == rhs);
+}
+
 void NinePatchFromDef(const NinePatchDef* def, NinePatch* nine_patch);
 
 /// Computes the |mesh| given the data in |nine_patch|.
 void GenerateNinePatchMesh(const NinePatch& nine_patch, MeshData* mesh);
 
+/// Appends the vertices of the mesh described by |nine_patch| to |vertices|.
+void GenerateNinePatchVertices(const NinePatch& nine_patch,
+                               std::vector<VertexPTT>* vertices);
+
+/// Adds the indices of the mesh described by |nine_patch| to |mesh|, offset by
+/// |base_vertex|.  The indices only depend on the subdivisions, so they do not
+/// change when the nine patch is resized.
+void GenerateNinePatchIndices(const NinePatch& nine_patch, uint32_t base_vertex,
+                              MeshData* mesh);
+
 }  // namespace lull
 
 #endif  // LULLABY_UTIL_NINE_PATCH_H_
@@ -46,6 +46,15 @@ class SaveToVariant {
     }
   }
 
+  // Same as above, but the root-level map is a SmallVariantMap.  Nested maps
+  // are still stored as VariantMaps.
+  explicit SaveToVariant(SmallVariantMap* variant)
+      : root_(nullptr), small_root_(variant) {
+    if (!variant) {
+      LOG(DFATAL) << "Cannot save to empty variant!";
+    }
+  }
+
   // Adds a new "internal" node (ie. VariantMap) to be the current node to
   // which data will be serialized.  This node/map is associated with |key| on
   // the current map.
@@ -53,10 +62,8 @@ class SaveToVariant {
     if (stack_.empty()) {
       stack_.emplace(root_);
     } else {
-      VariantMap* curr_map = stack_.top();
-      auto iter = curr_map->emplace(key, VariantMap());
-      VariantMap* next_map = iter.first->second.Get<VariantMap>();
-      stack_.emplace(next_map);
+      Variant* next = Emplace(key, VariantMap());
+      stack_.emplace(next->Get<VariantMap>());
     }
   }
 
@@ -120,16 +127,29 @@ class SaveToVariant {
   template <typename T>
   void Save(T* ptr, HashValue key) {
     if (!stack_.empty()) {
-      VariantMap* map = stack_.top();
-      map->emplace(key, Variant(*ptr));
+      Emplace(key, Variant(*ptr));
     } else {
       LOG(DFATAL) << "No VariantMap in stack - cannot save key: " << key;
     }
   }
 
+  // Adds the |value| with the |key| to the "top" map (if there isn't already
+  // a value with that key) and returns the stored value.  A null entry in the
+  // stack refers to the SmallVariantMap root.
+  Variant* Emplace(HashValue key, Variant value) {
+    VariantMap* map = stack_.top();
+    if (map) {
+      return &map->emplace(key, std::move(value)).first->second;
+    }
+    return &small_root_->emplace(key, std::move(value)).first->second;
+  }
+
   // The root-level variant map.
   VariantMap* root_;
 
+  // The root-level map if saving to a SmallVariantMap.
+  SmallVariantMap* small_root_ = nullptr;
+
   // The stack of variant maps.
   std::stack<VariantMap*> stack_;
 };
@@ -143,6 +163,15 @@ class LoadFromVariant {
     }
   }
 
+  // Same as above, but the root-level map is a SmallVariantMap.  Nested maps
+  // are expected to be VariantMaps.
+  explicit LoadFromVariant(const SmallVariantMap* variant)
+      : root_(nullptr), small_root_(variant) {
+    if (!variant) {
+      LOG(DFATAL) << "Cannot load from empty variant!";
+    }
+  }
+
   // Adds a new "internal" node (ie. VariantMap) to be the current node to
   // which data will be serialized.  This node/map is associated with |key| on
   // the current map.
@@ -150,13 +179,12 @@ class LoadFromVariant {
     if (stack_.empty()) {
       stack_.emplace(root_);
     } else {
-      const VariantMap* curr_map = stack_.top();
-      auto iter = curr_map->find(key);
-      if (iter == curr_map->end()) {
+      const Variant* next = Find(key);
+      if (next == nullptr) {
         LOG(DFATAL) << "No such element with key " << key;
         return;
       }
-      const VariantMap* next_map = iter->second.Get<VariantMap>();
+      const VariantMap* next_map = next->Get<VariantMap>();
       if (!next_map) {
         LOG(DFATAL) << "Expected a VariantMap at key " << key;
         return;
@@ -241,21 +269,36 @@ class LoadFromVariant {
       return;
     }
 
-    const VariantMap* map = stack_.top();
-    const auto iter = map->find(key);
-    if (iter == map->end()) {
+    const Variant* variant = Find(key);
+    if (variant == nullptr) {
       return;
     }
-    const T* value = iter->second.Get<T>();
+    const T* value = variant->Get<T>();
     if (value == nullptr) {
       return;
     }
     *ptr = *value;
   }
 
+  // Returns the value associated with |key| in the "top" map, or nullptr if
+  // there is no such value.  A null entry in the stack refers to the
+  // SmallVariantMap root.
+  const Variant* Find(HashValue key) const {
+    const VariantMap* map = stack_.top();
+    if (map) {
+      const auto iter = map->find(key);
+      return iter != map->end() ? &iter->second : nullptr;
+    }
+    const auto iter = small_root_->find(key);
+    return iter != small_root_->end() ? &iter->second : nullptr;
+  }
+
   // The root-level variant map.
   const VariantMap* root_;
 
+  // The root-level map if loading from a SmallVariantMap.
+  const SmallVariantMap* small_root_ = nullptr;
+
   // The stack of variant maps.
   std::stack<const VariantMap*> stack_;
 };
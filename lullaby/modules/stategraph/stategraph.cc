@@ -16,6 +16,10 @@ limitations under the License.
 
 #include "lullaby/modules/stategraph/stategraph.h"
 
+#include <algorithm>
+#include <limits>
+#include <utility>
+
 #include "lullaby/util/logging.h"
 
 namespace lull {
@@ -27,6 +31,7 @@ void Stategraph::AddState(std::unique_ptr<StategraphState> state) {
     LOG(DFATAL) << "State already in stategraph: " << id;
   }
   states_[id] = std::move(state);
+  routes_dirty_ = true;
 }
 
 const StategraphState* Stategraph::GetState(HashValue id) const {
@@ -34,58 +39,79 @@ const StategraphState* Stategraph::GetState(HashValue id) const {
   return iter != states_.end() ? iter->second.get() : nullptr;
 }
 
-Stategraph::Path Stategraph::FindPathHelper(const StategraphState* node,
-                                            const StategraphState* dest,
-                                            std::set<HashValue> visited) const {
-  if (node == dest) {
-    LOG(DFATAL) << "Should not have reached this far.";
-    return {};
+void Stategraph::BuildRoutingTable() const {
+  if (!routes_dirty_) {
+    return;
+  }
+  routes_dirty_ = false;
+
+  const size_t n = states_.size();
+  std::vector<const StategraphState*> states;
+  states.reserve(n);
+  route_index_.clear();
+  for (const auto& iter : states_) {
+    route_index_[iter.first] = states.size();
+    states.push_back(iter.second.get());
   }
 
-  Path shortest_path;
-  bool first = true;
-  visited.insert(node->GetId());
-
-  const std::vector<StategraphTransition>& transitions = node->GetTransitions();
-  for (const StategraphTransition& transition : transitions) {
-    const StategraphState* next = GetState(transition.to_state);
-    if (next == nullptr) {
-      LOG(DFATAL) << "Found a transition to an invalid state: "
-                  << transition.to_state;
-      continue;
-    }
-    if (visited.count(transition.to_state) != 0) {
-      continue;
-    }
-
-    Path path;
-    path.push_back(transition);
-
-    if (next == dest) {
-      shortest_path = std::move(path);
-      break;
-    }
-
-    Path tmp = FindPathHelper(next, dest, visited);
-    if (tmp.empty()) {
-      continue;
+  // The cost of a path is its total transition time followed by its number of
+  // Transitions, compared lexicographically.
+  using Cost = std::pair<Clock::duration::rep, size_t>;
+  const Cost kUnreachable(std::numeric_limits<Clock::duration::rep>::max(),
+                          std::numeric_limits<size_t>::max());
+  std::vector<Cost> costs(n * n, kUnreachable);
+  next_hop_.assign(n * n, nullptr);
+
+  for (size_t from = 0; from < n; ++from) {
+    costs[from * n + from] = Cost(0, 0);
+    for (const StategraphTransition& transition :
+         states[from]->GetTransitions()) {
+      auto iter = route_index_.find(transition.to_state);
+      if (iter == route_index_.end()) {
+        LOG(ERROR) << "Found a transition to an invalid state: "
+                   << transition.to_state;
+        continue;
+      }
+      const size_t to = iter->second;
+      if (to == from) {
+        continue;
+      }
+      // Negative transition times would allow cycles of ever-cheaper paths.
+      const Cost cost(std::max(transition.transition_time.count(),
+                               Clock::duration::rep(0)),
+                      1);
+      if (cost < costs[from * n + to]) {
+        costs[from * n + to] = cost;
+        next_hop_[from * n + to] = &transition;
+      }
     }
+  }
 
-    path.insert(path.end(), tmp.begin(), tmp.end());
-    if (first) {
-      first = false;
-      shortest_path = std::move(path);
-    } else if (path.size() < shortest_path.size()) {
-      shortest_path = std::move(path);
+  // Floyd-Warshall: allow paths to pass through each State in turn.
+  for (size_t via = 0; via < n; ++via) {
+    for (size_t from = 0; from < n; ++from) {
+      const Cost& first = costs[from * n + via];
+      if (first == kUnreachable || from == via) {
+        continue;
+      }
+      for (size_t to = 0; to < n; ++to) {
+        const Cost& second = costs[via * n + to];
+        if (second == kUnreachable || to == via) {
+          continue;
+        }
+        const Cost cost(first.first + second.first,
+                        first.second + second.second);
+        if (cost < costs[from * n + to]) {
+          costs[from * n + to] = cost;
+          next_hop_[from * n + to] = next_hop_[from * n + via];
+        }
+      }
     }
   }
-  return shortest_path;
 }
 
 Stategraph::Path Stategraph::FindPath(HashValue from_state_id,
                                       HashValue to_state_id) const {
-  Path path;
-
   const StategraphState* from_state = GetState(from_state_id);
   if (from_state == nullptr) {
     LOG(DFATAL) << "Could not find initial state: " << from_state_id;
@@ -102,8 +128,21 @@ Stategraph::Path Stategraph::FindPath(HashValue from_state_id,
     return {};
   }
 
-  std::set<HashValue> visited;
-  return FindPathHelper(from_state, to_state, visited);
+  BuildRoutingTable();
+  const size_t n = states_.size();
+  const size_t to = route_index_[to_state_id];
+  size_t from = route_index_[from_state_id];
+
+  Path path;
+  while (from != to) {
+    const StategraphTransition* transition = next_hop_[from * n + to];
+    if (transition == nullptr || path.size() >= n) {
+      return {};
+    }
+    path.push_back(*transition);
+    from = route_index_[transition->to_state];
+  }
+  return path;
 }
 
 std::string Stategraph::GetGraphDebugString() const {
@@ -19,8 +19,8 @@ limitations under the License.
 
 #include <deque>
 #include <memory>
-#include <set>
 #include <unordered_map>
+#include <vector>
 #include "lullaby/modules/stategraph/stategraph_state.h"
 #include "lullaby/util/hash.h"
 #include "lullaby/util/typeid.h"
@@ -34,6 +34,11 @@ namespace lull {
 // Transitions are single-directional, with the State that owns the Transition
 // being the originating State for the Transition.  The Stategraph provides
 // functions to find a path of Transitions between two States.
+//
+// Paths are looked up in a routing table holding the first Transition of the
+// shortest path between every pair of States.  The table is built the first
+// time a path is requested after the set of States changes, so FindPath only
+// costs one table lookup per Transition in the returned path.
 class Stategraph {
  public:
   Stategraph() {}
@@ -49,18 +54,29 @@ class Stategraph {
   const StategraphState* GetState(HashValue id) const;
 
   // Returns the sequence of Transitions required to go between the given
-  // States.
+  // States.  This is the path with the shortest total transition_time, with
+  // ties going to the path with the fewest Transitions.
   using Path = std::deque<StategraphTransition>;
   Path FindPath(HashValue from_state_id, HashValue to_state_id) const;
 
+  // Builds the routing table used by FindPath if it is out of date.  This is
+  // done automatically by FindPath, but can be called once all States are
+  // added to avoid the cost when the first path is requested.
+  void BuildRoutingTable() const;
+
   // Returns the Graphviz representation of the graph.
   std::string GetGraphDebugString() const;
 
  private:
-  Path FindPathHelper(const StategraphState* node, const StategraphState* dest,
-                      std::set<HashValue> visited) const;
-
   std::unordered_map<HashValue, std::unique_ptr<StategraphState>> states_;
+
+  // The routing table, which is built lazily from |states_|.  Each State is
+  // assigned a dense index, and |next_hop_[from * n + to]| is the first
+  // Transition of the shortest path between those States (or nullptr if there
+  // is no such path), where n is the number of States.
+  mutable std::unordered_map<HashValue, size_t> route_index_;
+  mutable std::vector<const StategraphTransition*> next_hop_;
+  mutable bool routes_dirty_ = true;
 };
 
 }  // namespace lull
@@ -105,7 +105,10 @@ void AnimationChannel::Update(std::vector<AnimationId>* completed) {
             (anim_values[i] * (i < num_multiplier ? anim.multiplier[i] : 1.f));
       }
       if (!UsesAnimationContext()) {
-        Set(entity, anim.scratch.data(), dimensions);
+        batch_entities_.push_back(entity);
+        batch_lengths_.push_back(dimensions);
+        batch_values_.insert(batch_values_.end(), anim.scratch.begin(),
+                             anim.scratch.begin() + dimensions);
       } else {
         Set(entity, anim.scratch.data(), dimensions, anim.context);
       }
@@ -120,6 +123,13 @@ void AnimationChannel::Update(std::vector<AnimationId>* completed) {
     }
   });
 
+  if (!batch_entities_.empty()) {
+    SetBatch(batch_entities_, batch_values_, batch_lengths_);
+    batch_entities_.clear();
+    batch_values_.clear();
+    batch_lengths_.clear();
+  }
+
   for (const Entity e : anims_to_cancel) {
     Cancel(e);
   }
@@ -387,6 +397,15 @@ void AnimationChannel::Set(Entity entity, const float* values, size_t len,
   LOG(DFATAL) << "Set (with context) called on an unsupported channel.";
 }
 
+void AnimationChannel::SetBatch(Span<Entity> entities, Span<float> values,
+                                Span<size_t> lengths) {
+  const float* data = values.data();
+  for (size_t i = 0; i < entities.size(); ++i) {
+    Set(entities[i], data, lengths[i]);
+    data += lengths[i];
+  }
+}
+
 void AnimationChannel::SetRig(Entity entity,
                               const mathfu::AffineTransform* values,
                               size_t len) {
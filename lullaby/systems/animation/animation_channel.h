@@ -18,6 +18,7 @@ limitations under the License.
 #define LULLABY_SYSTEMS_ANIMATION_ANIMATION_CHANNEL_H_
 
 #include <memory>
+#include <vector>
 #include "lullaby/events/animation_events.h"
 #include "lullaby/modules/ecs/component.h"
 #include "lullaby/systems/animation/playback_parameters.h"
@@ -38,10 +39,12 @@ namespace lull {
 // Responsible for mapping data between Components and a motive::Motivator.
 //
 // Each AnimationChannel stores a set of Animation objects which associate
-// Motivators with Entities.  Each frame, the current Motivator values are
-// passed to the AnimationChannel's virtual |Set| function which is overridden
-// such that the data is passed to the correct Component for the associated
-// Entity.
+// Motivators with Entities.  Each frame, the current Motivator values of all
+// the channel's animations are passed to the AnimationChannel's virtual
+// |SetBatch| function, which by default calls the virtual |Set| function for
+// each Entity.  Channels override |Set| such that the data is passed to the
+// correct Component for the associated Entity, and may additionally override
+// |SetBatch| to apply the data for all Entities in a single pass.
 //
 // Animation channels can specify an exact number of dimensions that they
 // animate, or 0 if they can animate a flexible number of dimensions. For
@@ -198,6 +201,15 @@ class AnimationChannel {
   virtual void Set(Entity entity, const float* values, size_t len,
                    const void* context);
 
+  // Sets the Component data for this channel for all the |entities| animated
+  // this frame.  The values of each entity are stored consecutively in
+  // |values|: the first |lengths[0]| floats belong to |entities[0]|, the next
+  // |lengths[1]| floats to |entities[1]|, and so on.  The default
+  // implementation calls Set() for each entity.  Not used by rig channels or
+  // channels that use an animation context.
+  virtual void SetBatch(Span<Entity> entities, Span<float> values,
+                        Span<size_t> lengths);
+
   // Sets the rig data associated with |entity|.
   virtual void SetRig(Entity entity, const mathfu::AffineTransform* values,
                       size_t len);
@@ -210,6 +222,12 @@ class AnimationChannel {
   Registry* registry_;
   ComponentPool<Animation> anims_;
   size_t dimensions_;
+
+ private:
+  // Scratch buffers for the values passed to SetBatch().
+  std::vector<Entity> batch_entities_;
+  std::vector<float> batch_values_;
+  std::vector<size_t> batch_lengths_;
 };
 
 using AnimationChannelPtr = std::unique_ptr<AnimationChannel>;
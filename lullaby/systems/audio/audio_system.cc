@@ -16,6 +16,8 @@ limitations under the License.
 
 #include "lullaby/systems/audio/audio_system.h"
 
+#include <algorithm>
+#include <limits>
 #include <utility>
 
 #include "mathfu/constants.h"
@@ -158,7 +160,11 @@ AudioSystem::AudioSystem(Registry* registry, std::unique_ptr<gvr::AudioApi> api)
       audio_running_(false),
       transform_flag_(TransformSystem::kInvalidFlag),
       master_volume_(1.0),
-      muted_(false) {
+      muted_(false),
+      max_voices_(0),
+      audibility_threshold_(0.f),
+      listener_position_(mathfu::kZeros3f),
+      num_virtual_sounds_(0) {
   if (audio_) {
     // Only Init() the gvr::AudioApi if it's backing C instance doesn't exist
     // else an already-in-use instance might be destroyed.
@@ -811,10 +817,34 @@ void AudioSystem::UpdateSource(AudioSource* source,
       ++iter;
     } else if (source_id == kInvalidSourceId) {
       PlaySound(&sound, source->sqt, asset);
+      // Rank the new sound in this Update() so that it is not left silent (or
+      // over budget) for a frame.
+      if (sound.id != kInvalidSourceId) {
+        Voice voice;
+        voice.source = source;
+        voice.sound = &sound;
+        voice.audibility = CalculateAudibility(&sound, source->sqt);
+        voices_.push_back(voice);
+      }
       ++iter;
     } else if (audio_->IsSoundPlaying(source_id)) {
-      if (sqt_updated) {
-        UpdateSoundTransform(&sound, source->sqt);
+      if (sound.params.playback_type ==
+          AudioPlaybackType::AudioPlaybackType_External) {
+        if (sqt_updated) {
+          UpdateSoundTransform(&sound, source->sqt);
+        }
+      } else {
+        // Transforms of virtual sounds are only sent once they are realized.
+        if (sound.is_virtual) {
+          sound.transform_dirty |= sqt_updated;
+        } else if (sqt_updated) {
+          UpdateSoundTransform(&sound, source->sqt);
+        }
+        Voice voice;
+        voice.source = source;
+        voice.sound = &sound;
+        voice.audibility = CalculateAudibility(&sound, source->sqt);
+        voices_.push_back(voice);
       }
       ++iter;
     } else {
@@ -861,8 +891,10 @@ void AudioSystem::Update() {
       transform_system->GetWorldFromEntityMatrix(listener_.GetEntity());
   if (world_mat) {
     audio_->SetHeadPose(ConvertToGvrHeadPoseMatrix(*world_mat));
+    listener_position_ = world_mat->TranslationVector3D();
   }
 
+  voices_.clear();
   transform_system->ForEach(
       transform_flag_,
       [this](Entity e, const mathfu::mat4& world_from_entity_mat,
@@ -870,10 +902,101 @@ void AudioSystem::Update() {
         auto* source = sources_.Get(e);
         UpdateSource(source, world_from_entity_mat);
       });
+  UpdateVoices();
 
   audio_->Update();
 }
 
+float AudioSystem::CalculateAudibility(Sound* sound, const Sqt& sqt) const {
+  const float volume = sound->params.volume;
+  if (sound->params.source_type !=
+      AudioSourceType::AudioSourceType_SoundObject) {
+    // Stereo sounds and soundfields are not attenuated by distance.
+    return volume;
+  }
+
+  // Without a custom rolloff, GVR Audio attenuates sound objects
+  // logarithmically starting at a distance of 1 meter.
+  gvr::AudioRolloffMethod method =
+      gvr::AudioRolloffMethod::GVR_AUDIO_ROLLOFF_LOGARITHMIC;
+  float min_distance = 1.f;
+  float max_distance = std::numeric_limits<float>::infinity();
+  if (IsDistanceRolloffMethodEnabled(sound)) {
+    method = sound->params.spatial_rolloff_method;
+    min_distance = sound->params.spatial_rolloff_min_distance;
+    max_distance = sound->params.spatial_rolloff_max_distance;
+  }
+
+  const float distance = (sqt.translation - listener_position_).Length();
+  if (method == gvr::AudioRolloffMethod::GVR_AUDIO_ROLLOFF_NONE ||
+      distance <= min_distance) {
+    return volume;
+  } else if (distance >= max_distance) {
+    return 0.f;
+  } else if (method == gvr::AudioRolloffMethod::GVR_AUDIO_ROLLOFF_LINEAR) {
+    return volume * (max_distance - distance) / (max_distance - min_distance);
+  }
+  return volume * std::max(min_distance, 1e-3f) / distance;
+}
+
+void AudioSystem::UpdateVoices() {
+  // Most audible sounds first, but always after higher priority sounds. The
+  // sort is stable so that equally audible sounds don't swap every Update().
+  auto compare = [](const Voice& lhs, const Voice& rhs) {
+    if (lhs.sound->params.priority != rhs.sound->params.priority) {
+      return lhs.sound->params.priority > rhs.sound->params.priority;
+    }
+    return lhs.audibility > rhs.audibility;
+  };
+  std::stable_sort(voices_.begin(), voices_.end(), compare);
+
+  num_virtual_sounds_ = 0;
+  size_t num_real_sounds = 0;
+  for (Voice& voice : voices_) {
+    const bool over_budget = max_voices_ > 0 && num_real_sounds >= max_voices_;
+    if (over_budget || voice.audibility < audibility_threshold_) {
+      VirtualizeSound(voice.sound);
+      ++num_virtual_sounds_;
+    } else {
+      RealizeSound(voice.sound, voice.source->sqt);
+      ++num_real_sounds;
+    }
+  }
+}
+
+void AudioSystem::VirtualizeSound(Sound* sound) {
+  if (!sound->is_virtual) {
+    audio_->SetSoundVolume(sound->id, 0.f);
+    sound->is_virtual = true;
+  }
+}
+
+void AudioSystem::RealizeSound(Sound* sound, const Sqt& sqt) {
+  if (sound->is_virtual) {
+    if (sound->transform_dirty) {
+      UpdateSoundTransform(sound, sqt);
+      sound->transform_dirty = false;
+    }
+    audio_->SetSoundVolume(sound->id, sound->params.volume);
+    sound->is_virtual = false;
+  }
+}
+
+void AudioSystem::SetMaxVoices(size_t max_voices) { max_voices_ = max_voices; }
+
+void AudioSystem::SetAudibilityThreshold(float threshold) {
+  audibility_threshold_ = threshold;
+}
+
+bool AudioSystem::IsVirtual(Entity e, HashValue sound) const {
+  const auto* source = sources_.Get(e);
+  if (source == nullptr) {
+    return false;
+  }
+  auto iter = source->sounds.find(sound);
+  return iter != source->sounds.end() && iter->second.is_virtual;
+}
+
 void AudioSystem::SetMute(bool muted) {
   muted_ = muted;
   if (audio_) {
@@ -942,7 +1065,9 @@ void AudioSystem::SetVolume(Entity e, float volume, HashValue sound) {
     auto iter = source->sounds.find(sound);
     if (iter != source->sounds.end()) {
       auto& sound = iter->second;
-      audio_->SetSoundVolume(sound.id, volume);
+      if (!sound.is_virtual) {
+        audio_->SetSoundVolume(sound.id, volume);
+      }
       sound.params.volume = volume;
     } else {
       LOG(WARNING) << "Failed to find the specified sound to change the "
@@ -951,7 +1076,9 @@ void AudioSystem::SetVolume(Entity e, float volume, HashValue sound) {
   } else {
     for (auto& iter : source->sounds) {
       auto& sound = iter.second;
-      audio_->SetSoundVolume(sound.id, volume);
+      if (!sound.is_virtual) {
+        audio_->SetSoundVolume(sound.id, volume);
+      }
       sound.params.volume = volume;
     }
   }
@@ -1142,7 +1269,14 @@ void AudioSystem::PlaySound(Sound* sound, const Sqt& sqt,
           sound->params.spatial_rolloff_max_distance);
     }
     UpdateSoundTransform(sound, sqt);
-    audio_->SetSoundVolume(new_id, sound->params.volume);
+    // Until UpdateVoices() ranks the new sound against the other voices, it
+    // can only be audible if there is no voice budget to exceed.
+    const bool is_virtual =
+        max_voices_ > 0 ||
+        CalculateAudibility(sound, sqt) < audibility_threshold_;
+    sound->is_virtual = is_virtual;
+    sound->transform_dirty = false;
+    audio_->SetSoundVolume(new_id, is_virtual ? 0.f : sound->params.volume);
     audio_->PlaySound(new_id, sound->params.loop);
   } else {
     // Never try to play a failed sound again.
@@ -162,6 +162,26 @@ class AudioSystem : public System {
                                            float min_distance,
                                            float max_distance);
 
+  // Sets the maximum number of sounds that are rendered at the same time. If
+  // more sounds are playing, the ones with the lowest priority and audibility
+  // become virtual: they keep playing silently, but receive no spatial updates
+  // until they are promoted back to real voices. A value of 0 (the default)
+  // means there is no limit. Externally tracked sounds are never virtualized
+  // and do not count against the limit.
+  void SetMaxVoices(size_t max_voices);
+
+  // Sets the audibility below which sounds become virtual regardless of the
+  // voice limit. A sound's audibility is its volume scaled by the distance
+  // attenuation between it and the AudioListener. The default is 0, which
+  // never virtualizes sounds based on audibility.
+  void SetAudibilityThreshold(float threshold);
+
+  // Returns true if the specified sound on |e| is currently virtual.
+  bool IsVirtual(Entity e, HashValue sound) const;
+
+  // Returns the number of sounds that were virtual after the last Update().
+  size_t GetNumVirtualSounds() const { return num_virtual_sounds_; }
+
  private:
   using SourceId = gvr::AudioSourceId;
   static const SourceId kInvalidSourceId = gvr::kInvalidSourceId;
@@ -171,6 +191,17 @@ class AudioSystem : public System {
     SoundAssetWeakPtr asset_handle;
     PlaySoundParameters params;
     bool paused = false;
+    // Virtual sounds are playing silently and are not sent transform updates.
+    bool is_virtual = false;
+    // Set if the source moved while the sound was virtual.
+    bool transform_dirty = false;
+  };
+
+  // A playing sound that is a candidate for being rendered this Update().
+  struct Voice {
+    AudioSource* source = nullptr;
+    Sound* sound = nullptr;
+    float audibility = 0.f;
   };
 
   struct AudioListener : Component {
@@ -214,6 +245,18 @@ class AudioSystem : public System {
   // to play or are finished playing.
   void UpdateSource(AudioSource* source, const mathfu::mat4& world_from_entity);
 
+  // Calculates how loud |sound| is at the listener's position, ignoring the
+  // master volume.
+  float CalculateAudibility(Sound* sound, const Sqt& sqt) const;
+
+  // Decides which of the |voices_| gathered by UpdateSource() are rendered and
+  // which are virtual, and applies any changes.
+  void UpdateVoices();
+
+  // Turn |sound| into a virtual sound, or back into a real one.
+  void VirtualizeSound(Sound* sound);
+  void RealizeSound(Sound* sound, const Sqt& sqt);
+
   // Check if |source|'s previous SQT is different than |world_from_entity|. If
   // it is, update |sources|'s stored SQT and return true. Otherwise, return
   // false.
@@ -223,7 +266,8 @@ class AudioSystem : public System {
   // Attempts to play |sound| using |sqt| as its transform. If the playback is
   // successful, the |sound|'s id will be set to the source id. If not, it will
   // be set to the invalid source id, and |asset| will be marked as "failed"
-  // to prevent future playback attempts.
+  // to prevent future playback attempts.  Sounds that may need to be virtual
+  // start silently and are left for UpdateVoices() to rank.
   void PlaySound(Sound* sound, const Sqt& sqt, const SoundAssetPtr& asset);
 
   // Pause or resume |sound| and update its tracked pause state.
@@ -261,6 +305,11 @@ class AudioSystem : public System {
   TransformSystem::TransformFlags transform_flag_;
   float master_volume_;
   bool muted_;
+  size_t max_voices_;
+  float audibility_threshold_;
+  mathfu::vec3 listener_position_;
+  std::vector<Voice> voices_;
+  size_t num_virtual_sounds_;
 
   AudioSystem(const AudioSystem&);
   AudioSystem& operator=(const AudioSystem&);
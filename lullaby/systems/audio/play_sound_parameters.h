@@ -71,6 +71,11 @@ struct PlaySoundParameters {
   float spatial_rolloff_min_distance = -1.0;
   float spatial_rolloff_max_distance = -1.0;
 
+  // When there are more playing sounds than the AudioSystem's voice limit,
+  // sounds with a higher priority are rendered before sounds with a lower
+  // priority, regardless of how audible they are.
+  int priority = 0;
+
   template <typename Archive>
   void Serialize(Archive archive) {
     archive(&playback_type, ConstHash("playback_type"));
@@ -84,6 +89,7 @@ struct PlaySoundParameters {
             ConstHash("spatial_rolloff_min_distance"));
     archive(&spatial_rolloff_max_distance,
             ConstHash("spatial_rolloff_max_distance"));
+    archive(&priority, ConstHash("priority"));
   }
 };
 
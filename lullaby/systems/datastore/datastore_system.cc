@@ -16,6 +16,8 @@ limitations under the License.
 
 #include "lullaby/systems/datastore/datastore_system.h"
 
+#include <algorithm>
+
 #include "lullaby/generated/datastore_def_generated.h"
 #include "lullaby/modules/flatbuffers/variant_fb_conversions.h"
 #include "lullaby/modules/script/function_binder.h"
@@ -26,6 +28,17 @@ limitations under the License.
 namespace lull {
 
 static const HashValue kDatastoreDef = ConstHash("DatastoreDef");
+static const size_t kMinIndexSize = 16;
+
+// Entities are often allocated sequentially, so mix the bits of the Entity to
+// spread them across the index.
+static size_t HashEntity(Entity entity) {
+  uint32_t value = entity.AsUint32();
+  value ^= value >> 16;
+  value *= 0x7feb352du;
+  value ^= value >> 15;
+  return static_cast<size_t>(value);
+}
 
 DatastoreSystem::DatastoreSystem(Registry* registry) : System(registry) {
   RegisterDef<DatastoreDefT>(this);
@@ -76,7 +89,7 @@ void DatastoreSystem::Create(Entity entity, HashValue type, const Def* def) {
   }
 }
 
-void DatastoreSystem::Destroy(Entity entity) { stores_.erase(entity); }
+void DatastoreSystem::Destroy(Entity entity) { DestroyStore(entity); }
 
 void DatastoreSystem::Set(Entity entity, HashValue key,
                           const Variant& variant) {
@@ -84,34 +97,173 @@ void DatastoreSystem::Set(Entity entity, HashValue key,
     return;
   }
 
-  const auto store_iter = stores_.emplace(entity, Datastore()).first;
-  store_iter->second[key] = variant;
+  (*GetOrCreateStore(entity))[key] = variant;
+}
+
+void DatastoreSystem::Set(Span<Entity> entities, HashValue key,
+                          Span<Variant> values) {
+  if (entities.size() != values.size()) {
+    LOG(DFATAL) << "Number of entities (" << entities.size()
+                << ") does not match number of values (" << values.size()
+                << ").";
+    return;
+  }
+
+  for (size_t i = 0; i < entities.size(); ++i) {
+    Set(entities[i], key, values[i]);
+  }
 }
 
 void DatastoreSystem::Remove(Entity entity, HashValue key) {
-  const auto store_iter = stores_.find(entity);
-  if (store_iter == stores_.end()) {
+  Datastore* store = FindStore(entity);
+  if (store == nullptr) {
     return;
   }
-  store_iter->second.erase(key);
-  if (store_iter->second.empty()) {
-    stores_.erase(entity);
+  store->erase(key);
+  if (store->empty()) {
+    DestroyStore(entity);
   }
 }
 
 const Variant& DatastoreSystem::GetVariant(Entity entity, HashValue key) const {
-  const auto store_iter = stores_.find(entity);
-  if (store_iter == stores_.end()) {
+  const Datastore* store = FindStore(entity);
+  if (store == nullptr) {
     return empty_variant_;
   }
 
-  const Datastore& store = store_iter->second;
-  auto variant_map_iter = store.find(key);
-  if (variant_map_iter == store.end()) {
+  auto variant_map_iter = store->find(key);
+  if (variant_map_iter == store->end()) {
     return empty_variant_;
   }
 
   return variant_map_iter->second;
 }
 
+void DatastoreSystem::GetVariants(Span<Entity> entities, HashValue key,
+                                  std::vector<const Variant*>* out) const {
+  out->resize(entities.size());
+  for (size_t i = 0; i < entities.size(); ++i) {
+    (*out)[i] = &GetVariant(entities[i], key);
+  }
+}
+
+DatastoreSystem::MemoryUsage DatastoreSystem::GetMemoryUsage() const {
+  MemoryUsage usage;
+  usage.num_entities = num_stores_;
+  usage.num_bytes =
+      index_.capacity() * sizeof(IndexEntry) +
+      slab_.capacity() * sizeof(slab_[0]) +
+      slab_.size() * kStoresPerChunk * sizeof(Datastore) +
+      free_stores_.capacity() * sizeof(uint32_t);
+  for (size_t i = 0; i < slab_size_; ++i) {
+    const Datastore& store = GetSlabStore(static_cast<uint32_t>(i));
+    usage.num_values += store.size();
+    if (store.IsOnHeap()) {
+      ++usage.num_spilled_stores;
+      usage.num_bytes += store.capacity() * sizeof(Datastore::value_type);
+    }
+  }
+  return usage;
+}
+
+size_t DatastoreSystem::FindIndexEntry(Entity entity) const {
+  const size_t mask = index_.size() - 1;
+  size_t pos = HashEntity(entity) & mask;
+  while (index_[pos].entity != kNullEntity && index_[pos].entity != entity) {
+    pos = (pos + 1) & mask;
+  }
+  return pos;
+}
+
+const DatastoreSystem::Datastore* DatastoreSystem::FindStore(
+    Entity entity) const {
+  if (index_.empty() || entity == kNullEntity) {
+    return nullptr;
+  }
+  const IndexEntry& entry = index_[FindIndexEntry(entity)];
+  return entry.entity == entity ? &GetSlabStore(entry.store) : nullptr;
+}
+
+DatastoreSystem::Datastore* DatastoreSystem::FindStore(Entity entity) {
+  return const_cast<Datastore*>(
+      static_cast<const DatastoreSystem*>(this)->FindStore(entity));
+}
+
+DatastoreSystem::Datastore* DatastoreSystem::GetOrCreateStore(Entity entity) {
+  if (2 * (num_stores_ + 1) > index_.size()) {
+    GrowIndex();
+  }
+
+  IndexEntry& entry = index_[FindIndexEntry(entity)];
+  if (entry.entity == entity) {
+    return &GetSlabStore(entry.store);
+  }
+
+  // Reuse the slot of a destroyed Datastore if possible.
+  if (free_stores_.empty()) {
+    if (slab_size_ == slab_.size() * kStoresPerChunk) {
+      slab_.emplace_back(new Datastore[kStoresPerChunk]);
+    }
+    entry.store = static_cast<uint32_t>(slab_size_);
+    ++slab_size_;
+  } else {
+    entry.store = free_stores_.back();
+    free_stores_.pop_back();
+  }
+  entry.entity = entity;
+  ++num_stores_;
+  return &GetSlabStore(entry.store);
+}
+
+DatastoreSystem::Datastore& DatastoreSystem::GetSlabStore(uint32_t store) {
+  return slab_[store / kStoresPerChunk][store % kStoresPerChunk];
+}
+
+const DatastoreSystem::Datastore& DatastoreSystem::GetSlabStore(
+    uint32_t store) const {
+  return slab_[store / kStoresPerChunk][store % kStoresPerChunk];
+}
+
+void DatastoreSystem::DestroyStore(Entity entity) {
+  if (index_.empty() || entity == kNullEntity) {
+    return;
+  }
+
+  size_t hole = FindIndexEntry(entity);
+  if (index_[hole].entity != entity) {
+    return;
+  }
+
+  // Release any heap-allocated values and make the slot available for reuse.
+  const uint32_t store = index_[hole].store;
+  GetSlabStore(store) = Datastore();
+  free_stores_.push_back(store);
+  --num_stores_;
+
+  // Shift back any entries that were displaced past the removed entry so that
+  // the index never needs tombstones.
+  const size_t mask = index_.size() - 1;
+  size_t pos = (hole + 1) & mask;
+  while (index_[pos].entity != kNullEntity) {
+    const size_t home = HashEntity(index_[pos].entity) & mask;
+    if (((pos - home) & mask) >= ((pos - hole) & mask)) {
+      index_[hole] = index_[pos];
+      hole = pos;
+    }
+    pos = (pos + 1) & mask;
+  }
+  index_[hole] = IndexEntry();
+}
+
+void DatastoreSystem::GrowIndex() {
+  std::vector<IndexEntry> old_index(
+      std::max(kMinIndexSize, 2 * index_.size()));
+  index_.swap(old_index);
+  for (const IndexEntry& entry : old_index) {
+    if (entry.entity != kNullEntity) {
+      index_[FindIndexEntry(entry.entity)] = entry;
+    }
+  }
+}
+
 }  // namespace lull
@@ -17,9 +17,11 @@ limitations under the License.
 #ifndef LULLABY_SYSTEMS_DATASTORE_DATASTORE_SYSTEM_H_
 #define LULLABY_SYSTEMS_DATASTORE_DATASTORE_SYSTEM_H_
 
-#include <unordered_map>
+#include <memory>
+#include <vector>
 #include "lullaby/modules/ecs/component.h"
 #include "lullaby/modules/ecs/system.h"
+#include "lullaby/util/span.h"
 #include "lullaby/util/variant.h"
 
 namespace lull {
@@ -29,8 +31,31 @@ namespace lull {
 // A Datastore is just a dictionary of a HashValue to a Variant.  Adding a
 // datastore to an Entity allows arbitrary key-value pairs to be associated with
 // the Entity.
+//
+// The Datastores are stored in a single slab indexed by an open-addressed table
+// of Entities, so looking up a value only requires a single probe of the table
+// followed by a search of the handful of (sorted) values stored inline in the
+// Entity's slot of the slab.
+//
+// The slab is allocated in fixed-size chunks that never move, so references
+// returned by the Get functions remain valid when values are set on other
+// Entities.  Setting or removing a value on an Entity (or destroying it) may
+// move that Entity's other values, invalidating any references to them.
 class DatastoreSystem : public System {
  public:
+  // Information about the memory used by the DatastoreSystem.
+  struct MemoryUsage {
+    // The number of Entities with a Datastore.
+    size_t num_entities = 0;
+    // The total number of values across all Datastores.
+    size_t num_values = 0;
+    // The number of Datastores whose values no longer fit inline in the slab.
+    size_t num_spilled_stores = 0;
+    // The number of bytes used by the index, the slab and spilled values.  Any
+    // memory owned by the values themselves (eg. strings) is not included.
+    size_t num_bytes = 0;
+  };
+
   explicit DatastoreSystem(Registry* registry);
 
   ~DatastoreSystem() override;
@@ -48,6 +73,10 @@ class DatastoreSystem : public System {
   // Associates the value stored in |variant| with the |key| on the |entity|.
   void Set(Entity entity, HashValue key, const Variant& variant);
 
+  // Associates each of the |values| with the |key| on the corresponding Entity
+  // in |entities|.  Both spans must be the same size.
+  void Set(Span<Entity> entities, HashValue key, Span<Variant> values);
+
   // Removes the value associated with the |key| on the |entity|.
   void Remove(Entity entity, HashValue key);
 
@@ -57,14 +86,58 @@ class DatastoreSystem : public System {
   const T* Get(Entity entity, HashValue key) const;
 
   // Returns the Variant value associated with the |key| on the |entity|, or an
-  // empty Variant if not set.
+  // empty Variant if not set.  The reference is invalidated by the next change
+  // to the |entity|'s datastore.
   const Variant& GetVariant(Entity entity, HashValue key) const;
 
- private:
-  using Datastore = std::unordered_map<HashValue, Variant>;
-  using EntityMap = std::unordered_map<Entity, Datastore>;
+  // Fills |out| with a pointer to the value associated with the |key| on each
+  // of the |entities|, or nullptr if not set or the type is incorrect.
+  template <typename T>
+  void Get(Span<Entity> entities, HashValue key,
+           std::vector<const T*>* out) const;
+
+  // Fills |out| with a pointer to the Variant associated with the |key| on each
+  // of the |entities|.  Pointers to an empty Variant are used for values that
+  // are not set.  As with GetVariant(), each pointer is invalidated by the next
+  // change to the corresponding Entity's datastore.
+  void GetVariants(Span<Entity> entities, HashValue key,
+                   std::vector<const Variant*>* out) const;
 
-  EntityMap stores_;
+  // Returns information about the memory currently used to store values.
+  MemoryUsage GetMemoryUsage() const;
+
+ private:
+  // Most entities only store a handful of values, so keep them inline.
+  using Datastore = SmallVariantMap;
+
+  // An entry in the open-addressed index from an Entity to its Datastore in the
+  // slab.  Unused entries have a null Entity.
+  struct IndexEntry {
+    Entity entity = kNullEntity;
+    uint32_t store = 0;
+  };
+
+  // The number of Datastores in each chunk of the slab.
+  static const size_t kStoresPerChunk = 64;
+
+  // Returns the index entry in which the |entity| is (or would be) stored.
+  size_t FindIndexEntry(Entity entity) const;
+
+  const Datastore* FindStore(Entity entity) const;
+  Datastore* FindStore(Entity entity);
+  Datastore* GetOrCreateStore(Entity entity);
+  Datastore& GetSlabStore(uint32_t store);
+  const Datastore& GetSlabStore(uint32_t store) const;
+  void DestroyStore(Entity entity);
+  void GrowIndex();
+
+  // The index size is always zero or a power of two, and it is kept at most
+  // half full so that probe sequences stay short.
+  std::vector<IndexEntry> index_;
+  size_t num_stores_ = 0;
+  std::vector<std::unique_ptr<Datastore[]>> slab_;
+  size_t slab_size_ = 0;
+  std::vector<uint32_t> free_stores_;
   Variant empty_variant_;
 
   DatastoreSystem(const DatastoreSystem&);
@@ -77,8 +150,7 @@ void DatastoreSystem::Set(Entity entity, HashValue key, const T& value) {
     return;
   }
 
-  const auto store_iter = stores_.emplace(entity, Datastore()).first;
-  store_iter->second[key] = value;
+  (*GetOrCreateStore(entity))[key] = value;
 }
 
 template <typename T>
@@ -86,6 +158,15 @@ const T* DatastoreSystem::Get(Entity entity, HashValue key) const {
   return GetVariant(entity, key).Get<T>();
 }
 
+template <typename T>
+void DatastoreSystem::Get(Span<Entity> entities, HashValue key,
+                          std::vector<const T*>* out) const {
+  out->resize(entities.size());
+  for (size_t i = 0; i < entities.size(); ++i) {
+    (*out)[i] = GetVariant(entities[i], key).Get<T>();
+  }
+}
+
 }  // namespace lull
 
 LULLABY_SETUP_TYPEID(lull::DatastoreSystem);
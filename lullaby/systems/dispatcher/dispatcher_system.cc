@@ -16,6 +16,8 @@ limitations under the License.
 
 #include "lullaby/systems/dispatcher/dispatcher_system.h"
 
+#include <algorithm>
+
 #include "lullaby/modules/dispatcher/dispatcher_binder.h"
 #include "lullaby/modules/dispatcher/queued_dispatcher.h"
 #include "lullaby/modules/script/function_binder.h"
@@ -25,7 +27,315 @@ limitations under the License.
 namespace lull {
 const HashValue kEventResponseDefHash = ConstHash("EventResponseDef");
 
-DispatcherSystem::DispatcherSystem(Registry* registry) : System(registry) {
+// Stores the event handlers for all Entities in a single table keyed by
+// (Entity, TypeId).  Each key maps to a contiguous array of handlers, and an
+// Entity without any handlers has no entries in the table.
+//
+// Similar to the Dispatcher's EventHandlerMap, adding and removing handlers
+// while a dispatch is in progress is handled by storing the request in a
+// command queue which is processed once the outermost dispatch completes.
+class DispatcherSystem::RouteTable : public Dispatcher::HandlerStore {
+ public:
+  // Associates the |fn| with events of |type| sent to |entity|.  Returns the
+  // ConnectionId which can be used to remove the handler.
+  Dispatcher::ConnectionId Add(Entity entity, TypeId type, const void* owner,
+                               Dispatcher::EventHandler fn);
+
+  // Removes the handler with the given |id|.  Called by Connections.
+  void Remove(TypeId type, Dispatcher::ConnectionId id,
+              const void* owner) override;
+
+  // Removes the handler of |entity| with the given |id|, or all the handlers
+  // of |entity| associated with |owner| if |id| is 0.  A |type| of 0 matches
+  // all types.
+  void Remove(Entity entity, TypeId type, Dispatcher::ConnectionId id,
+              const void* owner);
+
+  // Removes all handlers associated with the |entity|.
+  void RemoveAll(Entity entity);
+
+  // Passes the |event| to all the handlers of |entity| that are listening for
+  // the event's type (or all events).  Must be called between BeginDispatch
+  // and EndDispatch.
+  void Send(Entity entity, const EventWrapper& event);
+
+  // Brackets a series of Send calls.  Adds and removes are deferred until the
+  // outermost EndDispatch.
+  void BeginDispatch() { ++dispatch_count_; }
+  void EndDispatch();
+  bool IsDispatching() const { return dispatch_count_ > 0; }
+
+  // Returns the number of handlers of |entity| for events of |type|.
+  size_t GetHandlerCount(Entity entity, TypeId type) const;
+
+  // Returns the number of Entities with at least one handler.
+  size_t GetNumEntities() const { return entity_types_.size(); }
+
+ private:
+  using RouteKey = uint64_t;
+
+  struct Handler {
+    Handler(Dispatcher::ConnectionId id, const void* owner,
+            Dispatcher::EventHandler fn)
+        : id(id), owner(owner), fn(std::move(fn)) {}
+
+    Dispatcher::ConnectionId id;
+    const void* owner;
+    Dispatcher::EventHandler fn;
+  };
+
+  // The Entity and TypeId for a ConnectionId.
+  struct Route {
+    Entity entity;
+    TypeId type;
+  };
+
+  // A deferred Add (if |fn| is set), Remove or RemoveAll (if |remove_all| is
+  // set) request.
+  struct Command {
+    Entity entity;
+    TypeId type;
+    Dispatcher::ConnectionId id;
+    const void* owner;
+    Dispatcher::EventHandler fn;
+    bool remove_all;
+  };
+
+  static RouteKey MakeKey(Entity entity, TypeId type) {
+    return (static_cast<RouteKey>(entity.AsUint32()) << 32) | type;
+  }
+
+  void AddImpl(Entity entity, TypeId type, Handler handler);
+  void RemoveImpl(Entity entity, TypeId type, Dispatcher::ConnectionId id,
+                  const void* owner);
+  void RemoveByIdImpl(Dispatcher::ConnectionId id);
+  void RemoveAllImpl(Entity entity);
+
+  // Removes the route if it no longer has any handlers.
+  void EraseRouteIfEmpty(Entity entity, TypeId type);
+
+  void SendToRoute(RouteKey key, const EventWrapper& event);
+
+  Dispatcher::ConnectionId next_id_ = 0;
+  int dispatch_count_ = 0;
+
+  // The handlers for each (Entity, TypeId) pair.
+  std::unordered_map<RouteKey, std::vector<Handler>> routes_;
+
+  // The TypeIds which have routes for each Entity, used for RemoveAll.
+  std::unordered_map<Entity, std::vector<TypeId>> entity_types_;
+
+  // The route of each ConnectionId, used to remove handlers by id.
+  std::unordered_map<Dispatcher::ConnectionId, Route> connections_;
+
+  std::vector<Command> commands_;
+};
+
+Dispatcher::ConnectionId DispatcherSystem::RouteTable::Add(
+    Entity entity, TypeId type, const void* owner,
+    Dispatcher::EventHandler fn) {
+  const Dispatcher::ConnectionId id = ++next_id_;
+  if (IsDispatching()) {
+    commands_.push_back({entity, type, id, owner, std::move(fn), false});
+  } else {
+    AddImpl(entity, type, Handler(id, owner, std::move(fn)));
+  }
+  return id;
+}
+
+void DispatcherSystem::RouteTable::Remove(TypeId type,
+                                          Dispatcher::ConnectionId id,
+                                          const void* owner) {
+  // Connections only remove by id, which is enough to identify the route.
+  if (IsDispatching()) {
+    commands_.push_back({kNullEntity, type, id, owner, nullptr, false});
+  } else {
+    RemoveByIdImpl(id);
+  }
+}
+
+void DispatcherSystem::RouteTable::Remove(Entity entity, TypeId type,
+                                          Dispatcher::ConnectionId id,
+                                          const void* owner) {
+  if (IsDispatching()) {
+    commands_.push_back({entity, type, id, owner, nullptr, false});
+  } else {
+    RemoveImpl(entity, type, id, owner);
+  }
+}
+
+void DispatcherSystem::RouteTable::RemoveAll(Entity entity) {
+  if (IsDispatching()) {
+    commands_.push_back({entity, 0, 0, nullptr, nullptr, true});
+  } else {
+    RemoveAllImpl(entity);
+  }
+}
+
+void DispatcherSystem::RouteTable::Send(Entity entity,
+                                        const EventWrapper& event) {
+  DCHECK(IsDispatching());
+  SendToRoute(MakeKey(entity, event.GetTypeId()), event);
+  // Send to handlers that are listening for all events.
+  SendToRoute(MakeKey(entity, 0), event);
+}
+
+void DispatcherSystem::RouteTable::SendToRoute(RouteKey key,
+                                               const EventWrapper& event) {
+  auto iter = routes_.find(key);
+  if (iter == routes_.end()) {
+    return;
+  }
+  // Handlers cannot be added or removed during a dispatch, so the handler
+  // array will not be modified while iterating.
+  for (Handler& handler : iter->second) {
+    handler.fn(event);
+  }
+}
+
+void DispatcherSystem::RouteTable::EndDispatch() {
+  DCHECK(IsDispatching());
+  --dispatch_count_;
+  if (dispatch_count_ > 0) {
+    return;
+  }
+
+  // Swap out the queue in case a handler being destroyed connects or
+  // disconnects other handlers.
+  std::vector<Command> commands;
+  commands.swap(commands_);
+  for (Command& cmd : commands) {
+    if (cmd.fn) {
+      AddImpl(cmd.entity, cmd.type,
+              Handler(cmd.id, cmd.owner, std::move(cmd.fn)));
+    } else if (cmd.remove_all) {
+      RemoveAllImpl(cmd.entity);
+    } else if (cmd.entity == kNullEntity) {
+      RemoveByIdImpl(cmd.id);
+    } else {
+      RemoveImpl(cmd.entity, cmd.type, cmd.id, cmd.owner);
+    }
+  }
+}
+
+size_t DispatcherSystem::RouteTable::GetHandlerCount(Entity entity,
+                                                     TypeId type) const {
+  auto iter = routes_.find(MakeKey(entity, type));
+  return iter != routes_.end() ? iter->second.size() : 0;
+}
+
+void DispatcherSystem::RouteTable::AddImpl(Entity entity, TypeId type,
+                                           Handler handler) {
+  std::vector<Handler>& handlers = routes_[MakeKey(entity, type)];
+  if (handlers.empty()) {
+    entity_types_[entity].push_back(type);
+  }
+  connections_[handler.id] = Route{entity, type};
+  handlers.emplace_back(std::move(handler));
+}
+
+void DispatcherSystem::RouteTable::RemoveImpl(Entity entity, TypeId type,
+                                              Dispatcher::ConnectionId id,
+                                              const void* owner) {
+  if (id != 0) {
+    auto iter = connections_.find(id);
+    if (iter != connections_.end() && iter->second.entity == entity &&
+        (type == 0 || iter->second.type == type)) {
+      RemoveByIdImpl(id);
+    }
+    return;
+  }
+  if (owner == nullptr) {
+    return;
+  }
+
+  if (type == 0) {
+    auto types = entity_types_.find(entity);
+    if (types == entity_types_.end()) {
+      return;
+    }
+    // Copy the types since removing routes modifies the list.
+    const std::vector<TypeId> entity_types = types->second;
+    for (TypeId entity_type : entity_types) {
+      RemoveImpl(entity, entity_type, 0, owner);
+    }
+    return;
+  }
+
+  auto iter = routes_.find(MakeKey(entity, type));
+  if (iter == routes_.end()) {
+    return;
+  }
+  std::vector<Handler>& handlers = iter->second;
+  auto remove_begin = std::stable_partition(
+      handlers.begin(), handlers.end(),
+      [owner](const Handler& handler) { return handler.owner != owner; });
+  for (auto it = remove_begin; it != handlers.end(); ++it) {
+    connections_.erase(it->id);
+  }
+  handlers.erase(remove_begin, handlers.end());
+  EraseRouteIfEmpty(entity, type);
+}
+
+void DispatcherSystem::RouteTable::RemoveByIdImpl(Dispatcher::ConnectionId id) {
+  auto iter = connections_.find(id);
+  if (iter == connections_.end()) {
+    return;
+  }
+  const Route route = iter->second;
+  connections_.erase(iter);
+
+  auto handlers = routes_.find(MakeKey(route.entity, route.type));
+  if (handlers == routes_.end()) {
+    return;
+  }
+  auto it = std::find_if(
+      handlers->second.begin(), handlers->second.end(),
+      [id](const Handler& handler) { return handler.id == id; });
+  if (it != handlers->second.end()) {
+    handlers->second.erase(it);
+  }
+  EraseRouteIfEmpty(route.entity, route.type);
+}
+
+void DispatcherSystem::RouteTable::RemoveAllImpl(Entity entity) {
+  auto types = entity_types_.find(entity);
+  if (types == entity_types_.end()) {
+    return;
+  }
+  for (TypeId type : types->second) {
+    auto iter = routes_.find(MakeKey(entity, type));
+    if (iter == routes_.end()) {
+      continue;
+    }
+    for (const Handler& handler : iter->second) {
+      connections_.erase(handler.id);
+    }
+    routes_.erase(iter);
+  }
+  entity_types_.erase(types);
+}
+
+void DispatcherSystem::RouteTable::EraseRouteIfEmpty(Entity entity,
+                                                     TypeId type) {
+  auto iter = routes_.find(MakeKey(entity, type));
+  if (iter == routes_.end() || !iter->second.empty()) {
+    return;
+  }
+  routes_.erase(iter);
+
+  auto types = entity_types_.find(entity);
+  if (types != entity_types_.end()) {
+    std::vector<TypeId>& list = types->second;
+    list.erase(std::remove(list.begin(), list.end(), type), list.end());
+    if (list.empty()) {
+      entity_types_.erase(types);
+    }
+  }
+}
+
+DispatcherSystem::DispatcherSystem(Registry* registry)
+    : System(registry), route_table_(std::make_shared<RouteTable>()) {
   RegisterDef<EventResponseDefT>(this);
   RegisterDependency<Dispatcher>(this);
 }
@@ -35,6 +345,9 @@ void DispatcherSystem::Initialize() {
   dispatcher->Connect(this, [this](const EntityEvent& entity_event) {
     SendImmediatelyImpl(entity_event);
   });
+  dispatcher->Connect(this, [this](const EntityListEvent& entity_list_event) {
+    SendImmediatelyToManyImpl(entity_list_event);
+  });
 
   FunctionBinder* binder = registry_->Get<FunctionBinder>();
   if (binder) {
@@ -94,15 +407,35 @@ void DispatcherSystem::Create(Entity entity, HashValue type, const Def* def) {
 
 void DispatcherSystem::Destroy(Entity entity) {
   connections_.erase(entity);
-  if (dispatch_count_ > 0) {
-    auto iter = dispatchers_.find(entity);
-    if (iter != dispatchers_.end()) {
-      iter->second.DisconnectAll(this);
-    }
+  if (route_table_->IsDispatching()) {
     queued_destruction_.insert(entity);
-  } else {
-    dispatchers_.erase(entity);
   }
+  route_table_->RemoveAll(entity);
+}
+
+Dispatcher::ScopedConnection DispatcherSystem::Connect(
+    Entity entity, TypeId type, Dispatcher::EventHandler handler) {
+  return ConnectImpl(entity, type, nullptr, std::move(handler));
+}
+
+Dispatcher::Connection DispatcherSystem::Connect(
+    Entity entity, TypeId type, const void* owner,
+    Dispatcher::EventHandler handler) {
+  return ConnectImpl(entity, type, owner, std::move(handler));
+}
+
+Dispatcher::Connection DispatcherSystem::ConnectImpl(
+    Entity entity, TypeId type, const void* owner,
+    Dispatcher::EventHandler handler) {
+  if (entity == kNullEntity) {
+    return Dispatcher::Connection();
+  }
+  // If the entity is queued to be destroyed and a new connection is made, it
+  // should start receiving events again.
+  queued_destruction_.erase(entity);
+  const Dispatcher::ConnectionId id =
+      route_table_->Add(entity, type, owner, std::move(handler));
+  return Dispatcher::Connection(route_table_, type, id);
 }
 
 void DispatcherSystem::ConnectEvent(Entity entity, const EventDef* input,
@@ -146,53 +479,56 @@ void DispatcherSystem::SendImmediatelyImpl(Entity entity,
 }
 
 void DispatcherSystem::SendImmediatelyImpl(const EntityEvent& entity_event) {
-  ++dispatch_count_;
+  route_table_->BeginDispatch();
   // When an entity has been queued for destruction, treat it as already
   // destroyed.
-  if (queued_destruction_.count(entity_event.entity) == 0) {
-    auto iter = dispatchers_.find(entity_event.entity);
-    if (iter != dispatchers_.end()) {
-      iter->second.Send(entity_event.event);
-    }
+  if (!IsQueuedForDestruction(entity_event.entity)) {
+    route_table_->Send(entity_event.entity, entity_event.event);
     universal_dispatcher_.Send(entity_event);
   }
-  --dispatch_count_;
+  route_table_->EndDispatch();
   DestroyQueued();
 }
 
-Dispatcher* DispatcherSystem::GetDispatcher(Entity entity) {
-  if (entity == kNullEntity) {
-    return nullptr;
+void DispatcherSystem::SendToManyImpl(Span<Entity> entities,
+                                      const EventWrapper& event) {
+  if (entities.empty()) {
+    return;
   }
-  return &dispatchers_[entity];
+  Dispatcher* dispatcher = registry_->Get<Dispatcher>();
+  dispatcher->Send(EntityListEvent(entities, event));
 }
 
-void DispatcherSystem::Disconnect(Entity entity, TypeId type,
-                                  const void* owner) {
-  auto iter = dispatchers_.find(entity);
-  if (iter == dispatchers_.end()) {
-    return;
+void DispatcherSystem::SendImmediatelyToManyImpl(
+    const EntityListEvent& entity_list_event) {
+  const EventWrapper& event = entity_list_event.event;
+  route_table_->BeginDispatch();
+  for (Entity entity : entity_list_event.entities) {
+    if (IsQueuedForDestruction(entity)) {
+      continue;
+    }
+    route_table_->Send(entity, event);
+    // Avoid copying the event into an EntityEvent if no one is listening.
+    if (universal_dispatcher_.GetHandlerCount() > 0) {
+      universal_dispatcher_.Send(EntityEvent(entity, event));
+    }
   }
+  route_table_->EndDispatch();
+  DestroyQueued();
+}
 
-  Dispatcher& dispatcher = iter->second;
-  dispatcher.Disconnect(type, owner);
-  if (dispatcher.GetHandlerCount() == 0) {
-    Destroy(entity);
-  }
+bool DispatcherSystem::IsQueuedForDestruction(Entity entity) const {
+  return !queued_destruction_.empty() && queued_destruction_.count(entity) > 0;
 }
 
 void DispatcherSystem::Disconnect(Entity entity, TypeId type,
-                                  Dispatcher::ConnectionId id) {
-  auto iter = dispatchers_.find(entity);
-  if (iter == dispatchers_.end()) {
-    return;
-  }
+                                  const void* owner) {
+  route_table_->Remove(entity, type, 0, owner);
+}
 
-  Dispatcher& dispatcher = iter->second;
-  dispatcher.Disconnect(type, id);
-  if (dispatcher.GetHandlerCount() == 0) {
-    Destroy(entity);
-  }
+void DispatcherSystem::Disconnect(Entity entity, TypeId type,
+                                  Dispatcher::ConnectionId id) {
+  route_table_->Remove(entity, type, id, nullptr);
 }
 
 Dispatcher::ScopedConnection DispatcherSystem::ConnectToAll(
@@ -201,22 +537,19 @@ Dispatcher::ScopedConnection DispatcherSystem::ConnectToAll(
 }
 
 size_t DispatcherSystem::GetHandlerCount(Entity entity, TypeId type) const {
-  auto iter = dispatchers_.find(entity);
-  if (iter != dispatchers_.end()) {
-    return iter->second.GetHandlerCount(type);
-  }
-  return 0;
+  return route_table_->GetHandlerCount(entity, type);
 }
 
 size_t DispatcherSystem::GetUniversalHandlerCount() const {
   return universal_dispatcher_.GetHandlerCount();
 }
 
+size_t DispatcherSystem::GetNumEntitiesWithHandlers() const {
+  return route_table_->GetNumEntities();
+}
+
 void DispatcherSystem::DestroyQueued() {
-  if (dispatch_count_ == 0) {
-    for (Entity entity : queued_destruction_) {
-      dispatchers_.erase(entity);
-    }
+  if (!route_table_->IsDispatching()) {
     queued_destruction_.clear();
   }
 }
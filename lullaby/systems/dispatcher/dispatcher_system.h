@@ -17,14 +17,24 @@ limitations under the License.
 #ifndef LULLABY_SYSTEMS_DISPATCHER_DISPATCHER_SYSTEM_H_
 #define LULLABY_SYSTEMS_DISPATCHER_DISPATCHER_SYSTEM_H_
 
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
 #include "lullaby/generated/dispatcher_def_generated.h"
 #include "lullaby/modules/dispatcher/dispatcher.h"
 #include "lullaby/modules/ecs/system.h"
+#include "lullaby/util/span.h"
 #include "lullaby/util/thread_safe_queue.h"
 
 namespace lull {
 
-/// Provides a Dispatcher as a Component for each Entity.
+/// Provides Dispatcher-like event handling for each Entity.
+///
+/// Rather than creating a Dispatcher per Entity, all event handlers are stored
+/// in a single routing table keyed by (Entity, TypeId).  Entities that have no
+/// handlers connected have no storage associated with them.
 class DispatcherSystem : public System {
  public:
   /// Pair of Entity and EventWrapper. Publicly this is only used to listen for
@@ -37,6 +47,16 @@ class DispatcherSystem : public System {
     EventWrapper event;
   };
 
+  /// List of Entities and an EventWrapper to send to each of them.  This is
+  /// only used internally to queue events sent via SendToMany.
+  struct EntityListEvent {
+    EntityListEvent() {}
+    EntityListEvent(Span<Entity> entities, const EventWrapper& event)
+        : entities(entities.begin(), entities.end()), event(event) {}
+    std::vector<Entity> entities;
+    EventWrapper event;
+  };
+
   /// A function to allow event dispatches to be tracked and logged.
   using EntityEventHandler = std::function<void(const EntityEvent&)>;
 
@@ -53,10 +73,10 @@ class DispatcherSystem : public System {
   /// Associates EventResponses with the Entity based on the |def|.
   void Create(Entity entity, HashValue type, const Def* def) override;
 
-  /// Destroys the Dispatcher and any Connections associated with the Entity.
-  /// If currently dispatching, this will queue the dispatcher to be destroyed
-  /// and prevent other events from being sent to it.  Otherwise it will destroy
-  /// the dispatcher immediately.
+  /// Disconnects all event handlers and Connections associated with the
+  /// Entity.  If currently dispatching, the handlers will be removed once the
+  /// dispatch completes and no other events will be sent to the Entity in the
+  /// meantime.  Otherwise the handlers are removed immediately.
   void Destroy(Entity entity) override;
 
   /// Sends |event| to all functions registered with the dispatcher associated
@@ -82,23 +102,43 @@ class DispatcherSystem : public System {
     SendImmediatelyImpl(entity, event_wrapper);
   }
 
-  /// Connects an event handler to the Dispatcher associated with |entity|.
-  /// This function is a simple wrapper around the various Dispatcher::Connect
-  /// functions.  For more information, please refer to the Dispatcher API.
-  template <typename... Args>
-  auto Connect(Entity entity, Args&&... args) -> decltype(
-      std::declval<Dispatcher>().Connect(std::forward<Args>(args)...)) {
-    Dispatcher* dispatcher = GetDispatcher(entity);
-    if (dispatcher) {
-      // If a dispatcher is queued to be destroyed and a new connection is
-      // made, that dispatcher needs to be kept alive.
-      queued_destruction_.erase(entity);
-      return dispatcher->Connect(std::forward<Args>(args)...);
-    } else {
-      return Dispatcher::Connection();
-    }
+  /// Sends |event| to the functions registered with each of the |entities|.
+  /// This is equivalent to calling Send for each Entity, but only a single
+  /// event is queued with the global Dispatcher.
+  template <typename Event>
+  void SendToMany(Span<Entity> entities, const Event& event) {
+    SendToManyImpl(entities, EventWrapper(event));
+  }
+
+  void SendToMany(Span<Entity> entities, const EventWrapper& event_wrapper) {
+    SendToManyImpl(entities, event_wrapper);
+  }
+
+  /// Connects an event handler to |entity|.  These functions mirror the
+  /// various Dispatcher::Connect functions.  For more information, please refer
+  /// to the Dispatcher API.
+  template <typename Fn>
+  Dispatcher::ScopedConnection Connect(Entity entity, Fn&& handler) {
+    return Connect(entity, static_cast<const void*>(nullptr),
+                   std::forward<Fn>(handler));
   }
 
+  template <typename Fn>
+  Dispatcher::Connection Connect(Entity entity, const void* owner,
+                                 Fn&& handler) {
+    TypeId type = 0;
+    Dispatcher::EventHandler fn =
+        Dispatcher::WrapHandler(std::forward<Fn>(handler), &type);
+    return ConnectImpl(entity, type, owner, std::move(fn));
+  }
+
+  Dispatcher::ScopedConnection Connect(Entity entity, TypeId type,
+                                       Dispatcher::EventHandler handler);
+
+  Dispatcher::Connection Connect(Entity entity, TypeId type,
+                                 const void* owner,
+                                 Dispatcher::EventHandler handler);
+
   /// Connects the |handler| to an event as described by the |input|.
   void ConnectEvent(Entity entity, const EventDef* input,
                     const Dispatcher::EventHandler& handler);
@@ -113,22 +153,19 @@ class DispatcherSystem : public System {
   //// Adds a function that will be called for every event that is dispatched.
   Dispatcher::ScopedConnection ConnectToAll(const EntityEventHandler& handler);
 
-  /// Disconnects an event handler identified by the |owner| from the Dispatcher
-  /// associated with |entity|.  See Dispatcher::Disconnect for more
-  /// information.
+  /// Disconnects an event handler identified by the |owner| from |entity|.
+  /// See Dispatcher::Disconnect for more information.
   template <typename Event>
   void Disconnect(Entity entity, const void* owner) {
     Disconnect(entity, GetTypeId<Event>(), owner);
   }
 
-  /// Disconnects an event handler identified by the |owner| from the Dispatcher
-  /// associated with |entity|.  See Dispatcher::Disconnect for more
-  /// information.
+  /// Disconnects an event handler identified by the |owner| from |entity|.
+  /// See Dispatcher::Disconnect for more information.
   void Disconnect(Entity entity, TypeId type, const void* owner);
 
-  /// Disconnects an event handler identified by the |id| from the Dispatcher
-  /// associated with |entity|.  See Dispatcher::Disconnect for more
-  /// information.
+  /// Disconnects an event handler identified by the |id| from |entity|.  See
+  /// Dispatcher::Disconnect for more information.
   void Disconnect(Entity entity, TypeId type, Dispatcher::ConnectionId id);
 
   /// Returns the number of functions listening for an event of |type|.
@@ -137,31 +174,42 @@ class DispatcherSystem : public System {
   /// Returns the number of functions listening for all events.
   size_t GetUniversalHandlerCount() const;
 
+  /// Returns the number of Entities that have at least one event handler.
+  size_t GetNumEntitiesWithHandlers() const;
+
   /// DEPRECATED
   void Dispatch() {}
   static void EnableQueuedDispatch() {}
 
  private:
-  using EntityDispatcherMap = std::unordered_map<Entity, Dispatcher>;
+  /// Table of event handlers keyed by (Entity, TypeId).  See the .cc file.
+  class RouteTable;
+
   using EntityConnections =
       std::unordered_map<Entity, std::vector<Dispatcher::ScopedConnection>>;
 
+  Dispatcher::Connection ConnectImpl(Entity entity, TypeId type,
+                                     const void* owner,
+                                     Dispatcher::EventHandler handler);
+
   void SendImpl(Entity entity, const EventWrapper& event);
   void SendImmediatelyImpl(Entity entity, const EventWrapper& event);
   void SendImmediatelyImpl(const EntityEvent& entity_event);
+  void SendToManyImpl(Span<Entity> entities, const EventWrapper& event);
+  void SendImmediatelyToManyImpl(const EntityListEvent& entity_list_event);
 
-  Dispatcher* GetDispatcher(Entity entity);
+  bool IsQueuedForDestruction(Entity entity) const;
 
   void DestroyQueued();
 
   EntityConnections connections_;
-  EntityDispatcherMap dispatchers_;
-  int dispatch_count_ = 0;
 
-  /// Destroying dispatchers will invalidate any iterators in the dispatchers_
-  /// map, and will cause problems if the code doing the destruction is
-  /// executing in an event sent by the dispatcher being removed.  For safety,
-  /// queue the destruction and handle it once |dispatch_count_| reaches 0.
+  /// Connections hold a weak reference to the route table so that they can be
+  /// safely disconnected after the DispatcherSystem is destroyed.
+  std::shared_ptr<RouteTable> route_table_;
+
+  /// Entities destroyed during a dispatch keep their handlers until the
+  /// dispatch completes, but no further events are sent to them.
   std::unordered_set<Entity> queued_destruction_;
 
 
@@ -174,6 +222,7 @@ class DispatcherSystem : public System {
 }  // namespace lull
 
 LULLABY_SETUP_TYPEID(lull::DispatcherSystem::EntityEvent);
+LULLABY_SETUP_TYPEID(lull::DispatcherSystem::EntityListEvent);
 LULLABY_SETUP_TYPEID(lull::DispatcherSystem);
 
 #endif  // LULLABY_SYSTEMS_DISPATCHER_DISPATCHER_SYSTEM_H_
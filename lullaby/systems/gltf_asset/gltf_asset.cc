@@ -16,9 +16,16 @@ limitations under the License.
 
 #include "lullaby/systems/gltf_asset/gltf_asset.h"
 
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <future>
+
 #include "lullaby/generated/flatbuffers/vertex_attribute_def_generated.h"
 #include "lullaby/modules/file/asset_loader.h"
+#include "lullaby/modules/render/image_decode.h"
 #include "lullaby/modules/render/tangent_generation.h"
+#include "lullaby/modules/serialize/buffer_serializer.h"
 #include "lullaby/modules/tinygltf/tinygltf_util.h"
 #include "lullaby/util/filename.h"
 #include "lullaby/util/make_unique.h"
@@ -36,8 +43,61 @@ struct LoadFileContext {
   Registry* registry = nullptr;
   bool success = false;
   std::vector<unsigned char> data;
+  // Every file that was read along with a hash of its contents, used to
+  // validate the import cache.
+  std::vector<std::pair<std::string, uint64_t>> files_read;
+};
+
+// Identifies a GltfAsset cache file and the version of its layout. The version
+// must be incremented whenever the layout or the conversion code changes.
+constexpr uint32_t kCacheMagic = 0x4c474c43;  // "CLGL"
+constexpr uint32_t kCacheVersion = 1;
+
+// The fixed-size header at the start of every cache file.
+struct CacheHeader {
+  uint32_t magic = 0;
+  uint32_t version = 0;
+  uint64_t content_hash = 0;
+  uint32_t preserve_normal_tangent = 0;
+  uint32_t reserved = 0;
+  uint64_t payload_size = 0;
+  uint64_t payload_hash = 0;
 };
 
+// Returns the 64-bit FNV-1a hash of |size| bytes at |data|. The 32-bit
+// lull::Hash is too collision-prone to identify file contents.
+uint64_t HashContents(const void* data, size_t size) {
+  const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+  uint64_t hash = 0xcbf29ce484222325ull;
+  for (size_t i = 0; i < size; ++i) {
+    hash ^= bytes[i];
+    hash *= 0x100000001b3ull;
+  }
+  return hash;
+}
+
+// Calls |fn| for every index in [0, count) and returns once all calls are
+// complete. The calls are spread across |workers| if provided, otherwise they
+// are made on the calling thread in order.
+void ForEachIndex(JobProcessor* workers, size_t count,
+                  const std::function<void(size_t)>& fn) {
+  if (workers == nullptr || count < 2) {
+    for (size_t i = 0; i < count; ++i) {
+      fn(i);
+    }
+    return;
+  }
+
+  std::vector<std::future<void>> jobs;
+  jobs.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    jobs.emplace_back(RunJob(workers, [&fn, i]() { fn(i); }));
+  }
+  for (std::future<void>& job : jobs) {
+    job.wait();
+  }
+}
+
 // TinyGLTF follows a successful call to FileExists with a call to
 // ReadWholeFile. To avoid forcing clients to provide both functions, we bundle
 // the two into this function by using the AssetLoader's LoadFileFn, then cache
@@ -51,6 +111,8 @@ bool FileExists(const std::string& filepath, void* user_data) {
     const bool res = load_file_fn(filepath.c_str(), &data);
     if (res) {
       const size_t num_bytes = data.length();
+      context->files_read.emplace_back(filepath,
+                                       HashContents(data.data(), num_bytes));
       context->data.resize(num_bytes);
       memcpy(context->data.data(), data.data(), num_bytes);
       context->success = true;
@@ -71,6 +133,77 @@ bool ReadWholeFile(std::vector<unsigned char>* out, std::string* err,
   return context->success;
 }
 
+// Stores the encoded bytes of each GLTF image instead of decoding them, which
+// TinyGLTF would otherwise do serially while parsing. |user_data| is a vector
+// of encoded images indexed by GLTF image index.
+bool DeferLoadImageData(tinygltf::Image* image, const int image_idx,
+                        std::string* err, std::string* warn, int req_width,
+                        int req_height, const unsigned char* bytes, int size,
+                        void* user_data) {
+  auto* images = reinterpret_cast<std::vector<std::vector<uint8_t>>*>(
+      user_data);
+  if (image_idx < 0 || size < 0) {
+    return false;
+  }
+  if (images->size() <= static_cast<size_t>(image_idx)) {
+    images->resize(image_idx + 1);
+  }
+  (*images)[image_idx].assign(bytes, bytes + size);
+  return true;
+}
+
+// Returns true if |image| is stored inside the GLTF (either in a buffer view or
+// as a data URI) instead of in a separate file.
+bool IsEmbeddedImage(const tinygltf::Image& image) {
+  return image.uri.empty() || image.uri.compare(0, 5, "data:") == 0;
+}
+
+// Serializes the contents of a DataContainer into a cache buffer.
+void SerializeDataContainer(SaveToBuffer* archive, DataContainer* container) {
+  size_t size = container->GetSize();
+  Serialize(archive, &size, 0);
+  if (size > 0) {
+    archive->Save(container->GetReadPtr(), size);
+  }
+}
+
+// Deserializes the contents of a DataContainer from a cache buffer.
+void SerializeDataContainer(LoadFromBuffer* archive,
+                            DataContainer* container) {
+  size_t size = 0;
+  Serialize(archive, &size, 0);
+  const uint8_t* bytes = size > 0 ? archive->Advance(size) : nullptr;
+  if (bytes) {
+    *container = DataContainer::CreateDataCopy(bytes, size);
+  } else {
+    *container = DataContainer();
+  }
+}
+
+// Serializes a VertexFormat as parallel lists of attribute usages and types.
+template <typename Archive>
+void SerializeVertexFormat(Archive* archive, VertexFormat* format) {
+  std::vector<int32_t> usages;
+  std::vector<int32_t> types;
+  for (size_t i = 0; i < format->GetNumAttributes(); ++i) {
+    usages.push_back(format->GetAttributeAt(i)->usage());
+    types.push_back(format->GetAttributeAt(i)->type());
+  }
+  Serialize(archive, &usages, 0);
+  Serialize(archive, &types, 0);
+  if (archive->IsDestructive()) {
+    *format = VertexFormat();
+    for (size_t i = 0; i < usages.size() && i < types.size(); ++i) {
+      format->AppendAttribute(
+          VertexAttribute(static_cast<VertexAttributeUsage>(usages[i]),
+                          static_cast<VertexAttributeType>(types[i])));
+    }
+  }
+}
+
+// The number of channels described by a TextureUsageInfo.
+constexpr int kNumTextureChannels = 4;
+
 mathfu::vec3 NodeTranslation(const tinygltf::Node& node) {
   if (node.translation.empty()) {
     return mathfu::kZeros3f;
@@ -265,17 +398,43 @@ Optional<VertexAttributeInfo> VerifyAndCreateVertexAttribute(
   return info;
 }
 
+// The cache only stores the material property types that PrepareMaterials
+// produces.
+bool IsCacheableProperty(const Variant& value) {
+  return value.Get<float>() != nullptr || value.Get<mathfu::vec4>() != nullptr;
+}
+
 }  // namespace
 
 GltfAsset::GltfAsset(Registry* registry, bool preserve_normal_tangent,
                      std::function<void()> finalize_callback)
+    : GltfAsset(registry, ImportOptions(), std::move(finalize_callback)) {
+  options_.preserve_normal_tangent = preserve_normal_tangent;
+  preserve_normal_tangent_ = preserve_normal_tangent;
+}
+
+GltfAsset::GltfAsset(Registry* registry, ImportOptions options,
+                     std::function<void()> finalize_callback)
     : registry_(registry),
-      preserve_normal_tangent_(preserve_normal_tangent),
+      options_(std::move(options)),
+      preserve_normal_tangent_(options_.preserve_normal_tangent),
       finalize_callback_(std::move(finalize_callback)) {}
 
 void GltfAsset::OnLoad(const std::string& filename, std::string* data) {
   id_ = Hash(filename);
 
+  // The cache is keyed by the contents of the GLTF, so it can be checked
+  // without parsing it.
+  uint64_t content_hash = 0;
+  std::string cache_path;
+  if (options_.use_cache) {
+    content_hash = HashContents(data->data(), data->size());
+    cache_path = GetCachePath(filename);
+    if (LoadFromCache(cache_path, content_hash)) {
+      return;
+    }
+  }
+
   const std::string directory = GetDirectoryFromFilename(filename);
   const unsigned int num_bytes = static_cast<unsigned int>(data->length());
   const unsigned char* bytes =
@@ -301,6 +460,10 @@ void GltfAsset::OnLoad(const std::string& filename, std::string* data) {
       &context};
   gltf.SetFsCallbacks(fs);
 
+  // Images are decoded after parsing so that they can be decoded in parallel.
+  std::vector<std::vector<uint8_t>> encoded_images;
+  gltf.SetImageLoader(&DeferLoadImageData, &encoded_images);
+
   std::string err;
   std::string warn;
   // Don't store the tinygltf representation of the asset; just store the fully
@@ -328,14 +491,31 @@ void GltfAsset::OnLoad(const std::string& filename, std::string* data) {
     LOG(WARNING) << "GLTF parsing warnings: " << warn;
   }
 
+  // Decode all embedded images. External images are left to the
+  // TextureFactory, which loads them by filename.
+  encoded_images.resize(model.images.size());
+  std::vector<ImageData> images(model.images.size());
+  ForEachIndex(options_.workers.get(), images.size(), [&](size_t i) {
+    const std::vector<uint8_t>& encoded = encoded_images[i];
+    if (IsEmbeddedImage(model.images[i]) && !encoded.empty()) {
+      images[i] =
+          DecodeImage(encoded.data(), encoded.size(), kDecodeImage_None);
+    }
+  });
+  encoded_images.clear();
+
   // Prepare data one type at a time. Order doesn't matter since all references
   // between data types are by index.
   PrepareNodes(model);
   PrepareMeshes(model);
   PrepareSkins(model);
   PrepareAnimations(model);
-  PrepareTextures(model, directory);
+  PrepareTextures(model, filename, std::move(images));
   PrepareMaterials(model);
+
+  if (options_.use_cache) {
+    SaveToCache(cache_path, content_hash, context.files_read);
+  }
 }
 
 void GltfAsset::PrepareNodes(const tinygltf::Model& model) {
@@ -359,9 +539,53 @@ void GltfAsset::PrepareNodes(const tinygltf::Model& model) {
 }
 
 void GltfAsset::PrepareMeshes(const tinygltf::Model& model) {
+  JobProcessor* workers = options_.workers.get();
   mesh_infos_.resize(model.meshes.size());
-  for (size_t i = 0; i < model.meshes.size(); ++i) {
+  ForEachIndex(workers, model.meshes.size(), [&](size_t i) {
     PrepareMesh(&mesh_infos_[i], model.meshes[i], model);
+  });
+
+  // Blend shapes need the converted base mesh, so they are converted in a
+  // second pass. Each Morph Target is converted separately so that meshes with
+  // many targets are spread across all workers.
+  std::vector<std::pair<size_t, size_t>> targets;
+  for (size_t i = 0; i < mesh_infos_.size(); ++i) {
+    if (mesh_infos_[i].blend_shape_format.GetNumAttributes() == 0) {
+      continue;
+    }
+    const tinygltf::Primitive& gltf_primitive =
+        model.meshes[i].primitives.front();
+    for (size_t j = 0; j < gltf_primitive.targets.size(); ++j) {
+      targets.emplace_back(i, j);
+    }
+  }
+
+  std::vector<Optional<DataContainer>> blend_shapes(targets.size());
+  ForEachIndex(workers, targets.size(), [&](size_t i) {
+    const size_t mesh_index = targets[i].first;
+    const std::map<std::string, int>& attr_map =
+        model.meshes[mesh_index].primitives.front().targets[targets[i].second];
+    if (attr_map.empty()) {
+      LOG(WARNING) << "Skipping empty blend shape.";
+      return;
+    }
+    blend_shapes[i] =
+        PrepareBlendShape(mesh_infos_[mesh_index], attr_map, model);
+  });
+
+  // Blend shapes are appended in order so that they match the GLTF's weights.
+  for (size_t i = 0; i < targets.size(); ++i) {
+    if (blend_shapes[i]) {
+      mesh_infos_[targets[i].first].blend_shapes.emplace_back(
+          std::move(*blend_shapes[i]));
+    }
+  }
+  for (size_t i = 0; i < mesh_infos_.size(); ++i) {
+    if (mesh_infos_[i].HasBlendShapes()) {
+      const std::vector<double>& weights = model.meshes[i].weights;
+      mesh_infos_[i].blend_shape_weights.assign(weights.cbegin(),
+                                                weights.cend());
+    }
   }
 }
 
@@ -383,13 +607,10 @@ void GltfAsset::PrepareMesh(MeshInfo* mesh_info,
     mesh_info->mesh_data = PreparePrimitive(gltf_primitive, model);
     mesh_info->material_index = gltf_primitive.material;
 
-    // Create blend shapes if Morph Target data exists.
+    // Set up blend shapes if Morph Target data exists. The blend shapes
+    // themselves are converted by PrepareMeshes once all meshes are ready.
     if (!gltf_primitive.targets.empty()) {
       PrepareBlendShapes(mesh_info, gltf_primitive, model);
-      if (mesh_info->HasBlendShapes()) {
-        mesh_info->blend_shape_weights.assign(gltf_mesh.weights.cbegin(),
-                                              gltf_mesh.weights.cend());
-      }
     }
   }
 }
@@ -746,21 +967,12 @@ void GltfAsset::PrepareBlendShapes(MeshInfo* mesh_info,
       memcpy(blend_vertex + blend_offset, mesh_vertex + mesh_offset, size);
     }
   }
-
-  // Process the individual blend shapes.
-  for (const auto& attr_map : gltf_primitive.targets) {
-    if (attr_map.empty()) {
-      LOG(WARNING) << "Skipping empty blend shape.";
-      continue;
-    }
-    PrepareBlendShape(mesh_info, attr_map, model);
-  }
 }
 
-void GltfAsset::PrepareBlendShape(MeshInfo* mesh_info,
-                                  const std::map<std::string, int>& attr_map,
-                                  const tinygltf::Model& model) {
-  const size_t num_vertices = mesh_info->mesh_data.GetNumVertices();
+Optional<DataContainer> GltfAsset::PrepareBlendShape(
+    const MeshInfo& mesh_info, const std::map<std::string, int>& attr_map,
+    const tinygltf::Model& model) const {
+  const size_t num_vertices = mesh_info.mesh_data.GetNumVertices();
 
   // Fetch pointers to all the supported attributes.
   const uint8_t* positions = nullptr;
@@ -848,10 +1060,10 @@ void GltfAsset::PrepareBlendShape(MeshInfo* mesh_info,
     }
   }
 
-  if (mesh_info->blend_shape_format != vertex_format) {
+  if (mesh_info.blend_shape_format != vertex_format) {
     LOG(DFATAL) << "Mismatched blend shape vertex format: " << vertex_format
-                << " does not match " << mesh_info->blend_shape_format;
-    return;
+                << " does not match " << mesh_info.blend_shape_format;
+    return NullOpt;
   }
 
   // Allocate heap storage for the entire blend shape.
@@ -860,7 +1072,7 @@ void GltfAsset::PrepareBlendShape(MeshInfo* mesh_info,
       DataContainer::CreateHeapDataContainer(num_vertices * vertex_size);
   uint8_t* vertex = reinterpret_cast<uint8_t*>(vertices.GetData());
 
-  const uint8_t* original_vertex = mesh_info->base_blend_shape.GetReadPtr();
+  const uint8_t* original_vertex = mesh_info.base_blend_shape.GetReadPtr();
   for (size_t i = 0; i < num_vertices; ++i) {
     // When preserving normals and tangents, blend shapes can operate in
     // displacement mode instead of interpolation mode, so we only need to store
@@ -921,7 +1133,7 @@ void GltfAsset::PrepareBlendShape(MeshInfo* mesh_info,
     vertex += vertex_size;
     vertices.Advance(vertex_size);
   }
-  mesh_info->blend_shapes.emplace_back(std::move(vertices));
+  return Optional<DataContainer>(std::move(vertices));
 }
 
 void GltfAsset::PrepareSkins(const tinygltf::Model& model) {
@@ -979,6 +1191,7 @@ void GltfAsset::PrepareSkin(SkinInfo* skin_info,
 
 void GltfAsset::PrepareAnimations(const tinygltf::Model& model) {
   anim_infos_.resize(model.animations.size());
+  anim_targets_.resize(model.animations.size());
   for (size_t i = 0; i < model.animations.size(); ++i) {
     PrepareAnimation(&anim_infos_[i], model.animations[i], model);
   }
@@ -1023,11 +1236,20 @@ void GltfAsset::PrepareAnimation(AnimationInfo* anim_info,
   anim_info->context =
       MakeUnique<SkeletonChannel::AnimationContext>(node_to_anims.size());
 
+  std::vector<AnimationTarget>& targets =
+      anim_targets_[anim_info - anim_infos_.data()];
   for (auto iter : node_to_anims) {
     const auto& anim_data = iter.second;
+    AnimationTarget target;
+    target.skeleton_index = static_cast<uint32_t>(iter.first);
+    target.has_translation = anim_data.HasTranslation();
+    target.has_rotation = anim_data.HasRotation();
+    target.has_scale = anim_data.HasScale();
+    target.blend_shape_count = anim_data.weights_channel_count;
     anim_info->context->CreateTarget(
-        iter.first, anim_data.HasTranslation(), anim_data.HasRotation(),
-        anim_data.HasScale(), anim_data.weights_channel_count);
+        target.skeleton_index, target.has_translation, target.has_rotation,
+        target.has_scale, target.blend_shape_count);
+    targets.push_back(target);
     Optional<size_t> bytes_used = AddAnimationData(buffer, anim_data);
     if (!bytes_used) {
       LOG(DFATAL) << "Failed to add animation splines.";
@@ -1051,16 +1273,36 @@ void GltfAsset::PrepareAnimation(AnimationInfo* anim_info,
 }
 
 void GltfAsset::PrepareTextures(const tinygltf::Model& model,
-                                string_view directory) {
+                                string_view filename,
+                                std::vector<ImageData> images) {
   // TODO textures.
   // TODO Support glTF's sampler attributes.
-  for (const tinygltf::Texture& texture : model.textures) {
+  const std::string directory = GetDirectoryFromFilename(filename);
+  for (size_t i = 0; i < model.textures.size(); ++i) {
+    const int source = model.textures[i].source;
     TextureInfo texture_info;
 
-    const std::string uri =
-        JoinPath(directory, model.images[texture.source].uri);
-    texture_info.name = uri;
-    texture_info.file = uri;
+    if (IsEmbeddedImage(model.images[source])) {
+      // Embedded images have no file, so name them after the texture instead.
+      texture_info.name = filename.to_string() + "#" + std::to_string(i);
+      ImageData& image = images[source];
+      if (image.IsEmpty()) {
+        LOG(ERROR) << "Failed to decode embedded image " << source;
+      } else {
+        // Textures may share an image, so only the last one takes ownership.
+        const bool shared = std::any_of(
+            model.textures.cbegin() + i + 1, model.textures.cend(),
+            [source](const tinygltf::Texture& texture) {
+              return texture.source == source;
+            });
+        texture_info.data =
+            shared ? image.CreateHeapCopy() : std::move(image);
+      }
+    } else {
+      const std::string uri = JoinPath(directory, model.images[source].uri);
+      texture_info.name = uri;
+      texture_info.file = uri;
+    }
 
     texture_infos_.push_back(std::move(texture_info));
   }
@@ -1186,6 +1428,331 @@ void GltfAsset::PrepareMaterials(const tinygltf::Model& model) {
   }
 }
 
+template <typename Archive>
+void GltfAsset::SerializeInfos(Archive* archive) {
+  const bool loading = archive->IsDestructive();
+
+  size_t count = node_infos_.size();
+  Serialize(archive, &count, 0);
+  node_infos_.resize(count);
+  for (NodeInfo& node_info : node_infos_) {
+    Serialize(archive, &node_info.name, 0);
+    Serialize(archive, &node_info.transform, 0);
+    Serialize(archive, &node_info.children, 0);
+    Serialize(archive, &node_info.mesh, 0);
+    Serialize(archive, &node_info.skin, 0);
+    Serialize(archive, &node_info.blend_shape_weights, 0);
+  }
+  Serialize(archive, &root_nodes_, 0);
+
+  count = mesh_infos_.size();
+  Serialize(archive, &count, 0);
+  mesh_infos_.resize(count);
+  for (MeshInfo& mesh_info : mesh_infos_) {
+    // MeshData doesn't expose its DataContainers, so its vertices and indices
+    // are saved through read-only wrappers.
+    const MeshData& mesh_data = mesh_info.mesh_data;
+    int32_t primitive_type = mesh_data.GetPrimitiveType();
+    int32_t index_type = mesh_data.GetIndexType();
+    const size_t vertex_size = mesh_data.GetVertexFormat().GetVertexSize();
+    const size_t index_size = mesh_data.GetIndexSize();
+    DataContainer vertices;
+    DataContainer indices;
+    if (!loading && vertex_size > 0 && mesh_data.GetNumVertices() > 0) {
+      vertices = DataContainer::WrapDataAsReadOnly(
+          mesh_data.GetVertexBytes(), mesh_data.GetNumVertices() * vertex_size);
+    }
+    if (!loading && mesh_data.GetNumIndices() > 0) {
+      indices = DataContainer::WrapDataAsReadOnly(
+          mesh_data.GetIndexBytes(), mesh_data.GetNumIndices() * index_size);
+    }
+
+    VertexFormat vertex_format = mesh_data.GetVertexFormat();
+    Serialize(archive, &primitive_type, 0);
+    SerializeVertexFormat(archive, &vertex_format);
+    SerializeDataContainer(archive, &vertices);
+    Serialize(archive, &index_type, 0);
+    SerializeDataContainer(archive, &indices);
+    if (loading) {
+      if (vertex_format.GetVertexSize() == 0) {
+        mesh_info.mesh_data = MeshData();
+      } else {
+        mesh_info.mesh_data = MeshData(
+            static_cast<MeshData::PrimitiveType>(primitive_type),
+            vertex_format, std::move(vertices),
+            static_cast<MeshData::IndexType>(index_type), std::move(indices));
+      }
+    }
+
+    Serialize(archive, &mesh_info.material_index, 0);
+    SerializeVertexFormat(archive, &mesh_info.blend_shape_format);
+    SerializeDataContainer(archive, &mesh_info.base_blend_shape);
+    size_t num_blend_shapes = mesh_info.blend_shapes.size();
+    Serialize(archive, &num_blend_shapes, 0);
+    mesh_info.blend_shapes.resize(num_blend_shapes);
+    for (DataContainer& blend_shape : mesh_info.blend_shapes) {
+      SerializeDataContainer(archive, &blend_shape);
+    }
+    Serialize(archive, &mesh_info.blend_shape_weights, 0);
+  }
+
+  count = skin_infos_.size();
+  Serialize(archive, &count, 0);
+  skin_infos_.resize(count);
+  for (SkinInfo& skin_info : skin_infos_) {
+    Serialize(archive, &skin_info.name, 0);
+    Serialize(archive, &skin_info.bones, 0);
+    size_t num_matrices = skin_info.inverse_bind_matrices.size();
+    Serialize(archive, &num_matrices, 0);
+    skin_info.inverse_bind_matrices.resize(num_matrices);
+    for (mathfu::AffineTransform& matrix : skin_info.inverse_bind_matrices) {
+      for (int row = 0; row < 3; ++row) {
+        for (int col = 0; col < 4; ++col) {
+          Serialize(archive, &matrix(row, col), 0);
+        }
+      }
+    }
+  }
+
+  count = anim_infos_.size();
+  Serialize(archive, &count, 0);
+  anim_infos_.resize(count);
+  anim_targets_.resize(count);
+  for (size_t i = 0; i < count; ++i) {
+    AnimationInfo& anim_info = anim_infos_[i];
+    std::vector<AnimationTarget>& targets = anim_targets_[i];
+    Serialize(archive, &anim_info.name, 0);
+    SerializeDataContainer(archive, &anim_info.splines);
+    Serialize(archive, &anim_info.num_splines, 0);
+    bool has_context = anim_info.context != nullptr;
+    Serialize(archive, &has_context, 0);
+    Serialize(archive, &targets, 0);
+    if (loading && has_context) {
+      anim_info.context =
+          MakeUnique<SkeletonChannel::AnimationContext>(targets.size());
+      for (const AnimationTarget& target : targets) {
+        anim_info.context->CreateTarget(
+            target.skeleton_index, target.has_translation, target.has_rotation,
+            target.has_scale, target.blend_shape_count);
+      }
+    }
+  }
+
+  count = texture_infos_.size();
+  Serialize(archive, &count, 0);
+  texture_infos_.resize(count);
+  for (TextureInfo& texture_info : texture_infos_) {
+    Serialize(archive, &texture_info.name, 0);
+    Serialize(archive, &texture_info.file, 0);
+    int32_t format = texture_info.data.GetFormat();
+    mathfu::vec2i size = texture_info.data.GetSize();
+    size_t stride = texture_info.data.GetStride();
+    DataContainer bytes;
+    if (!loading && !texture_info.data.IsEmpty()) {
+      bytes = DataContainer::WrapDataAsReadOnly(
+          texture_info.data.GetBytes(), texture_info.data.GetDataSize());
+    }
+    Serialize(archive, &format, 0);
+    Serialize(archive, &size, 0);
+    Serialize(archive, &stride, 0);
+    SerializeDataContainer(archive, &bytes);
+    if (loading && bytes.GetSize() > 0) {
+      texture_info.data = ImageData(static_cast<ImageData::Format>(format),
+                                    size, std::move(bytes), stride);
+    }
+  }
+
+  count = material_infos_.size();
+  Serialize(archive, &count, 0);
+  for (size_t i = 0; i < count; ++i) {
+    std::string shading_model;
+    std::vector<int32_t> texture_usages;
+    std::vector<std::string> texture_names;
+    std::vector<HashValue> property_keys;
+    std::vector<mathfu::vec4> property_values;
+    std::vector<int32_t> property_sizes;
+    if (!loading) {
+      const MaterialInfo& material_info = material_infos_[i];
+      shading_model = material_info.GetShadingModel();
+      for (const auto& iter : material_info.GetTextureInfos()) {
+        for (int channel = 0; channel < kNumTextureChannels; ++channel) {
+          texture_usages.push_back(iter.first.GetChannelUsage(channel));
+        }
+        texture_names.push_back(iter.second);
+      }
+      // GLTF materials only have float and vec4 properties. SaveToCache()
+      // checks this before anything is written.
+      for (const auto& iter : material_info.GetProperties()) {
+        const float* scalar = iter.second.Get<float>();
+        const mathfu::vec4* vector = iter.second.Get<mathfu::vec4>();
+        property_keys.push_back(iter.first);
+        if (scalar) {
+          property_values.emplace_back(*scalar, 0.f, 0.f, 0.f);
+          property_sizes.push_back(1);
+        } else {
+          DCHECK(vector != nullptr);
+          property_values.push_back(vector ? *vector : mathfu::kZeros4f);
+          property_sizes.push_back(4);
+        }
+      }
+    }
+
+    Serialize(archive, &shading_model, 0);
+    Serialize(archive, &texture_usages, 0);
+    Serialize(archive, &texture_names, 0);
+    Serialize(archive, &property_keys, 0);
+    Serialize(archive, &property_values, 0);
+    Serialize(archive, &property_sizes, 0);
+
+    if (loading) {
+      MaterialInfo material_info(shading_model);
+      const size_t num_textures = std::min(
+          texture_names.size(), texture_usages.size() / kNumTextureChannels);
+      for (size_t j = 0; j < num_textures; ++j) {
+        MaterialTextureUsage usages[kNumTextureChannels];
+        for (int channel = 0; channel < kNumTextureChannels; ++channel) {
+          usages[channel] = static_cast<MaterialTextureUsage>(
+              texture_usages[j * kNumTextureChannels + channel]);
+        }
+        material_info.SetTexture(
+            TextureUsageInfo(Span<MaterialTextureUsage>(usages)),
+            texture_names[j]);
+      }
+      VariantMap properties;
+      for (size_t j = 0; j < property_keys.size(); ++j) {
+        if (property_sizes[j] == 1) {
+          properties[property_keys[j]] = property_values[j].x;
+        } else {
+          properties[property_keys[j]] = property_values[j];
+        }
+      }
+      material_info.SetProperties(properties);
+      material_infos_.push_back(std::move(material_info));
+    }
+  }
+}
+
+std::string GltfAsset::GetCachePath(const std::string& filename) const {
+  if (options_.cache_directory.empty()) {
+    return filename + ".cache";
+  }
+  // GLTFs with the same name in different directories share the cache
+  // directory, so the cache file is also named after a hash of the full path.
+  char path_hash[17];
+  snprintf(path_hash, sizeof(path_hash), "%016llx",
+           static_cast<unsigned long long>(  // NOLINT
+               HashContents(filename.data(), filename.size())));
+  return JoinPath(options_.cache_directory,
+                  GetBasenameFromFilename(filename) + "." + path_hash +
+                      ".cache");
+}
+
+bool GltfAsset::LoadFromCache(const std::string& path, uint64_t content_hash) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    return false;
+  }
+
+  CacheHeader header;
+  file.read(reinterpret_cast<char*>(&header), sizeof(header));
+  if (!file || header.magic != kCacheMagic ||
+      header.version != kCacheVersion ||
+      header.content_hash != content_hash ||
+      header.preserve_normal_tangent != (preserve_normal_tangent_ ? 1u : 0u)) {
+    return false;
+  }
+
+  LoadFromBuffer::Buffer payload(static_cast<size_t>(header.payload_size));
+  file.read(reinterpret_cast<char*>(payload.data()), payload.size());
+  if (!file ||
+      HashContents(payload.data(), payload.size()) != header.payload_hash) {
+    LOG(WARNING) << "Ignoring corrupt GLTF cache " << path;
+    return false;
+  }
+
+  // The cache is stale if any file referenced by the GLTF has changed. This
+  // reads every such file, so a cache hit only saves parsing and conversion,
+  // not I/O. The AssetLoader's load function offers no cheaper way to detect
+  // changes, such as modification times.
+  LoadFromBuffer archive(&payload);
+  std::vector<std::string> dependencies;
+  std::vector<uint64_t> dependency_hashes;
+  Serialize(&archive, &dependencies, 0);
+  Serialize(&archive, &dependency_hashes, 0);
+  if (dependencies.size() != dependency_hashes.size()) {
+    return false;
+  }
+  if (!dependencies.empty()) {
+    auto* asset_loader = registry_->Get<AssetLoader>();
+    if (asset_loader == nullptr) {
+      return false;
+    }
+    auto load_file_fn = asset_loader->GetLoadFunction();
+    for (size_t i = 0; i < dependencies.size(); ++i) {
+      std::string data;
+      if (!load_file_fn(dependencies[i].c_str(), &data) ||
+          HashContents(data.data(), data.size()) != dependency_hashes[i]) {
+        return false;
+      }
+    }
+  }
+
+  SerializeInfos(&archive);
+  return true;
+}
+
+void GltfAsset::SaveToCache(const std::string& path, uint64_t content_hash,
+                            const std::vector<FileHash>& files) {
+  // Rather than write a cache entry that would load differently from the GLTF,
+  // don't cache it at all.
+  for (const MaterialInfo& material_info : material_infos_) {
+    for (const auto& iter : material_info.GetProperties()) {
+      if (!IsCacheableProperty(iter.second)) {
+        LOG(WARNING) << "Not caching GLTF with unsupported material property "
+                     << iter.first << ": " << path;
+        return;
+      }
+    }
+  }
+
+  SaveToBuffer::Buffer payload;
+  SaveToBuffer archive(&payload);
+  std::vector<std::string> dependencies;
+  std::vector<uint64_t> dependency_hashes;
+  for (const FileHash& file : files) {
+    dependencies.push_back(file.first);
+    dependency_hashes.push_back(file.second);
+  }
+  Serialize(&archive, &dependencies, 0);
+  Serialize(&archive, &dependency_hashes, 0);
+  SerializeInfos(&archive);
+
+  CacheHeader header;
+  header.magic = kCacheMagic;
+  header.version = kCacheVersion;
+  header.content_hash = content_hash;
+  header.preserve_normal_tangent = preserve_normal_tangent_ ? 1u : 0u;
+  header.payload_size = payload.size();
+  header.payload_hash = HashContents(payload.data(), payload.size());
+
+  // Write to a temporary file first so that concurrent loads of the same GLTF
+  // never read a partially written cache.
+  const std::string temp_path = path + ".tmp";
+  {
+    std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(payload.data()), payload.size());
+    if (!file) {
+      LOG(WARNING) << "Failed to write GLTF cache " << path;
+      return;
+    }
+  }
+  if (std::rename(temp_path.c_str(), path.c_str()) != 0) {
+    LOG(WARNING) << "Failed to write GLTF cache " << path;
+    std::remove(temp_path.c_str());
+  }
+}
+
 void GltfAsset::OnFinalize(const std::string& filename, std::string* data) {
   if (finalize_callback_) {
     finalize_callback_();
@@ -17,8 +17,12 @@ limitations under the License.
 #ifndef LULLABY_SYSTEMS_GLTF_ASSET_GLTF_ASSET_H_
 #define LULLABY_SYSTEMS_GLTF_ASSET_GLTF_ASSET_H_
 
+#include <cstdint>
 #include <memory>
+#include <string>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "lullaby/modules/animation_channels/skeleton_channel.h"
 #include "lullaby/modules/file/asset.h"
@@ -28,7 +32,9 @@ limitations under the License.
 #include "lullaby/modules/render/texture_params.h"
 #include "lullaby/modules/render/vertex_format.h"
 #include "lullaby/modules/tinygltf/tinygltf_util.h"
+#include "lullaby/util/job_processor.h"
 #include "lullaby/util/math.h"
+#include "lullaby/util/optional.h"
 #include "lullaby/util/registry.h"
 #include "lullaby/util/span.h"
 #include "lullaby/util/string_view.h"
@@ -43,9 +49,33 @@ namespace lull {
 /// consumed by appropriate runtime Systems.
 class GltfAsset : public Asset {
  public:
+  /// Options that control how a GLTF file is converted.
+  struct ImportOptions {
+    /// If true, skips conversion of mesh normals and tangents to orientations.
+    bool preserve_normal_tangent = false;
+
+    /// Workers used to decode embedded images and convert mesh primitives and
+    /// blend shapes in parallel. If null, everything is converted on the
+    /// loading thread. These workers must not be the ones running OnLoad.
+    std::shared_ptr<JobProcessor> workers;
+
+    /// If true, the converted data is stored in a binary cache file keyed by
+    /// the contents of the GLTF and every file it references. Later loads of
+    /// the same unmodified GLTF read the cache instead of parsing the GLTF.
+    /// Checking a cache file still loads and hashes every referenced file.
+    /// The cache is read and written directly from the local filesystem.
+    bool use_cache = false;
+
+    /// The directory in which cache files are stored. If empty, each cache file
+    /// is stored next to its GLTF.
+    std::string cache_directory;
+  };
+
   explicit GltfAsset(Registry* registry,
                      bool preserve_normal_tangent,
                      std::function<void()> finalize_callback);
+  GltfAsset(Registry* registry, ImportOptions options,
+            std::function<void()> finalize_callback);
 
   /// Extracts the data from the .gltf file and stores it locally.
   void OnLoad(const std::string& filename, std::string* data) override;
@@ -151,6 +181,46 @@ class GltfAsset : public Asset {
   std::vector<TextureInfo>& GetMutableTextures() { return texture_infos_; }
 
  private:
+  /// The arguments used to create one of the targets of an AnimationInfo's
+  /// context, which are needed to recreate the context from the cache.
+  struct AnimationTarget {
+    uint32_t skeleton_index = 0;
+    bool has_translation = false;
+    bool has_rotation = false;
+    bool has_scale = false;
+    size_t blend_shape_count = 0;
+
+    template <typename Archive>
+    void Serialize(Archive archive) {
+      archive(&skeleton_index, ConstHash("skeleton_index"));
+      archive(&has_translation, ConstHash("has_translation"));
+      archive(&has_rotation, ConstHash("has_rotation"));
+      archive(&has_scale, ConstHash("has_scale"));
+      archive(&blend_shape_count, ConstHash("blend_shape_count"));
+    }
+  };
+
+  /// A file read while parsing the GLTF and a hash of its contents.
+  using FileHash = std::pair<std::string, uint64_t>;
+
+  /// Returns the path of the cache file for the GLTF |filename|.
+  std::string GetCachePath(const std::string& filename) const;
+
+  /// Replaces all Infos with the data in the cache file at |path|. Returns
+  /// false if the file doesn't exist or doesn't match |content_hash|, the hash
+  /// of the GLTF's contents.
+  bool LoadFromCache(const std::string& path, uint64_t content_hash);
+
+  /// Writes all Infos to the cache file at |path|. |files| are all the files
+  /// read while parsing the GLTF, which must be unchanged for the cache to be
+  /// used.
+  void SaveToCache(const std::string& path, uint64_t content_hash,
+                   const std::vector<FileHash>& files);
+
+  /// Saves or loads all Infos using either a SaveToBuffer or LoadFromBuffer.
+  template <typename Archive>
+  void SerializeInfos(Archive* archive);
+
   /// Functions to iterate though the various GLTF properties and create Infos
   /// for them. Infos reference other Infos by index, so all Infos must be
   /// created in the order they are present in |model|.
@@ -158,7 +228,8 @@ class GltfAsset : public Asset {
   void PrepareMeshes(const tinygltf::Model& model);
   void PrepareSkins(const tinygltf::Model& model);
   void PrepareAnimations(const tinygltf::Model& model);
-  void PrepareTextures(const tinygltf::Model& model, string_view directory);
+  void PrepareTextures(const tinygltf::Model& model, string_view filename,
+                       std::vector<ImageData> images);
   void PrepareMaterials(const tinygltf::Model& model);
 
   /// Functions to convert individual GLTF structures into individual Infos.
@@ -176,21 +247,23 @@ class GltfAsset : public Asset {
   MeshData PreparePrimitive(const tinygltf::Primitive& gltf_primitive,
                             const tinygltf::Model& model);
 
-  /// Converts all Morph Targets in |gltf_primitive| into blend shapes in
-  /// |mesh_info| using the data in |model|.
+  /// Sets up the blend shape format and base blend shape of |mesh_info| for
+  /// the Morph Targets in |gltf_primitive|. The blend shapes themselves are
+  /// converted afterwards by PrepareBlendShape.
   void PrepareBlendShapes(MeshInfo* mesh_info,
                           const tinygltf::Primitive& gltf_primitive,
                           const tinygltf::Model& model);
 
   /// Converts an individual Morph Target represented by |attr_map|, a map from
-  /// attribute names to GLTF Accessors in |model|, into a blend shape that is
-  /// appended to |mesh_info.blend_shapes|.
-  void PrepareBlendShape(MeshInfo* mesh_info,
-                         const std::map<std::string, int>& attr_map,
-                         const tinygltf::Model& model);
+  /// attribute names to GLTF Accessors in |model|, into a blend shape for
+  /// |mesh_info|. Returns NullOpt if the Morph Target is invalid.
+  Optional<DataContainer> PrepareBlendShape(
+      const MeshInfo& mesh_info, const std::map<std::string, int>& attr_map,
+      const tinygltf::Model& model) const;
 
   Registry* registry_;
   HashValue id_;
+  ImportOptions options_;
   bool preserve_normal_tangent_ = false;
   std::function<void()> finalize_callback_;
 
@@ -199,6 +272,7 @@ class GltfAsset : public Asset {
   std::vector<MeshInfo> mesh_infos_;
   std::vector<SkinInfo> skin_infos_;
   std::vector<AnimationInfo> anim_infos_;
+  std::vector<std::vector<AnimationTarget>> anim_targets_;
   std::vector<TextureInfo> texture_infos_;
   std::vector<MaterialInfo> material_infos_;
 };
@@ -132,6 +132,13 @@ GltfAssetSystem::GltfAssetSystem(Registry* registry, const InitParams& params)
     : System(registry),
       gltfs_(ResourceManager<GltfAssetInstance>::kCacheFullyOnCreate),
       preserve_normal_tangent_(params.preserve_normal_tangent) {
+  import_options_.preserve_normal_tangent = params.preserve_normal_tangent;
+  if (params.num_import_threads > 0) {
+    import_options_.workers =
+        std::make_shared<JobProcessor>(params.num_import_threads);
+  }
+  import_options_.use_cache = params.use_import_cache;
+  import_options_.cache_directory = params.import_cache_directory;
   RegisterDef<GltfAssetDefT>(this);
   RegisterDependency<TransformSystem>(this);
 }
@@ -205,7 +212,7 @@ void GltfAssetSystem::LoadGltf(string_view filename) {
     auto* asset_loader = registry_->Get<AssetLoader>();
     auto callback = [this, key]() { Finalize(key); };
     auto gltf_asset = asset_loader->LoadAsync<GltfAsset>(
-        std::string(filename), registry_, preserve_normal_tangent_, callback);
+        std::string(filename), registry_, import_options_, callback);
     return std::make_shared<GltfAssetInstance>(registry_, gltf_asset);
   });
 }
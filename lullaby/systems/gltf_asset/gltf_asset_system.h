@@ -41,6 +41,18 @@ class GltfAssetSystem : public System {
   struct InitParams {
     /// If true, skips conversion of mesh normals and tangents to orientations.
     bool preserve_normal_tangent = false;
+
+    /// The number of worker threads used to convert each GLTF. If 0, each GLTF
+    /// is converted entirely on the AssetLoader's thread.
+    size_t num_import_threads = 0;
+
+    /// If true, converted GLTFs are cached in binary files. See
+    /// GltfAsset::ImportOptions.
+    bool use_import_cache = false;
+
+    /// The directory in which to store cache files, or empty to store them
+    /// next to each GLTF.
+    std::string import_cache_directory;
   };
 
   explicit GltfAssetSystem(Registry* registry);
@@ -110,6 +122,7 @@ class GltfAssetSystem : public System {
   std::unordered_map<Entity, HashValue> entity_to_asset_hash_;
   MeshPtr empty_mesh_;
   bool preserve_normal_tangent_ = false;
+  GltfAsset::ImportOptions import_options_;
 };
 
 }  // namespace lull
@@ -16,6 +16,7 @@ limitations under the License.
 
 #include "lullaby/systems/model_asset/model_asset.h"
 
+#include "lullaby/modules/flatbuffers/mathfu_fb_conversions.h"
 #include "lullaby/modules/render/image_data.h"
 #include "lullaby/modules/render/image_decode.h"
 #include "lullaby/util/flatbuffer_reader.h"
@@ -53,18 +54,13 @@ void ModelAsset::OnFinalize(const std::string& filename, std::string* data) {
   }
 }
 
-void ModelAsset::PrepareMesh() {
-  const int lod = 0;
-  if (model_def_->lods() == nullptr || model_def_->lods()->size() != 1) {
-    LOG(DFATAL) << "Only support single LODs for now.";
-    return;
-  }
-  const ModelInstanceDef* model = model_def_->lods()->Get(lod);
-
+// Builds a MeshData that wraps the vertex and index data of |model| without
+// copying it.
+static bool BuildMeshData(const ModelInstanceDef* model, MeshData* out) {
   const uint32_t num_vertices = model->num_vertices();
   if (num_vertices == 0) {
     LOG(DFATAL) << "Model must have vertices.";
-    return;
+    return false;
   }
 
   MeshData::IndexType index_type = MeshData::kIndexU16;
@@ -81,19 +77,19 @@ void ModelAsset::PrepareMesh() {
     num_indices = model->indices32()->size();
   } else {
     LOG(DFATAL) << "Model must have indices.";
-    return;
+    return false;
   }
 
   const uint32_t num_materials =
       model->materials() ? model->materials()->size() : 0;
   if (num_materials == 0) {
     LOG(DFATAL) << "Model must have materials.";
-    return;
+    return false;
   }
 
   if (model->vertex_attributes() == nullptr) {
     LOG(DFATAL) << "Model must have attributes.";
-    return;
+    return false;
   }
 
   VertexFormat vertex_format;
@@ -115,9 +111,35 @@ void ModelAsset::PrepareMesh() {
       DataContainer::WrapDataAsReadOnly(index_bytes, index_num_bytes);
   DataContainer submeshes =
       DataContainer::WrapDataAsReadOnly(range_bytes, range_num_bytes);
-  mesh_data_ =
-      MeshData(MeshData::kTriangles, vertex_format, std::move(vertices),
-               index_type, std::move(indices), std::move(submeshes));
+  *out = MeshData(MeshData::kTriangles, vertex_format, std::move(vertices),
+                  index_type, std::move(indices), std::move(submeshes));
+
+  if (model->aabbs()) {
+    std::vector<Aabb> submesh_aabbs;
+    submesh_aabbs.reserve(model->aabbs()->size());
+    for (uint32_t ii = 0; ii < model->aabbs()->size(); ++ii) {
+      auto min = (*model->aabbs())[ii]->min_position();
+      auto max = (*model->aabbs())[ii]->max_position();
+
+      submesh_aabbs.push_back(Aabb(mathfu::vec3(min->x(), min->y(), min->z()),
+                                   mathfu::vec3(max->x(), max->y(), max->z())));
+    }
+
+    out->SetSubmeshAabbs(std::move(submesh_aabbs));
+  }
+  return true;
+}
+
+void ModelAsset::PrepareMesh() {
+  if (model_def_->lods() == nullptr || model_def_->lods()->size() == 0) {
+    LOG(DFATAL) << "No geometry/model data in the lullmodel file.";
+    return;
+  }
+  const ModelInstanceDef* model = model_def_->lods()->Get(0);
+  if (!BuildMeshData(model, &mesh_data_)) {
+    return;
+  }
+  const VertexFormat& vertex_format = mesh_data_.GetVertexFormat();
   base_blend_mesh_ = mesh_data_.CreateHeapCopy();
 
   if (model->blend_shapes()) {
@@ -172,19 +194,52 @@ void ModelAsset::PrepareMesh() {
     }
   }
 
-  if (model->aabbs()) {
-    std::vector<Aabb> submesh_aabbs;
-    submesh_aabbs.reserve(model->aabbs()->size());
-    for (uint32_t ii = 0; ii < model->aabbs()->size(); ++ii) {
-      auto min = (*model->aabbs())[ii]->min_position();
-      auto max = (*model->aabbs())[ii]->max_position();
+  PrepareLods();
+}
 
-      submesh_aabbs.push_back(Aabb(mathfu::vec3(min->x(), min->y(), min->z()),
-                                   mathfu::vec3(max->x(), max->y(), max->z())));
+void ModelAsset::PrepareLods() {
+  const uint32_t num_lods = model_def_->lods()->size();
+  const size_t num_submeshes = mesh_data_.GetNumSubMeshes();
+  for (uint32_t lod = 1; lod < num_lods; ++lod) {
+    // All LODs share the materials of the base LOD.
+    const ModelInstanceDef* model = model_def_->lods()->Get(lod);
+    MeshData mesh;
+    if (!BuildMeshData(model, &mesh)) {
+      break;
+    }
+    if (mesh.GetNumSubMeshes() != num_submeshes) {
+      LOG(DFATAL) << "LOD " << lod << " does not match the submeshes of LOD 0.";
+      break;
     }
+    lod_mesh_data_.emplace_back(std::move(mesh));
+  }
 
-    mesh_data_.SetSubmeshAabbs(std::move(submesh_aabbs));
+  const size_t num_loaded = GetNumLods();
+  const auto* screen_sizes = model_def_->lod_screen_sizes();
+  if (screen_sizes && screen_sizes->size() >= num_loaded) {
+    for (size_t i = 0; i < num_loaded; ++i) {
+      lod_screen_sizes_.push_back(
+          screen_sizes->Get(static_cast<uint32_t>(i)));
+    }
+  } else if (num_loaded > 1) {
+    // Switch to the next LOD each time the model's screen size halves.
+    float screen_size = 0.5f;
+    for (size_t i = 0; i < num_loaded; ++i) {
+      lod_screen_sizes_.push_back(screen_size);
+      screen_size *= 0.5f;
+    }
+  }
+  if (!lod_screen_sizes_.empty()) {
+    lod_screen_sizes_.back() = 0.f;
   }
+
+  if (const AabbDef* bounding_box = model_def_->bounding_box()) {
+    AabbFromFbAabb(bounding_box, &bounding_box_);
+  }
+}
+
+MeshData& ModelAsset::GetMutableLodMeshData(size_t lod) {
+  return lod == 0 ? mesh_data_ : lod_mesh_data_[lod - 1];
 }
 
 static MaterialInfo BuildMaterialInfo(const MaterialDef* material_def) {
@@ -228,11 +283,6 @@ void ModelAsset::PrepareMaterials() {
     LOG(DFATAL) << "No geometry/model data in the lullmodel file.";
     return;
   }
-  if (model_def_->lods()->size() != 1) {
-    LOG(DFATAL) << "Lullaby currently does not support multiple LODs";
-    return;
-  }
-
   const int lod = 0;
   const ModelInstanceDef* model = model_def_->lods()->Get(lod);
   const uint32_t num_materials =
@@ -23,6 +23,7 @@ limitations under the License.
 #include "lullaby/modules/render/mesh_data.h"
 #include "lullaby/modules/render/material_info.h"
 #include "lullaby/modules/render/texture_params.h"
+#include "lullaby/util/math.h"
 #include "lullaby/util/registry.h"
 #include "lullaby/util/span.h"
 #include "lullaby/generated/model_def_generated.h"
@@ -50,6 +51,22 @@ class ModelAsset : public Asset {
   /// Returns the MeshData contained in the model asset.
   const MeshData& GetMeshData() const { return mesh_data_; }
 
+  /// Returns the number of levels of detail in the model asset.
+  size_t GetNumLods() const { return lod_mesh_data_.size() + 1; }
+
+  /// Returns the MeshData for the given level of detail, where 0 is the
+  /// MeshData returned by GetMutableMeshData().  All LODs share the same
+  /// materials.
+  MeshData& GetMutableLodMeshData(size_t lod);
+
+  /// Returns the minimum screen size (fraction of the viewport height covered
+  /// by the bounding box) of each LOD, in decreasing order.  Empty if the
+  /// model only has a single LOD.
+  Span<float> GetLodScreenSizes() const { return lod_screen_sizes_; }
+
+  /// Returns the bounding box of the model.
+  const Aabb& GetBoundingBox() const { return bounding_box_; }
+
   /// Returns the list of materials contained in the model asset.
   std::vector<MaterialInfo>& GetMutableMaterials() { return materials_; }
 
@@ -123,6 +140,7 @@ class ModelAsset : public Asset {
   };
 
   void PrepareMesh();
+  void PrepareLods();
   void PrepareMaterials();
   void PrepareTextures();
   void PrepareSkeleton();
@@ -131,6 +149,9 @@ class ModelAsset : public Asset {
   FlatbufferDataObject<ModelDef, std::string> model_def_;
   MeshData mesh_data_;
   MeshData collision_data_;
+  std::vector<MeshData> lod_mesh_data_;
+  std::vector<float> lod_screen_sizes_;
+  Aabb bounding_box_;
   VertexFormat blend_format_;
   DataContainer base_blend_shape_;
   MeshData base_blend_mesh_;
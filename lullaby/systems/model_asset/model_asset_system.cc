@@ -17,6 +17,7 @@ limitations under the License.
 #include "lullaby/systems/model_asset/model_asset_system.h"
 
 #include "lullaby/modules/file/asset_loader.h"
+#include "lullaby/modules/render/lod_util.h"
 #include "lullaby/systems/blend_shape/blend_shape_system.h"
 #include "lullaby/systems/collision/collision_provider.h"
 #include "lullaby/systems/collision/collision_system.h"
@@ -24,6 +25,7 @@ limitations under the License.
 #include "lullaby/systems/render/render_helpers.h"
 #include "lullaby/systems/render/render_system.h"
 #include "lullaby/systems/render/texture_factory.h"
+#include "lullaby/systems/transform/transform_system.h"
 #include "lullaby/util/filename.h"
 #include "lullaby/generated/model_asset_def_generated.h"
 
@@ -63,8 +65,10 @@ void ModelAssetSystem::ModelAssetInstance::Finalize() {
   if (mesh_factory && !create_distinct_meshes_) {
     auto* blend_shape_system = registry_->Get<BlendShapeSystem>();
     if (blend_shape_system == nullptr || !model_asset_->HasBlendShapes()) {
-      MeshData& data = model_asset_->GetMutableMeshData();
-      mesh_ = mesh_factory->CreateMesh(std::move(data));
+      for (size_t lod = 0; lod < model_asset_->GetNumLods(); ++lod) {
+        MeshData& data = model_asset_->GetMutableLodMeshData(lod);
+        meshes_.emplace_back(mesh_factory->CreateMesh(std::move(data)));
+      }
     }
   }
 
@@ -93,7 +97,9 @@ void ModelAssetSystem::ModelAssetInstance::Finalize() {
   }
 }
 
-MeshPtr ModelAssetSystem::ModelAssetInstance::GetMesh() const { return mesh_; }
+MeshPtr ModelAssetSystem::ModelAssetInstance::GetMesh(size_t lod) const {
+  return lod < meshes_.size() ? meshes_[lod] : nullptr;
+}
 
 ModelAssetSystem::ModelAssetSystem(Registry* registry)
     : System(registry),
@@ -230,75 +236,85 @@ static const ModelAssetMaterialDefT* FindMaterialDef(const ModelAssetDefT& def,
   return nullptr;
 }
 
-void ModelAssetSystem::FinalizeEntity(const EntitySetupInfo& setup) {
-  // We only support a single level of detail.
-  const int lod = 0;
-
+void ModelAssetSystem::SetMaterials(const EntitySetupInfo& setup, int lod) {
   // A cahce of textures created in this function.  More information below.
   std::vector<TexturePtr> local_texture_cache;
 
   auto asset = setup.instance->GetAsset();
-  auto* blend_shape_system = registry_->Get<BlendShapeSystem>();
   auto* render_system = registry_->Get<RenderSystem>();
   auto* texture_factory = registry_->Get<TextureFactory>();
-  auto* collision_system = registry_->Get<CollisionSystem>();
-  if (render_system && texture_factory) {
-    render_system->Create(setup.entity, setup.def.pass);
+  if (render_system == nullptr || texture_factory == nullptr) {
+    return;
+  }
 
-    const auto& materials = asset->GetMutableMaterials();
-    for (size_t i = 0; i < materials.size(); ++i) {
-      const int submesh_index = static_cast<int>(i);
-      const ModelAssetMaterialDefT* def =
-          FindMaterialDef(setup.def, lod, submesh_index);
+  const auto& materials = asset->GetMutableMaterials();
+  for (size_t i = 0; i < materials.size(); ++i) {
+    const int submesh_index = static_cast<int>(i);
+    const ModelAssetMaterialDefT* def =
+        FindMaterialDef(setup.def, lod, submesh_index);
 
-      if (def) {
-        // Create a copy of the reference material.  The def will be used to
-        // override/extend the data in this material.
-        MaterialInfo material = materials[i];
+    if (def) {
+      // Create a copy of the reference material.  The def will be used to
+      // override/extend the data in this material.
+      MaterialInfo material = materials[i];
 
-        // First, update the material shading model if it is being overridden.
-        if (!def->shading_model.empty()) {
-          material.SetShadingModel(def->shading_model);
-        }
+      // First, update the material shading model if it is being overridden.
+      if (!def->shading_model.empty()) {
+        material.SetShadingModel(def->shading_model);
+      }
 
-        // Next copy all the material properties from the def into the material.
-        VariantMap properties;
-        VariantMapFromVariantMapDefT(def->properties, &properties);
-        for (HashValue feature : def->shading_features) {
-          properties[feature] = true;
-        }
-        material.SetProperties(properties);
-
-        // The def may specify its own set of textures to use, so create them
-        // here. We need to keep the references to these textures "alive" long
-        // enough for the RenderSystem to associate them with the Entity.
-        // This mapping occurs when we call RenderSystem::SetMaterial. If we
-        // don't cache these textures, the TextureFactory will "forget" about
-        // them when the shared_ptr goes out-of-scope. Then, when the
-        // RenderSystem attempts to map the texture to the material, it will
-        // have to reload the texture using potentially incorrect settings.
-        for (const ModelAssetTextureDefT& texture_def : def->textures) {
-          TexturePtr texture =
-              texture_factory->CreateTexture(texture_def.texture);
-          if (texture) {
-            material.SetTexture(texture_def.usage, texture_def.texture.file);
-            local_texture_cache.emplace_back(std::move(texture));
-          }
+      // Next copy all the material properties from the def into the material.
+      VariantMap properties;
+      VariantMapFromVariantMapDefT(def->properties, &properties);
+      for (HashValue feature : def->shading_features) {
+        properties[feature] = true;
+      }
+      material.SetProperties(properties);
+
+      // The def may specify its own set of textures to use, so create them
+      // here. We need to keep the references to these textures "alive" long
+      // enough for the RenderSystem to associate them with the Entity.
+      // This mapping occurs when we call RenderSystem::SetMaterial. If we
+      // don't cache these textures, the TextureFactory will "forget" about
+      // them when the shared_ptr goes out-of-scope. Then, when the
+      // RenderSystem attempts to map the texture to the material, it will
+      // have to reload the texture using potentially incorrect settings.
+      for (const ModelAssetTextureDefT& texture_def : def->textures) {
+        TexturePtr texture =
+            texture_factory->CreateTexture(texture_def.texture);
+        if (texture) {
+          material.SetTexture(texture_def.usage, texture_def.texture.file);
+          local_texture_cache.emplace_back(std::move(texture));
         }
-        render_system->SetMaterial({setup.entity, DrawableIndex(submesh_index)},
-                                   material);
-        local_texture_cache.clear();
-
-        // Finally, update uniform data for any shader uniforms specified in the
-        // def.
-        ApplyUniforms(setup.entity, setup.def.pass, submesh_index, material,
-                      def);
-      } else {
-        render_system->SetMaterial({setup.entity, DrawableIndex(submesh_index)},
-                                   materials[i]);
       }
+      render_system->SetMaterial({setup.entity, DrawableIndex(submesh_index)},
+                                 material);
+      local_texture_cache.clear();
+
+      // Finally, update uniform data for any shader uniforms specified in the
+      // def.
+      ApplyUniforms(setup.entity, setup.def.pass, lod, submesh_index, material,
+                    def);
+    } else {
+      render_system->SetMaterial({setup.entity, DrawableIndex(submesh_index)},
+                                 materials[i]);
     }
   }
+}
+
+void ModelAssetSystem::FinalizeEntity(const EntitySetupInfo& setup) {
+  // Entities start at the highest level of detail until UpdateLods is called.
+  const int lod = 0;
+
+  auto asset = setup.instance->GetAsset();
+  auto* blend_shape_system = registry_->Get<BlendShapeSystem>();
+  auto* render_system = registry_->Get<RenderSystem>();
+  auto* texture_factory = registry_->Get<TextureFactory>();
+  auto* collision_system = registry_->Get<CollisionSystem>();
+  if (render_system && texture_factory) {
+    render_system->Create(setup.entity, setup.def.pass);
+    SetMaterials(setup, lod);
+  }
 
   if (blend_shape_system && !asset->GetBlendShapeNames().empty()) {
     blend_shape_system->InitBlendShape(
@@ -313,9 +329,10 @@ void ModelAssetSystem::FinalizeEntity(const EntitySetupInfo& setup) {
           asset->GetBlendShapeData(i).CreateHeapCopy());
     }
   } else if (render_system) {
-    MeshPtr mesh = setup.instance->GetMesh();
+    MeshPtr mesh = setup.instance->GetMesh(lod);
     if (mesh) {
       render_system->SetMesh({setup.entity, setup.def.pass}, mesh);
+      RegisterLods(setup);
     } else {
       const MeshData& data = asset->GetMeshData();
       render_system->SetMesh({setup.entity, setup.def.pass}, data);
@@ -396,12 +413,12 @@ static Span<uint8_t> GetUniformData(const ShaderUniformDefT& uniform,
   return {reinterpret_cast<const uint8_t*>(data), size * sizeof(float)};
 }
 
-void ModelAssetSystem::ApplyUniforms(Entity entity, HashValue pass,
+void ModelAssetSystem::ApplyUniforms(Entity entity, HashValue pass, int lod,
                                      int submesh_index,
                                      const MaterialInfo& material,
                                      const ModelAssetMaterialDefT* def) {
-  if (def->lod != -1 && def->lod != 0) {
-    // We only support LOD 0 for now.  An LOD of -1 applies to all LODs.
+  if (def->lod != -1 && def->lod != lod) {
+    // An LOD of -1 applies to all LODs.
     return;
   } else if (def->submesh != -1 && def->submesh != submesh_index) {
     return;
@@ -417,4 +434,93 @@ void ModelAssetSystem::ApplyUniforms(Entity entity, HashValue pass,
   }
 }
 
+void ModelAssetSystem::RegisterLods(const EntitySetupInfo& setup) {
+  if (setup.instance->GetNumMeshes() < 2) {
+    UnregisterLods(setup.entity);
+    return;
+  }
+
+  LodState state;
+  state.setup = setup;
+  for (const ModelAssetMaterialDefT& material : setup.def.materials) {
+    state.has_lod_materials |= material.lod != -1;
+  }
+
+  auto iter = entity_to_lod_index_.find(setup.entity);
+  if (iter != entity_to_lod_index_.end()) {
+    lod_states_[iter->second] = std::move(state);
+  } else {
+    entity_to_lod_index_.emplace(setup.entity, lod_states_.size());
+    lod_states_.emplace_back(std::move(state));
+  }
+}
+
+void ModelAssetSystem::Destroy(Entity entity) { UnregisterLods(entity); }
+
+void ModelAssetSystem::UnregisterLods(Entity entity) {
+  auto iter = entity_to_lod_index_.find(entity);
+  if (iter == entity_to_lod_index_.end()) {
+    return;
+  }
+
+  // Swap the last state into the removed slot to keep the states packed.
+  const size_t index = iter->second;
+  entity_to_lod_index_.erase(iter);
+  if (index + 1 != lod_states_.size()) {
+    lod_states_[index] = std::move(lod_states_.back());
+    entity_to_lod_index_[lod_states_[index].setup.entity] = index;
+  }
+  lod_states_.pop_back();
+}
+
+void ModelAssetSystem::UpdateLods(Span<RenderView> views) {
+  auto* render_system = registry_->Get<RenderSystem>();
+  auto* transform_system = registry_->Get<TransformSystem>();
+  if (render_system == nullptr || transform_system == nullptr ||
+      views.empty()) {
+    return;
+  }
+
+  for (LodState& state : lod_states_) {
+    const EntitySetupInfo& setup = state.setup;
+    const mathfu::mat4* world_from_entity =
+        transform_system->GetWorldFromEntityMatrix(setup.entity);
+    if (world_from_entity == nullptr) {
+      continue;
+    }
+
+    const ModelAsset& asset = *setup.instance->GetAsset();
+    const Sphere sphere =
+        GetWorldBoundingSphere(asset.GetBoundingBox(), *world_from_entity);
+    float screen_size = GetScreenSize(sphere, views);
+    auto bias = lod_biases_.find(setup.def.pass);
+    if (bias != lod_biases_.end()) {
+      screen_size *= bias->second;
+    }
+
+    const int lod = SelectLod(asset.GetLodScreenSizes(), screen_size,
+                              state.lod, lod_hysteresis_);
+    if (lod == state.lod) {
+      continue;
+    }
+
+    state.lod = lod;
+    render_system->SetMesh({setup.entity, setup.def.pass},
+                           setup.instance->GetMesh(lod));
+    if (state.has_lod_materials) {
+      SetMaterials(setup, lod);
+    }
+  }
+}
+
+void ModelAssetSystem::SetLodBias(HashValue pass, float bias) {
+  lod_biases_[pass] = bias;
+}
+
+int ModelAssetSystem::GetLod(Entity entity) const {
+  auto iter = entity_to_lod_index_.find(entity);
+  return iter != entity_to_lod_index_.end() ? lod_states_[iter->second].lod
+                                            : 0;
+}
+
 }  // namespace lull
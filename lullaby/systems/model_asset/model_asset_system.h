@@ -20,10 +20,12 @@ limitations under the License.
 #include "lullaby/generated/model_asset_def_generated.h"
 #include "lullaby/modules/ecs/component.h"
 #include "lullaby/modules/ecs/system.h"
+#include "lullaby/modules/render/render_view.h"
 #include "lullaby/systems/model_asset/model_asset.h"
 #include "lullaby/systems/render/render_system.h"
 #include "lullaby/systems/rig/rig_system.h"
 #include "lullaby/util/resource_manager.h"
+#include "lullaby/util/span.h"
 #include "lullaby/util/string_view.h"
 
 namespace lull {
@@ -59,6 +61,26 @@ class ModelAssetSystem : public System {
   /// Releases the loaded model file from the internal cache.
   void ReleaseModel(HashValue key);
 
+  /// Stops selecting LODs for the Entity.
+  void Destroy(Entity entity) override;
+
+  /// Selects the level of detail of every Entity whose model has multiple LODs
+  /// based on the screen size of the model's bounds in the given |views|.  This
+  /// should be called once per frame before rendering.
+  void UpdateLods(Span<RenderView> views);
+
+  /// Scales the screen size of all Entities in the |pass| before selecting
+  /// their LODs.  Values below 1 select coarser LODs sooner, trading quality
+  /// for performance.  Defaults to 1.
+  void SetLodBias(HashValue pass, float bias);
+
+  /// Sets the fraction by which an Entity's screen size must cross a LOD
+  /// threshold before its LOD changes.  Defaults to 0.1.
+  void SetLodHysteresis(float hysteresis) { lod_hysteresis_ = hysteresis; }
+
+  /// Returns the level of detail currently used by the Entity.
+  int GetLod(Entity entity) const;
+
  private:
   class ModelAssetInstance {
    public:
@@ -70,12 +92,13 @@ class ModelAssetSystem : public System {
     bool IsReady() const { return ready_; }
     void SetReady(bool b) { ready_ = b; }
 
-    MeshPtr GetMesh() const;
+    MeshPtr GetMesh(size_t lod = 0) const;
+    size_t GetNumMeshes() const { return meshes_.size(); }
     std::shared_ptr<ModelAsset> GetAsset() const { return model_asset_; }
 
    private:
     Registry* registry_;
-    MeshPtr mesh_;
+    std::vector<MeshPtr> meshes_;
     std::unordered_map<HashValue, TexturePtr> textures_;
     std::shared_ptr<ModelAsset> model_asset_;
     bool create_distinct_meshes_ = false;
@@ -88,21 +111,34 @@ class ModelAssetSystem : public System {
     ModelAssetDefT def;
   };
 
+  struct LodState {
+    EntitySetupInfo setup;
+    int lod = 0;
+    // True if the def has materials that only apply to some LODs.
+    bool has_lod_materials = false;
+  };
+
   void Finalize(HashValue key);
 
   void RegisterEntity(const EntitySetupInfo& setup);
   void FinalizeEntity(const EntitySetupInfo& setup);
   void SetMesh(const EntitySetupInfo& setup);
-  void SetMaterials(const EntitySetupInfo& setup);
+  void SetMaterials(const EntitySetupInfo& setup, int lod);
   void SetRig(const EntitySetupInfo& setup);
-  void ApplyUniforms(Entity entity, HashValue pass, int submesh_index,
+  void ApplyUniforms(Entity entity, HashValue pass, int lod, int submesh_index,
                      const MaterialInfo& material,
                      const ModelAssetMaterialDefT* def);
+  void RegisterLods(const EntitySetupInfo& setup);
+  void UnregisterLods(Entity entity);
 
   ResourceManager<ModelAssetInstance> models_;
   std::unordered_map<HashValue, std::vector<EntitySetupInfo>> pending_entities_;
   MeshPtr empty_mesh_;
   std::unordered_map<Entity, HashValue> entity_to_asset_hash_;
+  std::vector<LodState> lod_states_;
+  std::unordered_map<Entity, size_t> entity_to_lod_index_;
+  std::unordered_map<HashValue, float> lod_biases_;
+  float lod_hysteresis_ = 0.1f;
 };
 
 }  // namespace lull
@@ -28,6 +28,8 @@ limitations under the License.
 namespace lull {
 
 constexpr HashValue kNinePatchDefHash = ConstHash("NinePatchDef");
+// Maximum number of distinct nine patch vertex sets kept for reuse.
+constexpr size_t kMaxCachedVertices = 8;
 
 NinePatchSystem::NinePatchSystem(Registry* registry)
     : System(registry), nine_patches_(16) {
@@ -81,7 +83,10 @@ void NinePatchSystem::PostCreateInit(Entity entity, DefType type,
   UpdateNinePatchMesh(entity, kNullEntity, &iter->second);
 }
 
-void NinePatchSystem::Destroy(Entity entity) { nine_patches_.erase(entity); }
+void NinePatchSystem::Destroy(Entity entity) {
+  nine_patches_.erase(entity);
+  mesh_params_.erase(entity);
+}
 
 void NinePatchSystem::SetSize(Entity entity, const mathfu::vec2& size) {
   auto iter = nine_patches_.find(entity);
@@ -123,16 +128,25 @@ Optional<mathfu::vec2> NinePatchSystem::GetOriginalSize(Entity entity) const {
 
 void NinePatchSystem::UpdateNinePatchMesh(Entity entity, Entity source,
                                           const NinePatch* nine_patch) {
-  auto* render_system = registry_->Get<RenderSystem>();
-
-  auto nine_patch_mesh_fn = [&nine_patch](lull::MeshData* mesh) {
-    GenerateNinePatchMesh(*nine_patch, mesh);
-  };
-
-  render_system->UpdateDynamicMesh(
-      entity, lull::MeshData::PrimitiveType::kTriangles,
-      lull::VertexPTT::kFormat, nine_patch->GetVertexCount(),
-      nine_patch->GetIndexCount(), nine_patch_mesh_fn);
+  // Layout animations often resize a panel to the size it already has, so
+  // avoid regenerating and uploading an identical mesh.
+  auto params = mesh_params_.find(entity);
+  if (params == mesh_params_.end() || params->second != *nine_patch) {
+    auto* render_system = registry_->Get<RenderSystem>();
+    const std::vector<VertexPTT>& vertices = GetVertices(*nine_patch);
+
+    auto nine_patch_mesh_fn = [&nine_patch, &vertices](lull::MeshData* mesh) {
+      const uint32_t base_vertex = mesh->GetNumVertices();
+      mesh->AddVertices(vertices.data(), vertices.size());
+      GenerateNinePatchIndices(*nine_patch, base_vertex, mesh);
+    };
+
+    render_system->UpdateDynamicMesh(
+        entity, lull::MeshData::PrimitiveType::kTriangles,
+        lull::VertexPTT::kFormat, nine_patch->GetVertexCount(),
+        nine_patch->GetIndexCount(), nine_patch_mesh_fn);
+    mesh_params_[entity] = *nine_patch;
+  }
 
   auto *layout_box_system = registry_->Get<LayoutBoxSystem>();
   if (layout_box_system) {
@@ -153,6 +167,28 @@ void NinePatchSystem::UpdateNinePatchMesh(Entity entity, Entity source,
   transform_system->SetAabb(entity, aabb);
 }
 
+const std::vector<VertexPTT>& NinePatchSystem::GetVertices(
+    const NinePatch& nine_patch) {
+  for (const CachedVertices& cached : vertex_cache_) {
+    if (cached.nine_patch == nine_patch) {
+      return cached.vertices;
+    }
+  }
+
+  // Replace the cached entries in round-robin order once the cache is full.
+  if (vertex_cache_.size() < kMaxCachedVertices) {
+    vertex_cache_.emplace_back();
+    next_cache_index_ = vertex_cache_.size() - 1;
+  }
+  CachedVertices& cached = vertex_cache_[next_cache_index_];
+  next_cache_index_ = (next_cache_index_ + 1) % kMaxCachedVertices;
+
+  cached.nine_patch = nine_patch;
+  cached.vertices.clear();
+  GenerateNinePatchVertices(nine_patch, &cached.vertices);
+  return cached.vertices;
+}
+
 void NinePatchSystem::OnDesiredSizeChanged(
     const DesiredSizeChangedEvent& event) {
   auto iter = nine_patches_.find(event.target);
@@ -17,6 +17,9 @@ limitations under the License.
 #ifndef LULLABY_SYSTEMS_NINE_PATCH_NINE_PATCH_SYSTEM_H_
 #define LULLABY_SYSTEMS_NINE_PATCH_NINE_PATCH_SYSTEM_H_
 
+#include <unordered_map>
+#include <vector>
+
 #include "lullaby/events/layout_events.h"
 #include "lullaby/modules/ecs/system.h"
 #include "lullaby/modules/render/nine_patch.h"
@@ -61,14 +64,31 @@ class NinePatchSystem : public System {
   Optional<mathfu::vec2> GetOriginalSize(Entity entity) const;
 
  private:
+  // Vertices generated for a set of NinePatch parameters.  Panels that share
+  // the same parameters (e.g. the rows of a list) reuse these vertices instead
+  // of generating their own.
+  struct CachedVertices {
+    NinePatch nine_patch;
+    std::vector<VertexPTT> vertices;
+  };
+
   // Recomputes the mesh for |entity| given the component data in |nine_patch|.
+  // The mesh is only regenerated if it was built from different parameters.
   void UpdateNinePatchMesh(Entity entity, Entity source,
                            const NinePatch* nine_patch);
 
+  // Returns the vertices for |nine_patch|, generating them if they are not
+  // already cached.
+  const std::vector<VertexPTT>& GetVertices(const NinePatch& nine_patch);
+
   // Recompute nine_patch based on new desired_size.
   void OnDesiredSizeChanged(const DesiredSizeChangedEvent& event);
 
   std::unordered_map<Entity, NinePatch> nine_patches_;
+  // The parameters that each entity's current mesh was generated from.
+  std::unordered_map<Entity, NinePatch> mesh_params_;
+  std::vector<CachedVertices> vertex_cache_;
+  size_t next_cache_index_ = 0;
 };
 
 }  // namespace lull
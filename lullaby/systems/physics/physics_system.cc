@@ -43,8 +43,13 @@ PhysicsSystem::PhysicsSystem(Registry* registry, const InitParams& params)
       rigid_bodies_(16),
       transform_system_(nullptr),
       transform_flag_(TransformSystem::kInvalidFlag),
+      dispatcher_system_(nullptr),
       timestep_(params.timestep),
       max_substeps_(params.max_substeps),
+      use_simulation_thread_(params.use_simulation_thread),
+      step_clock_(params.step_clock),
+      stop_simulation_thread_(false),
+      num_simulation_steps_(0),
       bt_config_(MakeUnique<btDefaultCollisionConfiguration>()),
       bt_dispatcher_(MakeUnique<btCollisionDispatcher>(bt_config_.get())),
       bt_broadphase_(MakeUnique<btDbvtBroadphase>()),
@@ -57,12 +62,21 @@ PhysicsSystem::PhysicsSystem(Registry* registry, const InitParams& params)
   RegisterDependency<DispatcherSystem>(this);
   RegisterDependency<TransformSystem>(this);
 
+  if (!step_clock_) {
+    step_clock_ = [] { return Clock::now(); };
+  }
+
   bt_world_->setGravity(BtVectorFromMathfu(params.gravity));
   bt_world_->setInternalTickCallback(
       InternalTickCallback, static_cast<void*>(this));
 }
 
 PhysicsSystem::~PhysicsSystem() {
+  if (simulation_thread_.joinable()) {
+    stop_simulation_thread_ = true;
+    simulation_thread_.join();
+  }
+
   auto* dispatcher = registry_->Get<Dispatcher>();
   if (dispatcher) {
     dispatcher->DisconnectAll(this);
@@ -77,6 +91,9 @@ PhysicsSystem::~PhysicsSystem() {
 void PhysicsSystem::Initialize() {
   transform_system_ = registry_->Get<TransformSystem>();
   transform_flag_ = transform_system_->RequestFlag();
+  transform_system_->EnableDirtyTracking(transform_flag_);
+  // Cached so that the simulation thread never touches the Registry.
+  dispatcher_system_ = registry_->Get<DispatcherSystem>();
 
   auto* dispatcher = registry_->Get<Dispatcher>();
   dispatcher->Connect(this, [this](const OnDisabledEvent& event) {
@@ -88,9 +105,18 @@ void PhysicsSystem::Initialize() {
   dispatcher->Connect(this, [this](const ParentChangedEvent& event) {
     OnParentChanged(event.target, event.new_parent);
   });
+
+  if (use_simulation_thread_) {
+    last_step_time_ = step_clock_();
+    const Clock::time_point first_step =
+        last_step_time_ + DurationFromSeconds(timestep_);
+    simulation_thread_ =
+        std::thread([this, first_step]() { SimulationThreadMain(first_step); });
+  }
 }
 
 void PhysicsSystem::Create(Entity entity, HashValue type, const Def* def) {
+  std::lock_guard<std::recursive_mutex> lock(world_mutex_);
   if (type == kRigidBodyDef) {
     rigid_bodies_.Emplace(entity);
   } else {
@@ -100,6 +126,7 @@ void PhysicsSystem::Create(Entity entity, HashValue type, const Def* def) {
 
 void PhysicsSystem::PostCreateInit(
     Entity entity, HashValue type, const Def* def) {
+  std::lock_guard<std::recursive_mutex> lock(world_mutex_);
   if (type == kRigidBodyDef) {
     const RigidBodyDef* data = ConvertDef<RigidBodyDef>(def);
     InitRigidBody(entity, data);
@@ -109,6 +136,7 @@ void PhysicsSystem::PostCreateInit(
 }
 
 void PhysicsSystem::Destroy(Entity entity) {
+  std::lock_guard<std::recursive_mutex> lock(world_mutex_);
   DisablePhysics(entity);
   rigid_bodies_.Destroy(entity);
 }
@@ -339,7 +367,6 @@ void PhysicsSystem::InternalTickCallback(
 void PhysicsSystem::PostSimulationTick() {
   // Retrieve all the manifolds from the most recent tick and collect all the
   // new contacts.
-  auto* dispatcher_system = registry_->Get<DispatcherSystem>();
   ContactMap new_contacts;
   const int num_manifolds = bt_dispatcher_->getNumManifolds();
   for (int i = 0; i < num_manifolds; ++i) {
@@ -367,22 +394,22 @@ void PhysicsSystem::PostSimulationTick() {
     PickPrimaryAndSecondaryEntities(entity1, entity2, &primary, &secondary);
     new_contacts[primary].insert(secondary);
 
-    if (dispatcher_system && !AreInContact(primary, secondary)) {
-      dispatcher_system->Send(primary, EnterPhysicsContactEvent(secondary));
-      dispatcher_system->Send(secondary, EnterPhysicsContactEvent(primary));
+    if (dispatcher_system_ && !AreInContact(primary, secondary)) {
+      SendContactEvent(primary, secondary, true);
+      SendContactEvent(secondary, primary, true);
     }
   }
 
   // Check which contacts no longer exist.
-  if (dispatcher_system) {
+  if (dispatcher_system_) {
     for (const auto& current : current_contacts_) {
       const Entity primary = current.first;
       for (const auto& secondary : current.second) {
         auto contact = new_contacts.find(primary);
         if (contact == new_contacts.end()
            || contact->second.find(secondary) == contact->second.end()) {
-          dispatcher_system->Send(primary, ExitPhysicsContactEvent(secondary));
-          dispatcher_system->Send(secondary, ExitPhysicsContactEvent(primary));
+          SendContactEvent(primary, secondary, false);
+          SendContactEvent(secondary, primary, false);
         }
       }
     }
@@ -392,10 +419,28 @@ void PhysicsSystem::PostSimulationTick() {
   std::swap(current_contacts_, new_contacts);
 }
 
+void PhysicsSystem::SendContactEvent(Entity target, Entity other, bool enter) {
+  if (use_simulation_thread_) {
+    PendingContactEvent event;
+    event.target = target;
+    event.other = other;
+    event.enter = enter;
+    std::lock_guard<std::mutex> lock(sync_mutex_);
+    pending_contact_events_.push_back(event);
+    return;
+  }
+
+  if (enter) {
+    dispatcher_system_->Send(target, EnterPhysicsContactEvent(other));
+  } else {
+    dispatcher_system_->Send(target, ExitPhysicsContactEvent(other));
+  }
+}
+
 void PhysicsSystem::UpdateSimulationTransform(
     Entity entity, const mathfu::mat4& world_from_entity_mat) {
   auto* body = rigid_bodies_.Get(entity);
-  if (body->type == RigidBodyType::RigidBodyType_Static) {
+  if (!body || body->type == RigidBodyType::RigidBodyType_Static) {
     return;
   }
 
@@ -436,22 +481,55 @@ void PhysicsSystem::MarkForUpdate(Entity entity) {
 
 void PhysicsSystem::UpdateLullabyTransform(Entity entity) {
   auto* body = rigid_bodies_.Get(entity);
+  const btTransform& world_transform = body->bt_body->getWorldTransform();
+  SetLullabyTransform(entity, MathfuVectorFromBt(world_transform.getOrigin()),
+                      MathfuQuatFromBt(world_transform.getRotation()));
+}
+
+void PhysicsSystem::SetLullabyTransform(Entity entity,
+                                        const mathfu::vec3& translation,
+                                        const mathfu::quat& rotation) {
+  auto* body = rigid_bodies_.Get(entity);
+  if (!body) {
+    return;
+  }
 
   // Un-apply any local offset transforms.
-  const btTransform& world_transform = body->bt_body->getWorldTransform();
-  Sqt sqt(MathfuVectorFromBt(world_transform.getOrigin()),
-          MathfuQuatFromBt(world_transform.getRotation()),
-          transform_system_->GetLocalScale(entity));
+  Sqt sqt(translation, rotation, transform_system_->GetLocalScale(entity));
   sqt.translation =
       CalculateTransformMatrix(sqt) * -body->center_of_mass_translation;
   transform_system_->SetSqt(entity, sqt);
+
+  // This change originated in the simulation, so there is no need to push it
+  // back into Bullet on the next frame.
+  transform_system_->ClearDirty(entity, transform_flag_);
 }
 
 void PhysicsSystem::AdvanceFrame(Clock::duration delta_time) {
   LULLABY_CPU_TRACE_CALL();
 
-  // Ensure that all Bullet transforms match their Lullaby counterparts.
-  transform_system_->ForEach(
+  if (use_simulation_thread_) {
+    // Hand all changed transforms to the simulation thread, which will apply
+    // them before its next step. Until then, the interpolated poses of these
+    // Entities are stale and will not be applied.
+    {
+      std::lock_guard<std::mutex> lock(sync_mutex_);
+      transform_system_->ForEachDirty(
+          transform_flag_,
+          [this](Entity e, const mathfu::mat4& world_from_entity_mat,
+                 const Aabb& box) {
+            pending_inputs_[e] = world_from_entity_mat;
+          });
+    }
+    ApplyInterpolatedTransforms();
+    SendPendingContactEvents();
+    return;
+  }
+
+  // Ensure that all Bullet transforms match their Lullaby counterparts. Only
+  // Entities whose transforms changed since the last frame need to be synced,
+  // which leaves unmoved (and sleeping) bodies untouched.
+  transform_system_->ForEachDirty(
       transform_flag_,
       [this](Entity e, const mathfu::mat4& world_from_entity_mat,
              const Aabb& box) {
@@ -489,7 +567,155 @@ bool PhysicsSystem::UsesKinematicMotionState(const RigidBody* body) {
       && body->collider_type == ColliderType::ColliderType_Standard;
 }
 
+void PhysicsSystem::SimulationThreadMain(Clock::time_point next_step) {
+  const Clock::duration step = DurationFromSeconds(timestep_);
+  while (!stop_simulation_thread_) {
+    // Run at a fixed rate of the step clock. The wait is re-checked against
+    // the step clock, which need not follow real time.
+    const Clock::time_point now = step_clock_();
+    if (now < next_step) {
+      std::this_thread::sleep_for(next_step - now);
+      continue;
+    }
+
+    StepSimulationThread();
+
+    // If the simulation has fallen more than |max_substeps_| steps behind,
+    // drop the missed time instead of trying to catch up.
+    if (now - next_step > step * max_substeps_) {
+      next_step = now;
+    }
+    next_step += step;
+  }
+}
+
+void PhysicsSystem::StepSimulationThread() {
+  LULLABY_CPU_TRACE_CALL();
+
+  {
+    std::lock_guard<std::mutex> lock(sync_mutex_);
+    std::swap(pending_inputs_, simulation_inputs_);
+    // Moved bodies restart their interpolation from the new transform instead
+    // of blending from their pose before the move.
+    for (const auto& input : simulation_inputs_) {
+      simulation_poses_.erase(input.first);
+    }
+  }
+
+  std::lock_guard<std::recursive_mutex> lock(world_mutex_);
+  for (const auto& input : simulation_inputs_) {
+    if (IsPhysicsEnabled(input.first)) {
+      UpdateSimulationTransform(input.first, input.second);
+    }
+  }
+
+  bt_world_->stepSimulation(timestep_, 1, timestep_);
+
+  // Sort the list of Entities to de-duplicate update requests.
+  std::sort(updated_entities_.begin(), updated_entities_.end());
+  updated_entities_.erase(
+      std::unique(updated_entities_.begin(), updated_entities_.end()),
+      updated_entities_.end());
+
+  // Publish the new poses. Bodies that didn't move during this step settle at
+  // their current pose.
+  std::lock_guard<std::mutex> sync_lock(sync_mutex_);
+  simulation_inputs_.clear();
+  for (auto& iter : simulation_poses_) {
+    SimulationPose& pose = iter.second;
+    pose.previous_translation = pose.current_translation;
+    pose.previous_rotation = pose.current_rotation;
+    pose.settled = true;
+  }
+  for (const Entity entity : updated_entities_) {
+    const auto* body = rigid_bodies_.Get(entity);
+    if (!body) {
+      continue;
+    }
+    const btTransform& world_transform = body->bt_body->getWorldTransform();
+    const mathfu::vec3 translation =
+        MathfuVectorFromBt(world_transform.getOrigin());
+    const mathfu::quat rotation =
+        MathfuQuatFromBt(world_transform.getRotation());
+
+    auto iter = simulation_poses_.find(entity);
+    if (iter == simulation_poses_.end()) {
+      iter = simulation_poses_.emplace(entity, SimulationPose()).first;
+      iter->second.previous_translation = translation;
+      iter->second.previous_rotation = rotation;
+    }
+    iter->second.current_translation = translation;
+    iter->second.current_rotation = rotation;
+    iter->second.settled = false;
+  }
+  last_step_time_ = step_clock_();
+  updated_entities_.clear();
+  ++num_simulation_steps_;
+}
+
+void PhysicsSystem::ApplyInterpolatedTransforms() {
+  float alpha = 1.f;
+  {
+    std::lock_guard<std::mutex> lock(sync_mutex_);
+    // Entities whose transform is waiting to be pushed to the simulation keep
+    // it until the simulation has applied it. Settled poses only need to be
+    // applied once.
+    for (auto iter = simulation_poses_.begin();
+         iter != simulation_poses_.end();) {
+      if (pending_inputs_.count(iter->first) == 0) {
+        interpolated_poses_.emplace_back(*iter);
+      }
+      if (iter->second.settled) {
+        iter = simulation_poses_.erase(iter);
+      } else {
+        ++iter;
+      }
+    }
+    alpha = SecondsFromDuration(step_clock_() - last_step_time_) / timestep_;
+  }
+
+  // Render one simulation step behind, interpolating between the two most
+  // recent steps based on how much time has passed since the latest one.
+  alpha = mathfu::Clamp(alpha, 0.f, 1.f);
+  for (const auto& iter : interpolated_poses_) {
+    const SimulationPose& pose = iter.second;
+    SetLullabyTransform(
+        iter.first,
+        mathfu::Lerp(pose.previous_translation, pose.current_translation,
+                     alpha),
+        mathfu::quat::Slerp(pose.previous_rotation, pose.current_rotation,
+                            alpha));
+  }
+  interpolated_poses_.clear();
+}
+
+void PhysicsSystem::SendPendingContactEvents() {
+  {
+    std::lock_guard<std::mutex> lock(sync_mutex_);
+    std::swap(pending_contact_events_, contact_events_to_send_);
+  }
+
+  for (const PendingContactEvent& event : contact_events_to_send_) {
+    if (event.enter) {
+      dispatcher_system_->Send(event.target,
+                               EnterPhysicsContactEvent(event.other));
+    } else {
+      dispatcher_system_->Send(event.target,
+                               ExitPhysicsContactEvent(event.other));
+    }
+  }
+  contact_events_to_send_.clear();
+}
+
+void PhysicsSystem::DiscardSimulationPose(Entity entity) {
+  if (use_simulation_thread_) {
+    std::lock_guard<std::mutex> lock(sync_mutex_);
+    simulation_poses_.erase(entity);
+  }
+}
+
 bool PhysicsSystem::AreInContact(Entity one, Entity two) const {
+  std::lock_guard<std::recursive_mutex> lock(world_mutex_);
   Entity primary;
   Entity secondary;
   PickPrimaryAndSecondaryEntities(one, two, &primary, &secondary);
@@ -501,6 +727,7 @@ bool PhysicsSystem::AreInContact(Entity one, Entity two) const {
 
 void PhysicsSystem::SetLinearVelocity(Entity entity,
                                       const mathfu::vec3& velocity) {
+  std::lock_guard<std::recursive_mutex> lock(world_mutex_);
   auto* body = rigid_bodies_.Get(entity);
   if (!IsPhysicsEnabled(entity)
       || body->type != RigidBodyType::RigidBodyType_Dynamic) {
@@ -513,6 +740,7 @@ void PhysicsSystem::SetLinearVelocity(Entity entity,
 
 void PhysicsSystem::SetAngularVelocity(Entity entity,
                                        const mathfu::vec3& velocity) {
+  std::lock_guard<std::recursive_mutex> lock(world_mutex_);
   auto* body = rigid_bodies_.Get(entity);
   if (!IsPhysicsEnabled(entity)
       || body->type != RigidBodyType::RigidBodyType_Dynamic) {
@@ -524,15 +752,18 @@ void PhysicsSystem::SetAngularVelocity(Entity entity,
 }
 
 void PhysicsSystem::SetGravity(const mathfu::vec3& gravity) {
+  std::lock_guard<std::recursive_mutex> lock(world_mutex_);
   bt_world_->setGravity(BtVectorFromMathfu(gravity));
 }
 
 void PhysicsSystem::DisablePhysics(Entity entity) {
+  std::lock_guard<std::recursive_mutex> lock(world_mutex_);
   if (IsPhysicsEnabled(entity)) {
     auto* body = rigid_bodies_.Get(entity);
     if (body) {
       body->enabled = false;
       transform_system_->ClearFlag(entity, transform_flag_);
+      DiscardSimulationPose(entity);
 
       if (transform_system_->IsEnabled(entity)) {
         bt_world_->removeRigidBody(body->bt_body.get());
@@ -544,6 +775,7 @@ void PhysicsSystem::DisablePhysics(Entity entity) {
 }
 
 void PhysicsSystem::EnablePhysics(Entity entity) {
+  std::lock_guard<std::recursive_mutex> lock(world_mutex_);
   if (!IsPhysicsEnabled(entity)) {
     auto* body = rigid_bodies_.Get(entity);
     if (body) {
@@ -565,13 +797,16 @@ bool PhysicsSystem::IsPhysicsEnabled(Entity entity) const {
 }
 
 void PhysicsSystem::OnEntityDisabled(Entity entity) {
+  std::lock_guard<std::recursive_mutex> lock(world_mutex_);
   auto* body = rigid_bodies_.Get(entity);
   if (body && body->enabled) {
     bt_world_->removeRigidBody(body->bt_body.get());
+    DiscardSimulationPose(entity);
   }
 }
 
 void PhysicsSystem::OnEntityEnabled(Entity entity) {
+  std::lock_guard<std::recursive_mutex> lock(world_mutex_);
   auto* body = rigid_bodies_.Get(entity);
   if (body && body->enabled) {
     bt_world_->addRigidBody(body->bt_body.get());
@@ -586,6 +821,7 @@ void PhysicsSystem::OnParentChanged(Entity entity, Entity new_parent) {
 }
 
 void PhysicsSystem::OnAabbChanged(Entity entity, AabbCollisionShape* shape) {
+  std::lock_guard<std::recursive_mutex> lock(world_mutex_);
   auto* body = rigid_bodies_.Get(entity);
   if (body) {
     SetupAabbCollisionShape(entity, shape);
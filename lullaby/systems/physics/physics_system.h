@@ -17,6 +17,10 @@ limitations under the License.
 #ifndef LULLABY_SYSTEMS_PHYSICS_PHYSICS_SYSTEM_H_
 #define LULLABY_SYSTEMS_PHYSICS_PHYSICS_SYSTEM_H_
 
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <thread>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -33,6 +37,8 @@ limitations under the License.
 
 namespace lull {
 
+class DispatcherSystem;
+
 /// The PhysicsSystem provides rigid body physics simulation to Entities using
 /// the Bullet physics engine. It will update the transforms of simulated
 /// Entities in the TransformSystem and dispatch events to Entities when they
@@ -44,6 +50,15 @@ class PhysicsSystem : public System {
     mathfu::vec3 gravity = mathfu::vec3(0.f, -9.81f, 0.f);
     float timestep = 1.f / 60.f;
     int max_substeps = 4;
+    /// If true, the simulation is stepped on a dedicated thread at a fixed
+    /// rate of 1 / |timestep| Hz instead of inside AdvanceFrame(). Transform
+    /// changes are handed to the simulation thread through a buffer, and the
+    /// transforms of simulated Entities are interpolated between the two most
+    /// recent simulation steps when AdvanceFrame() is called.
+    bool use_simulation_thread = false;
+    /// The clock that paces the simulation thread and interpolates between its
+    /// steps. Defaults to Clock::now(). Only used with |use_simulation_thread|.
+    std::function<Clock::time_point()> step_clock;
   };
 
   explicit PhysicsSystem(Registry* registry);
@@ -55,9 +70,15 @@ class PhysicsSystem : public System {
   void PostCreateInit(Entity entity, HashValue type, const Def* def) override;
   void Destroy(Entity entity) override;
 
-  /// Update the physics simulation by |delta_time| seconds.
+  /// Update the physics simulation by |delta_time| seconds. If the simulation
+  /// runs on its own thread, |delta_time| is ignored and this instead pushes
+  /// pending transform changes to the simulation and pulls interpolated
+  /// results and contact events from it.
   void AdvanceFrame(Clock::duration delta_time);
 
+  /// Returns the number of steps taken by the simulation thread so far.
+  uint64_t GetNumSimulationSteps() const { return num_simulation_steps_; }
+
   /// Check if two Entities are in contact.
   bool AreInContact(Entity one, Entity two) const;
 
@@ -119,6 +140,26 @@ class PhysicsSystem : public System {
     bool enabled = false;
   };
 
+  // The simulated pose of a dynamic body at the two most recent simulation
+  // steps, used to interpolate transforms when running on a separate thread.
+  struct SimulationPose {
+    mathfu::vec3 previous_translation = mathfu::kZeros3f;
+    mathfu::quat previous_rotation = mathfu::quat::identity;
+    mathfu::vec3 current_translation = mathfu::kZeros3f;
+    mathfu::quat current_rotation = mathfu::quat::identity;
+    // True once the body stopped moving. Settled poses are removed after they
+    // have been applied to the TransformSystem.
+    bool settled = false;
+  };
+
+  // A contact event generated on the simulation thread, to be sent on the main
+  // thread.
+  struct PendingContactEvent {
+    Entity target = kNullEntity;
+    Entity other = kNullEntity;
+    bool enter = false;
+  };
+
   void InitRigidBody(Entity entity, const RigidBodyDef* data);
   void InitCollisionShape(
       RigidBody* body, const RigidBodyDef* data);
@@ -147,6 +188,19 @@ class PhysicsSystem : public System {
   // For simulation -> Lullaby transform syncs.
   void MarkForUpdate(Entity entity);
   void UpdateLullabyTransform(Entity entity);
+  void SetLullabyTransform(Entity entity, const mathfu::vec3& translation,
+                           const mathfu::quat& rotation);
+
+  // Sends a contact event, or queues it for the main thread if called from the
+  // simulation thread.
+  void SendContactEvent(Entity target, Entity other, bool enter);
+
+  // Functions used when the simulation runs on a separate thread.
+  void SimulationThreadMain(Clock::time_point next_step);
+  void StepSimulationThread();
+  void ApplyInterpolatedTransforms();
+  void SendPendingContactEvents();
+  void DiscardSimulationPose(Entity entity);
 
   // Delegate |one| and |two| to the outputs |primary| and |secondary| for
   // accessing the ContactMap.
@@ -168,6 +222,7 @@ class PhysicsSystem : public System {
   // The list of Entities that changed during the most recent set of simulation
   // updates.
   std::vector<Entity> updated_entities_;
+  DispatcherSystem* dispatcher_system_;
 
   // Maps each Entity to the set of its current contacts (as of the last
   // simulation update). For each pair of Entities A and B, the contact will be
@@ -179,6 +234,32 @@ class PhysicsSystem : public System {
   float timestep_;
   int max_substeps_;
 
+  // Guards the Bullet world, |rigid_bodies_| and |current_contacts_| against
+  // concurrent access by the simulation thread. Main thread functions that
+  // modify the simulation may block until an in-progress step finishes.
+  mutable std::recursive_mutex world_mutex_;
+
+  // Buffers shared between the main thread and the simulation thread, guarded
+  // by |sync_mutex_|. This mutex is never held while stepping the simulation.
+  // Only the latest input for each Entity is kept.
+  std::mutex sync_mutex_;
+  std::unordered_map<Entity, mathfu::mat4> pending_inputs_;
+  std::unordered_map<Entity, SimulationPose> simulation_poses_;
+  std::vector<PendingContactEvent> pending_contact_events_;
+  Clock::time_point last_step_time_;
+
+  // Scratch buffers owned by one of the two threads, swapped with the shared
+  // buffers above to keep the time spent holding |sync_mutex_| short.
+  std::unordered_map<Entity, mathfu::mat4> simulation_inputs_;
+  std::vector<std::pair<Entity, SimulationPose>> interpolated_poses_;
+  std::vector<PendingContactEvent> contact_events_to_send_;
+
+  const bool use_simulation_thread_;
+  std::function<Clock::time_point()> step_clock_;
+  std::atomic<bool> stop_simulation_thread_;
+  std::atomic<uint64_t> num_simulation_steps_;
+  std::thread simulation_thread_;
+
   std::unique_ptr<btCollisionConfiguration> bt_config_;
   std::unique_ptr<btCollisionDispatcher> bt_dispatcher_;
   std::unique_ptr<btBroadphaseInterface> bt_broadphase_;
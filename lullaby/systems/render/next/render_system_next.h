@@ -368,8 +368,8 @@ class RenderSystemNext : public System {
   RenderData* active_render_data_ = nullptr;
 
   /// Buffer of RenderData objects so one thread can write data while another
-  /// can use data for rendering.
-  BufferedData<RenderData> render_data_buffer_;
+  /// can use data for rendering, without either thread blocking the other.
+  TripleBufferedData<RenderData> render_data_buffer_;
 
   /// Definitions of Render Passes.
   HashValue default_pass_ = ConstHash("Main");
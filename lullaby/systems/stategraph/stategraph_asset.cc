@@ -184,6 +184,7 @@ void StategraphAsset::OnFinalize(const std::string& filename,
   for (const AnimationStateDef* state_def : *stategraph_def->states()) {
     stategraph_->AddState(CreateState(state_def));
   }
+  stategraph_->BuildRoutingTable();
 }
 
 StategraphTransition StategraphAsset::CreateTransition(
@@ -61,7 +61,8 @@ TransformSystem::TransformSystem(Registry* registry)
       nodes_(16),
       world_transforms_(16),
       disabled_transforms_(16),
-      reserved_flags_(0) {
+      reserved_flags_(0),
+      dirty_tracked_flags_(0) {
   RegisterDef<TransformDefT>(this);
 
   EntityFactory* entity_factory = registry_->Get<EntityFactory>();
@@ -354,7 +355,11 @@ void TransformSystem::Destroy(Entity e) {
 void TransformSystem::SetFlag(Entity e, TransformFlags flag) {
   auto transform = GetWorldTransform(e);
   if (transform) {
+    const bool newly_set = !CheckBit(transform->flags, flag);
     transform->flags = SetBit(transform->flags, flag);
+    if (newly_set) {
+      MarkDirty(transform);
+    }
   }
 }
 
@@ -362,6 +367,7 @@ void TransformSystem::ClearFlag(Entity e, TransformFlags flag) {
   auto transform = GetWorldTransform(e);
   if (transform) {
     transform->flags = ClearBit(transform->flags, flag);
+    transform->dirty_flags = ClearBit(transform->dirty_flags, flag);
   }
 }
 
@@ -433,6 +439,17 @@ void TransformSystem::SetSqt(Entity e, const Sqt& sqt) {
   }
 }
 
+void TransformSystem::SetSqts(Span<Entity> entities, Span<Sqt> sqts) {
+  DCHECK_EQ(entities.size(), sqts.size());
+  for (size_t i = 0; i < entities.size(); ++i) {
+    auto node = nodes_.Get(entities[i]);
+    if (node) {
+      node->local_sqt = sqts[i];
+    }
+  }
+  RecalculateWorldFromEntityMatrices(entities);
+}
+
 const Sqt* TransformSystem::GetSqt(Entity e) const {
   auto node = nodes_.Get(e);
   return node ? &node->local_sqt : nullptr;
@@ -842,11 +859,49 @@ void TransformSystem::RecalculateWorldFromEntityMatrix(Entity child) {
   world_transform->world_from_entity_mat =
       node->world_from_entity_matrix_function(
           node->local_sqt, GetWorldFromEntityMatrix(node->parent));
+  MarkDirty(world_transform);
   for (const auto& grand_child : node->children) {
     RecalculateWorldFromEntityMatrix(grand_child);
   }
 }
 
+void TransformSystem::RecalculateWorldFromEntityMatrices(
+    Span<Entity> entities) {
+  if (entities.size() == 1) {
+    RecalculateWorldFromEntityMatrix(entities[0]);
+    return;
+  }
+
+  // Only recalculate the entities that do not have an ancestor in the list,
+  // since the others are recalculated along with that ancestor.
+  recalculate_sorted_.assign(entities.begin(), entities.end());
+  std::sort(recalculate_sorted_.begin(), recalculate_sorted_.end());
+  recalculate_sorted_.erase(
+      std::unique(recalculate_sorted_.begin(), recalculate_sorted_.end()),
+      recalculate_sorted_.end());
+
+  // The roots are disjoint subtrees, so their order does not matter.
+  recalculate_roots_.clear();
+  for (const Entity entity : recalculate_sorted_) {
+    bool has_ancestor_in_list = false;
+    const GraphNode* node = nodes_.Get(entity);
+    while (node && node->parent != kNullEntity) {
+      if (std::binary_search(recalculate_sorted_.begin(),
+                             recalculate_sorted_.end(), node->parent)) {
+        has_ancestor_in_list = true;
+        break;
+      }
+      node = nodes_.Get(node->parent);
+    }
+    if (!has_ancestor_in_list) {
+      recalculate_roots_.push_back(entity);
+    }
+  }
+  for (const Entity root : recalculate_roots_) {
+    RecalculateWorldFromEntityMatrix(root);
+  }
+}
+
 void TransformSystem::SetEnabled(Entity e, bool enabled) {
   auto node = nodes_.Get(e);
   if (node && node->enable_self != enabled) {
@@ -877,8 +932,11 @@ void TransformSystem::UpdateEnabled(Entity e, bool parent_enabled) {
     if (transform) {
       if (enabled && parent_enabled) {
         changed = true;
-        world_transforms_.Emplace(std::move(*transform));
+        transform = world_transforms_.Emplace(std::move(*transform));
         disabled_transforms_.Destroy(e);
+        // Any dirty list entries were dropped while the Entity was disabled.
+        transform->dirty_flags = 0;
+        MarkDirty(transform);
         SendEvent(registry_, e, OnEnabledEvent(e));
       }
     }
@@ -927,6 +985,65 @@ void TransformSystem::ReleaseFlag(TransformFlags flag) {
     return;
   }
   reserved_flags_ = ClearBit(reserved_flags_, flag);
+  if (CheckBit(dirty_tracked_flags_, flag)) {
+    dirty_tracked_flags_ = ClearBit(dirty_tracked_flags_, flag);
+    dirty_entities_[GetFlagIndex(flag)].clear();
+  }
+}
+
+void TransformSystem::EnableDirtyTracking(TransformFlags flag) {
+  if (!CheckBit(reserved_flags_, flag)) {
+    LOG(DFATAL) << "Dirty tracking requires a flag returned by RequestFlag.";
+    return;
+  }
+  if (CheckBit(dirty_tracked_flags_, flag)) {
+    return;
+  }
+  dirty_tracked_flags_ = SetBit(dirty_tracked_flags_, flag);
+
+  // Start out with every Entity that already has the flag marked as dirty so
+  // that the first ForEachDirty behaves like ForEach.
+  world_transforms_.ForEach([this](WorldTransform& transform) {
+    MarkDirty(&transform);
+  });
+}
+
+void TransformSystem::ClearDirty(Entity e, TransformFlags flag) {
+  auto transform = GetWorldTransform(e);
+  if (transform) {
+    transform->dirty_flags = ClearBit(transform->dirty_flags, flag);
+  }
+}
+
+bool TransformSystem::IsDirty(Entity e, TransformFlags flag) const {
+  auto transform = GetWorldTransform(e);
+  return transform ? CheckBit(transform->dirty_flags, flag) : false;
+}
+
+void TransformSystem::MarkDirty(WorldTransform* transform) {
+  // Only add the Entity to the lists in which it isn't already present.
+  Bits pending = ClearBit(transform->flags & dirty_tracked_flags_,
+                          transform->dirty_flags);
+  if (pending == 0) {
+    return;
+  }
+  transform->dirty_flags = SetBit(transform->dirty_flags, pending);
+  const Entity e = transform->GetEntity();
+  for (size_t i = 0; pending != 0; ++i, pending >>= 1) {
+    if (pending & 1) {
+      dirty_entities_[i].push_back(e);
+    }
+  }
+}
+
+size_t TransformSystem::GetFlagIndex(TransformFlags flag) {
+  DCHECK(flag != kInvalidFlag && (flag & (flag - 1)) == 0)
+      << "Expected a single flag returned by RequestFlag.";
+  size_t index = 0;
+  while ((flag >>= 1) != 0) {
+    ++index;
+  }
+  return index;
 }
 
 std::string TransformSystem::GetEntityTreeDebugString(bool enabled_only) const {
@@ -17,10 +17,13 @@ limitations under the License.
 #ifndef LULLABY_SYSTEMS_TRANSFORM_TRANSFORM_SYSTEM_H_
 #define LULLABY_SYSTEMS_TRANSFORM_TRANSFORM_SYSTEM_H_
 
+#include <vector>
+
 #include "lullaby/modules/ecs/component.h"
 #include "lullaby/modules/ecs/system.h"
 #include "lullaby/util/bits.h"
 #include "lullaby/util/math.h"
+#include "lullaby/util/span.h"
 #include "mathfu/constants.h"
 #include "mathfu/glsl_mappings.h"
 
@@ -125,6 +128,12 @@ class TransformSystem : public System {
   /// Set the specified entity to the given position, rotation, and scale.
   void SetSqt(Entity e, const Sqt& sqt);
 
+  /// Sets the position, rotation, and scale of each of the |entities| to the
+  /// corresponding entry in |sqts|.  This is equivalent to calling SetSqt() for
+  /// each entity, but only recalculates the world matrices of each affected
+  /// subtree once.
+  void SetSqts(Span<Entity> entities, Span<Sqt> sqts);
+
   /// Gets the SQT for the specified entity (or NULL if it does not have a
   /// transform).
   const Sqt* GetSqt(Entity e) const;
@@ -236,6 +245,23 @@ class TransformSystem : public System {
   /// kInvalidFlag.
   void ReleaseFlag(TransformFlags flag);
 
+  /// Enables change tracking for a |flag| returned by RequestFlag().  Once
+  /// enabled, Entities with the |flag| are recorded whenever their world
+  /// transform changes, when they gain the |flag|, or when they become enabled.
+  /// The recorded Entities can then be visited via ForEachDirty() instead of
+  /// iterating over every flagged Entity with ForEach().
+  void EnableDirtyTracking(TransformFlags flag);
+
+  /// Removes |e| from the set of Entities that will be visited by the next
+  /// ForEachDirty() call for |flag|.  This is useful for systems that write
+  /// transforms back into the TransformSystem and don't want to be notified of
+  /// their own changes.
+  void ClearDirty(Entity e, TransformFlags flag);
+
+  /// Checks whether |e| will be visited by the next ForEachDirty() call for
+  /// |flag|.
+  bool IsDirty(Entity e, TransformFlags flag) const;
+
   /// Calls the provided function with every Transform and provides the
   /// TransformFlags.
   template <typename Fn>
@@ -271,6 +297,26 @@ class TransformSystem : public System {
     }
   }
 
+  /// Calls the provided function with a Transform for every enabled Entity
+  /// with the provided flag that was changed since the last call, and then
+  /// clears the list of changes.  Dirty tracking must have been enabled for
+  /// the flag via EnableDirtyTracking().  The callback has the same signature
+  /// as the one used by ForEach().
+  template <typename Fn>
+  void ForEachDirty(TransformFlags flag, Fn fn) {
+    std::vector<Entity>& dirty = dirty_entities_[GetFlagIndex(flag)];
+    // Iterate by index since |fn| may cause more Entities to become dirty.
+    for (size_t i = 0; i < dirty.size(); ++i) {
+      const Entity e = dirty[i];
+      WorldTransform* transform = world_transforms_.Get(e);
+      if (transform && CheckBit(transform->dirty_flags, flag)) {
+        transform->dirty_flags = ClearBit(transform->dirty_flags, flag);
+        fn(e, transform->world_from_entity_mat, transform->box);
+      }
+    }
+    dirty.clear();
+  }
+
   /// Calls the provided function on the provided entity and all of it's
   /// descendants.
   template <typename Fn>
@@ -293,6 +339,11 @@ class TransformSystem : public System {
   // all of its children. Potentially expensive, so should be called sparingly.
   void RecalculateWorldFromEntityMatrix(Entity child);
 
+  // Recalculates the WorldFromEntityMatrix for all the given entities and their
+  // children.  Entities that are descendants of other entities in the list are
+  // only recalculated once.
+  void RecalculateWorldFromEntityMatrices(Span<Entity> entities);
+
   // Calculates the world_from_entity_matrix for the given local sqt and
   // world_from_parent_matrix.
   static mathfu::mat4 CalculateWorldFromEntityMatrix(
@@ -318,8 +369,11 @@ class TransformSystem : public System {
   struct WorldTransform : Component {
     // This struct should be kept as small as possible to reduce cache misses
     // when iterating.
-    explicit WorldTransform(Entity e) : Component(e), flags(0) {}
+    explicit WorldTransform(Entity e)
+        : Component(e), flags(0), dirty_flags(0) {}
     Bits flags;
+    // The subset of |flags| for which this Entity is in the dirty list.
+    Bits dirty_flags;
     mathfu::mat4 world_from_entity_mat;
     Aabb box;
   };
@@ -331,6 +385,12 @@ class TransformSystem : public System {
   const WorldTransform* GetWorldTransform(Entity e) const;
   WorldTransform* GetWorldTransform(Entity e);
 
+  // Adds |transform| to the dirty list of every tracked flag it has set.
+  void MarkDirty(WorldTransform* transform);
+
+  // Returns the index of the bit set in a flag returned by RequestFlag().
+  static size_t GetFlagIndex(TransformFlags flag);
+
   // Break a child's connection to its parent without sending any events.
   void RemoveParentNoEvent(Entity child);
 
@@ -342,6 +402,16 @@ class TransformSystem : public System {
   ComponentPool<WorldTransform> world_transforms_;
   ComponentPool<WorldTransform> disabled_transforms_;
   uint32_t reserved_flags_;
+  // The flags for which EnableDirtyTracking() has been called, and the list of
+  // changed Entities for each of them, indexed by GetFlagIndex().
+  uint32_t dirty_tracked_flags_;
+  std::vector<Entity> dirty_entities_[8 * sizeof(TransformFlags)];
+
+  // Scratch buffers used by RecalculateWorldFromEntityMatrices(), which keep
+  // their capacity between calls.  The requested Entities are sorted so that
+  // ancestors can be looked up with a binary search.
+  std::vector<Entity> recalculate_sorted_;
+  std::vector<Entity> recalculate_roots_;
 
   // A map of parent/child relationships requested by CreateChild, which need to
   // be handled during Create().
@@ -0,0 +1,207 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/tools/common/batch_runner.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "lullaby/tools/common/file_utils.h"
+#include "lullaby/util/filename.h"
+
+namespace lull {
+namespace tool {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::Eq;
+using ::testing::IsEmpty;
+
+std::string GetTempDir() {
+  const char* dir = std::getenv("TEST_TMPDIR");
+  return dir ? dir : "/tmp";
+}
+
+void WriteFile(const std::string& filename, const std::string& contents) {
+  ASSERT_TRUE(
+      SaveFile(contents.data(), contents.size(), filename.c_str(), false));
+}
+
+std::string ReadFile(const std::string& filename) {
+  std::string contents;
+  LoadFile(filename.c_str(), false, &contents);
+  return contents;
+}
+
+TEST(BatchRunner, SplitArgs) {
+  EXPECT_THAT(SplitArgs(""), IsEmpty());
+  EXPECT_THAT(SplitArgs("  \t "), IsEmpty());
+  EXPECT_THAT(SplitArgs("--input a.fbx --output b"),
+              ElementsAre("--input", "a.fbx", "--output", "b"));
+  EXPECT_THAT(SplitArgs("  a \t b  "), ElementsAre("a", "b"));
+  EXPECT_THAT(SplitArgs("--input \"my model.fbx\" x"),
+              ElementsAre("--input", "my model.fbx", "x"));
+  EXPECT_THAT(SplitArgs("a\"b c\"d"), ElementsAre("ab cd"));
+  EXPECT_THAT(SplitArgs("a \"\" b"), ElementsAre("a", "", "b"));
+}
+
+TEST(BatchRunner, IsBatchMode) {
+  const char* batch[] = {"tool", "--jobs", "2", "--batch", "jobs.txt"};
+  const char* single[] = {"tool", "--input", "a.fbx"};
+  EXPECT_TRUE(IsBatchMode(5, batch));
+  EXPECT_FALSE(IsBatchMode(3, single));
+}
+
+// A tool that copies its input to its output, appending the contents of an
+// optional dependency that is only discovered when the job runs.
+class BatchRunnerCacheTest : public ::testing::Test {
+ protected:
+  BatchRunnerCacheTest() {
+    // Use a new directory for each test so that no cache entries are shared.
+    const auto now = std::chrono::steady_clock::now().time_since_epoch();
+    dir_ = JoinPath(GetTempDir(),
+                    "batch_runner_test_" + std::to_string(now.count()));
+    CreateFolder(dir_.c_str());
+    input_ = JoinPath(dir_, "input.txt");
+    dependency_ = JoinPath(dir_, "dependency.txt");
+    output_ = JoinPath(dir_, "out/output.txt");
+    manifest_ = JoinPath(dir_, "jobs.txt");
+    cache_ = JoinPath(dir_, "cache");
+
+    tool_.version = "1";
+    tool_.add_args = [](ArgParser* args) {
+      args->AddArg("input").SetNumArgs(1).SetRequired();
+      args->AddArg("output").SetNumArgs(1).SetRequired();
+      args->AddArg("dependency").SetNumArgs(1);
+    };
+    tool_.get_inputs = [](const ArgParser& args,
+                          std::vector<std::string>* inputs) {
+      inputs->emplace_back(args.GetString("input"));
+    };
+    tool_.run = [this](const ArgParser& args, BatchJobFiles* files) {
+      ++num_runs_;
+      std::string contents = ReadFile(std::string(args.GetString("input")));
+      if (args.IsSet("dependency")) {
+        const std::string dependency(args.GetString("dependency"));
+        contents += ReadFile(dependency);
+        files->dependencies.push_back(dependency);
+      }
+      const std::string output(args.GetString("output"));
+      CreateFolder(GetDirectoryFromFilename(output).c_str());
+      if (!SaveFile(contents.data(), contents.size(), output.c_str(),
+                    false)) {
+        return 1;
+      }
+      files->outputs.push_back(output);
+      return 0;
+    };
+
+    WriteFile(input_, "input");
+    WriteFile(dependency_, "+dependency");
+    WriteFile(manifest_, "# Copies the input.\n\n--input " + input_ +
+                             " --output " + output_ + " --dependency " +
+                             dependency_ + "\n");
+  }
+
+  ~BatchRunnerCacheTest() override {
+    std::remove(output_.c_str());
+    std::remove(input_.c_str());
+    std::remove(dependency_.c_str());
+    std::remove(manifest_.c_str());
+  }
+
+  int Run(const std::string& cache) {
+    const char* argv[] = {"tool",     "--batch", manifest_.c_str(),
+                          "--jobs",   "1",       "--cache",
+                          cache.c_str()};
+    return RunBatch(tool_, cache.empty() ? 5 : 7, argv);
+  }
+
+  BatchTool tool_;
+  std::atomic<int> num_runs_{0};
+  std::string dir_;
+  std::string input_;
+  std::string dependency_;
+  std::string output_;
+  std::string manifest_;
+  std::string cache_;
+};
+
+TEST_F(BatchRunnerCacheTest, RunsWithoutCache) {
+  EXPECT_THAT(Run(""), Eq(0));
+  EXPECT_THAT(Run(""), Eq(0));
+  EXPECT_THAT(num_runs_.load(), Eq(2));
+  EXPECT_THAT(ReadFile(output_), Eq("input+dependency"));
+}
+
+TEST_F(BatchRunnerCacheTest, CacheHit) {
+  EXPECT_THAT(Run(cache_), Eq(0));
+  EXPECT_THAT(num_runs_.load(), Eq(1));
+
+  // The output is restored from the cache without running the job.
+  std::remove(output_.c_str());
+  EXPECT_THAT(Run(cache_), Eq(0));
+  EXPECT_THAT(num_runs_.load(), Eq(1));
+  EXPECT_THAT(ReadFile(output_), Eq("input+dependency"));
+}
+
+TEST_F(BatchRunnerCacheTest, CacheMissOnChangedInput) {
+  EXPECT_THAT(Run(cache_), Eq(0));
+
+  WriteFile(input_, "changed");
+  EXPECT_THAT(Run(cache_), Eq(0));
+  EXPECT_THAT(num_runs_.load(), Eq(2));
+  EXPECT_THAT(ReadFile(output_), Eq("changed+dependency"));
+
+  // Both versions of the input are now cached.
+  WriteFile(input_, "input");
+  EXPECT_THAT(Run(cache_), Eq(0));
+  EXPECT_THAT(num_runs_.load(), Eq(2));
+  EXPECT_THAT(ReadFile(output_), Eq("input+dependency"));
+}
+
+TEST_F(BatchRunnerCacheTest, CacheInvalidatedByDependency) {
+  EXPECT_THAT(Run(cache_), Eq(0));
+
+  WriteFile(dependency_, "+changed");
+  EXPECT_THAT(Run(cache_), Eq(0));
+  EXPECT_THAT(num_runs_.load(), Eq(2));
+  EXPECT_THAT(ReadFile(output_), Eq("input+changed"));
+}
+
+TEST_F(BatchRunnerCacheTest, CacheInvalidatedByVersion) {
+  EXPECT_THAT(Run(cache_), Eq(0));
+
+  tool_.version = "2";
+  EXPECT_THAT(Run(cache_), Eq(0));
+  EXPECT_THAT(num_runs_.load(), Eq(2));
+}
+
+TEST_F(BatchRunnerCacheTest, FailedJob) {
+  WriteFile(manifest_, "--output " + output_ + "\n");
+  EXPECT_THAT(Run(""), Eq(-1));
+  EXPECT_THAT(num_runs_.load(), Eq(0));
+}
+
+}  // namespace
+}  // namespace tool
+}  // namespace lull
@@ -232,4 +232,132 @@ TEST(BufferedDataTest, ThreadSanitizerThreeBuffers) {
   read_thread.join();
 }
 
+TEST(TripleBufferedDataTest, SynchronousReadWrite) {
+  TripleBufferedData<int> buffered_data;
+
+  // Nothing has been written yet.
+  int* read_data = buffered_data.LockReadBuffer();
+  EXPECT_TRUE(buffered_data.IsReadBufferStale());
+  EXPECT_THAT(buffered_data.GetReadSequence(), Eq(0u));
+  buffered_data.UnlockReadBuffer();
+
+  int* write_data = buffered_data.LockWriteBuffer();
+  *write_data = 1;
+  buffered_data.UnlockWriteBuffer();
+  EXPECT_THAT(buffered_data.GetWriteSequence(), Eq(1u));
+
+  read_data = buffered_data.LockReadBuffer();
+  EXPECT_THAT(*read_data, Eq(1));
+  EXPECT_FALSE(buffered_data.IsReadBufferStale());
+  EXPECT_THAT(buffered_data.GetReadSequence(), Eq(1u));
+  buffered_data.UnlockReadBuffer();
+
+  // Reading again without a new write returns the same, stale, data.
+  read_data = buffered_data.LockReadBuffer();
+  EXPECT_THAT(*read_data, Eq(1));
+  EXPECT_TRUE(buffered_data.IsReadBufferStale());
+  EXPECT_THAT(buffered_data.GetReadSequence(), Eq(1u));
+  buffered_data.UnlockReadBuffer();
+
+  // Writing twice between reads skips the first write.
+  write_data = buffered_data.LockWriteBuffer();
+  *write_data = 2;
+  buffered_data.UnlockWriteBuffer();
+  write_data = buffered_data.LockWriteBuffer();
+  *write_data = 3;
+  buffered_data.UnlockWriteBuffer();
+
+  read_data = buffered_data.LockReadBuffer();
+  EXPECT_THAT(*read_data, Eq(3));
+  EXPECT_FALSE(buffered_data.IsReadBufferStale());
+  EXPECT_THAT(buffered_data.GetReadSequence(), Eq(3u));
+  buffered_data.UnlockReadBuffer();
+}
+
+TEST(TripleBufferedDataTest, AsynchronousReadWrite) {
+  TripleBufferedData<int> buffered_data;
+
+  int* write_data = buffered_data.LockWriteBuffer();
+  *write_data = 1;
+  buffered_data.UnlockWriteBuffer();
+
+  // The buffer being written is never visible to the reader.
+  write_data = buffered_data.LockWriteBuffer();
+  *write_data = 2;
+  int* read_data = buffered_data.LockReadBuffer();
+  EXPECT_THAT(*read_data, Eq(1));
+  EXPECT_THAT(read_data, Not(Eq(write_data)));
+
+  // Publishing while the reader holds its buffer does not affect it.
+  buffered_data.UnlockWriteBuffer();
+  write_data = buffered_data.LockWriteBuffer();
+  EXPECT_THAT(read_data, Not(Eq(write_data)));
+  EXPECT_THAT(*read_data, Eq(1));
+  buffered_data.UnlockReadBuffer();
+
+  read_data = buffered_data.LockReadBuffer();
+  EXPECT_THAT(*read_data, Eq(2));
+  EXPECT_THAT(buffered_data.GetReadSequence(), Eq(2u));
+  EXPECT_THAT(read_data, Not(Eq(write_data)));
+  buffered_data.UnlockReadBuffer();
+  buffered_data.UnlockWriteBuffer();
+}
+
+TEST(TripleBufferedDataTest, DoubleLock) {
+  TripleBufferedData<int> buffered_data;
+
+  buffered_data.LockWriteBuffer();
+  PORT_EXPECT_DEBUG_DEATH(buffered_data.LockWriteBuffer(), "");
+  buffered_data.UnlockWriteBuffer();
+
+  PORT_EXPECT_DEBUG_DEATH(buffered_data.UnlockReadBuffer(), "");
+}
+
+struct StressFrame {
+  uint64_t sequence = 0;
+  int values[64] = {};
+};
+
+void StressWriteThreadFunc(TripleBufferedData<StressFrame>* buffered_data,
+                           int num_frames) {
+  for (int i = 1; i <= num_frames; ++i) {
+    StressFrame* frame = buffered_data->LockWriteBuffer();
+    frame->sequence = static_cast<uint64_t>(i);
+    for (int& value : frame->values) {
+      value = i;
+    }
+    buffered_data->UnlockWriteBuffer();
+  }
+}
+
+TEST(TripleBufferedDataTest, ThreadSanitizerStress) {
+  const int kNumFrames = 100000;
+  TripleBufferedData<StressFrame> buffered_data;
+
+  std::thread write_thread(StressWriteThreadFunc, &buffered_data, kNumFrames);
+
+  uint64_t last_sequence = 0;
+  while (last_sequence < static_cast<uint64_t>(kNumFrames)) {
+    const StressFrame* frame = buffered_data.LockReadBuffer();
+    const uint64_t sequence = buffered_data.GetReadSequence();
+
+    // A frame is never torn, and carries the sequence it was published with.
+    EXPECT_THAT(frame->sequence, Eq(sequence));
+    for (const int value : frame->values) {
+      ASSERT_THAT(static_cast<uint64_t>(value), Eq(sequence));
+    }
+
+    // Frames only move forward, and a stale read repeats the previous frame.
+    if (buffered_data.IsReadBufferStale()) {
+      EXPECT_THAT(sequence, Eq(last_sequence));
+    } else {
+      EXPECT_GT(sequence, last_sequence);
+    }
+    last_sequence = sequence;
+    buffered_data.UnlockReadBuffer();
+  }
+
+  write_thread.join();
+}
+
 }  // namespace lull
@@ -16,6 +16,8 @@ limitations under the License.
 
 #include "lullaby/systems/datastore/datastore_system.h"
 
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "lullaby/generated/datastore_def_generated.h"
@@ -26,6 +28,7 @@ namespace lull {
 namespace {
 
 using ::testing::Eq;
+using ::testing::Gt;
 using ::testing::IsNull;
 using ::testing::NotNull;
 
@@ -180,6 +183,117 @@ TEST(DatastoreSystem, SetNullEntity) {
   EXPECT_THAT(float_value, IsNull());
 }
 
+TEST(DatastoreSystem, ManyEntities) {
+  Registry r;
+  DatastoreSystem d(&r);
+
+  static const int kNumEntities = 1000;
+  for (int i = 1; i <= kNumEntities; ++i) {
+    d.Set(Entity(i), kTestKey1, i);
+  }
+
+  // Destroy every other entity to shuffle entries around in the index.
+  for (int i = 1; i <= kNumEntities; i += 2) {
+    d.Destroy(Entity(i));
+  }
+  for (int i = 1; i <= kNumEntities; ++i) {
+    const int* value = d.Get<int>(Entity(i), kTestKey1);
+    if (i % 2 == 1) {
+      EXPECT_THAT(value, IsNull());
+    } else {
+      ASSERT_THAT(value, NotNull());
+      EXPECT_THAT(*value, Eq(i));
+    }
+  }
+
+  // Recreate the destroyed entities, reusing their slots.
+  for (int i = 1; i <= kNumEntities; i += 2) {
+    d.Set(Entity(i), kTestKey2, -i);
+  }
+  for (int i = 1; i <= kNumEntities; ++i) {
+    if (i % 2 == 1) {
+      EXPECT_THAT(d.Get<int>(Entity(i), kTestKey1), IsNull());
+      EXPECT_THAT(*d.Get<int>(Entity(i), kTestKey2), Eq(-i));
+    } else {
+      EXPECT_THAT(*d.Get<int>(Entity(i), kTestKey1), Eq(i));
+      EXPECT_THAT(d.Get<int>(Entity(i), kTestKey2), IsNull());
+    }
+  }
+  EXPECT_THAT(d.GetMemoryUsage().num_entities, Eq(kNumEntities));
+}
+
+TEST(DatastoreSystem, BulkSetGet) {
+  Registry r;
+  DatastoreSystem d(&r);
+
+  const std::vector<Entity> entities = {kTestEntity1, kTestEntity2};
+  const std::vector<Variant> values = {123, 456.f};
+  d.Set(entities, kTestKey1, values);
+
+  std::vector<const int*> ints;
+  d.Get<int>(entities, kTestKey1, &ints);
+  ASSERT_THAT(ints.size(), Eq(2));
+  ASSERT_THAT(ints[0], NotNull());
+  EXPECT_THAT(*ints[0], Eq(123));
+  EXPECT_THAT(ints[1], IsNull());
+
+  std::vector<const Variant*> variants;
+  d.GetVariants(entities, kTestKey2, &variants);
+  ASSERT_THAT(variants.size(), Eq(2));
+  EXPECT_THAT(variants[0]->Empty(), Eq(true));
+  EXPECT_THAT(variants[1]->Empty(), Eq(true));
+
+  d.GetVariants(entities, kTestKey1, &variants);
+  EXPECT_THAT(*variants[1]->Get<float>(), Eq(456.f));
+}
+
+TEST(DatastoreSystem, ReferencesSurviveOtherEntities) {
+  Registry r;
+  DatastoreSystem d(&r);
+
+  d.Set(kTestEntity1, kTestKey1, 123);
+  const Variant& variant = d.GetVariant(kTestEntity1, kTestKey1);
+  const int* value = d.Get<int>(kTestEntity1, kTestKey1);
+
+  // Adding datastores to many other entities grows the slab.
+  for (int i = 1; i <= 1000; ++i) {
+    d.Set(Entity(i), kTestKey1, i);
+  }
+  EXPECT_THAT(&d.GetVariant(kTestEntity1, kTestKey1), Eq(&variant));
+  EXPECT_THAT(d.Get<int>(kTestEntity1, kTestKey1), Eq(value));
+  EXPECT_THAT(*value, Eq(123));
+}
+
+TEST(DatastoreSystem, MemoryUsage) {
+  Registry r;
+  DatastoreSystem d(&r);
+
+  EXPECT_THAT(d.GetMemoryUsage().num_entities, Eq(0));
+  EXPECT_THAT(d.GetMemoryUsage().num_values, Eq(0));
+
+  d.Set(kTestEntity1, kTestKey1, 123);
+  d.Set(kTestEntity1, kTestKey2, 456);
+  d.Set(kTestEntity2, kTestKey1, 789);
+  DatastoreSystem::MemoryUsage usage = d.GetMemoryUsage();
+  EXPECT_THAT(usage.num_entities, Eq(2));
+  EXPECT_THAT(usage.num_values, Eq(3));
+  EXPECT_THAT(usage.num_spilled_stores, Eq(0));
+  EXPECT_THAT(usage.num_bytes, Gt(0));
+
+  for (HashValue key = 1; key <= 10; ++key) {
+    d.Set(kTestEntity2, key, 0);
+  }
+  usage = d.GetMemoryUsage();
+  EXPECT_THAT(usage.num_values, Eq(13));
+  EXPECT_THAT(usage.num_spilled_stores, Eq(1));
+
+  d.Destroy(kTestEntity2);
+  usage = d.GetMemoryUsage();
+  EXPECT_THAT(usage.num_entities, Eq(1));
+  EXPECT_THAT(usage.num_values, Eq(2));
+  EXPECT_THAT(usage.num_spilled_stores, Eq(0));
+}
+
 TEST(DatastoreSystem, CreateFromNullDatastoreDef) {
   Registry r;
   DatastoreSystem d(&r);
@@ -209,6 +209,71 @@ TEST_F(DeformSystemTest, DeformerMissingDeformed) {
   ExpectUndeformedTransform(deformer, kOrigin);
 }
 
+TEST_F(DeformSystemTest, ReuseDeformedMesh) {
+  Blueprint blueprint;
+  {
+    TransformDefT transform;
+    blueprint.Write(&transform);
+
+    DeformerDefT deformer;
+    deformer.horizontal_radius = kDeformRadius;
+    blueprint.Write(&deformer);
+  }
+  const Entity deformer = entity_factory_->Create(&blueprint);
+  ASSERT_THAT(deformation_fns_, Contains(Key(deformer)));
+
+  const mathfu::vec3 expected[] = {
+      mathfu::vec3(-0.479426f, 2.0f, 2.87758f),
+      mathfu::vec3(-3.63719f, 5.0f, 0.335413f),
+      mathfu::vec3(2.45548f, 8.0f, -4.5552f),
+  };
+  auto deform = [&](VertexP* verts, size_t count) {
+    DataContainer vertex_data(
+        DataContainer::DataPtr(reinterpret_cast<uint8_t*>(verts),
+                               [](const void*) {}),
+        count * sizeof(VertexP), count * sizeof(VertexP), DataContainer::kAll);
+    MeshData mesh(MeshData::kTriangles, VertexP::kFormat,
+                  std::move(vertex_data));
+    deformation_fns_[deformer](&mesh);
+  };
+
+  // Deforming the same positions twice gives the same result.
+  for (int i = 0; i < 2; ++i) {
+    VertexP verts[] = {
+        VertexP(1.0f, 2.0f, 3.0f),
+        VertexP(4.0f, 5.0f, 6.0f),
+        VertexP(7.0f, 8.0f, 9.0f),
+    };
+    deform(verts, 3);
+    EXPECT_THAT(GetPosition(verts[0]), NearMathfu(expected[0], kEpsilon));
+    EXPECT_THAT(GetPosition(verts[1]), NearMathfu(expected[1], kEpsilon));
+    EXPECT_THAT(GetPosition(verts[2]), NearMathfu(expected[2], kEpsilon));
+    EXPECT_THAT(deform_system_->UndeformedBoundingBox(deformer)->max,
+                NearMathfu(mathfu::vec3(7.0f, 8.0f, 9.0f), kEpsilon));
+  }
+
+  // Changing a single position must not reuse the previous result.
+  VertexP changed[] = {
+      VertexP(1.0f, 2.0f, 3.0f),
+      VertexP(4.0f, 5.0f, 6.0f),
+      VertexP(1.0f, 2.0f, 3.0f),
+  };
+  deform(changed, 3);
+  EXPECT_THAT(GetPosition(changed[1]), NearMathfu(expected[1], kEpsilon));
+  EXPECT_THAT(GetPosition(changed[2]), NearMathfu(expected[0], kEpsilon));
+  EXPECT_THAT(deform_system_->UndeformedBoundingBox(deformer)->max,
+              NearMathfu(mathfu::vec3(4.0f, 5.0f, 6.0f), kEpsilon));
+
+  // Neither must changing the number of positions.
+  VertexP fewer[] = {
+      VertexP(1.0f, 2.0f, 3.0f),
+      VertexP(4.0f, 5.0f, 6.0f),
+  };
+  deform(fewer, 2);
+  EXPECT_THAT(GetPosition(fewer[0]), NearMathfu(expected[0], kEpsilon));
+  EXPECT_THAT(GetPosition(fewer[1]), NearMathfu(expected[1], kEpsilon));
+}
+
 TEST_F(DeformSystemTest, DeformedMissingDeformer) {
   const mathfu::vec3 offset(1.0f, 0.0f, 0.0f);
   Blueprint blueprint;
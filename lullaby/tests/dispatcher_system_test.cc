@@ -315,6 +315,89 @@ TEST_F(DispatcherSystemTest, MultipleEntitiesQueued) {
   EXPECT_THAT(order, ElementsAre(entity1, entity2, entity2, entity1));
 }
 
+TEST_F(DispatcherSystemTest, SendToMany) {
+  CreateImmediateDispatcherSystem();
+
+  const Entity entity1 = Hash("test");
+  const Entity entity2 = Hash("test2");
+  const Entity entity3 = Hash("test3");
+
+  std::vector<Entity> order;
+  int count_all = 0;
+  auto c1 = dispatcher_system_->ConnectToAll(
+      [&](const DispatcherSystem::EntityEvent& event) { ++count_all; });
+  dispatcher_system_->Connect(entity1, this, [&](const EventClass& e) {
+    order.emplace_back(entity1);
+  });
+  dispatcher_system_->Connect(entity2, this, [&](const EventClass& e) {
+    order.emplace_back(entity2);
+  });
+
+  const std::vector<Entity> entities = {entity2, entity3, entity1};
+  dispatcher_system_->SendToMany(entities, EventClass(123));
+  EXPECT_THAT(order, ElementsAre(entity2, entity1));
+  EXPECT_THAT(count_all, Eq(3));
+}
+
+TEST_F(DispatcherSystemTest, SendToManyQueued) {
+  CreateDispatcherSystem();
+
+  const Entity entity1 = Hash("test");
+  const Entity entity2 = Hash("test2");
+
+  std::vector<int> values;
+  dispatcher_system_->Connect(entity1, this, [&](const EventClass& e) {
+    values.emplace_back(e.value);
+  });
+  dispatcher_system_->Connect(entity2, this, [&](const EventClass& e) {
+    values.emplace_back(-e.value);
+  });
+
+  const std::vector<Entity> entities = {entity1, entity2};
+  dispatcher_system_->Send(entity2, EventClass(1));
+  dispatcher_system_->SendToMany(entities, EventClass(2));
+  dispatcher_system_->Send(entity1, EventClass(3));
+  EXPECT_THAT(values, ElementsAre());
+
+  dispatcher_->Dispatch();
+  EXPECT_THAT(values, ElementsAre(-1, 2, -2, 3));
+}
+
+TEST_F(DispatcherSystemTest, EntitiesWithoutHandlers) {
+  CreateImmediateDispatcherSystem();
+
+  const Entity entity1 = Hash("test");
+  const Entity entity2 = Hash("test2");
+  EXPECT_THAT(dispatcher_system_->GetNumEntitiesWithHandlers(), Eq(size_t{0}));
+
+  dispatcher_system_->Send(entity1, EventClass(123));
+  EXPECT_THAT(dispatcher_system_->GetNumEntitiesWithHandlers(), Eq(size_t{0}));
+
+  auto c1 = dispatcher_system_->Connect(entity1, [](const EventClass& e) {});
+  dispatcher_system_->Connect(entity2, this, [](const EventClass& e) {});
+  EXPECT_THAT(dispatcher_system_->GetNumEntitiesWithHandlers(), Eq(size_t{2}));
+
+  c1.Disconnect();
+  EXPECT_THAT(dispatcher_system_->GetNumEntitiesWithHandlers(), Eq(size_t{1}));
+
+  dispatcher_system_->Destroy(entity2);
+  EXPECT_THAT(dispatcher_system_->GetNumEntitiesWithHandlers(), Eq(size_t{0}));
+}
+
+TEST_F(DispatcherSystemTest, ConnectionOutlivesSystem) {
+  Dispatcher::ScopedConnection connection;
+  {
+    Registry registry;
+    registry.Create<Dispatcher>();
+    auto* dispatcher_system = registry.Create<DispatcherSystem>(&registry);
+    dispatcher_system->Initialize();
+    connection = dispatcher_system->Connect(Hash("test"),
+                                            [](const EventClass& e) {});
+  }
+  // Should be safe to disconnect after the DispatcherSystem is destroyed.
+  connection.Disconnect();
+}
+
 TEST_F(DispatcherSystemTest, QueuedInterleaving) {
   CreateDispatcherSystem();
 
@@ -0,0 +1,152 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include "gtest/gtest.h"
+#include "lullaby/modules/dispatcher/event_wrapper.h"
+#include "lullaby/modules/dispatcher/queued_dispatcher.h"
+#include "lullaby/util/hash.h"
+
+// Counts all global heap allocations made by this test binary.
+static std::atomic<int> g_num_allocations(0);
+
+void* operator new(size_t size) {
+  ++g_num_allocations;
+  void* ptr = std::malloc(size == 0 ? 1 : size);
+  if (ptr == nullptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void* operator new[](size_t size) { return operator new(size); }
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+
+void operator delete[](void* ptr, size_t) noexcept { std::free(ptr); }
+
+namespace lull {
+namespace {
+
+struct AllocationTestEvent {
+  AllocationTestEvent() {}
+  explicit AllocationTestEvent(int value) : value(value) {}
+
+  template <typename Archive>
+  void Serialize(Archive archive) {
+    archive(&value, ConstHash("value"));
+  }
+
+  int value = 0;
+};
+
+}  // namespace
+}  // namespace lull
+
+LULLABY_SETUP_TYPEID(lull::AllocationTestEvent);
+
+namespace lull {
+namespace {
+
+const HashValue kRuntimeEvent = ConstHash("AllocationTestRuntimeEvent");
+const HashValue kValueHash = ConstHash("value");
+
+TEST(EventWrapperAllocation, CopyIsShared) {
+  EventWrapper event(kRuntimeEvent);
+  event.SetValue(kValueHash, 123);
+  const SmallVariantMap* values = event.GetValues();
+
+  const int num_allocations = g_num_allocations;
+  EventWrapper copy1(event);
+  EventWrapper copy2 = copy1;
+  EXPECT_EQ(g_num_allocations, num_allocations);
+  EXPECT_EQ(copy2.GetValues(), values);
+
+  // Modifying a shared event does not modify the other copies.
+  copy2.SetValues(SmallVariantMap());
+  copy2.SetValue(kValueHash, 456);
+  EXPECT_NE(copy2.GetValues(), values);
+  EXPECT_EQ(*event.GetValue<int>(kValueHash), 123);
+  EXPECT_EQ(*copy1.GetValue<int>(kValueHash), 123);
+  EXPECT_EQ(*copy2.GetValue<int>(kValueHash), 456);
+}
+
+TEST(EventWrapperAllocation, ConcreteCopyIsShared) {
+  AllocationTestEvent concrete(123);
+  EventWrapper event(concrete);
+
+  // The first copy owns a copy of the concrete event, further copies share it.
+  EventWrapper owned(event);
+  const AllocationTestEvent* ptr = owned.Get<AllocationTestEvent>();
+  EXPECT_NE(ptr, &concrete);
+
+  const int num_allocations = g_num_allocations;
+  EventWrapper copy(owned);
+  EXPECT_EQ(g_num_allocations, num_allocations);
+  EXPECT_EQ(copy.Get<AllocationTestEvent>(), ptr);
+  EXPECT_EQ(copy.Get<AllocationTestEvent>()->value, 123);
+}
+
+TEST(EventWrapperAllocation, SteadyStateQueuedDispatch) {
+  QueuedDispatcher dispatcher;
+
+  int concrete_sum = 0;
+  int runtime_sum = 0;
+  auto c1 = dispatcher.Connect([&](const AllocationTestEvent& event) {
+    concrete_sum += event.value;
+  });
+  auto c2 = dispatcher.Connect(kRuntimeEvent, [&](const EventWrapper& event) {
+    runtime_sum += event.GetValueWithDefault(kValueHash, 0);
+  });
+
+  const int kNumEventsPerFrame = 16;
+  auto run_frame = [&]() {
+    for (int i = 0; i < kNumEventsPerFrame; ++i) {
+      dispatcher.Send(AllocationTestEvent(1));
+
+      EventWrapper event(kRuntimeEvent);
+      event.SetValue(kValueHash, 1);
+      dispatcher.Send(event);
+    }
+    dispatcher.Dispatch();
+  };
+
+  // Warm up the payload pools and dispatch buffers.
+  for (int i = 0; i < 4; ++i) {
+    run_frame();
+  }
+
+  const int kNumFrames = 100;
+  const int num_allocations = g_num_allocations;
+  for (int i = 0; i < kNumFrames; ++i) {
+    run_frame();
+  }
+  EXPECT_EQ(g_num_allocations, num_allocations);
+
+  const int expected_sum = (kNumFrames + 4) * kNumEventsPerFrame;
+  EXPECT_EQ(concrete_sum, expected_sum);
+  EXPECT_EQ(runtime_sum, expected_sum);
+}
+
+}  // namespace
+}  // namespace lull
@@ -0,0 +1,106 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "benchmark/benchmark.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "lullaby/modules/dispatcher/event_wrapper.h"
+#include "lullaby/util/hash.h"
+#include "lullaby/util/variant.h"
+
+namespace lull {
+namespace {
+
+using ::testing::Eq;
+using ::testing::NotNull;
+
+const HashValue kEventType = ConstHash("BenchmarkEvent");
+
+// Creates a runtime event with |num_values| int values keyed by their index.
+EventWrapper CreateEvent(int num_values) {
+  EventWrapper event(kEventType);
+  for (int i = 0; i < num_values; ++i) {
+    event.SetValue(static_cast<HashValue>(i), i);
+  }
+  return event;
+}
+
+// Creates a VariantMap with the same contents as the event above.
+VariantMap CreateVariantMap(int num_values) {
+  VariantMap map;
+  for (int i = 0; i < num_values; ++i) {
+    map.emplace(static_cast<HashValue>(i), i);
+  }
+  return map;
+}
+
+static void BM_EventCreate(benchmark::State& state) {
+  const int num_values = static_cast<int>(state.range(0));
+  while (state.KeepRunning()) {
+    EventWrapper event = CreateEvent(num_values);
+    benchmark::DoNotOptimize(event);
+  }
+}
+BENCHMARK(BM_EventCreate)->Arg(1)->Arg(4)->Arg(8);
+
+static void BM_EventCopy(benchmark::State& state) {
+  const EventWrapper event = CreateEvent(static_cast<int>(state.range(0)));
+  while (state.KeepRunning()) {
+    EventWrapper copy(event);
+    benchmark::DoNotOptimize(copy);
+  }
+}
+BENCHMARK(BM_EventCopy)->Arg(1)->Arg(4)->Arg(8);
+
+static void BM_EventLookup(benchmark::State& state) {
+  const int num_values = static_cast<int>(state.range(0));
+  const EventWrapper event = CreateEvent(num_values);
+  int sum = 0;
+  while (state.KeepRunning()) {
+    for (int i = 0; i < num_values; ++i) {
+      sum += *event.GetValue<int>(static_cast<HashValue>(i));
+    }
+  }
+  benchmark::DoNotOptimize(sum);
+}
+BENCHMARK(BM_EventLookup)->Arg(1)->Arg(4)->Arg(8);
+
+// Baseline for BM_EventCopy using the node-based VariantMap.
+static void BM_VariantMapCopy(benchmark::State& state) {
+  const VariantMap map = CreateVariantMap(static_cast<int>(state.range(0)));
+  while (state.KeepRunning()) {
+    VariantMap copy(map);
+    benchmark::DoNotOptimize(copy);
+  }
+}
+BENCHMARK(BM_VariantMapCopy)->Arg(1)->Arg(4)->Arg(8);
+
+// This test verifies that the benchmark code actually behaves correctly.
+TEST(EventWrapperBenchmarkTest, BenchmarkTestVerification) {
+  const EventWrapper event = CreateEvent(8);
+  const EventWrapper copy(event);
+  ASSERT_THAT(copy.GetValues(), NotNull());
+  EXPECT_THAT(copy.GetValues()->size(), Eq(static_cast<size_t>(8)));
+  for (int i = 0; i < 8; ++i) {
+    const int* value = copy.GetValue<int>(static_cast<HashValue>(i));
+    ASSERT_THAT(value, NotNull());
+    EXPECT_THAT(*value, Eq(i));
+  }
+  EXPECT_THAT(CreateVariantMap(8).size(), Eq(static_cast<size_t>(8)));
+}
+
+}  // namespace
+}  // namespace lull
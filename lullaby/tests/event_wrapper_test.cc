@@ -187,7 +187,7 @@ TEST(EventWrapper, RuntimeMap) {
   EventWrapper wrapper(GetTypeId<Event>());
   wrapper.SetValues(map);
 
-  const VariantMap* other = wrapper.GetValues();
+  const SmallVariantMap* other = wrapper.GetValues();
 
   const Variant& var1 = map.find(kWordHash)->second;
   const Variant& var2 = other->find(kWordHash)->second;
@@ -0,0 +1,237 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/systems/gltf_asset/gltf_asset.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "lullaby/modules/file/asset_loader.h"
+#include "lullaby/tests/mathfu_matchers.h"
+#include "lullaby/util/filename.h"
+#include "lullaby/util/registry.h"
+
+namespace lull {
+namespace {
+
+using ::testing::Eq;
+using ::testing::NotNull;
+using testing::NearMathfu;
+
+constexpr float kEpsilon = 1.0E-5f;
+
+// A GLTF with a single triangle whose vertices are in the external buffer
+// "triangle.bin".
+constexpr char kTriangleGltf[] = R"({
+  "asset": {"version": "2.0"},
+  "scene": 0,
+  "scenes": [{"nodes": [0]}],
+  "nodes": [{"name": "triangle", "mesh": 0, "translation": [1, 2, 3]}],
+  "meshes": [{"primitives": [{
+    "attributes": {"POSITION": 0},
+    "indices": 1,
+    "material": 0
+  }]}],
+  "materials": [{
+    "pbrMetallicRoughness": {
+      "baseColorFactor": [0.5, 0.25, 1.0, 1.0],
+      "metallicFactor": 0.5,
+      "roughnessFactor": 0.25
+    },
+    "emissiveFactor": [1.0, 0.0, 0.0]
+  }],
+  "buffers": [{"uri": "triangle.bin", "byteLength": 42}],
+  "bufferViews": [
+    {"buffer": 0, "byteOffset": 0, "byteLength": 36, "target": 34962},
+    {"buffer": 0, "byteOffset": 36, "byteLength": 6, "target": 34963}
+  ],
+  "accessors": [
+    {"bufferView": 0, "componentType": 5126, "count": 3, "type": "VEC3",
+     "min": [-1, -1, 0], "max": [1, 1, 0]},
+    {"bufferView": 1, "componentType": 5123, "count": 3, "type": "SCALAR"}
+  ]
+})";
+
+// Returns the contents of "triangle.bin": three positions followed by three
+// 16-bit indices. |height| is the y coordinate of the top vertex.
+std::string CreateTriangleBuffer(float height) {
+  const float positions[] = {-1.f, -1.f, 0.f, 1.f, -1.f, 0.f, 0.f, height, 0.f};
+  const uint16_t indices[] = {0, 1, 2};
+  std::string buffer(reinterpret_cast<const char*>(positions),
+                     sizeof(positions));
+  buffer.append(reinterpret_cast<const char*>(indices), sizeof(indices));
+  return buffer;
+}
+
+std::string GetTempDir() {
+  const char* dir = std::getenv("TEST_TMPDIR");
+  return dir ? dir : "/tmp";
+}
+
+class GltfAssetTest : public ::testing::Test {
+ protected:
+  GltfAssetTest() {
+    // Use a new GLTF filename for each test so that no cache files are shared.
+    const auto now = std::chrono::steady_clock::now().time_since_epoch();
+    filename_ = JoinPath(GetTempDir(), "gltf_asset_test_" +
+                                           std::to_string(now.count()) +
+                                           ".gltf");
+    buffer_ = CreateTriangleBuffer(1.f);
+    registry_.Create<AssetLoader>(
+        [this](const char* filename, std::string* out) {
+          if (GetBasenameFromFilename(filename) != "triangle.bin") {
+            return false;
+          }
+          ++num_buffer_loads_;
+          *out = buffer_;
+          return true;
+        });
+  }
+
+  ~GltfAssetTest() override { std::remove(GetCachePath().c_str()); }
+
+  // With no cache directory, the cache file is stored next to the GLTF.
+  std::string GetCachePath() const { return filename_ + ".cache"; }
+
+  bool CacheExists() const { return std::ifstream(GetCachePath()).good(); }
+
+  std::unique_ptr<GltfAsset> Load() {
+    GltfAsset::ImportOptions options;
+    options.use_cache = true;
+    std::unique_ptr<GltfAsset> asset(
+        new GltfAsset(&registry_, options, nullptr));
+    std::string data = kTriangleGltf;
+    asset->OnLoad(filename_, &data);
+    return asset;
+  }
+
+  Registry registry_;
+  std::string filename_;
+  std::string buffer_;
+  int num_buffer_loads_ = 0;
+};
+
+// Expects |lhs| and |rhs| to hold the same data.
+void ExpectSameInfos(GltfAsset* lhs, GltfAsset* rhs) {
+  ASSERT_THAT(lhs->GetNodeInfos().size(), Eq(rhs->GetNodeInfos().size()));
+  for (size_t i = 0; i < lhs->GetNodeInfos().size(); ++i) {
+    const GltfAsset::NodeInfo& a = lhs->GetNodeInfos()[i];
+    const GltfAsset::NodeInfo& b = rhs->GetNodeInfos()[i];
+    EXPECT_THAT(a.name, Eq(b.name));
+    EXPECT_THAT(a.transform.translation,
+                NearMathfu(b.transform.translation, kEpsilon));
+    EXPECT_THAT(a.children, Eq(b.children));
+    EXPECT_THAT(a.mesh, Eq(b.mesh));
+    EXPECT_THAT(a.skin, Eq(b.skin));
+  }
+  ASSERT_THAT(lhs->GetRootNodes().size(), Eq(rhs->GetRootNodes().size()));
+  for (size_t i = 0; i < lhs->GetRootNodes().size(); ++i) {
+    EXPECT_THAT(lhs->GetRootNodes()[i], Eq(rhs->GetRootNodes()[i]));
+  }
+
+  const auto& lhs_meshes = lhs->GetMutableMeshInfos();
+  const auto& rhs_meshes = rhs->GetMutableMeshInfos();
+  ASSERT_THAT(lhs_meshes.size(), Eq(rhs_meshes.size()));
+  for (size_t i = 0; i < lhs_meshes.size(); ++i) {
+    const MeshData& a = lhs_meshes[i].mesh_data;
+    const MeshData& b = rhs_meshes[i].mesh_data;
+    EXPECT_THAT(lhs_meshes[i].material_index,
+                Eq(rhs_meshes[i].material_index));
+    EXPECT_THAT(a.GetPrimitiveType(), Eq(b.GetPrimitiveType()));
+    EXPECT_TRUE(a.GetVertexFormat() == b.GetVertexFormat());
+    ASSERT_THAT(a.GetNumVertices(), Eq(b.GetNumVertices()));
+    const size_t vertex_size = a.GetVertexFormat().GetVertexSize();
+    EXPECT_THAT(memcmp(a.GetVertexBytes(), b.GetVertexBytes(),
+                       a.GetNumVertices() * vertex_size),
+                Eq(0));
+    ASSERT_THAT(a.GetNumIndices(), Eq(b.GetNumIndices()));
+    EXPECT_THAT(a.GetIndexType(), Eq(b.GetIndexType()));
+    EXPECT_THAT(memcmp(a.GetIndexBytes(), b.GetIndexBytes(),
+                       a.GetNumIndices() * a.GetIndexSize()),
+                Eq(0));
+  }
+
+  const MaterialInfo& a = lhs->GetMaterialInfo(0);
+  const MaterialInfo& b = rhs->GetMaterialInfo(0);
+  EXPECT_THAT(a.GetShadingModel(), Eq(b.GetShadingModel()));
+  EXPECT_THAT(a.GetTextureInfos().size(), Eq(b.GetTextureInfos().size()));
+  ASSERT_THAT(a.GetProperties().size(), Eq(b.GetProperties().size()));
+  for (const auto& iter : a.GetProperties()) {
+    auto other = b.GetProperties().find(iter.first);
+    ASSERT_TRUE(other != b.GetProperties().end());
+    EXPECT_THAT(other->second.GetTypeId(), Eq(iter.second.GetTypeId()));
+    if (const float* value = iter.second.Get<float>()) {
+      EXPECT_THAT(*other->second.Get<float>(), Eq(*value));
+    } else if (const mathfu::vec4* value = iter.second.Get<mathfu::vec4>()) {
+      EXPECT_THAT(*other->second.Get<mathfu::vec4>(),
+                  NearMathfu(*value, kEpsilon));
+    }
+  }
+}
+
+TEST_F(GltfAssetTest, CachedLoadMatchesFreshLoad) {
+  std::unique_ptr<GltfAsset> fresh = Load();
+  ASSERT_TRUE(CacheExists());
+  ASSERT_THAT(fresh->GetNodeInfos().size(), Eq(1u));
+  EXPECT_THAT(fresh->GetNodeInfos()[0].name, Eq("triangle"));
+  EXPECT_THAT(fresh->GetMutableMeshInfos()[0].mesh_data.GetNumVertices(),
+              Eq(3u));
+  const float* metallic =
+      fresh->GetMaterialInfo(0).GetProperties().at(ConstHash("Metallic"))
+          .Get<float>();
+  ASSERT_THAT(metallic, NotNull());
+  EXPECT_THAT(*metallic, Eq(0.5f));
+
+  // A cache hit still verifies the buffer.
+  num_buffer_loads_ = 0;
+  std::unique_ptr<GltfAsset> cached = Load();
+  EXPECT_THAT(num_buffer_loads_, Eq(1));
+  ExpectSameInfos(fresh.get(), cached.get());
+}
+
+TEST_F(GltfAssetTest, ChangedDependencyInvalidatesCache) {
+  std::unique_ptr<GltfAsset> original = Load();
+  ASSERT_TRUE(CacheExists());
+
+  // Checking the cache loads the buffer again, and finds it changed.
+  buffer_ = CreateTriangleBuffer(2.f);
+  num_buffer_loads_ = 0;
+  std::unique_ptr<GltfAsset> changed = Load();
+  EXPECT_THAT(num_buffer_loads_, Eq(2));
+
+  // The vertices only have positions, so the top vertex's y coordinate is the
+  // eighth float.
+  const MeshData& mesh = changed->GetMutableMeshInfos()[0].mesh_data;
+  ASSERT_THAT(mesh.GetNumVertices(), Eq(3u));
+  ASSERT_THAT(mesh.GetVertexFormat().GetVertexSize(), Eq(3 * sizeof(float)));
+  float height = 0.f;
+  memcpy(&height, mesh.GetVertexBytes() + 7 * sizeof(float), sizeof(height));
+  EXPECT_THAT(height, Eq(2.f));
+
+  // The rewritten cache matches a fresh load of the changed buffer.
+  std::unique_ptr<GltfAsset> cached = Load();
+  ExpectSameInfos(changed.get(), cached.get());
+}
+
+}  // namespace
+}  // namespace lull
@@ -615,6 +615,85 @@ TEST(InputManagerDeathTest, DegreesOfFreedom) {
   EXPECT_TRUE(!input.IsConnected(device));
 }
 
+TEST(InputManagerDeathTest, PoseHistory) {
+  InputManager input;
+  const auto device = InputManager::kController;
+  const Clock::time_point start;
+  const Clock::duration step = std::chrono::milliseconds(10);
+
+  PORT_EXPECT_DEBUG_DEATH(input.GetPositionAt(device, start), "");
+  PORT_EXPECT_DEBUG_DEATH(input.GetRotationAt(device, start), "");
+  PORT_EXPECT_DEBUG_DEATH(
+      input.GetPredictedDofWorldFromObjectMatrix(device, step), "");
+
+  DeviceProfile profile;
+  profile.rotation_dof = DeviceProfile::kRealDof;
+  profile.position_dof = DeviceProfile::kRealDof;
+  input.ConnectDevice(device, profile);
+
+  // Without samples, the current state is returned.
+  EXPECT_THAT(input.GetPositionAt(device, start),
+              NearMathfu(mathfu::kZeros3f, kEpsilon));
+
+  const mathfu::vec3 axis(0, 1, 0);
+  const float angle = 0.2f;
+  for (int i = 0; i < 3; ++i) {
+    input.UpdatePosition(device, mathfu::vec3(static_cast<float>(i), 0, 0),
+                         start + i * step);
+    input.UpdateRotation(device,
+                         mathfu::quat::FromAngleAxis(angle * i, axis),
+                         start + i * step);
+  }
+
+  // Samples older than the newest one are dropped, and do not change the
+  // current state either.
+  input.UpdatePosition(device, mathfu::vec3(100, 0, 0), start + step);
+  input.UpdateRotation(device, mathfu::quat::identity, start + step);
+  input.AdvanceFrame(kDeltaTime);
+  EXPECT_THAT(input.GetDofPosition(device),
+              NearMathfu(mathfu::vec3(2, 0, 0), kEpsilon));
+  const mathfu::quat newest = mathfu::quat::FromAngleAxis(angle * 2, axis);
+  EXPECT_THAT(input.GetDofRotation(device), NearMathfu(newest, kEpsilon));
+
+  // Before the first sample.
+  EXPECT_THAT(input.GetPositionAt(device, start - step),
+              NearMathfu(mathfu::kZeros3f, kEpsilon));
+
+  // Interpolated between samples.
+  EXPECT_THAT(input.GetPositionAt(device, start + step / 2),
+              NearMathfu(mathfu::vec3(0.5f, 0, 0), kEpsilon));
+  EXPECT_THAT(input.GetPositionAt(device, start + step * 3 / 2),
+              NearMathfu(mathfu::vec3(1.5f, 0, 0), kEpsilon));
+  const mathfu::quat half = mathfu::quat::FromAngleAxis(angle * 1.5f, axis);
+  EXPECT_THAT(input.GetRotationAt(device, start + step * 3 / 2),
+              NearMathfu(half, kEpsilon));
+
+  // Extrapolated past the newest sample.
+  EXPECT_THAT(input.GetPositionAt(device, start + 3 * step),
+              NearMathfu(mathfu::vec3(3, 0, 0), kEpsilon));
+  const mathfu::quat ahead = mathfu::quat::FromAngleAxis(angle * 3, axis);
+  EXPECT_THAT(input.GetRotationAt(device, start + 3 * step),
+              NearMathfu(ahead, kEpsilon));
+
+  // Extrapolation is limited to kMaxPoseExtrapolation.
+  const float max_steps =
+      static_cast<float>(InputManager::kMaxPoseExtrapolation.count()) /
+      static_cast<float>(step.count());
+  EXPECT_THAT(input.GetPositionAt(device, start + std::chrono::seconds(10)),
+              NearMathfu(mathfu::vec3(2 + max_steps, 0, 0), kEpsilon));
+
+  // The prediction is relative to the newest sample.
+  const mathfu::mat4 predicted =
+      input.GetPredictedDofWorldFromObjectMatrix(device, step);
+  EXPECT_NEAR(predicted(0, 3), 3.f, kEpsilon);
+
+  // Reconnecting clears the history.
+  input.DisconnectDevice(device);
+  input.ConnectDevice(device, profile);
+  EXPECT_THAT(input.GetPositionAt(device, start + step),
+              NearMathfu(mathfu::kZeros3f, kEpsilon));
+}
+
 TEST(InputManagerDeathTest, Eye) {
   InputManager input;
   const auto device = InputManager::kHmd;
@@ -982,5 +982,63 @@ TEST_F(QueuedLayoutSystemTest, ActualBoxClosestSource_Second) {
                      actual_sources_);
 }
 
+// Test that layouts dirtied in the same frame are processed from the bottom up,
+// so that a parent is laid out after its nested layouts have been resized.
+TEST_F(QueuedLayoutSystemTest, NestedLayoutsBottomUp) {
+  const Entity parent = CreateParent();
+  const Entity child = CreateChild(parent, 0.f, true);
+  CreateChild(child);
+
+  std::vector<Entity> order;
+  auto connection = dispatcher_->Connect([&order](const LayoutChangedEvent& e) {
+    order.push_back(e.target);
+  });
+  dispatcher_->Dispatch();
+  ASSERT_GE(order.size(), 2u);
+  EXPECT_EQ(child, order[0]);
+  EXPECT_EQ(parent, order[1]);
+}
+
+// Test that relaying out a layout whose inputs have not changed leaves its
+// children in place without recalculating their world matrices.
+TEST_F(LayoutSystemTest, RelayoutUnchanged) {
+  const mathfu::vec2 expectations[] = {
+      mathfu::vec2(-0.5f, 0.5f), mathfu::vec2(0.5f, 0.5f),
+  };
+
+  const Entity parent = CreateParent();
+  const int num_children = 2;
+  Entity children[num_children];
+  for (int i = 0; i < num_children; ++i) {
+    children[i] = CreateChild(parent);
+    layout_box_system_->SetOriginalBox(
+        children[i], Aabb({-0.5f, -0.5f, 0.f}, {0.5f, 0.5f, 0.f}));
+  }
+  AssertTranslationsAndSizes(num_children, children, expectations);
+
+  // Count the world matrix recalculations of the children.  Installing the
+  // function recalculates once, so only count those made by the relayout.
+  int num_recalculations = 0;
+  for (int i = 0; i < num_children; ++i) {
+    transform_system_->SetWorldFromEntityMatrixFunction(
+        children[i],
+        [&num_recalculations](const Sqt& sqt, const mathfu::mat4* parent_mat) {
+          ++num_recalculations;
+          return TransformSystem::CalculateWorldFromEntityMatrix(sqt,
+                                                                 parent_mat);
+        });
+  }
+  num_recalculations = 0;
+
+  layout_system_->Layout(parent);
+  AssertTranslationsAndSizes(num_children, children, expectations);
+  EXPECT_EQ(0, num_recalculations);
+  const mathfu::mat4* world_mat =
+      transform_system_->GetWorldFromEntityMatrix(children[1]);
+  ASSERT_NE(nullptr, world_mat);
+  EXPECT_NEAR(0.5f, world_mat->TranslationVector3D().x, kEpsilon);
+  EXPECT_NEAR(0.5f, world_mat->TranslationVector3D().y, kEpsilon);
+}
+
 }  // namespace
 }  // namespace lull
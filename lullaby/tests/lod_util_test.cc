@@ -0,0 +1,125 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/modules/render/lod_util.h"
+
+#include <cmath>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "lullaby/tests/mathfu_matchers.h"
+#include "mathfu/constants.h"
+
+namespace lull {
+namespace {
+
+constexpr float kEpsilon = 1.0E-5f;
+
+using testing::NearMathfu;
+
+RenderView CreateView(const mathfu::vec3& eye_position) {
+  RenderView view;
+  view.world_from_eye_matrix =
+      mathfu::mat4::FromTranslationVector(eye_position);
+  view.eye_from_world_matrix = view.world_from_eye_matrix.Inverse();
+  // A 90 degree vertical field of view, so that P[1][1] is 1.
+  view.clip_from_eye_matrix = CalculatePerspectiveMatrixFromView(
+      0.5f * kPi, 1.f, 0.1f, 100.f);
+  view.clip_from_world_matrix =
+      view.clip_from_eye_matrix * view.eye_from_world_matrix;
+  return view;
+}
+
+TEST(LodUtil, WorldBoundingSphere) {
+  const Aabb aabb(mathfu::vec3(-1.f, -1.f, -1.f), mathfu::vec3(1.f, 1.f, 1.f));
+  const Sphere local = GetWorldBoundingSphere(aabb, mathfu::mat4::Identity());
+  EXPECT_THAT(local.position, NearMathfu(mathfu::kZeros3f, kEpsilon));
+  EXPECT_NEAR(local.radius, std::sqrt(3.f), kEpsilon);
+
+  // The largest axis scale is used for non-uniform scales.
+  const mathfu::mat4 world_from_local = mathfu::mat4::Transform(
+      mathfu::vec3(1.f, 2.f, 3.f), mathfu::mat3::Identity(),
+      mathfu::vec3(1.f, 4.f, 2.f));
+  const Sphere world = GetWorldBoundingSphere(aabb, world_from_local);
+  EXPECT_THAT(world.position,
+              NearMathfu(mathfu::vec3(1.f, 2.f, 3.f), kEpsilon));
+  EXPECT_NEAR(world.radius, 4.f * std::sqrt(3.f), kEpsilon);
+}
+
+TEST(LodUtil, ScreenSize) {
+  const Sphere sphere(mathfu::vec3(0.f, 0.f, -10.f), 1.f);
+  RenderView views[2] = {CreateView(mathfu::kZeros3f),
+                         CreateView(mathfu::vec3(0.f, 0.f, -5.f))};
+
+  EXPECT_EQ(GetScreenSize(sphere, Span<RenderView>()), 0.f);
+  EXPECT_NEAR(GetScreenSize(sphere, Span<RenderView>(views, 1)), 0.1f,
+              kEpsilon);
+
+  // The closest view determines the screen size.
+  EXPECT_NEAR(GetScreenSize(sphere, Span<RenderView>(views, 2)), 0.2f,
+              kEpsilon);
+
+  // Moving the sphere twice as far away halves its size.
+  const Sphere far_sphere(mathfu::vec3(0.f, 0.f, -20.f), 1.f);
+  EXPECT_NEAR(GetScreenSize(far_sphere, Span<RenderView>(views, 1)), 0.05f,
+              kEpsilon);
+
+  // An eye inside the sphere always selects the highest detail.
+  const Sphere around_eye(mathfu::vec3(0.f, 0.f, -0.5f), 1.f);
+  EXPECT_GT(GetScreenSize(around_eye, Span<RenderView>(views, 1)), 1.f);
+}
+
+TEST(LodUtil, ScreenSizeOrthographic) {
+  // A view volume 20 units high, so that P[1][1] is 0.1.
+  RenderView view = CreateView(mathfu::kZeros3f);
+  view.clip_from_eye_matrix =
+      mathfu::mat4::Ortho(-10.f, 10.f, -10.f, 10.f, 0.1f, 100.f);
+  view.clip_from_world_matrix =
+      view.clip_from_eye_matrix * view.eye_from_world_matrix;
+
+  // The screen size does not depend on distance, and spheres larger than the
+  // (constant) w are not treated as containing the eye.
+  const Sphere near_sphere(mathfu::vec3(0.f, 0.f, -10.f), 2.f);
+  const Sphere far_sphere(mathfu::vec3(0.f, 0.f, -50.f), 2.f);
+  EXPECT_NEAR(GetScreenSize(near_sphere, Span<RenderView>(&view, 1)), 0.2f,
+              kEpsilon);
+  EXPECT_NEAR(GetScreenSize(far_sphere, Span<RenderView>(&view, 1)), 0.2f,
+              kEpsilon);
+}
+
+TEST(LodUtil, SelectLod) {
+  std::vector<float> thresholds = {0.5f, 0.25f, 0.f};
+  const float kHysteresis = 0.1f;
+
+  EXPECT_EQ(SelectLod(Span<float>(), 0.1f, 0, kHysteresis), 0);
+  EXPECT_EQ(SelectLod(thresholds, 1.f, 0, kHysteresis), 0);
+  EXPECT_EQ(SelectLod(thresholds, 0.3f, 0, kHysteresis), 1);
+  EXPECT_EQ(SelectLod(thresholds, 0.01f, 0, kHysteresis), 2);
+  EXPECT_EQ(SelectLod(thresholds, 1.f, 2, kHysteresis), 0);
+
+  // Sizes just past a threshold do not switch away from the current LOD.
+  EXPECT_EQ(SelectLod(thresholds, 0.48f, 0, kHysteresis), 0);
+  EXPECT_EQ(SelectLod(thresholds, 0.52f, 1, kHysteresis), 1);
+  EXPECT_EQ(SelectLod(thresholds, 0.44f, 0, kHysteresis), 1);
+  EXPECT_EQ(SelectLod(thresholds, 0.56f, 1, kHysteresis), 0);
+
+  // Out of range LODs are clamped.
+  EXPECT_EQ(SelectLod(thresholds, 0.01f, 10, kHysteresis), 2);
+  EXPECT_EQ(SelectLod(thresholds, 1.f, -1, kHysteresis), 0);
+}
+
+}  // namespace
+}  // namespace lull
@@ -386,6 +386,43 @@ TEST(ApplyDeformation, IsAppliedAsExpectedToMesh) {
   EXPECT_EQ(vertices[2].v0, 0.6f);
 }
 
+TEST(ApplyBatchDeformation, MatchesCylinderBend) {
+  const size_t kNumVertices = 100;
+  std::vector<VertexPT> vertices;
+  for (size_t i = 0; i < kNumVertices; ++i) {
+    const float f = static_cast<float>(i);
+    vertices.emplace_back(0.1f * f - 5.f, 0.05f * f, -1.f - 0.01f * f, 0.f,
+                          0.f);
+  }
+  const std::vector<VertexPT> original = vertices;
+  DataContainer vertex_data(
+      DataContainer::DataPtr(reinterpret_cast<uint8_t*>(vertices.data()),
+                             [](const uint8_t*) {}),
+      kNumVertices * sizeof(VertexPT), kNumVertices * sizeof(VertexPT),
+      DataContainer::kAll);
+  MeshData mesh(MeshData::kPoints, VertexPT::kFormat, std::move(vertex_data));
+
+  const float radius = 2.f;
+  const mathfu::mat4 pre_mat =
+      mathfu::mat4::FromTranslationVector(mathfu::vec3(0.f, 1.f, -2.f));
+  const mathfu::mat4 post_mat =
+      mathfu::mat4::FromScaleVector(mathfu::vec3(2.f, 2.f, 2.f));
+  ApplyBatchDeformation(&mesh, [&](float* positions, size_t num_positions,
+                                   size_t stride) {
+    EXPECT_EQ(num_positions, kNumVertices);
+    EXPECT_EQ(stride, sizeof(VertexPT) / sizeof(float));
+    CylinderBendPositions(positions, num_positions, stride, pre_mat, radius,
+                          post_mat);
+  });
+
+  for (size_t i = 0; i < kNumVertices; ++i) {
+    const mathfu::vec3 expected =
+        post_mat * DeformPoint(pre_mat * GetPosition(original[i]), radius);
+    // The batched version uses a slightly different order of operations.
+    EXPECT_THAT(GetPosition(vertices[i]), NearMathfu(expected, 1.0E-4f));
+  }
+}
+
 TEST(ApplyDeformationDeathTest, FailsWithInsufficientAccess) {
   auto deform = [](const mathfu::vec3& pos) {
     LOG(FATAL);
@@ -0,0 +1,292 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <cmath>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "lullaby/modules/dispatcher/dispatcher.h"
+#include "lullaby/modules/ecs/entity_factory.h"
+#include "lullaby/modules/file/asset_loader.h"
+#include "lullaby/modules/render/render_view.h"
+#include "lullaby/systems/model_asset/model_asset_system.h"
+#include "lullaby/systems/render/mesh_factory.h"
+#include "lullaby/systems/render/render_system.h"
+#include "lullaby/systems/render/testing/mesh.h"
+#include "lullaby/systems/render/testing/mock_render_system_impl.h"
+#include "lullaby/systems/transform/transform_system.h"
+#include "lullaby/util/flatbuffer_writer.h"
+#include "lullaby/util/inward_buffer.h"
+#include "lullaby/util/math.h"
+#include "lullaby/util/registry.h"
+#include "lullaby/util/span.h"
+#include "mathfu/constants.h"
+#include "lullaby/generated/model_def_generated.h"
+
+namespace lull {
+namespace {
+
+using ::testing::An;
+using ::testing::Eq;
+using ::testing::Invoke;
+using ::testing::_;
+
+constexpr char kModelName[] = "lods.lullmodel";
+
+// The screen-size thresholds of the three LODs in the test model.
+constexpr float kLod0ScreenSize = 0.5f;
+constexpr float kLod1ScreenSize = 0.25f;
+
+// The bounding box of the test model is a 2x2x2 cube, so its bounding sphere
+// has a radius of sqrt(3).
+const float kBoundingRadius = std::sqrt(3.f);
+
+// Creates a unique Mesh for every call so that LODs can be told apart.
+class FakeMeshFactory : public MeshFactory {
+ public:
+  void CacheMesh(HashValue name, const MeshPtr& mesh) override {}
+  MeshPtr GetMesh(HashValue name) const override { return nullptr; }
+  void ReleaseMesh(HashValue name) override {}
+  MeshPtr CreateMesh(MeshData mesh_data) override { return CreateMesh(); }
+  MeshPtr CreateMesh(MeshData* mesh_datas, size_t len) override {
+    return CreateMesh();
+  }
+  MeshPtr CreateMesh(HashValue name, MeshData mesh_data) override {
+    return CreateMesh();
+  }
+  MeshPtr CreateMesh(HashValue name, MeshData* mesh_datas,
+                     size_t len) override {
+    return CreateMesh();
+  }
+  MeshPtr EmptyMesh() override { return empty_mesh_; }
+
+  const std::vector<MeshPtr>& GetCreatedMeshes() const { return meshes_; }
+
+ private:
+  MeshPtr CreateMesh() {
+    meshes_.emplace_back(std::make_shared<Mesh>());
+    return meshes_.back();
+  }
+
+  MeshPtr empty_mesh_ = std::make_shared<Mesh>();
+  std::vector<MeshPtr> meshes_;
+};
+
+ModelInstanceDefT CreateTriangle() {
+  const mathfu::vec3_packed positions[] = {
+      mathfu::vec3_packed(mathfu::vec3(-1.f, -1.f, 0.f)),
+      mathfu::vec3_packed(mathfu::vec3(1.f, -1.f, 0.f)),
+      mathfu::vec3_packed(mathfu::vec3(0.f, 1.f, 0.f)),
+  };
+  const uint8_t* bytes = reinterpret_cast<const uint8_t*>(positions);
+
+  ModelInstanceDefT lod;
+  lod.num_vertices = 3;
+  lod.vertex_data.assign(bytes, bytes + sizeof(positions));
+  lod.vertex_attributes.emplace_back();
+  lod.vertex_attributes.back().usage = VertexAttributeUsage_Position;
+  lod.vertex_attributes.back().type = VertexAttributeType_Vec3f;
+  lod.indices16 = {0, 1, 2};
+  lod.ranges.emplace_back();
+  lod.ranges.back().start = 0;
+  lod.ranges.back().end = 3;
+  lod.materials.emplace_back();
+  return lod;
+}
+
+// Returns a lullmodel with three identical LODs.
+std::string CreateLodModel() {
+  ModelDefT model;
+  model.bounding_box = Aabb(mathfu::vec3(-1.f, -1.f, -1.f),
+                            mathfu::vec3(1.f, 1.f, 1.f));
+  for (int i = 0; i < 3; ++i) {
+    model.lods.emplace_back(CreateTriangle());
+  }
+  model.lod_screen_sizes = {kLod0ScreenSize, kLod1ScreenSize, 0.f};
+
+  InwardBuffer buffer(256);
+  WriteFlatbuffer(&model, &buffer);
+  const size_t length = buffer.BackSize();
+  const char* data = static_cast<const char*>(buffer.BackAt(length));
+  return std::string(data, length);
+}
+
+class ModelAssetSystemTest : public ::testing::Test {
+ protected:
+  ModelAssetSystemTest() {
+    const std::string model = CreateLodModel();
+    registry_.Create<AssetLoader>(
+        [model](const char* filename, std::string* out) {
+          *out = model;
+          return true;
+        });
+    registry_.Create<Dispatcher>();
+    mesh_factory_ = new FakeMeshFactory();
+    registry_.Register(std::unique_ptr<MeshFactory>(mesh_factory_));
+
+    entity_factory_ = registry_.Create<EntityFactory>(&registry_);
+    model_asset_system_ = entity_factory_->CreateSystem<ModelAssetSystem>();
+    render_system_ = entity_factory_->CreateSystem<RenderSystem>();
+    transform_system_ = entity_factory_->CreateSystem<TransformSystem>();
+
+    ON_CALL(*render_system_->GetImpl(), SetMesh(_, _, An<MeshPtr>()))
+        .WillByDefault(Invoke([this](Entity e, HashValue pass, MeshPtr mesh) {
+          meshes_[e] = mesh;
+          ++num_set_mesh_calls_;
+        }));
+
+    entity_factory_->Initialize();
+
+    // A 90 degree vertical field of view, so that an object's screen size is
+    // its bounding radius divided by its distance.
+    view_.world_from_eye_matrix = mathfu::mat4::Identity();
+    view_.eye_from_world_matrix = mathfu::mat4::Identity();
+    view_.clip_from_eye_matrix =
+        CalculatePerspectiveMatrixFromView(0.5f * kPi, 1.f, 0.1f, 100.f);
+    view_.clip_from_world_matrix = view_.clip_from_eye_matrix;
+  }
+
+  Entity CreateLodEntity() {
+    const Entity entity = entity_factory_->Create();
+    transform_system_->Create(entity, Sqt());
+    model_asset_system_->CreateModel(entity, kModelName);
+
+    auto* asset_loader = registry_.Get<AssetLoader>();
+    while (asset_loader->Finalize() > 0) {
+    }
+    num_set_mesh_calls_ = 0;
+    return entity;
+  }
+
+  // Moves |entity| in front of the view so that it covers |screen_size| of
+  // the viewport, then updates LODs.
+  void UpdateLods(Entity entity, float screen_size) {
+    const float distance = kBoundingRadius / screen_size;
+    transform_system_->SetSqt(entity, Sqt(mathfu::vec3(0.f, 0.f, -distance),
+                                          mathfu::quat::identity,
+                                          mathfu::kOnes3f));
+    model_asset_system_->UpdateLods(Span<RenderView>(&view_, 1));
+  }
+
+  // Returns the mesh that was created for the given |lod|.
+  MeshPtr GetLodMesh(int lod) const {
+    return mesh_factory_->GetCreatedMeshes()[lod];
+  }
+
+  Registry registry_;
+  EntityFactory* entity_factory_ = nullptr;
+  ModelAssetSystem* model_asset_system_ = nullptr;
+  RenderSystem* render_system_ = nullptr;
+  TransformSystem* transform_system_ = nullptr;
+  FakeMeshFactory* mesh_factory_ = nullptr;
+  RenderView view_;
+  std::unordered_map<Entity, MeshPtr> meshes_;
+  int num_set_mesh_calls_ = 0;
+};
+
+TEST_F(ModelAssetSystemTest, CreatesMeshPerLod) {
+  const Entity entity = CreateLodEntity();
+
+  ASSERT_THAT(mesh_factory_->GetCreatedMeshes().size(), Eq(3u));
+  EXPECT_THAT(model_asset_system_->GetLod(entity), Eq(0));
+  EXPECT_THAT(meshes_[entity], Eq(GetLodMesh(0)));
+
+  const ModelAsset* asset = model_asset_system_->GetModelAsset(entity);
+  ASSERT_TRUE(asset != nullptr);
+  EXPECT_THAT(asset->GetNumLods(), Eq(3u));
+}
+
+TEST_F(ModelAssetSystemTest, SwitchesLods) {
+  const Entity entity = CreateLodEntity();
+
+  UpdateLods(entity, 1.f);
+  EXPECT_THAT(model_asset_system_->GetLod(entity), Eq(0));
+  EXPECT_THAT(num_set_mesh_calls_, Eq(0));
+
+  UpdateLods(entity, 0.4f);
+  EXPECT_THAT(model_asset_system_->GetLod(entity), Eq(1));
+  EXPECT_THAT(meshes_[entity], Eq(GetLodMesh(1)));
+  EXPECT_THAT(num_set_mesh_calls_, Eq(1));
+
+  // Skips straight past LOD 1 when the model becomes tiny.
+  UpdateLods(entity, 1.f);
+  UpdateLods(entity, 0.05f);
+  EXPECT_THAT(model_asset_system_->GetLod(entity), Eq(2));
+  EXPECT_THAT(meshes_[entity], Eq(GetLodMesh(2)));
+  EXPECT_THAT(num_set_mesh_calls_, Eq(3));
+
+  // The mesh is only set when the LOD changes.
+  UpdateLods(entity, 0.04f);
+  EXPECT_THAT(num_set_mesh_calls_, Eq(3));
+
+  UpdateLods(entity, 2.f);
+  EXPECT_THAT(model_asset_system_->GetLod(entity), Eq(0));
+  EXPECT_THAT(meshes_[entity], Eq(GetLodMesh(0)));
+}
+
+TEST_F(ModelAssetSystemTest, Hysteresis) {
+  const Entity entity = CreateLodEntity();
+  model_asset_system_->SetLodHysteresis(0.1f);
+
+  // Just below the LOD 0 threshold, but within the hysteresis band.
+  UpdateLods(entity, 0.47f);
+  EXPECT_THAT(model_asset_system_->GetLod(entity), Eq(0));
+
+  UpdateLods(entity, 0.44f);
+  EXPECT_THAT(model_asset_system_->GetLod(entity), Eq(1));
+
+  // Just above the LOD 0 threshold, but within the hysteresis band.
+  UpdateLods(entity, 0.53f);
+  EXPECT_THAT(model_asset_system_->GetLod(entity), Eq(1));
+
+  UpdateLods(entity, 0.56f);
+  EXPECT_THAT(model_asset_system_->GetLod(entity), Eq(0));
+  EXPECT_THAT(num_set_mesh_calls_, Eq(2));
+
+  // Without hysteresis the LOD changes as soon as a threshold is crossed.
+  model_asset_system_->SetLodHysteresis(0.f);
+  UpdateLods(entity, 0.49f);
+  EXPECT_THAT(model_asset_system_->GetLod(entity), Eq(1));
+  UpdateLods(entity, 0.51f);
+  EXPECT_THAT(model_asset_system_->GetLod(entity), Eq(0));
+}
+
+TEST_F(ModelAssetSystemTest, LodBias) {
+  const Entity entity = CreateLodEntity();
+
+  model_asset_system_->SetLodBias(RenderSystem::kDefaultPass, 0.5f);
+  UpdateLods(entity, 0.8f);
+  EXPECT_THAT(model_asset_system_->GetLod(entity), Eq(1));
+
+  model_asset_system_->SetLodBias(RenderSystem::kDefaultPass, 1.f);
+  UpdateLods(entity, 0.8f);
+  EXPECT_THAT(model_asset_system_->GetLod(entity), Eq(0));
+}
+
+TEST_F(ModelAssetSystemTest, DestroyStopsLodSelection) {
+  const Entity entity = CreateLodEntity();
+
+  model_asset_system_->Destroy(entity);
+  UpdateLods(entity, 0.05f);
+  EXPECT_THAT(model_asset_system_->GetLod(entity), Eq(0));
+  EXPECT_THAT(num_set_mesh_calls_, Eq(0));
+}
+
+}  // namespace
+}  // namespace lull
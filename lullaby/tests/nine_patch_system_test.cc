@@ -30,6 +30,7 @@ limitations under the License.
 namespace lull {
 namespace {
 
+using ::testing::_;
 using testing::NearMathfuVec3;
 static const float kEpsilon = 0.001f;
 
@@ -89,5 +90,24 @@ TEST_F(NinePatchSystemTest, Aabb) {
   EXPECT_THAT(aabb->max, NearMathfuVec3(half_dims, kEpsilon));
 }
 
+TEST_F(NinePatchSystemTest, SameSizeDoesNotRegenerateMesh) {
+  Blueprint blueprint;
+  TransformDefT transform;
+  blueprint.Write(&transform);
+  NinePatchDefT nine_patch;
+  nine_patch.size = mathfu::vec2(1.f, 1.f);
+  blueprint.Write(&nine_patch);
+
+  const Entity entity = entity_factory_->Create(&blueprint);
+
+  EXPECT_CALL(*render_system_, UpdateDynamicMesh(entity, _, _, _, _, _))
+      .Times(1);
+  nine_patch_system_->SetSize(entity, mathfu::vec2(2.f, 1.f));
+  nine_patch_system_->SetSize(entity, mathfu::vec2(2.f, 1.f));
+
+  const lull::Aabb* aabb = transform_system_->GetAabb(entity);
+  EXPECT_THAT(aabb->max, NearMathfuVec3(mathfu::vec3(1.f, .5f, 0.f), kEpsilon));
+}
+
 }  // namespace
 }  // namespace lull
@@ -852,5 +852,60 @@ TEST(NinePatch, CheckFullWidthRightTopSlices) {
                             expected_uvs, expected_uv1s);
 }
 
+// Test that generating the vertices and indices separately matches the mesh
+// generated by GenerateNinePatchMesh.
+TEST(NinePatch, CheckSeparateVerticesAndIndices) {
+  NinePatch nine_patch;
+  nine_patch.size = mathfu::vec2(3, 2);
+  nine_patch.original_size = mathfu::vec2(1, 1);
+  nine_patch.left_slice = .25f;
+  nine_patch.right_slice = .1f;
+  nine_patch.bottom_slice = .2f;
+  nine_patch.top_slice = .3f;
+  nine_patch.subdivisions = mathfu::vec2i(4, 3);
+
+  std::vector<lull::VertexPTT> mesh_vertices(nine_patch.GetVertexCount());
+  std::vector<uint16_t> mesh_indices(nine_patch.GetIndexCount());
+  MeshData mesh =
+      BuildMeshFromNinePatchVerticesAndIndices(&mesh_vertices, &mesh_indices);
+  GenerateNinePatchMesh(nine_patch, &mesh);
+
+  std::vector<lull::VertexPTT> vertices;
+  GenerateNinePatchVertices(nine_patch, &vertices);
+  ASSERT_EQ(mesh_vertices.size(), vertices.size());
+  for (size_t i = 0; i < vertices.size(); ++i) {
+    EXPECT_EQ(mesh_vertices[i].x, vertices[i].x);
+    EXPECT_EQ(mesh_vertices[i].y, vertices[i].y);
+    EXPECT_EQ(mesh_vertices[i].z, vertices[i].z);
+    EXPECT_EQ(mesh_vertices[i].u0, vertices[i].u0);
+    EXPECT_EQ(mesh_vertices[i].v0, vertices[i].v0);
+    EXPECT_EQ(mesh_vertices[i].u1, vertices[i].u1);
+    EXPECT_EQ(mesh_vertices[i].v1, vertices[i].v1);
+  }
+
+  // The indices do not depend on the size of the nine patch.
+  nine_patch.size = mathfu::vec2(10, 10);
+  std::vector<lull::VertexPTT> unused_vertices;
+  std::vector<uint16_t> indices(nine_patch.GetIndexCount());
+  MeshData index_mesh =
+      BuildMeshFromNinePatchVerticesAndIndices(&unused_vertices, &indices);
+  GenerateNinePatchIndices(nine_patch, 0, &index_mesh);
+  EXPECT_EQ(mesh_indices, indices);
+}
+
+TEST(NinePatch, CheckEquality) {
+  NinePatch a;
+  NinePatch b;
+  EXPECT_TRUE(a == b);
+
+  b.size = mathfu::vec2(1, 2);
+  EXPECT_TRUE(a != b);
+  a.size = b.size;
+  EXPECT_TRUE(a == b);
+
+  b.subdivisions = mathfu::vec2i(2, 1);
+  EXPECT_TRUE(a != b);
+}
+
 }  // namespace
 }  // namespace lull
@@ -0,0 +1,132 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "benchmark/benchmark.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "lullaby/modules/ecs/entity_factory.h"
+#include "lullaby/systems/dispatcher/dispatcher_system.h"
+#include "lullaby/systems/physics/physics_system.h"
+#include "lullaby/systems/transform/transform_system.h"
+#include "lullaby/util/make_unique.h"
+#include "lullaby/generated/rigid_body_def_generated.h"
+#include "lullaby/generated/transform_def_generated.h"
+
+namespace lull {
+namespace {
+
+using ::testing::Gt;
+
+const Clock::duration kFrameDuration = DurationFromSeconds(1.f / 60.f);
+
+// A scene consisting of a grid of static colliders, a handful of kinematic
+// bodies that are moved every frame, and a handful of dynamic bodies falling
+// onto the static colliders.
+class MostlyStaticScene {
+ public:
+  MostlyStaticScene(int num_static, int num_kinematic, int num_dynamic) {
+    registry_ = MakeUnique<Registry>();
+    registry_->Create<Dispatcher>();
+
+    auto* entity_factory = registry_->Create<EntityFactory>(registry_.get());
+    entity_factory->CreateSystem<DispatcherSystem>();
+    entity_factory->CreateSystem<TransformSystem>();
+    entity_factory->CreateSystem<PhysicsSystem>();
+    entity_factory->Initialize();
+
+    const int row = 100;
+    for (int i = 0; i < num_static; ++i) {
+      const mathfu::vec3 position(3.f * static_cast<float>(i % row), 0.f,
+                                  3.f * static_cast<float>(i / row));
+      CreateBody(position, RigidBodyType::RigidBodyType_Static);
+    }
+    for (int i = 0; i < num_kinematic; ++i) {
+      const mathfu::vec3 position(3.f * static_cast<float>(i), 10.f, 0.f);
+      kinematic_.push_back(
+          CreateBody(position, RigidBodyType::RigidBodyType_Kinematic));
+    }
+    for (int i = 0; i < num_dynamic; ++i) {
+      const mathfu::vec3 position(3.f * static_cast<float>(i), 5.f, 3.f);
+      CreateBody(position, RigidBodyType::RigidBodyType_Dynamic);
+    }
+  }
+
+  void AdvanceFrame() {
+    auto* transform_system = registry_->Get<TransformSystem>();
+    offset_ += 0.01f;
+    for (const Entity entity : kinematic_) {
+      mathfu::vec3 position = transform_system->GetLocalTranslation(entity);
+      position.y = 10.f + offset_;
+      transform_system->SetLocalTranslation(entity, position);
+    }
+    registry_->Get<PhysicsSystem>()->AdvanceFrame(kFrameDuration);
+  }
+
+  Registry* GetRegistry() { return registry_.get(); }
+
+ private:
+  Entity CreateBody(const mathfu::vec3& position, RigidBodyType type) {
+    Blueprint blueprint(512);
+
+    TransformDefT transform;
+    transform.aabb.min = -mathfu::kOnes3f;
+    transform.aabb.max = mathfu::kOnes3f;
+    transform.position = position;
+    blueprint.Write(&transform);
+
+    RigidBodyDefT rigid_body;
+    rigid_body.type = type;
+    blueprint.Write(&rigid_body);
+
+    return registry_->Get<EntityFactory>()->Create(&blueprint);
+  }
+
+  std::unique_ptr<Registry> registry_;
+  std::vector<Entity> kinematic_;
+  float offset_ = 0.f;
+};
+
+static void BM_PhysicsMostlyStatic(benchmark::State& state) {
+  MostlyStaticScene scene(static_cast<int>(state.range(0)), 10, 10);
+  while (state.KeepRunning()) {
+    scene.AdvanceFrame();
+  }
+}
+BENCHMARK(BM_PhysicsMostlyStatic)->Arg(1000)->Arg(10000);
+
+// This test verifies that the benchmark scene actually simulates.
+TEST(PhysicsSystemBenchmarkTest, BenchmarkTestVerification) {
+  MostlyStaticScene scene(100, 1, 1);
+  auto* transform_system = scene.GetRegistry()->Get<TransformSystem>();
+
+  Entity dynamic = kNullEntity;
+  transform_system->ForAll([&](Entity e, const mathfu::mat4& mat,
+                               const Aabb& box, Bits flags) {
+    if (mat.TranslationVector3D().y == 5.f) {
+      dynamic = e;
+    }
+  });
+  ASSERT_NE(dynamic, kNullEntity);
+
+  const float start = transform_system->GetLocalTranslation(dynamic).y;
+  for (int i = 0; i < 10; ++i) {
+    scene.AdvanceFrame();
+  }
+  EXPECT_THAT(start, Gt(transform_system->GetLocalTranslation(dynamic).y));
+}
+
+}  // namespace
+}  // namespace lull
@@ -15,6 +15,11 @@ limitations under the License.
 */
 
 #include "lullaby/systems/physics/physics_system.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
 #include "gtest/gtest.h"
 #include "lullaby/events/physics_events.h"
 #include "lullaby/modules/ecs/entity_factory.h"
@@ -30,29 +35,65 @@ namespace lull {
 namespace {
 
 using ::testing::Eq;
+using ::testing::Le;
+using ::testing::Lt;
 using ::testing::Ne;
 using testing::NearMathfuVec3;
 using testing::NearMathfuQuat;
 
 const float kFrameSeconds = 1.f / 60.f;
 const Clock::duration kFrameDuration = DurationFromSeconds(kFrameSeconds);
+const Clock::duration kSimulationStep = std::chrono::milliseconds(4);
 
 class PhysicsSystemTest : public ::testing::Test {
  public:
-  void SetUp() override {
+  void SetUp() override { CreateSystems(PhysicsSystem::InitParams()); }
+
+  // Replaces the current Registry with one containing a PhysicsSystem
+  // configured with |params|.
+  void CreateSystems(const PhysicsSystem::InitParams& params) {
     registry_ = MakeUnique<Registry>();
     registry_->Create<Dispatcher>();
 
     auto* entity_factory = registry_->Create<EntityFactory>(registry_.get());
     entity_factory->CreateSystem<DispatcherSystem>();
     entity_factory->CreateSystem<TransformSystem>();
-    entity_factory->CreateSystem<PhysicsSystem>();
+    entity_factory->CreateSystem<PhysicsSystem>(params);
     entity_factory->Initialize();
   }
 
   void TearDown() override {
   }
 
+  // Replaces the current Registry with one whose PhysicsSystem steps on its
+  // own thread, paced by a step clock that only advances when told to.
+  void CreateSystemsWithSimulationThread() {
+    PhysicsSystem::InitParams params;
+    params.timestep = SecondsFromDuration(kSimulationStep);
+    params.use_simulation_thread = true;
+    params.step_clock = [this]() {
+      return Clock::time_point(Clock::duration(step_clock_ticks_.load()));
+    };
+    CreateSystems(params);
+  }
+
+  void AdvanceStepClock(Clock::duration duration) {
+    step_clock_ticks_ += duration.count();
+  }
+
+  // Advances the step clock by |num_steps| simulation steps and waits until
+  // the simulation thread has taken all of them.
+  void StepSimulationThread(int num_steps) {
+    auto* physics_system = registry_->Get<PhysicsSystem>();
+    for (int i = 0; i < num_steps; ++i) {
+      const uint64_t steps = physics_system->GetNumSimulationSteps();
+      AdvanceStepClock(kSimulationStep);
+      while (physics_system->GetNumSimulationSteps() == steps) {
+        std::this_thread::yield();
+      }
+    }
+  }
+
   // Creates a 2x2x2 rigid body at the given position with the given types.
   Entity CreateBasicRigidBody(
       const mathfu::vec3& position = mathfu::kZeros3f,
@@ -77,6 +118,8 @@ class PhysicsSystemTest : public ::testing::Test {
   }
 
  protected:
+  // Declared before |registry_| so that it outlives the simulation thread.
+  std::atomic<Clock::rep> step_clock_ticks_{0};
   std::unique_ptr<Registry> registry_;
 };
 
@@ -545,5 +588,105 @@ TEST_F(PhysicsSystemTest, MultipleTimesteps) {
   EXPECT_THAT(sqt->translation, NearMathfuVec3(next_position, kDefaultEpsilon));
 }
 
+// Test that the simulation advances on its own thread, and that results are
+// written back to the TransformSystem when the main thread advances.
+TEST_F(PhysicsSystemTest, SimulationThread) {
+  CreateSystemsWithSimulationThread();
+
+  auto* physics_system = registry_->Get<PhysicsSystem>();
+  auto* transform_system = registry_->Get<TransformSystem>();
+  auto* dispatcher_system = registry_->Get<DispatcherSystem>();
+
+  // Create a Dynamic box above a Static box.
+  const Entity ground = CreateBasicRigidBody(
+      mathfu::kZeros3f, RigidBodyType::RigidBodyType_Static);
+  const Entity entity = CreateBasicRigidBody(
+      mathfu::vec3(0.f, 3.f, 0.f), RigidBodyType::RigidBodyType_Dynamic);
+  EXPECT_THAT(ground, Ne(kNullEntity));
+  EXPECT_THAT(entity, Ne(kNullEntity));
+
+  int num_enter_events = 0;
+  dispatcher_system->Connect(
+      entity, this, [&](const EnterPhysicsContactEvent& e) {
+        EXPECT_THAT(e.other, Eq(ground));
+        ++num_enter_events;
+      });
+
+  // The simulation doesn't step until the step clock reaches the next step.
+  physics_system->AdvanceFrame(kFrameDuration);
+  EXPECT_THAT(physics_system->GetNumSimulationSteps(), Eq(0u));
+  EXPECT_THAT(transform_system->GetLocalTranslation(entity),
+              NearMathfuVec3(mathfu::vec3(0.f, 3.f, 0.f), kDefaultEpsilon));
+
+  // The Lullaby transform only changes when the main thread advances.
+  StepSimulationThread(10);
+  EXPECT_THAT(transform_system->GetLocalTranslation(entity),
+              NearMathfuVec3(mathfu::vec3(0.f, 3.f, 0.f), kDefaultEpsilon));
+  physics_system->AdvanceFrame(kFrameDuration);
+  EXPECT_THAT(transform_system->GetLocalTranslation(entity).y, Lt(3.f));
+
+  // Let the box fall onto the ground.
+  for (int i = 0; i < 400 && num_enter_events == 0; ++i) {
+    StepSimulationThread(1);
+    physics_system->AdvanceFrame(kFrameDuration);
+  }
+  EXPECT_THAT(num_enter_events, Eq(1));
+  EXPECT_TRUE(physics_system->AreInContact(entity, ground));
+}
+
+// Test that transforms set on the main thread are not overwritten by poses
+// that the simulation thread computed before it received them.
+TEST_F(PhysicsSystemTest, SimulationThreadTeleport) {
+  CreateSystemsWithSimulationThread();
+
+  auto* physics_system = registry_->Get<PhysicsSystem>();
+  auto* transform_system = registry_->Get<TransformSystem>();
+
+  const Entity entity = CreateBasicRigidBody(
+      mathfu::vec3(0.f, 3.f, 0.f), RigidBodyType::RigidBodyType_Dynamic);
+  StepSimulationThread(10);
+  physics_system->AdvanceFrame(kFrameDuration);
+  EXPECT_THAT(transform_system->GetLocalTranslation(entity).y, Lt(3.f));
+
+  // Teleport the falling box. The simulation hasn't received the new
+  // transform yet, so the interpolated poses it has are stale.
+  const mathfu::vec3 teleport(5.f, 10.f, 0.f);
+  transform_system->SetLocalTranslation(entity, teleport);
+  AdvanceStepClock(kSimulationStep / 2);
+  physics_system->AdvanceFrame(kFrameDuration);
+  EXPECT_THAT(transform_system->GetLocalTranslation(entity),
+              NearMathfuVec3(teleport, kDefaultEpsilon));
+
+  // Once the simulation steps, the box falls from its new position.
+  StepSimulationThread(1);
+  physics_system->AdvanceFrame(kFrameDuration);
+  const mathfu::vec3 translation =
+      transform_system->GetLocalTranslation(entity);
+  EXPECT_THAT(translation, NearMathfuVec3(teleport, 0.1f));
+  EXPECT_THAT(translation.y, Le(teleport.y));
+}
+
+// Test that disabling physics stops applying simulated poses immediately.
+TEST_F(PhysicsSystemTest, SimulationThreadDisablePhysics) {
+  CreateSystemsWithSimulationThread();
+
+  auto* physics_system = registry_->Get<PhysicsSystem>();
+  auto* transform_system = registry_->Get<TransformSystem>();
+
+  const Entity entity = CreateBasicRigidBody(
+      mathfu::vec3(0.f, 3.f, 0.f), RigidBodyType::RigidBodyType_Dynamic);
+  StepSimulationThread(10);
+  physics_system->AdvanceFrame(kFrameDuration);
+
+  // Interpolating halfway towards the latest step would move the box again.
+  const mathfu::vec3 translation =
+      transform_system->GetLocalTranslation(entity);
+  physics_system->DisablePhysics(entity);
+  AdvanceStepClock(kSimulationStep / 2);
+  physics_system->AdvanceFrame(kFrameDuration);
+  EXPECT_THAT(transform_system->GetLocalTranslation(entity),
+              NearMathfuVec3(translation, kDefaultEpsilon));
+}
+
 }  // namespace
 }  // namespace lull
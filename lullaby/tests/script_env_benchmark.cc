@@ -91,6 +91,25 @@ static void BM_Lullscript(benchmark::State& state) {
 }
 BENCHMARK(BM_Lullscript);
 
+// Arithmetic-heavy loop where every intermediate result is a scalar value.
+static const char* kArithmeticBenchmarkSrc =
+    "(do "
+    "(= sum 0) "
+    "(= total 0.0f) "
+    "(array-foreach [0 1 2 3 4 5 6 7 8 9 10 11 12 13 14 15] (i v) "
+    "  (= sum (+ sum (* v 2) (- v 1))) "
+    "  (= total (+ total (* 0.5f 2.0f) (- 1.0f 0.5f)))) "
+    ")";
+
+static void BM_LullscriptArithmetic(benchmark::State& state) {
+  ScriptEnv env;
+  auto script = env.Read(kArithmeticBenchmarkSrc);
+  while (state.KeepRunning()) {
+    env.Eval(script);
+  }
+}
+BENCHMARK(BM_LullscriptArithmetic);
+
 // This test verifies that the benchmark code actually behaves correctly.
 TEST(ScriptEnvBenchmarkTest, BenchmarkTestVerification) {
   Registry registry;
@@ -126,5 +145,14 @@ TEST(ScriptEnvBenchmarkTest, BenchmarkTestVerification) {
   EXPECT_THAT(qt.scalar(), Eq(mathfu::quat(2, 3, 4, 1).scalar()));
 }
 
+TEST(ScriptEnvBenchmarkTest, ArithmeticBenchmarkTestVerification) {
+  ScriptEnv env;
+  auto script = env.Read(kArithmeticBenchmarkSrc);
+  env.Eval(script);
+
+  EXPECT_THAT(*env.GetValue(Symbol("sum")).Get<int>(), Eq(344));
+  EXPECT_THAT(*env.GetValue(Symbol("total")).Get<float>(), Eq(24.f));
+}
+
 }  // namespace
 }  // namespace lull
@@ -15,6 +15,9 @@ limitations under the License.
 */
 
 #include "lullaby/modules/lullscript/script_value.h"
+
+#include <string>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
@@ -77,13 +80,17 @@ TEST(ScriptValueTest, CopyAssignMove) {
   EXPECT_TRUE(value1.Is<float>());
   EXPECT_TRUE(value2.Is<float>());
   EXPECT_TRUE(value3.IsNil());
-  EXPECT_THAT(value1.Get<float>(), Eq(value2.Get<float>()));
+  EXPECT_THAT(*value1.Get<float>(), Eq(*value2.Get<float>()));
 
+  // Scalars are copied by value.
   value2.Set(789);
-  EXPECT_TRUE(value1.Is<int>());
+  EXPECT_TRUE(value1.Is<float>());
   EXPECT_TRUE(value2.Is<int>());
   EXPECT_TRUE(value3.IsNil());
-  EXPECT_THAT(value1.Get<int>(), Eq(value2.Get<int>()));
+
+  value1 = value2;
+  EXPECT_TRUE(value1.Is<int>());
+  EXPECT_THAT(*value1.Get<int>(), Eq(*value2.Get<int>()));
 
   value1 = value3;
   EXPECT_TRUE(value1.IsNil());
@@ -100,7 +107,7 @@ TEST(ScriptValueTest, CopyAssignMove) {
   EXPECT_TRUE(value2.IsNil());
   EXPECT_TRUE(value3.IsNil());
   EXPECT_TRUE(value4.Is<int>());
-  EXPECT_THAT(value1.Get<int>(), Eq(value4.Get<int>()));
+  EXPECT_THAT(*value1.Get<int>(), Eq(*value4.Get<int>()));
 
   ScriptValue value5 = std::move(value1);
   EXPECT_TRUE(value1.IsNil());
@@ -108,7 +115,49 @@ TEST(ScriptValueTest, CopyAssignMove) {
   EXPECT_TRUE(value3.IsNil());
   EXPECT_TRUE(value4.Is<int>());
   EXPECT_TRUE(value5.Is<int>());
-  EXPECT_THAT(value4.Get<int>(), Eq(value5.Get<int>()));
+  EXPECT_THAT(*value4.Get<int>(), Eq(*value5.Get<int>()));
+}
+
+TEST(ScriptValueTest, SharedValues) {
+  ScriptValue value1 = ScriptValue::Create(std::string("hello"));
+  ScriptValue value2 = value1;
+  EXPECT_THAT(value1.Get<std::string>(), Eq(value2.Get<std::string>()));
+
+  // Non-scalar values are shared, so changing one changes all of them.
+  value2.Set(std::string("world"));
+  EXPECT_THAT(*value1.Get<std::string>(), Eq("world"));
+
+  // Scalars are never shared, so setting one only changes that value.
+  value2.Set(123);
+  EXPECT_TRUE(value1.Is<std::string>());
+  EXPECT_THAT(*value1.Get<std::string>(), Eq("world"));
+  EXPECT_THAT(*value2.Get<int>(), Eq(123));
+
+  value2.SetFromVariant(Variant(std::string("again")));
+  EXPECT_THAT(*value1.Get<std::string>(), Eq("world"));
+  EXPECT_THAT(*value2.Get<std::string>(), Eq("again"));
+
+  ScriptValue value3 = ScriptValue::Clone(value1);
+  value3.Set(std::string("clone"));
+  EXPECT_THAT(*value1.Get<std::string>(), Eq("world"));
+  EXPECT_THAT(*value3.Get<std::string>(), Eq("clone"));
+}
+
+TEST(ScriptValueTest, PromotedScalarsAreNotShared) {
+  ScriptValue value1 = ScriptValue::Create(123);
+  ASSERT_THAT(value1.GetVariant(), NotNull());
+
+  // Moving the scalar into a Variant doesn't make copies share it.
+  ScriptValue value2 = value1;
+  value2.Set(456);
+  EXPECT_THAT(*value1.Get<int>(), Eq(123));
+  *value2.Get<int>() = 789;
+  EXPECT_THAT(*value1.Get<int>(), Eq(123));
+
+  ScriptValue value3;
+  value3 = value1;
+  *value1.Get<int>() = 0;
+  EXPECT_THAT(*value3.Get<int>(), Eq(123));
 }
 
 TEST(ScriptValueTest, ImplicitCast) {
@@ -162,6 +211,13 @@ TEST(ScriptValueTest, Variant) {
   var = value.GetVariant();
   EXPECT_THAT(var, NotNull());
   EXPECT_THAT(var->GetTypeId(), Eq(GetTypeId<float>()));
+
+  value.SetFromVariant(Variant(std::string("hello")));
+  EXPECT_TRUE(value.Is<std::string>());
+  EXPECT_THAT(*value.ToVariant().Get<std::string>(), Eq("hello"));
+
+  value = ScriptValue::Create(789);
+  EXPECT_THAT(*value.ToVariant().Get<int>(), Eq(789));
 }
 
 }  // namespace
@@ -0,0 +1,224 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/util/small_flat_map.h"
+
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "lullaby/util/variant.h"
+
+namespace lull {
+namespace {
+
+using TestMap = SmallFlatMap<int, std::string, 4>;
+
+TEST(SmallFlatMap, Empty) {
+  TestMap map;
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(map.size(), 0u);
+  EXPECT_EQ(map.begin(), map.end());
+  EXPECT_FALSE(map.IsOnHeap());
+}
+
+TEST(SmallFlatMap, EmplaceAndFind) {
+  TestMap map;
+  auto res = map.emplace(2, "two");
+  EXPECT_TRUE(res.second);
+  EXPECT_EQ(res.first->first, 2);
+  EXPECT_EQ(res.first->second, "two");
+
+  // Emplacing an existing key does not replace the value.
+  res = map.emplace(2, "deux");
+  EXPECT_FALSE(res.second);
+  EXPECT_EQ(res.first->second, "two");
+
+  EXPECT_EQ(map.size(), 1u);
+  EXPECT_NE(map.find(2), map.end());
+  EXPECT_EQ(map.find(3), map.end());
+  EXPECT_EQ(map.count(2), 1u);
+  EXPECT_EQ(map.count(3), 0u);
+}
+
+TEST(SmallFlatMap, SortedIteration) {
+  TestMap map;
+  map[5] = "five";
+  map[1] = "one";
+  map[3] = "three";
+  map[2] = "two";
+
+  int prev = 0;
+  for (const auto& kv : map) {
+    EXPECT_LT(prev, kv.first);
+    prev = kv.first;
+  }
+  EXPECT_EQ(map[3], "three");
+}
+
+TEST(SmallFlatMap, SpillsToHeap) {
+  TestMap map;
+  for (int i = 10; i > 0; --i) {
+    map[i] = std::to_string(i);
+    EXPECT_EQ(map.IsOnHeap(), map.size() > 4);
+  }
+
+  EXPECT_EQ(map.size(), 10u);
+  int expected = 1;
+  for (const auto& kv : map) {
+    EXPECT_EQ(kv.first, expected);
+    EXPECT_EQ(kv.second, std::to_string(expected));
+    ++expected;
+  }
+}
+
+TEST(SmallFlatMap, Erase) {
+  TestMap map;
+  map[1] = "one";
+  map[2] = "two";
+  map[3] = "three";
+
+  EXPECT_EQ(map.erase(2), 1u);
+  EXPECT_EQ(map.erase(2), 0u);
+  EXPECT_EQ(map.size(), 2u);
+  EXPECT_EQ(map.find(2), map.end());
+  EXPECT_EQ(map[1], "one");
+  EXPECT_EQ(map[3], "three");
+
+  auto iter = map.erase(map.find(1));
+  EXPECT_EQ(iter->first, 3);
+  EXPECT_EQ(map.size(), 1u);
+
+  for (int i = 0; i < 10; ++i) {
+    map[i] = std::to_string(i);
+  }
+  EXPECT_EQ(map.erase(5), 1u);
+  EXPECT_EQ(map.size(), 9u);
+  EXPECT_EQ(map.find(5), map.end());
+  EXPECT_EQ(map[6], "6");
+}
+
+TEST(SmallFlatMap, Clear) {
+  TestMap map;
+  map[1] = "one";
+  map.clear();
+  EXPECT_TRUE(map.empty());
+
+  for (int i = 0; i < 10; ++i) {
+    map[i] = std::to_string(i);
+  }
+  map.clear();
+  EXPECT_TRUE(map.empty());
+  map[1] = "one";
+  EXPECT_EQ(map.size(), 1u);
+  EXPECT_EQ(map[1], "one");
+}
+
+TEST(SmallFlatMap, Copy) {
+  for (int count : {3, 10}) {
+    TestMap map;
+    for (int i = 0; i < count; ++i) {
+      map[i] = std::to_string(i);
+    }
+
+    TestMap copy(map);
+    EXPECT_EQ(copy.size(), map.size());
+    EXPECT_EQ(copy.IsOnHeap(), map.IsOnHeap());
+    for (const auto& kv : map) {
+      EXPECT_EQ(copy[kv.first], kv.second);
+    }
+
+    TestMap assigned;
+    assigned[100] = "hundred";
+    assigned = map;
+    EXPECT_EQ(assigned.size(), map.size());
+    EXPECT_EQ(assigned.count(100), 0u);
+  }
+}
+
+TEST(SmallFlatMap, Move) {
+  for (int count : {3, 10}) {
+    TestMap map;
+    for (int i = 0; i < count; ++i) {
+      map[i] = std::to_string(i);
+    }
+
+    TestMap moved(std::move(map));
+    EXPECT_EQ(moved.size(), static_cast<size_t>(count));
+    EXPECT_TRUE(map.empty());
+    EXPECT_EQ(moved[count - 1], std::to_string(count - 1));
+
+    TestMap assigned;
+    assigned[100] = "hundred";
+    assigned = std::move(moved);
+    EXPECT_EQ(assigned.size(), static_cast<size_t>(count));
+    EXPECT_EQ(assigned.count(100), 0u);
+    EXPECT_TRUE(moved.empty());
+  }
+}
+
+TEST(SmallFlatMap, NothrowMove) {
+  static_assert(std::is_nothrow_move_constructible<TestMap>::value, "");
+  static_assert(std::is_nothrow_move_assignable<TestMap>::value, "");
+  static_assert(std::is_nothrow_move_constructible<SmallVariantMap>::value,
+                "");
+  static_assert(std::is_nothrow_move_assignable<SmallVariantMap>::value, "");
+
+  // Growing a vector of maps moves the existing maps, so pointers to heap
+  // allocated elements remain valid.
+  std::vector<TestMap> maps(1);
+  for (int i = 0; i < 10; ++i) {
+    maps[0][i] = std::to_string(i);
+  }
+  const std::string* value = &maps[0][5];
+  maps.resize(maps.capacity() + 1);
+  EXPECT_EQ(&maps[0][5], value);
+}
+
+TEST(SmallFlatMap, RangeConstruction) {
+  std::unordered_map<int, std::string> source;
+  source[3] = "three";
+  source[1] = "one";
+  source[2] = "two";
+
+  TestMap map(source.begin(), source.end());
+  EXPECT_EQ(map.size(), 3u);
+  EXPECT_EQ(map.begin()->first, 1);
+  EXPECT_EQ(map[2], "two");
+
+  map.assign(source.begin(), source.begin());
+  EXPECT_TRUE(map.empty());
+}
+
+TEST(SmallFlatMap, DestroysValues) {
+  auto counter = std::make_shared<int>(0);
+  {
+    SmallFlatMap<int, std::shared_ptr<int>, 2> map;
+    for (int i = 0; i < 5; ++i) {
+      map[i] = counter;
+    }
+    EXPECT_EQ(counter.use_count(), 6);
+    map.erase(0);
+    EXPECT_EQ(counter.use_count(), 5);
+  }
+  EXPECT_EQ(counter.use_count(), 1);
+}
+
+}  // namespace
+}  // namespace lull
@@ -60,8 +60,11 @@ class StategraphPopulator {
     return *this;
   }
 
-  StategraphPopulator& AddTransition(size_t from, size_t to) {
+  StategraphPopulator& AddTransition(
+      size_t from, size_t to,
+      Clock::duration transition_time = Clock::duration(0)) {
     StategraphTransition transition;
+    transition.transition_time = transition_time;
     if (to < states_.size()) {
       transition.to_state = states_[to]->GetId();
     }
@@ -249,6 +252,64 @@ TEST(StategraphTest, StraightLineWithCyclesAndTwoPaths) {
   EXPECT_TRANSITION(path[1], 1, 4);
 }
 
+TEST(StategraphTest, ShortestTransitionTime) {
+  Stategraph sg;
+
+  // Create a graph that looks like:
+  //
+  // [0]--(10s)--[3]
+  //  |           |
+  // [1]--(1s)---[2]
+  //
+  // All other transitions are instant, so the longer path is faster.
+  StategraphPopulator(&sg)
+      .AddStates(4)
+      .AddTransition(0, 3, DurationFromSeconds(10.f))
+      .AddTransition(0, 1)
+      .AddTransition(1, 2, DurationFromSeconds(1.f))
+      .AddTransition(2, 3);
+
+  auto path = sg.FindPath(IndexToId(0), IndexToId(3));
+  EXPECT_THAT(path.size(), Eq(size_t(3)));
+  EXPECT_TRANSITION(path[0], 0, 1);
+  EXPECT_TRANSITION(path[1], 1, 2);
+  EXPECT_TRANSITION(path[2], 2, 3);
+
+  path = sg.FindPath(IndexToId(3), IndexToId(0));
+  EXPECT_TRUE(path.empty());
+}
+
+TEST(StategraphTest, AddStateAfterFindPath) {
+  Stategraph sg;
+
+  // Create a graph that looks like:
+  //
+  // [0]--[1]--[2]
+  //
+  // where [1] is only added after the first path is found.
+  auto state0 = MakeUnique<TestState>(IndexToId(0));
+  auto state1 = MakeUnique<TestState>(IndexToId(1));
+  auto state2 = MakeUnique<TestState>(IndexToId(2));
+  StategraphTransition transition;
+  transition.from_state = IndexToId(0);
+  transition.to_state = IndexToId(1);
+  state0->AddTransition(transition);
+  transition.from_state = IndexToId(1);
+  transition.to_state = IndexToId(2);
+  state1->AddTransition(transition);
+  sg.AddState(std::move(state0));
+  sg.AddState(std::move(state2));
+
+  auto path = sg.FindPath(IndexToId(0), IndexToId(2));
+  EXPECT_TRUE(path.empty());
+
+  sg.AddState(std::move(state1));
+  path = sg.FindPath(IndexToId(0), IndexToId(2));
+  EXPECT_THAT(path.size(), Eq(size_t(2)));
+  EXPECT_TRANSITION(path[0], 0, 1);
+  EXPECT_TRANSITION(path[1], 1, 2);
+}
+
 TEST(StategraphDeathTest, InvalidState) {
   Stategraph sg;
   StategraphPopulator(&sg).AddStates(2).AddTransition(0, 1);
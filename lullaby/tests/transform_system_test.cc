@@ -297,6 +297,45 @@ TEST_F(TransformSystemTest, SetSqt) {
   EXPECT_THAT(sqt->scale, EqualsMathfuVec3({2.f, 3.f, 4.f}));
 }
 
+TEST_F(TransformSystemTest, SetSqts) {
+  const Entity parent = 1;
+  const Entity child = 2;
+  const Entity other = 3;
+  CreateDefaultTransform(parent);
+  CreateDefaultTransform(child);
+  CreateDefaultTransform(other);
+
+  auto* transform_system = registry_.Get<TransformSystem>();
+  transform_system->AddChild(parent, child);
+
+  Sqt parent_sqt;
+  parent_sqt.translation = mathfu::vec3(1.f, 2.f, 3.f);
+  Sqt child_sqt;
+  child_sqt.translation = mathfu::vec3(10.f, 20.f, 30.f);
+  Sqt other_sqt;
+  other_sqt.scale = mathfu::vec3(2.f, 3.f, 4.f);
+
+  // The child comes before its parent to make sure its world matrix is still
+  // calculated from the updated parent.
+  const std::vector<Entity> entities = {child, parent, other};
+  const std::vector<Sqt> sqts = {child_sqt, parent_sqt, other_sqt};
+  transform_system->SetSqts(entities, sqts);
+
+  EXPECT_THAT(transform_system->GetSqt(parent)->translation,
+              EqualsMathfuVec3({1.f, 2.f, 3.f}));
+  EXPECT_THAT(transform_system->GetSqt(child)->translation,
+              EqualsMathfuVec3({10.f, 20.f, 30.f}));
+  EXPECT_THAT(transform_system->GetSqt(other)->scale,
+              EqualsMathfuVec3({2.f, 3.f, 4.f}));
+
+  Sqt sqt =
+      CalculateSqtFromMatrix(transform_system->GetWorldFromEntityMatrix(child));
+  EXPECT_THAT(sqt.translation, NearMathfuVec3({11.f, 22.f, 33.f}, kEpsilon));
+  sqt =
+      CalculateSqtFromMatrix(transform_system->GetWorldFromEntityMatrix(other));
+  EXPECT_THAT(sqt.scale, NearMathfuVec3({2.f, 3.f, 4.f}, kEpsilon));
+}
+
 TEST_F(TransformSystemTest, ApplySqt) {
   const Entity entity = 1;
   CreateDefaultTransform(entity);
@@ -1009,6 +1048,84 @@ TEST_F(TransformSystemTest, ForEachFiltered) {
   EXPECT_THAT(seen, Eq(std::unordered_set<Entity>{1}));
 }
 
+TEST_F(TransformSystemTest, ForEachDirty) {
+  CreateDefaultTransform(1);
+  CreateDefaultTransform(2);
+  CreateDefaultTransform(3);
+
+  std::unordered_set<Entity> seen;
+  auto fn = [&](Entity entity, const mathfu::mat4& matrix, const Aabb& aabb) {
+    seen.emplace(entity);
+  };
+
+  auto* transform_system = registry_.Get<TransformSystem>();
+  const TransformSystem::TransformFlags flag = transform_system->RequestFlag();
+  transform_system->SetFlag(1, flag);
+  transform_system->EnableDirtyTracking(flag);
+
+  // Entities that already have the flag start out dirty.
+  EXPECT_THAT(transform_system->IsDirty(1, flag), Eq(true));
+  transform_system->ForEachDirty(flag, fn);
+  EXPECT_THAT(seen, Eq(std::unordered_set<Entity>{1}));
+  EXPECT_THAT(transform_system->IsDirty(1, flag), Eq(false));
+  seen.clear();
+
+  // Nothing changed, so nothing is visited.
+  transform_system->ForEachDirty(flag, fn);
+  EXPECT_THAT(seen.empty(), Eq(true));
+
+  // Gaining the flag marks an Entity as dirty.
+  transform_system->SetFlag(2, flag);
+  transform_system->ForEachDirty(flag, fn);
+  EXPECT_THAT(seen, Eq(std::unordered_set<Entity>{2}));
+  seen.clear();
+
+  // Moving an Entity marks it as dirty, but only once per flag.
+  transform_system->SetLocalTranslation(1, mathfu::vec3(1.f, 2.f, 3.f));
+  transform_system->SetLocalTranslation(1, mathfu::vec3(3.f, 2.f, 1.f));
+  transform_system->SetLocalTranslation(3, mathfu::vec3(1.f, 2.f, 3.f));
+  int count = 0;
+  transform_system->ForEachDirty(
+      flag, [&](Entity entity, const mathfu::mat4& matrix, const Aabb& aabb) {
+        EXPECT_THAT(entity, Eq(Entity(1)));
+        EXPECT_THAT(matrix.TranslationVector3D(),
+                    NearMathfuVec3(mathfu::vec3(3.f, 2.f, 1.f), kEpsilon));
+        ++count;
+      });
+  EXPECT_THAT(count, Eq(1));
+
+  // Moving a parent marks its children as dirty.
+  transform_system->AddChild(3, 2);
+  transform_system->ForEachDirty(flag, fn);
+  seen.clear();
+  transform_system->SetLocalTranslation(3, mathfu::vec3(0.f, 1.f, 0.f));
+  transform_system->ForEachDirty(flag, fn);
+  EXPECT_THAT(seen, Eq(std::unordered_set<Entity>{2}));
+  seen.clear();
+
+  // ClearDirty removes a pending change.
+  transform_system->SetLocalTranslation(1, mathfu::vec3(0.f, 0.f, 1.f));
+  transform_system->ClearDirty(1, flag);
+  transform_system->ForEachDirty(flag, fn);
+  EXPECT_THAT(seen.empty(), Eq(true));
+
+  // Disabled Entities are skipped, and visited again once re-enabled.
+  transform_system->Disable(1);
+  transform_system->SetLocalTranslation(1, mathfu::vec3(0.f, 0.f, 2.f));
+  transform_system->ForEachDirty(flag, fn);
+  EXPECT_THAT(seen.empty(), Eq(true));
+  transform_system->Enable(1);
+  transform_system->ForEachDirty(flag, fn);
+  EXPECT_THAT(seen, Eq(std::unordered_set<Entity>{1}));
+  seen.clear();
+
+  // Destroyed Entities are never visited.
+  transform_system->SetLocalTranslation(1, mathfu::vec3(0.f, 0.f, 3.f));
+  transform_system->Destroy(1);
+  transform_system->ForEachDirty(flag, fn);
+  EXPECT_THAT(seen.empty(), Eq(true));
+}
+
 TEST_F(TransformSystemTest, ForAllDescendants) {
   CreateDefaultTransform(1);
   CreateDefaultTransform(2);
@@ -0,0 +1,435 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/tools/common/batch_runner.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include "lullaby/tools/common/file_utils.h"
+#include "lullaby/util/filename.h"
+#include "lullaby/util/job_processor.h"
+#include "lullaby/util/logging.h"
+
+namespace lull {
+namespace tool {
+namespace {
+
+constexpr const char* kBatchArg = "batch";
+
+// The 32-bit lull::Hash is too prone to collisions to identify file contents,
+// so cache keys use 64-bit FNV-1a instead.
+constexpr uint64_t kFnvOffsetBasis = 14695981039346656037ull;
+constexpr uint64_t kFnvPrime = 1099511628211ull;
+
+uint64_t HashBytes(uint64_t hash, const void* data, size_t size) {
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  for (size_t i = 0; i < size; ++i) {
+    hash = (hash ^ bytes[i]) * kFnvPrime;
+  }
+  return hash;
+}
+
+// Hashes |str| followed by a terminator, so that consecutive strings can't
+// produce the same key by moving characters between them.
+uint64_t HashString(uint64_t hash, const std::string& str) {
+  hash = HashBytes(hash, str.data(), str.size());
+  return HashBytes(hash, "", 1);
+}
+
+bool HashFile(const std::string& filename, uint64_t* hash) {
+  std::string contents;
+  if (!LoadFile(filename.c_str(), true, &contents)) {
+    return false;
+  }
+  *hash = HashBytes(kFnvOffsetBasis, contents.data(), contents.size());
+  return true;
+}
+
+std::string ToHex(uint64_t value) {
+  char buffer[17];
+  snprintf(buffer, sizeof(buffer), "%016llx",
+           static_cast<unsigned long long>(value));
+  return buffer;
+}
+
+enum class JobStatus {
+  kFailed,
+  kBuilt,
+  kCached,
+};
+
+const char* GetStatusName(JobStatus status) {
+  switch (status) {
+    case JobStatus::kBuilt:
+      return "built";
+    case JobStatus::kCached:
+      return "cached";
+    default:
+      return "FAILED";
+  }
+}
+
+struct Job {
+  int line_number = 0;
+  std::string line;
+  // The arguments for the job, with the program name as the first entry.
+  std::vector<std::string> args;
+  JobStatus status = JobStatus::kFailed;
+  double seconds = 0.0;
+};
+
+// Stores and restores job outputs.  Each entry is named by its key and has a
+// manifest file listing the job's dependencies (with their content hashes) and
+// outputs, followed by one file per output.  The manifest is written last, so
+// an entry is only used once it is complete.  Only jobs with the same key
+// (whose entries share files) are serialized; other jobs access the cache
+// concurrently.
+class BatchCache {
+ public:
+  explicit BatchCache(std::string directory)
+      : directory_(std::move(directory)) {}
+
+  // Restores the outputs of the entry for |key| if the entry exists and all of
+  // its dependencies are unchanged.
+  bool Restore(uint64_t key) {
+    std::lock_guard<std::mutex> lock(GetEntryMutex(key));
+    const std::string entry = GetEntryPath(key);
+    const std::string manifest_file = entry + ".manifest";
+    std::string manifest;
+    if (!FileExists(manifest_file.c_str()) ||
+        !LoadFile(manifest_file.c_str(), false, &manifest)) {
+      return false;
+    }
+
+    std::vector<std::string> outputs;
+    std::istringstream stream(manifest);
+    std::string type;
+    while (stream >> type) {
+      std::string path;
+      if (type == "dep") {
+        std::string expected;
+        uint64_t hash = 0;
+        stream >> expected;
+        std::getline(stream >> std::ws, path);
+        if (!HashFile(path, &hash) || ToHex(hash) != expected) {
+          return false;
+        }
+      } else if (type == "out") {
+        std::getline(stream >> std::ws, path);
+        outputs.push_back(std::move(path));
+      } else {
+        LOG(ERROR) << "Corrupt cache manifest: " << manifest_file;
+        return false;
+      }
+    }
+
+    for (size_t i = 0; i < outputs.size(); ++i) {
+      const std::string cached = entry + "." + std::to_string(i);
+      if (!CreateFolder(GetDirectoryFromFilename(outputs[i]).c_str()) ||
+          !CopyFile(outputs[i].c_str(), cached.c_str())) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Stores the outputs of a job under |key|.
+  void Store(uint64_t key, const BatchJobFiles& files) {
+    std::lock_guard<std::mutex> lock(GetEntryMutex(key));
+    const std::string entry = GetEntryPath(key);
+    std::ostringstream manifest;
+    for (const std::string& dependency : files.dependencies) {
+      uint64_t hash = 0;
+      if (!HashFile(dependency, &hash)) {
+        LOG(WARNING) << "Not caching job; unable to read " << dependency;
+        return;
+      }
+      manifest << "dep " << ToHex(hash) << " " << dependency << "\n";
+    }
+    for (size_t i = 0; i < files.outputs.size(); ++i) {
+      const std::string cached = entry + "." + std::to_string(i);
+      if (!CopyFile(cached.c_str(), files.outputs[i].c_str())) {
+        LOG(WARNING) << "Not caching job; unable to copy " << files.outputs[i];
+        return;
+      }
+      manifest << "out " << files.outputs[i] << "\n";
+    }
+
+    const std::string manifest_file = entry + ".manifest";
+    const std::string contents = manifest.str();
+    if (!SaveFile(contents.data(), contents.size(), manifest_file.c_str(),
+                  false)) {
+      LOG(WARNING) << "Unable to write cache manifest: " << manifest_file;
+    }
+  }
+
+ private:
+  std::string GetEntryPath(uint64_t key) const {
+    return JoinPath(directory_, ToHex(key));
+  }
+
+  // Each entry is guarded by one of a fixed set of mutexes, so that
+  // concurrent jobs with different keys rarely wait on each other.
+  static constexpr size_t kNumEntryMutexes = 64;
+
+  std::mutex& GetEntryMutex(uint64_t key) {
+    return entry_mutexes_[key % kNumEntryMutexes];
+  }
+
+  const std::string directory_;
+  std::mutex entry_mutexes_[kNumEntryMutexes];
+};
+
+// Returns a hash identifying the version of the tool that is running.
+uint64_t GetToolHash(const BatchTool& tool, const std::string& program) {
+  uint64_t hash = HashString(kFnvOffsetBasis, tool.version);
+  uint64_t executable = 0;
+  if (HashFile("/proc/self/exe", &executable) ||
+      HashFile(program, &executable)) {
+    hash = HashBytes(hash, &executable, sizeof(executable));
+  } else {
+    LOG(WARNING) << "Unable to read the tool executable; cached outputs will "
+                 << "only be invalidated when the tool version changes.";
+  }
+  return hash;
+}
+
+JobStatus ProcessJob(const BatchTool& tool, uint64_t tool_hash,
+                     BatchCache* cache, const Job& job) {
+  std::vector<const char*> argv;
+  for (const std::string& arg : job.args) {
+    argv.push_back(arg.c_str());
+  }
+
+  ArgParser args;
+  tool.add_args(&args);
+  if (!args.Parse(static_cast<int>(argv.size()), argv.data())) {
+    for (const std::string& error : args.GetErrors()) {
+      LOG(ERROR) << "Line " << job.line_number << ": " << error;
+    }
+    return JobStatus::kFailed;
+  }
+
+  uint64_t key = tool_hash;
+  for (size_t i = 1; i < job.args.size(); ++i) {
+    key = HashString(key, job.args[i]);
+  }
+  if (tool.get_inputs) {
+    std::vector<std::string> inputs;
+    tool.get_inputs(args, &inputs);
+    for (const std::string& input : inputs) {
+      uint64_t hash = 0;
+      if (!HashFile(input, &hash)) {
+        LOG(ERROR) << "Line " << job.line_number << ": Unable to read input "
+                   << input;
+        return JobStatus::kFailed;
+      }
+      key = HashString(key, input);
+      key = HashBytes(key, &hash, sizeof(hash));
+    }
+  }
+
+  if (cache && cache->Restore(key)) {
+    return JobStatus::kCached;
+  }
+
+  BatchJobFiles files;
+  if (tool.run(args, &files) != 0) {
+    return JobStatus::kFailed;
+  }
+  if (cache) {
+    cache->Store(key, files);
+  }
+  return JobStatus::kBuilt;
+}
+
+void LogTimingSummary(const std::vector<Job>& jobs, double seconds) {
+  int num_built = 0;
+  int num_cached = 0;
+  int num_failed = 0;
+  std::vector<const Job*> sorted;
+  for (const Job& job : jobs) {
+    switch (job.status) {
+      case JobStatus::kBuilt:
+        ++num_built;
+        break;
+      case JobStatus::kCached:
+        ++num_cached;
+        break;
+      case JobStatus::kFailed:
+        ++num_failed;
+        break;
+    }
+    sorted.push_back(&job);
+  }
+  std::stable_sort(sorted.begin(), sorted.end(),
+                   [](const Job* lhs, const Job* rhs) {
+                     return lhs->seconds > rhs->seconds;
+                   });
+
+  char buffer[64];
+  for (const Job* job : sorted) {
+    snprintf(buffer, sizeof(buffer), "%9.3fs %-7s line %d: ", job->seconds,
+             GetStatusName(job->status), job->line_number);
+    LOG(INFO) << buffer << job->line;
+  }
+  snprintf(buffer, sizeof(buffer), "%.3fs", seconds);
+  LOG(INFO) << jobs.size() << " jobs in " << buffer << ": " << num_built
+            << " built, " << num_cached << " cached, " << num_failed
+            << " failed.";
+}
+
+}  // namespace
+
+std::vector<std::string> SplitArgs(const std::string& line) {
+  std::vector<std::string> args;
+  std::string arg;
+  bool in_arg = false;
+  bool in_quotes = false;
+  for (char c : line) {
+    if (c == '"') {
+      in_quotes = !in_quotes;
+      in_arg = true;
+    } else if (!in_quotes && isspace(static_cast<unsigned char>(c))) {
+      if (in_arg) {
+        args.push_back(std::move(arg));
+        arg.clear();
+        in_arg = false;
+      }
+    } else {
+      arg += c;
+      in_arg = true;
+    }
+  }
+  if (in_arg) {
+    args.push_back(std::move(arg));
+  }
+  return args;
+}
+
+bool IsBatchMode(int argc, const char** argv) {
+  const std::string flag = std::string("--") + kBatchArg;
+  for (int i = 1; i < argc; ++i) {
+    if (flag == argv[i]) {
+      return true;
+    }
+  }
+  return false;
+}
+
+int RunBatch(const BatchTool& tool, int argc, const char** argv) {
+  ArgParser parser;
+  parser.AddArg(kBatchArg)
+      .SetNumArgs(1)
+      .SetRequired()
+      .SetDescription("Manifest file with the arguments of one job per line.");
+  parser.AddArg("jobs")
+      .SetNumArgs(1)
+      .SetDescription("Number of jobs to run concurrently. Defaults to the "
+                      "number of cores.");
+  parser.AddArg("cache")
+      .SetNumArgs(1)
+      .SetDescription("Directory in which to cache job outputs.");
+  if (!parser.Parse(argc, argv)) {
+    for (const std::string& error : parser.GetErrors()) {
+      LOG(ERROR) << error;
+    }
+    LOG(ERROR) << parser.GetUsage();
+    return -1;
+  }
+
+  const std::string manifest_file(parser.GetString(kBatchArg));
+  std::string manifest;
+  if (!LoadFile(manifest_file.c_str(), false, &manifest)) {
+    LOG(ERROR) << "Unable to load batch manifest: " << manifest_file;
+    return -1;
+  }
+
+  const std::string program = parser.GetProgram();
+  std::vector<Job> jobs;
+  std::istringstream stream(manifest);
+  std::string line;
+  for (int line_number = 1; std::getline(stream, line); ++line_number) {
+    std::vector<std::string> args = SplitArgs(line);
+    if (args.empty() || args[0][0] == '#') {
+      continue;
+    }
+    jobs.emplace_back();
+    Job& job = jobs.back();
+    job.line_number = line_number;
+    job.line = line;
+    job.args.push_back(program);
+    job.args.insert(job.args.end(), args.begin(), args.end());
+  }
+
+  std::unique_ptr<BatchCache> cache;
+  if (parser.IsSet("cache")) {
+    const std::string cache_dir(parser.GetString("cache"));
+    if (!CreateFolder(cache_dir.c_str())) {
+      LOG(ERROR) << "Could not create cache directory: " << cache_dir;
+      return -1;
+    }
+    cache.reset(new BatchCache(cache_dir));
+  }
+
+  int num_threads = parser.IsSet("jobs") ? parser.GetInt("jobs") : 0;
+  if (num_threads <= 0) {
+    num_threads = static_cast<int>(std::thread::hardware_concurrency());
+  }
+  num_threads = std::max(1, num_threads);
+
+  using Clock = std::chrono::steady_clock;
+  using Seconds = std::chrono::duration<double>;
+  const Clock::time_point start = Clock::now();
+  const uint64_t tool_hash = GetToolHash(tool, program);
+  {
+    JobProcessor processor(static_cast<size_t>(num_threads));
+    std::vector<std::future<void>> futures;
+    futures.reserve(jobs.size());
+    BatchCache* cache_ptr = cache.get();
+    for (Job& job : jobs) {
+      Job* job_ptr = &job;
+      auto fn = [&tool, tool_hash, cache_ptr, job_ptr]() {
+        const Clock::time_point job_start = Clock::now();
+        job_ptr->status = ProcessJob(tool, tool_hash, cache_ptr, *job_ptr);
+        job_ptr->seconds = Seconds(Clock::now() - job_start).count();
+      };
+      futures.push_back(RunJob(&processor, fn));
+    }
+    for (std::future<void>& future : futures) {
+      future.wait();
+    }
+  }
+  LogTimingSummary(jobs, Seconds(Clock::now() - start).count());
+
+  for (const Job& job : jobs) {
+    if (job.status == JobStatus::kFailed) {
+      return -1;
+    }
+  }
+  return 0;
+}
+
+}  // namespace tool
+}  // namespace lull
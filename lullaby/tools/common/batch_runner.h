@@ -0,0 +1,88 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef LULLABY_TOOLS_COMMON_BATCH_RUNNER_H_
+#define LULLABY_TOOLS_COMMON_BATCH_RUNNER_H_
+
+#include <functional>
+#include <string>
+#include <vector>
+#include "lullaby/util/arg_parser.h"
+
+namespace lull {
+namespace tool {
+
+// Files that were read and written by a single job of a batch.
+struct BatchJobFiles {
+  // Files that were read by the job but could not be known from its
+  // arguments alone (eg. textures referenced by a model).
+  std::vector<std::string> dependencies;
+
+  // Files that were written by the job.
+  std::vector<std::string> outputs;
+};
+
+// Describes how a command-line tool runs a single job so that many jobs can be
+// run by a single process.
+struct BatchTool {
+  // A version string for the tool.  Changing it invalidates all of the tool's
+  // cached outputs.  The contents of the tool's executable are also included
+  // in every cache key, so this only needs to change for behavior that is not
+  // compiled into the tool.
+  std::string version;
+
+  // Adds the arguments accepted by a single job to |args|.
+  std::function<void(ArgParser* args)> add_args;
+
+  // Adds the files named by the job's |args| that are read by the job to
+  // |inputs|.
+  std::function<void(const ArgParser& args, std::vector<std::string>* inputs)>
+      get_inputs;
+
+  // Runs the job with the given |args| and records the other files it read
+  // and wrote in |files|.  Returns 0 on success.  Jobs are run concurrently,
+  // so this function must be thread-safe.
+  std::function<int(const ArgParser& args, BatchJobFiles* files)> run;
+};
+
+// Splits a line of a batch manifest into arguments.  Arguments are separated
+// by whitespace unless they are enclosed in double quotes.
+std::vector<std::string> SplitArgs(const std::string& line);
+
+// Returns true if the command line requests batch mode, ie. it contains a
+// --batch argument.
+bool IsBatchMode(int argc, const char** argv);
+
+// Runs a batch of jobs for |tool|.  The command line accepts:
+//   --batch <file>:  A manifest with one job per line.  Each line holds the
+//                    arguments for a single job, exactly as they would be
+//                    passed on the command line.  Arguments containing spaces
+//                    may be double-quoted.  Empty lines and lines starting
+//                    with '#' are ignored.
+//   --jobs <n>:      The number of jobs to run concurrently.  Defaults to the
+//                    number of cores.
+//   --cache <dir>:   A directory used to cache job outputs.  A job is skipped,
+//                    and its outputs are restored from the cache, if its
+//                    arguments, the contents of its inputs and dependencies,
+//                    and the tool version all match a previous run.
+// Once all jobs are complete, a timing summary is logged.  Returns 0 if all
+// jobs succeeded.
+int RunBatch(const BatchTool& tool, int argc, const char** argv);
+
+}  // namespace tool
+}  // namespace lull
+
+#endif  // LULLABY_TOOLS_COMMON_BATCH_RUNNER_H_
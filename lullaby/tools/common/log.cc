@@ -22,7 +22,8 @@ limitations under the License.
 namespace lull {
 
 namespace {
-  FILE* g_log_handle = nullptr;
+  // Each thread has its own log so that batched jobs can run concurrently.
+  thread_local FILE* g_log_handle = nullptr;
 }
 
 void LogOpen(const char* log_file) {
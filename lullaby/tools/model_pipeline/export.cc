@@ -16,6 +16,7 @@ limitations under the License.
 
 #include "lullaby/tools/model_pipeline/export.h"
 
+#include <algorithm>
 #include <fstream>
 #include <iomanip>
 #include <limits>
@@ -27,6 +28,7 @@ limitations under the License.
 #include "lullaby/generated/model_pipeline_def_generated.h"
 #include "lullaby/tools/common/log.h"
 #include "lullaby/tools/model_pipeline/export_options.h"
+#include "lullaby/tools/model_pipeline/simplify.h"
 #include "lullaby/tools/model_pipeline/util.h"
 #include "mathfu/io.h"
 #include "openssl/sha.h"
@@ -527,11 +529,19 @@ ByteArray ExportModel(
 
   // Export model lods.
   LogWrite("Render Models:\n");
+  const Model* base_model = nullptr;
+  std::vector<size_t> lod_triangle_counts;
   for (const auto& iter : models) {
     const Model& model = iter.second;
     if (model.CheckUsage(Model::kForRendering)) {
       const int level = model.GetLodLevel();
-      model_def.lods.resize(level + 1);
+      model_def.lods.resize(std::max(model_def.lods.size(),
+                                     static_cast<size_t>(level + 1)));
+      lod_triangle_counts.resize(model_def.lods.size(), 0);
+      lod_triangle_counts[level] = GetNumTriangles(model);
+      if (level == 0) {
+        base_model = &model;
+      }
       LogWrite("  Model %s:\n", pipeline_def.renderables.size());
       pipeline_def.renderables.emplace_back();
       ExportModelInstance(model, &model_def.lods[level],
@@ -539,6 +549,37 @@ ByteArray ExportModel(
     }
   }
 
+  // Generate the remaining lods by simplifying the previous one.  Generated
+  // lods are not added to the pipeline config since they have no source.
+  if (base_model && model_def.lods.size() == 1 && options.num_lods > 1) {
+    SimplifyOptions simplify_options;
+    simplify_options.target_ratio = options.lod_target_ratio;
+    simplify_options.max_error = options.lod_max_error;
+
+    Model previous = *base_model;
+    for (int level = 1; level < options.num_lods; ++level) {
+      Model lod = SimplifyModel(previous, simplify_options);
+      const size_t num_triangles = GetNumTriangles(lod);
+      if (num_triangles == 0 || num_triangles >= lod_triangle_counts.back()) {
+        LogWrite("  Stopped generating lods at level %d.\n", level);
+        break;
+      }
+
+      LogWrite("  Generated lod %d: %d triangles\n", level,
+               static_cast<int>(num_triangles));
+      ModelPipelineRenderableDefT unused_config;
+      model_def.lods.emplace_back();
+      ExportModelInstance(lod, &model_def.lods.back(), &unused_config,
+                          options);
+      lod_triangle_counts.push_back(num_triangles);
+      previous = std::move(lod);
+    }
+  }
+  if (model_def.lods.size() > 1) {
+    model_def.lod_screen_sizes = ComputeLodScreenSizes(
+        lod_triangle_counts, options.lod_base_screen_size);
+  }
+
   // Export collidables.
   for (const auto& iter : models) {
     const Model& model = iter.second;
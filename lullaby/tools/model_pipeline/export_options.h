@@ -38,6 +38,21 @@ struct ExportOptions {
   // If true, attempt a saving-throw on untextured materials by performing
   // a texture lookup based on the surface name.
   bool look_for_unlinked_textures = false;
+
+  // The total number of LODs to export.  If the renderables only provide the
+  // base LOD, the remaining LODs are generated by simplifying the previous LOD.
+  int num_lods = 1;
+
+  // The fraction of triangles each generated LOD keeps from the previous LOD.
+  float lod_target_ratio = 0.5f;
+
+  // The maximum error each generated LOD may introduce, relative to the
+  // diagonal of the model's bounding box.  Zero means unbounded.
+  float lod_max_error = 0.f;
+
+  // The screen size (as a fraction of the viewport height) below which the
+  // renderer switches from the base LOD to the first simplified LOD.
+  float lod_base_screen_size = 0.5f;
 };
 
 }  // namespace tool
@@ -18,9 +18,12 @@ limitations under the License.
 #include <unistd.h>
 #endif // !defined(_WINDOWS) && !defined(_WIN32)
 
+#include <mutex>
+
 #include "flatbuffers/util.h"
 #include "lullaby/util/arg_parser.h"
 #include "lullaby/util/filename.h"
+#include "lullaby/tools/common/batch_runner.h"
 #include "lullaby/tools/common/file_utils.h"
 #include "lullaby/tools/common/log.h"
 #include "lullaby/tools/model_pipeline/export_options.h"
@@ -32,23 +35,55 @@ namespace tool {
 Model ImportFbx(const ModelPipelineImportDefT& import_def);
 Model ImportAsset(const ModelPipelineImportDefT& import_def);
 
-int Run(int argc, const char** argv) {
-  ArgParser args;
-  args.AddArg("input").SetNumArgs(1).SetDescription("Asset file to process.");
-  args.AddArg("config-json")
+// The version of the model pipeline used to identify cached batch outputs.
+constexpr const char* kToolVersion = "model_pipeline-1";
+
+// Assimp and the FBX SDK both use global state, so only one asset is imported
+// at a time.  The rest of the pipeline (eg. LOD generation and export) can run
+// concurrently in batch mode.
+std::mutex g_import_mutex;
+
+Model ImportFbxSerialized(const ModelPipelineImportDefT& import_def) {
+  std::lock_guard<std::mutex> lock(g_import_mutex);
+  return ImportFbx(import_def);
+}
+
+Model ImportAssetSerialized(const ModelPipelineImportDefT& import_def) {
+  std::lock_guard<std::mutex> lock(g_import_mutex);
+  return ImportAsset(import_def);
+}
+
+// Splits the semi-colon delimited list of textures passed on the command line.
+std::vector<std::string> GetTextures(const ArgParser& args) {
+  std::vector<std::string> textures;
+  std::string temp(args.GetString("textures"));
+  while (true) {
+    auto pos = temp.find(';');
+    if (pos == std::string::npos) {
+      break;
+    }
+    textures.push_back(temp.substr(0, pos));
+    temp = temp.substr(pos + 1);
+  }
+  return textures;
+}
+
+void AddArgs(ArgParser* args) {
+  args->AddArg("input").SetNumArgs(1).SetDescription("Asset file to process.");
+  args->AddArg("config-json")
       .SetNumArgs(1)
       .SetDescription("Config file to process.");
-  args.AddArg("output")
+  args->AddArg("output")
       .SetRequired()
       .SetNumArgs(1)
       .SetDescription("Mesh file to save.");
-  args.AddArg("outdir")
+  args->AddArg("outdir")
       .SetNumArgs(1)
       .SetDescription("Location (path) to save file.");
-  args.AddArg("textures")
+  args->AddArg("textures")
       .SetNumArgs(1)
       .SetDescription("List of semi-colon delimited textures.");
-  args.AddArg("attrib")
+  args->AddArg("attrib")
       .SetNumArgs(1)
       .SetDescription("A list of characters describing the vertex attributes to"
                       "be exported. \n"
@@ -59,36 +94,57 @@ int Run(int argc, const char** argv) {
                       "c - 32-bit RGBA color\n"
                       "u - 2D texture coordinates (uvs)\n"
                       "b - Bone influences (indices and weights)");
-  args.AddArg("schema")
+  args->AddArg("schema")
       .SetNumArgs(1)
       .SetDescription("Path to the model_pipeline_def.fbs schema file.");
-  args.AddArg("ext")
+  args->AddArg("ext")
       .SetNumArgs(1)
       .SetDescription("Extension to use for the output file.");
-  args.AddArg("save-config")
+  args->AddArg("save-config")
       .SetDescription("Export a config file.");
-  args.AddArg("log")
+  args->AddArg("log")
       .SetDescription("Write a log file to the output directory. The log file"
                       " will be named the same as the output file with the"
                       " extension changed to '.log'.");
-  args.AddArg("discrete-textures")
+  args->AddArg("discrete-textures")
       .SetDescription("Don't embed textures in the lullmodel. The dependent"
                       " textures will be copied to the output directory beside"
                       " the lullmodel.");
-  args.AddArg("use-relative-paths")
+  args->AddArg("use-relative-paths")
       .SetDescription(
           "Paths embeded within the lullmodel will use relative paths.");
+  args->AddArg("lods")
+      .SetNumArgs(1)
+      .SetDescription("Total number of LODs to export. Missing LODs are"
+                      " generated by simplifying the previous LOD.");
+  args->AddArg("lod-ratio")
+      .SetNumArgs(1)
+      .SetDescription("Fraction of triangles each generated LOD keeps from the"
+                      " previous LOD. Defaults to 0.5.");
+  args->AddArg("lod-max-error")
+      .SetNumArgs(1)
+      .SetDescription("Maximum error each generated LOD may introduce, relative"
+                      " to the size of the model. Defaults to unbounded.");
+  args->AddArg("lod-screen-size")
+      .SetNumArgs(1)
+      .SetDescription("Screen size (fraction of the viewport height) below"
+                      " which the first generated LOD is used. Defaults to"
+                      " 0.5.");
+}
 
-  // Parse the command-line arguments.
-  if (!args.Parse(argc, argv)) {
-    auto& errors = args.GetErrors();
-    for (auto& err : errors) {
-      std::cout << "Error: " << err << std::endl;
-    }
-    std::cout << args.GetUsage() << std::endl;
-    return -1;
+void GetInputs(const ArgParser& args, std::vector<std::string>* inputs) {
+  if (args.IsSet("input")) {
+    inputs->emplace_back(args.GetString("input"));
+  }
+  if (args.IsSet("schema")) {
+    inputs->emplace_back(args.GetString("schema"));
+  }
+  for (const std::string& texture : GetTextures(args)) {
+    inputs->push_back(texture);
   }
+}
 
+int RunJob(const ArgParser& args, BatchJobFiles* files) {
   const std::string output(args.GetString("output"));
   std::string out_dir = GetDirectoryFromFilename(output);
   if (args.IsSet("outdir")) {
@@ -102,6 +158,7 @@ int Run(int argc, const char** argv) {
   if (args.IsSet("log")) {
     const std::string log_path = RemoveExtensionFromFilename(output) + ".log";
     LogOpen(log_path.c_str());
+    files->outputs.push_back(log_path);
   }
 
   const std::string mesh_name = RemoveDirectoryAndExtensionFromFilename(
@@ -126,19 +183,13 @@ int Run(int argc, const char** argv) {
   LogWrite("output:            %s\n\n", outfile.c_str());
 
   ModelPipeline pipeline;
-  pipeline.RegisterImporter(ImportFbx, ".fbx");
-  pipeline.RegisterImporter(ImportAsset, ".dae");
-  pipeline.RegisterImporter(ImportAsset, ".gltf");
-  pipeline.RegisterImporter(ImportAsset, ".obj");
+  pipeline.RegisterImporter(ImportFbxSerialized, ".fbx");
+  pipeline.RegisterImporter(ImportAssetSerialized, ".dae");
+  pipeline.RegisterImporter(ImportAssetSerialized, ".gltf");
+  pipeline.RegisterImporter(ImportAssetSerialized, ".obj");
 
-  std::string temp(args.GetString("textures"));
-  while (true) {
-    auto pos = temp.find(';');
-    if (pos == std::string::npos) {
-      break;
-    }
-    pipeline.RegisterTexture(temp.substr(0, pos));
-    temp = temp.substr(pos + 1);
+  for (const std::string& texture : GetTextures(args)) {
+    pipeline.RegisterTexture(texture);
   }
   if (args.IsSet("schema")) {
     pipeline.SetModelDefSchema(std::string(args.GetString("schema")));
@@ -181,9 +232,21 @@ int Run(int argc, const char** argv) {
   ExportOptions options;
   options.embed_textures = !args.IsSet("discrete-textures");
   options.relative_path = args.IsSet("use-relative-paths");
+  if (args.IsSet("lods")) {
+    options.num_lods = args.GetInt("lods");
+  }
+  if (args.IsSet("lod-ratio")) {
+    options.lod_target_ratio = args.GetFloat("lod-ratio");
+  }
+  if (args.IsSet("lod-max-error")) {
+    options.lod_max_error = args.GetFloat("lod-max-error");
+  }
+  if (args.IsSet("lod-screen-size")) {
+    options.lod_base_screen_size = args.GetFloat("lod-screen-size");
+  }
   if (args.IsSet("config-json")) {
     const string_view json = args.GetString("config-json");
-    if (!pipeline.ImportUsingConfig(std::string(json))) {
+    if (!pipeline.ImportUsingConfig(std::string(json), options)) {
       return -1;
     }
   } else {
@@ -201,6 +264,8 @@ int Run(int argc, const char** argv) {
     LOG(ERROR) << "Unable to save model.";
     return -1;
   }
+  files->outputs.push_back(outfile);
+  files->dependencies = pipeline.GetOpenedFilePaths();
 
   // If we are not embedding the textures in the lullmodel, copy the textures
   // into the output directory.
@@ -211,6 +276,7 @@ int Run(int argc, const char** argv) {
           JoinPath(out_dir, GetBasenameFromFilename(src_texture));
       if (CopyFile(dst_texture.c_str(), src_texture.c_str())) {
         LogWrite("Copied %s to %s\n", src_texture.c_str(), dst_texture.c_str());
+        files->outputs.push_back(dst_texture);
       } else {
         LogWrite("Failed to copy %s to %s\n", src_texture.c_str(),
                  dst_texture.c_str());
@@ -225,6 +291,7 @@ int Run(int argc, const char** argv) {
       LOG(ERROR) << "Unable to save renderable.";
       return -1;
     }
+    files->outputs.push_back(outfile);
   }
 
   LogClose();
@@ -232,6 +299,38 @@ int Run(int argc, const char** argv) {
   return 0;
 }
 
+int Run(int argc, const char** argv) {
+  if (IsBatchMode(argc, argv)) {
+    BatchTool tool;
+    tool.version = kToolVersion;
+    tool.add_args = AddArgs;
+    tool.get_inputs = GetInputs;
+    tool.run = [](const ArgParser& args, BatchJobFiles* files) {
+      const int result = RunJob(args, files);
+      // Failed jobs may return before closing their log, and the log is
+      // per-thread, so make sure it isn't reused by the next job.
+      LogClose();
+      return result;
+    };
+    return RunBatch(tool, argc, argv);
+  }
+
+  // Parse the command-line arguments.
+  ArgParser args;
+  AddArgs(&args);
+  if (!args.Parse(argc, argv)) {
+    auto& errors = args.GetErrors();
+    for (auto& err : errors) {
+      std::cout << "Error: " << err << std::endl;
+    }
+    std::cout << args.GetUsage() << std::endl;
+    return -1;
+  }
+
+  BatchJobFiles files;
+  return RunJob(args, &files);
+}
+
 }  // namespace tool
 }  // namespace lull
 
@@ -254,9 +254,11 @@ bool ModelPipeline::ImportFile(const std::string& source,
   return Import(flatbuffers::GetRoot<ModelPipelineDef>(buffer.data()), options);
 }
 
-bool ModelPipeline::ImportUsingConfig(const std::string& json) {
+bool ModelPipeline::ImportUsingConfig(const std::string& json,
+                                      const ExportOptions& options) {
   flatbuffers::DetachedBuffer buffer = FromString(json, schema_);
-  return Import(flatbuffers::GetRoot<ModelPipelineDef>(buffer.data()));
+  return Import(flatbuffers::GetRoot<ModelPipelineDef>(buffer.data()),
+                options);
 }
 
 bool ModelPipeline::Import(const ModelPipelineDef* config,
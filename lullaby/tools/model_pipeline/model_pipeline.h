@@ -71,7 +71,8 @@ class ModelPipeline {
 
   // Imports model data from the specified json string config. The contents of
   // the json string should be a ModelPipelineDef object.
-  bool ImportUsingConfig(const std::string& json);
+  bool ImportUsingConfig(const std::string& json,
+                         const ExportOptions& options = ExportOptions());
 
   // Returns the LullModel binary object.
   const ByteArray& GetLullModel() const { return lull_model_; }
@@ -0,0 +1,62 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef LULLABY_TOOLS_MODEL_PIPELINE_SIMPLIFY_H_
+#define LULLABY_TOOLS_MODEL_PIPELINE_SIMPLIFY_H_
+
+#include <vector>
+#include "lullaby/tools/model_pipeline/model.h"
+
+namespace lull {
+namespace tool {
+
+// Options that control how much a model is simplified.
+struct SimplifyOptions {
+  // The fraction of triangles to keep.
+  float target_ratio = 0.5f;
+
+  // The maximum distance any surface is allowed to move, relative to the
+  // diagonal of the model's bounding box.  Simplification stops early if the
+  // target ratio cannot be reached without exceeding this error.  A value of
+  // zero means the error is unbounded.
+  float max_error = 0.f;
+};
+
+// Returns a simplified copy of |model| generated using quadric error metric
+// edge collapses.  The remaining vertices are a subset of the original
+// vertices, so all of their attributes (including skin weights) are preserved.
+// UV/normal seams, material boundaries and open borders are never collapsed.
+//
+// The returned model has the same import def, bones, attributes and materials
+// as |model|, but no usage flags and an LOD level of 0.
+Model SimplifyModel(const Model& model, const SimplifyOptions& options);
+
+// Returns the number of triangles in all the drawables of |model|.
+size_t GetNumTriangles(const Model& model);
+
+// Calculates the screen-size thresholds for a chain of LODs given the number
+// of triangles in each LOD.  The screen size is the fraction of the viewport
+// height covered by the model's bounds.  LOD i should be used while the model's
+// screen size is greater than or equal to the i-th threshold, which results in
+// a roughly constant triangle density on screen.  The first threshold is
+// |base_screen_size| and the last one is always 0.
+std::vector<float> ComputeLodScreenSizes(
+    const std::vector<size_t>& triangle_counts, float base_screen_size);
+
+}  // namespace tool
+}  // namespace lull
+
+#endif  // LULLABY_TOOLS_MODEL_PIPELINE_SIMPLIFY_H_
@@ -20,6 +20,7 @@ limitations under the License.
 #include "lullaby/util/common_types.h"
 #include "lullaby/util/filename.h"
 #include "lullaby/util/logging.h"
+#include "lullaby/tools/common/batch_runner.h"
 #include "lullaby/tools/common/file_utils.h"
 #include "lullaby/tools/texture_pipeline/encode_astc.h"
 #include "lullaby/tools/texture_pipeline/encode_jpg.h"
@@ -31,23 +32,38 @@ limitations under the License.
 namespace lull {
 namespace tool {
 
-int Run(int argc, const char** argv) {
-  ArgParser parser;
-  parser.AddArg("in").SetNumArgs(1).SetRequired();
-  parser.AddArg("out").SetNumArgs(1).SetRequired();
-  parser.AddArg("mipmap");
-  parser.AddArg("cubemap");
-  parser.AddArg("generate_mipmap_levels");
+// The version of the texture pipeline used to identify cached batch outputs.
+constexpr const char* kToolVersion = "texture_pipeline-1";
 
-  if (!parser.Parse(argc, argv)) {
-    LOG(ERROR) << "Failed to parse args:";
-    const auto& errors = parser.GetErrors();
-    for (const auto& error : errors) {
-      LOG(ERROR) << error;
-    }
-    return -1;
+void AddArgs(ArgParser* parser) {
+  parser->AddArg("in").SetNumArgs(1).SetRequired();
+  parser->AddArg("out").SetNumArgs(1).SetRequired();
+  parser->AddArg("mipmap");
+  parser->AddArg("cubemap");
+  parser->AddArg("generate_mipmap_levels");
+  parser->AddArg("mipmap_filter")
+      .SetNumArgs(1)
+      .SetDescription("Filter used to generate mipmap levels: box or kaiser. "
+                      "Defaults to box.");
+  parser->AddArg("srgb").SetDescription(
+      "Treats the color channels as sRGB encoded, so mipmap levels are "
+      "filtered in linear space.");
+  parser->AddArg("threads")
+      .SetNumArgs(1)
+      .SetDescription("Number of threads used to generate mipmap levels. "
+                      "Defaults to the number of cores, or 1 in batch mode.");
+}
+
+void GetInputs(const ArgParser& parser, std::vector<std::string>* inputs) {
+  for (uint32_t i = 0; i < parser.GetNumValues("in"); ++i) {
+    inputs->emplace_back(parser.GetString("in", i));
   }
+}
 
+// Converts the images given by |parser|.  |default_threads| is the number of
+// threads used to generate mipmaps if the job doesn't specify it.
+int RunJob(const ArgParser& parser, int default_threads,
+           BatchJobFiles* files) {
   std::vector<std::string> data;
   std::vector<ImageData> images;
   for (uint32_t i = 0; i < parser.GetNumValues("in"); ++i) {
@@ -79,7 +95,20 @@ int Run(int argc, const char** argv) {
       return -1;
     }
 
-    images = GenerateMipmapLevels(std::move(images[0]));
+    MipmapOptions options;
+    if (parser.IsSet("mipmap_filter")) {
+      const string_view filter = parser.GetString("mipmap_filter");
+      if (filter == "kaiser") {
+        options.filter = MipmapFilter::kKaiser;
+      } else if (filter != "box") {
+        LOG(ERROR) << "Unknown mipmap filter: " << filter;
+        return -1;
+      }
+    }
+    options.srgb = parser.GetBool("srgb");
+    options.num_threads = parser.IsSet("threads") ? parser.GetInt("threads")
+                                                  : default_threads;
+    images = GenerateMipmapLevels(std::move(images[0]), options);
   }
 
   if (images.size() == 1) {
@@ -116,12 +145,41 @@ int Run(int argc, const char** argv) {
   }
 
   if (!SaveFile(new_image.data(), new_image.size(), output.c_str(), true)) {
-    LOG(FATAL) << "Failed to save new image: " << output;
+    LOG(ERROR) << "Failed to save new image: " << output;
     return -1;
   }
+  files->outputs.push_back(output);
   return 0;
 }
 
+int Run(int argc, const char** argv) {
+  if (IsBatchMode(argc, argv)) {
+    BatchTool tool;
+    tool.version = kToolVersion;
+    tool.add_args = AddArgs;
+    tool.get_inputs = GetInputs;
+    // Jobs already run concurrently, so each job uses a single thread.
+    tool.run = [](const ArgParser& parser, BatchJobFiles* files) {
+      return RunJob(parser, 1, files);
+    };
+    return RunBatch(tool, argc, argv);
+  }
+
+  ArgParser parser;
+  AddArgs(&parser);
+  if (!parser.Parse(argc, argv)) {
+    LOG(ERROR) << "Failed to parse args:";
+    const auto& errors = parser.GetErrors();
+    for (const auto& error : errors) {
+      LOG(ERROR) << error;
+    }
+    return -1;
+  }
+
+  BatchJobFiles files;
+  return RunJob(parser, 0, &files);
+}
+
 }  // namespace tool
 }  // namespace lull
 
@@ -18,7 +18,9 @@ limitations under the License.
 #define LULLABY_UTIL_BUFFERED_DATA_H_
 
 #include <algorithm>
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
 #include <mutex>
 
 #include "lullaby/util/logging.h"
@@ -158,6 +160,138 @@ class BufferedData {
   size_t locked_write_ = N;
 };
 
+/// A wait-free alternative to BufferedData<T, 3> for handing data from exactly
+/// one writer thread to exactly one reader thread.
+///
+/// The writer and the reader each own one of the three buffers.  The third,
+/// "pending", buffer is exchanged between them through a single atomic word,
+/// so neither thread ever blocks on the other:
+///
+/// - |UnlockWriteBuffer| publishes the written buffer as the pending buffer
+///   and takes the previous pending buffer as the next buffer to write.
+///
+/// - |LockReadBuffer| takes the pending buffer if it has been published since
+///   the last read.  Otherwise it returns the same buffer as the previous read,
+///   which can be detected with |IsReadBufferStale|.
+///
+/// Each published buffer is tagged with a frame sequence number (starting at 1)
+/// that is carried in the same atomic word, so the reader can tell exactly
+/// which write it is looking at, and how many writes it has skipped.
+///
+/// Unlike BufferedData, the buffer returned by |LockWriteBuffer| is not the
+/// most recently written one, so the writer must fully rewrite its contents.
+template <typename T>
+class TripleBufferedData {
+ public:
+  TripleBufferedData()
+      : pending_(PackState(kPendingInitial, 0, false)) {}
+
+  TripleBufferedData(const TripleBufferedData&) = delete;
+  TripleBufferedData& operator=(const TripleBufferedData&) = delete;
+
+  /// Locks and returns the buffer owned by the writer.  Must only be called by
+  /// the writer thread, and must be followed by |UnlockWriteBuffer|.
+  T* LockWriteBuffer() {
+    DCHECK(!write_locked_) << "Write buffer already locked.";
+    write_locked_ = true;
+    return &data_[write_index_];
+  }
+
+  /// Publishes the write buffer so that the next |LockReadBuffer| will return
+  /// it, and takes ownership of another buffer for the next write.
+  void UnlockWriteBuffer() {
+    DCHECK(write_locked_) << "Write buffer was not locked!";
+    write_locked_ = false;
+    ++write_sequence_;
+    // The release publishes the written data to the reader; the acquire makes
+    // sure the reader is done with the buffer that is handed back.
+    const uint64_t previous = pending_.exchange(
+        PackState(write_index_, write_sequence_, true),
+        std::memory_order_acq_rel);
+    write_index_ = GetIndex(previous);
+  }
+
+  /// Locks and returns the most recently published buffer.  Must only be called
+  /// by the reader thread, and must be followed by |UnlockReadBuffer|.
+  T* LockReadBuffer() {
+    DCHECK(!read_locked_) << "Read buffer already locked.";
+    read_locked_ = true;
+
+    // Only swap with the pending buffer if it holds newer data, otherwise keep
+    // reading the current buffer so that no published data is lost.
+    if (IsFresh(pending_.load(std::memory_order_relaxed))) {
+      const uint64_t previous = pending_.exchange(
+          PackState(read_index_, read_sequence_, false),
+          std::memory_order_acq_rel);
+      read_index_ = GetIndex(previous);
+      read_stale_ = false;
+      read_sequence_ = GetSequence(previous);
+    } else {
+      read_stale_ = true;
+    }
+    return &data_[read_index_];
+  }
+
+  /// Releases the read buffer.
+  void UnlockReadBuffer() {
+    DCHECK(read_locked_) << "Read buffer was not locked!";
+    read_locked_ = false;
+  }
+
+  /// Returns true if the last |LockReadBuffer| returned the same data as the
+  /// read before it, i.e. nothing was published in between.  Must only be
+  /// called by the reader thread.
+  bool IsReadBufferStale() const { return read_stale_; }
+
+  /// Returns the frame sequence number of the buffer returned by the last
+  /// |LockReadBuffer|, or 0 if nothing has been written yet.  Must only be
+  /// called by the reader thread.
+  uint64_t GetReadSequence() const { return read_sequence_; }
+
+  /// Returns the number of buffers published by the writer.  Must only be
+  /// called by the writer thread.
+  uint64_t GetWriteSequence() const { return write_sequence_; }
+
+ private:
+  // The atomic word holds the pending buffer's index in the lowest 2 bits, a
+  // "fresh" flag in the next bit, and the frame sequence in the remaining bits.
+  static constexpr uint64_t kIndexMask = 0x3;
+  static constexpr uint64_t kFreshBit = 0x4;
+  static constexpr int kSequenceShift = 3;
+
+  static constexpr size_t kWriteInitial = 0;
+  static constexpr size_t kPendingInitial = 1;
+  static constexpr size_t kReadInitial = 2;
+
+  static uint64_t PackState(size_t index, uint64_t sequence, bool fresh) {
+    return (sequence << kSequenceShift) | (fresh ? kFreshBit : 0) |
+           static_cast<uint64_t>(index);
+  }
+  static size_t GetIndex(uint64_t state) {
+    return static_cast<size_t>(state & kIndexMask);
+  }
+  static bool IsFresh(uint64_t state) { return (state & kFreshBit) != 0; }
+  static uint64_t GetSequence(uint64_t state) {
+    return state >> kSequenceShift;
+  }
+
+  /// The three buffers, each owned by the writer, the reader, or pending.
+  T data_[3];
+  /// The state of the pending buffer, shared by both threads.
+  std::atomic<uint64_t> pending_;
+
+  // Only accessed by the writer thread.
+  size_t write_index_ = kWriteInitial;
+  uint64_t write_sequence_ = 0;
+  bool write_locked_ = false;
+
+  // Only accessed by the reader thread.
+  size_t read_index_ = kReadInitial;
+  uint64_t read_sequence_ = 0;
+  bool read_stale_ = true;
+  bool read_locked_ = false;
+};
+
 }  // namespace lull
 
 #endif  // LULLABY_UTIL_BUFFERED_DATA_H_
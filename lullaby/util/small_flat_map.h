@@ -0,0 +1,323 @@
+/*
+Copyright 2017-2019 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef LULLABY_UTIL_SMALL_FLAT_MAP_H_
+#define LULLABY_UTIL_SMALL_FLAT_MAP_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace lull {
+
+// A map-like container of Key to Value that stores its elements in a single
+// array sorted by Key.
+//
+// The first |N| elements are stored inline in the container itself, so small
+// maps do not require any dynamic allocations.  Once the map grows beyond |N|
+// elements, all elements are moved into a heap-allocated array where they stay
+// until the map is cleared, destroyed or assigned.  Lookups are a binary search
+// over contiguous memory, which for a handful of elements is significantly
+// cheaper than hashing into the separately allocated nodes of an unordered_map.
+//
+// The API is a subset of std::unordered_map so that it can be used as a
+// drop-in replacement for small maps.  The main differences are:
+//
+// * Iteration is in Key order.
+// * The value_type is std::pair<Key, Value> (ie. the key is not const).  Do
+//   not modify the key through an iterator.
+// * Insertions and erasures invalidate all iterators and pointers to elements.
+//
+// Insertion and erasure are O(n), so this container should not be used for
+// maps that are expected to hold many elements.
+template <typename Key, typename Value, size_t N>
+class SmallFlatMap {
+  static_assert(N > 0, "SmallFlatMap requires a non-zero inline capacity.");
+
+  static constexpr bool kNothrowMove =
+      std::is_nothrow_move_constructible<Key>::value &&
+      std::is_nothrow_move_constructible<Value>::value;
+
+ public:
+  using key_type = Key;
+  using mapped_type = Value;
+  using value_type = std::pair<Key, Value>;
+  using size_type = size_t;
+  using iterator = value_type*;
+  using const_iterator = const value_type*;
+
+  SmallFlatMap() {}
+
+  template <typename InputIt>
+  SmallFlatMap(InputIt first, InputIt last) {
+    insert(first, last);
+  }
+
+  SmallFlatMap(std::initializer_list<value_type> init) {
+    insert(init.begin(), init.end());
+  }
+
+  SmallFlatMap(const SmallFlatMap& rhs) { CopyFrom(rhs); }
+
+  // Moves are noexcept whenever the elements are, so that containers of maps
+  // (eg. std::vector<SmallFlatMap>) move rather than copy them when growing.
+  SmallFlatMap(SmallFlatMap&& rhs) noexcept(kNothrowMove) { MoveFrom(&rhs); }
+
+  ~SmallFlatMap() { DestroyInline(); }
+
+  SmallFlatMap& operator=(const SmallFlatMap& rhs) {
+    if (this != &rhs) {
+      Reset();
+      CopyFrom(rhs);
+    }
+    return *this;
+  }
+
+  SmallFlatMap& operator=(SmallFlatMap&& rhs) noexcept(kNothrowMove) {
+    if (this != &rhs) {
+      Reset();
+      MoveFrom(&rhs);
+    }
+    return *this;
+  }
+
+  // Replaces the contents of the map with the elements in [first, last).
+  template <typename InputIt>
+  void assign(InputIt first, InputIt last) {
+    Reset();
+    insert(first, last);
+  }
+
+  iterator begin() { return Data(); }
+  iterator end() { return Data() + size(); }
+  const_iterator begin() const { return Data(); }
+  const_iterator end() const { return Data() + size(); }
+  const_iterator cbegin() const { return begin(); }
+  const_iterator cend() const { return end(); }
+
+  size_t size() const { return on_heap_ ? heap_.size() : inline_size_; }
+  bool empty() const { return size() == 0; }
+
+  // Returns the number of elements that can be stored without allocating.
+  size_t capacity() const { return on_heap_ ? heap_.capacity() : N; }
+
+  // Returns true if the elements are no longer stored inline.
+  bool IsOnHeap() const { return on_heap_; }
+
+  // Removes all elements.  Heap-allocated storage, if any, is retained.
+  void clear() {
+    DestroyInline();
+    heap_.clear();
+  }
+
+  // Ensures that |count| elements can be stored without further allocations.
+  void reserve(size_t count) {
+    if (count > N || on_heap_) {
+      MoveToHeap(count);
+    }
+  }
+
+  iterator find(const Key& key) {
+    iterator iter = LowerBound(key);
+    return (iter != end() && iter->first == key) ? iter : end();
+  }
+
+  const_iterator find(const Key& key) const {
+    return const_cast<SmallFlatMap*>(this)->find(key);
+  }
+
+  size_t count(const Key& key) const { return find(key) != end() ? 1 : 0; }
+
+  // Returns the value associated with |key|, inserting a default constructed
+  // Value if there is no such association.
+  Value& operator[](const Key& key) {
+    return TryEmplace(key).first->second;
+  }
+
+  // Associates the Value constructed from |args| with the |key| if there is no
+  // existing association.  Returns an iterator to the element associated with
+  // |key| and whether or not the insertion took place.
+  template <typename... Args>
+  std::pair<iterator, bool> emplace(const Key& key, Args&&... args) {
+    return TryEmplace(key, std::forward<Args>(args)...);
+  }
+
+  std::pair<iterator, bool> insert(const value_type& value) {
+    return TryEmplace(value.first, value.second);
+  }
+
+  std::pair<iterator, bool> insert(value_type&& value) {
+    return TryEmplace(value.first, std::move(value.second));
+  }
+
+  template <typename InputIt>
+  void insert(InputIt first, InputIt last) {
+    for (; first != last; ++first) {
+      TryEmplace(first->first, first->second);
+    }
+  }
+
+  // Removes the element associated with |key|, returning the number of
+  // elements removed.
+  size_t erase(const Key& key) {
+    iterator iter = find(key);
+    if (iter == end()) {
+      return 0;
+    }
+    erase(iter);
+    return 1;
+  }
+
+  // Removes the element at |pos|, returning an iterator to the element after
+  // the removed one.
+  iterator erase(const_iterator pos) {
+    const size_t index = static_cast<size_t>(pos - begin());
+    if (on_heap_) {
+      heap_.erase(heap_.begin() + index);
+    } else {
+      value_type* data = InlineData();
+      std::move(data + index + 1, data + inline_size_, data + index);
+      --inline_size_;
+      data[inline_size_].~value_type();
+    }
+    return begin() + index;
+  }
+
+ private:
+  using Storage = typename std::aligned_storage<sizeof(value_type),
+                                                alignof(value_type)>::type;
+
+  value_type* InlineData() { return reinterpret_cast<value_type*>(inline_); }
+
+  value_type* Data() { return on_heap_ ? heap_.data() : InlineData(); }
+  const value_type* Data() const {
+    return const_cast<SmallFlatMap*>(this)->Data();
+  }
+
+  iterator LowerBound(const Key& key) {
+    return std::lower_bound(begin(), end(), key,
+                            [](const value_type& lhs, const Key& rhs) {
+                              return lhs.first < rhs;
+                            });
+  }
+
+  template <typename... Args>
+  std::pair<iterator, bool> TryEmplace(const Key& key, Args&&... args) {
+    iterator iter = LowerBound(key);
+    if (iter != end() && iter->first == key) {
+      return std::make_pair(iter, false);
+    }
+
+    const size_t index = static_cast<size_t>(iter - begin());
+    if (!on_heap_ && inline_size_ == N) {
+      MoveToHeap(2 * N);
+    }
+
+    if (on_heap_) {
+      heap_.emplace(heap_.begin() + index, std::piecewise_construct,
+                    std::forward_as_tuple(key),
+                    std::forward_as_tuple(std::forward<Args>(args)...));
+    } else {
+      // Construct the new element at the end and rotate it into place.
+      value_type* data = InlineData();
+      new (data + inline_size_)
+          value_type(std::piecewise_construct, std::forward_as_tuple(key),
+                     std::forward_as_tuple(std::forward<Args>(args)...));
+      ++inline_size_;
+      std::rotate(data + index, data + inline_size_ - 1, data + inline_size_);
+    }
+    return std::make_pair(begin() + index, true);
+  }
+
+  // Moves all inline elements into the heap array, ensuring it can store at
+  // least |count| elements.
+  void MoveToHeap(size_t count) {
+    heap_.reserve(count);
+    if (on_heap_) {
+      return;
+    }
+
+    value_type* data = InlineData();
+    for (size_t i = 0; i < inline_size_; ++i) {
+      heap_.emplace_back(std::move(data[i]));
+    }
+    DestroyInline();
+    on_heap_ = true;
+  }
+
+  void DestroyInline() {
+    value_type* data = InlineData();
+    for (size_t i = 0; i < inline_size_; ++i) {
+      data[i].~value_type();
+    }
+    inline_size_ = 0;
+  }
+
+  // Destroys all elements and releases any heap-allocated storage.
+  void Reset() {
+    DestroyInline();
+    std::vector<value_type>().swap(heap_);
+    on_heap_ = false;
+  }
+
+  // Copies the elements of |rhs| into this (empty) map.  The elements of |rhs|
+  // are already sorted so they can simply be appended.
+  void CopyFrom(const SmallFlatMap& rhs) {
+    if (rhs.size() > N) {
+      on_heap_ = true;
+      heap_.assign(rhs.begin(), rhs.end());
+      return;
+    }
+
+    value_type* data = InlineData();
+    for (const value_type& kv : rhs) {
+      new (data + inline_size_) value_type(kv);
+      ++inline_size_;
+    }
+  }
+
+  // Moves the elements of |rhs| into this (empty) map, leaving |rhs| empty.
+  void MoveFrom(SmallFlatMap* rhs) {
+    if (rhs->on_heap_) {
+      on_heap_ = true;
+      heap_ = std::move(rhs->heap_);
+      rhs->Reset();
+      return;
+    }
+
+    value_type* data = InlineData();
+    value_type* rhs_data = rhs->InlineData();
+    for (size_t i = 0; i < rhs->inline_size_; ++i) {
+      new (data + inline_size_) value_type(std::move(rhs_data[i]));
+      ++inline_size_;
+    }
+    rhs->DestroyInline();
+  }
+
+  Storage inline_[N];
+  size_t inline_size_ = 0;
+  bool on_heap_ = false;
+  std::vector<value_type> heap_;
+};
+
+}  // namespace lull
+
+#endif  // LULLABY_UTIL_SMALL_FLAT_MAP_H_
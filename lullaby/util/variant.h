@@ -26,6 +26,7 @@ limitations under the License.
 #include "lullaby/util/common_types.h"
 #include "lullaby/util/entity.h"
 #include "lullaby/util/logging.h"
+#include "lullaby/util/small_flat_map.h"
 #include "lullaby/util/type_util.h"
 #include "lullaby/util/typeid.h"
 #include "mathfu/glsl_mappings.h"
@@ -36,6 +37,11 @@ class Variant;
 using VariantArray = std::vector<Variant>;
 using VariantMap = std::unordered_map<HashValue, Variant>;
 
+// A VariantMap alternative that stores a few elements inline.  Useful for
+// short-lived or frequently copied maps that usually only have a handful of
+// entries.  Note that Variants themselves only store VariantMaps.
+using SmallVariantMap = SmallFlatMap<HashValue, Variant, 4>;
+
 }  // namespace lull
 
 LULLABY_SETUP_TYPEID(lull::Variant);
@@ -92,8 +98,9 @@ class Variant {
     }
   }
 
-  // Move constructor, copies variant value stored in |rhs|.
-  Variant(Variant&& rhs) : type_(0), size_(0), handler_(nullptr) {
+  // Move constructor, copies variant value stored in |rhs|.  Stored types are
+  // expected to have non-throwing move constructors.
+  Variant(Variant&& rhs) noexcept : type_(0), size_(0), handler_(nullptr) {
     if (!rhs.Empty()) {
       Move(&rhs, this);
     }
@@ -124,7 +131,7 @@ class Variant {
   }
 
   // Moves variant value from |rhs| if a value is set.
-  Variant& operator=(Variant&& rhs) {
+  Variant& operator=(Variant&& rhs) noexcept {
     if (this != &rhs) {
       Clear();
       if (!rhs.Empty()) {
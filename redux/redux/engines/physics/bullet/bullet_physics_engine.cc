@@ -43,6 +43,82 @@ static void InternalTickCallback(btDynamicsWorld* world, btScalar time_step) {
   engine->OnSimTick();
 }
 
+// Sets up the collision filter of a query callback such that it only finds
+// objects belonging to one of the groups in `collision_filter`.
+template <typename Callback>
+static void SetQueryFilter(Callback* callback, Bits32 collision_filter) {
+  callback->m_collisionFilterGroup = static_cast<int>(Bits32::All().Value());
+  callback->m_collisionFilterMask = static_cast<int>(collision_filter.Value());
+}
+
+// Gathers every hit along a ray directly into a SceneQueryHit array.
+class AllHitsRayCallback : public btCollisionWorld::RayResultCallback {
+ public:
+  AllHitsRayCallback(const btVector3& from, const btVector3& to, float length,
+                     std::vector<SceneQueryHit>* hits)
+      : from_(from), to_(to), length_(length), hits_(hits) {}
+
+  btScalar addSingleResult(btCollisionWorld::LocalRayResult& result,
+                           bool normal_in_world_space) override {
+    const btCollisionObject* object = result.m_collisionObject;
+    const btVector3 normal =
+        normal_in_world_space
+            ? result.m_hitNormalLocal
+            : object->getWorldTransform().getBasis() * result.m_hitNormalLocal;
+
+    SceneQueryHit hit;
+    hit.entity = EntityFromBulletUserIndex(object->getUserIndex());
+    hit.position = FromBullet(from_.lerp(to_, result.m_hitFraction));
+    hit.normal = FromBullet(normal);
+    hit.distance = result.m_hitFraction * length_;
+    hits_->emplace_back(hit);
+
+    // Don't shorten the ray so that all hits are reported.
+    m_collisionObject = object;
+    return m_closestHitFraction;
+  }
+
+ private:
+  btVector3 from_;
+  btVector3 to_;
+  float length_ = 0.f;
+  std::vector<SceneQueryHit>* hits_ = nullptr;
+};
+
+// Gathers the Entities of every object that penetrates the query object.
+class OverlapCallback : public btCollisionWorld::ContactResultCallback {
+ public:
+  OverlapCallback(const btCollisionObject* query_object,
+                  std::vector<Entity>* entities)
+      : query_object_(query_object), entities_(entities) {}
+
+  btScalar addSingleResult(btManifoldPoint& point,
+                           const btCollisionObjectWrapper* wrapper0, int part0,
+                           int index0, const btCollisionObjectWrapper* wrapper1,
+                           int part1, int index1) override {
+    // Contact tests also report points that are merely close to each other.
+    if (point.getDistance() > 0.f) {
+      return 0.f;
+    }
+
+    // The wrappers are swapped for some shape pairs, so the query object may
+    // be either one of them.
+    const btCollisionObject* object = wrapper0->getCollisionObject();
+    if (object == query_object_) {
+      object = wrapper1->getCollisionObject();
+    }
+    if (object != query_object_) {
+      const int user_index = object->getUserIndex();
+      entities_->emplace_back(EntityFromBulletUserIndex(user_index));
+    }
+    return 0.f;
+  }
+
+ private:
+  const btCollisionObject* query_object_ = nullptr;
+  std::vector<Entity>* entities_ = nullptr;
+};
+
 BulletPhysicsEngine::BulletPhysicsEngine(Registry* registry)
     : registry_(registry) {
   bt_config_ = std::make_unique<btDefaultCollisionConfiguration>();
@@ -132,6 +208,152 @@ BulletPhysicsEngine::GetActiveContacts(Entity entity_a, Entity entity_b) const {
   return {};
 }
 
+void BulletPhysicsEngine::RaycastClosest(
+    absl::Span<const RaycastQuery> queries,
+    absl::Span<SceneQueryHit> results) const {
+  CHECK_EQ(queries.size(), results.size());
+  for (size_t i = 0; i < queries.size(); ++i) {
+    const RaycastQuery& query = queries[i];
+    const btVector3 from = ToBullet(query.ray.origin);
+    const btVector3 to =
+        ToBullet(query.ray.GetPointAt(query.max_distance));
+
+    btCollisionWorld::ClosestRayResultCallback callback(from, to);
+    SetQueryFilter(&callback, query.collision_filter);
+    bt_world_->rayTest(from, to, callback);
+
+    SceneQueryHit& hit = results[i];
+    hit = SceneQueryHit();
+    if (callback.hasHit()) {
+      hit.entity =
+          EntityFromBulletUserIndex(callback.m_collisionObject->getUserIndex());
+      hit.position = FromBullet(callback.m_hitPointWorld);
+      hit.normal = FromBullet(callback.m_hitNormalWorld);
+      hit.distance = callback.m_closestHitFraction * query.max_distance;
+    }
+  }
+}
+
+void BulletPhysicsEngine::RaycastAll(absl::Span<const RaycastQuery> queries,
+                                     std::vector<SceneQueryHit>* hits,
+                                     absl::Span<SceneQueryRange> ranges) const {
+  CHECK(hits);
+  CHECK_EQ(queries.size(), ranges.size());
+  for (size_t i = 0; i < queries.size(); ++i) {
+    const RaycastQuery& query = queries[i];
+    const btVector3 from = ToBullet(query.ray.origin);
+    const btVector3 to =
+        ToBullet(query.ray.GetPointAt(query.max_distance));
+
+    const size_t offset = hits->size();
+    AllHitsRayCallback callback(from, to, query.max_distance, hits);
+    SetQueryFilter(&callback, query.collision_filter);
+    bt_world_->rayTest(from, to, callback);
+
+    std::sort(hits->begin() + offset, hits->end(),
+              [](const SceneQueryHit& lhs, const SceneQueryHit& rhs) {
+                return lhs.distance < rhs.distance;
+              });
+    ranges[i].offset = offset;
+    ranges[i].count = hits->size() - offset;
+  }
+}
+
+void BulletPhysicsEngine::SweepClosest(
+    absl::Span<const SweepQuery> queries,
+    absl::Span<SceneQueryHit> results) const {
+  CHECK_EQ(queries.size(), results.size());
+  for (size_t i = 0; i < queries.size(); ++i) {
+    const SweepQuery& query = queries[i];
+    SceneQueryHit& hit = results[i];
+    hit = SceneQueryHit();
+
+    btCollisionShape* shape =
+        query.shape ? Upcast(query.shape.get())->GetUnderlyingBtCollisionShape()
+                    : nullptr;
+    if (shape == nullptr || !shape->isConvex()) {
+      LOG(ERROR) << "Sweep queries require a convex shape.";
+      continue;
+    }
+
+    const btQuaternion rotation = ToBullet(query.rotation);
+    const btTransform from(rotation, ToBullet(query.from));
+    const btTransform to(rotation, ToBullet(query.to));
+
+    btCollisionWorld::ClosestConvexResultCallback callback(from.getOrigin(),
+                                                           to.getOrigin());
+    SetQueryFilter(&callback, query.collision_filter);
+    bt_world_->convexSweepTest(static_cast<btConvexShape*>(shape), from, to,
+                               callback);
+
+    if (callback.hasHit()) {
+      hit.entity = EntityFromBulletUserIndex(
+          callback.m_hitCollisionObject->getUserIndex());
+      hit.position = FromBullet(callback.m_hitPointWorld);
+      hit.normal = FromBullet(callback.m_hitNormalWorld);
+      hit.distance =
+          callback.m_closestHitFraction * (query.to - query.from).Length();
+    }
+  }
+}
+
+void BulletPhysicsEngine::OverlapBoxes(
+    absl::Span<const BoxOverlapQuery> queries, std::vector<Entity>* entities,
+    absl::Span<SceneQueryRange> ranges) const {
+  CHECK(entities);
+  CHECK_EQ(queries.size(), ranges.size());
+  for (size_t i = 0; i < queries.size(); ++i) {
+    const BoxOverlapQuery& query = queries[i];
+    btBoxShape shape(ToBullet(query.box.Size() / 2.f));
+    ranges[i] = CollectOverlaps(&shape, query.box.Center(),
+                                query.collision_filter, entities);
+  }
+}
+
+void BulletPhysicsEngine::OverlapSpheres(
+    absl::Span<const SphereOverlapQuery> queries, std::vector<Entity>* entities,
+    absl::Span<SceneQueryRange> ranges) const {
+  CHECK(entities);
+  CHECK_EQ(queries.size(), ranges.size());
+  for (size_t i = 0; i < queries.size(); ++i) {
+    const SphereOverlapQuery& query = queries[i];
+    btSphereShape shape(query.radius);
+    ranges[i] = CollectOverlaps(&shape, query.center, query.collision_filter,
+                                entities);
+  }
+}
+
+SceneQueryRange BulletPhysicsEngine::CollectOverlaps(
+    btCollisionShape* shape, const vec3& position, Bits32 collision_filter,
+    std::vector<Entity>* entities) const {
+  btTransform transform = btTransform::getIdentity();
+  transform.setOrigin(ToBullet(position));
+  btCollisionObject query_object;
+  query_object.setCollisionShape(shape);
+  query_object.setWorldTransform(transform);
+
+  SceneQueryRange range;
+  range.offset = entities->size();
+
+  OverlapCallback callback(&query_object, entities);
+  SetQueryFilter(&callback, collision_filter);
+  {
+    // The dispatcher allocates the collision algorithms used by the contact
+    // test from a pool that is not thread-safe.
+    absl::MutexLock lock(&contact_test_mutex_);
+    bt_world_->contactTest(&query_object, callback);
+  }
+
+  // An object may be reported once for every contact point, so only keep the
+  // unique Entities.
+  std::sort(entities->begin() + range.offset, entities->end());
+  entities->erase(
+      std::unique(entities->begin() + range.offset, entities->end()),
+      entities->end());
+  range.count = entities->size() - range.offset;
+  return range;
+}
+
 void BulletPhysicsEngine::AdvanceFrame(absl::Duration timestep) {
   // During one AdvanceFrame() call, do at most a set number of 1/60 second
   // updates. Bullet will update the MotionStates of every Dynamic Entity that
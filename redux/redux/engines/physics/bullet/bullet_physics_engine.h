@@ -19,6 +19,7 @@ limitations under the License.
 
 #include <algorithm>
 
+#include "absl/synchronization/mutex.h"
 #include "btBulletDynamicsCommon.h"
 #include "redux/engines/physics/bullet/bullet_collision_shape.h"
 #include "redux/engines/physics/bullet/bullet_rigid_body.h"
@@ -116,6 +117,39 @@ class BulletPhysicsEngine : public PhysicsEngine {
   absl::Span<const ContactPoint> GetActiveContacts(Entity entity_a,
                                                    Entity entity_b) const;
 
+  // The scene queries below may be called concurrently with each other, but
+  // not with functions that modify the world, such as AdvanceFrame().
+
+  // Casts each ray in `queries` and stores the closest hit in the
+  // corresponding element of `results`, which must be the same size as
+  // `queries`. Rays that hit nothing have an invalid entity in their result.
+  void RaycastClosest(absl::Span<const RaycastQuery> queries,
+                      absl::Span<SceneQueryHit> results) const;
+
+  // Casts each ray in `queries` and appends every hit to `hits`, sorted by
+  // distance. The hits for each query are identified by the corresponding
+  // element of `ranges`, which must be the same size as `queries`.
+  void RaycastAll(absl::Span<const RaycastQuery> queries,
+                  std::vector<SceneQueryHit>* hits,
+                  absl::Span<SceneQueryRange> ranges) const;
+
+  // Sweeps each shape in `queries` and stores the closest hit in the
+  // corresponding element of `results`, which must be the same size as
+  // `queries`. Sweeps that hit nothing have an invalid entity in their result.
+  void SweepClosest(absl::Span<const SweepQuery> queries,
+                    absl::Span<SceneQueryHit> results) const;
+
+  // Appends the Entities of all physics objects overlapping each query volume
+  // to `entities`. The Entities for each query are identified by the
+  // corresponding element of `ranges`, which must be the same size as
+  // `queries`.
+  void OverlapBoxes(absl::Span<const BoxOverlapQuery> queries,
+                    std::vector<Entity>* entities,
+                    absl::Span<SceneQueryRange> ranges) const;
+  void OverlapSpheres(absl::Span<const SphereOverlapQuery> queries,
+                      std::vector<Entity>* entities,
+                      absl::Span<SceneQueryRange> ranges) const;
+
   // Internal function used by the Bullet tick/step callback.
   void OnSimTick();
 
@@ -125,6 +159,12 @@ class BulletPhysicsEngine : public PhysicsEngine {
 
   void ProcessContactManifold(const btPersistentManifold* manifold);
 
+  // Finds all objects overlapping `shape`, placed at `position`, and appends
+  // their Entities to `entities`.
+  SceneQueryRange CollectOverlaps(btCollisionShape* shape, const vec3& position,
+                                  Bits32 collision_filter,
+                                  std::vector<Entity>* entities) const;
+
   Registry* registry_ = nullptr;
   ResourceManager<CollisionData> shape_data_;
   CollisionCallback on_enter_collision_;
@@ -137,6 +177,7 @@ class BulletPhysicsEngine : public PhysicsEngine {
   CollisionMap current_collisions_;
   CollisionMap previous_collisions_;
   std::vector<ContactPoint> contacts_;
+  mutable absl::Mutex contact_test_mutex_;
   vec3 gravity_ = {0, -9.81, 0};
   float timestep_ = 1 / 60.f;
   int max_substeps_ = 4;
@@ -0,0 +1,228 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "redux/engines/physics/bullet/bullet_physics_engine.h"
+#include "redux/modules/math/testing.h"
+
+namespace redux {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::Eq;
+using ::testing::FloatNear;
+
+class BulletPhysicsEngineTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    engine_ = std::make_unique<BulletPhysicsEngine>(&registry_);
+
+    // A box in front of the origin, a sphere behind it, and a box off to the
+    // side.
+    AddBody(kFrontBox, vec3(0, 0, -5), MakeBox(vec3(1, 1, 1)));
+    AddBody(kBackSphere, vec3(0, 0, -10), MakeSphere(1.f));
+    AddBody(kSideBox, vec3(5, 0, 0), MakeBox(vec3(1, 1, 1)));
+
+    // Step once so that the broadphase picks up the body transforms.
+    engine_->AdvanceFrame(absl::Milliseconds(20));
+  }
+
+  CollisionShapePtr MakeBox(const vec3& half_extents) {
+    auto data = std::make_shared<CollisionData>();
+    data->AddBox(vec3::Zero(), quat::Identity(), half_extents);
+    return engine_->CreateShape(std::move(data));
+  }
+
+  CollisionShapePtr MakeSphere(float radius) {
+    auto data = std::make_shared<CollisionData>();
+    data->AddSphere(vec3::Zero(), radius);
+    return engine_->CreateShape(std::move(data));
+  }
+
+  void AddBody(Entity entity, const vec3& position, CollisionShapePtr shape) {
+    RigidBodyParams params;
+    params.entity = entity;
+    params.shape = std::move(shape);
+    RigidBodyPtr body = engine_->CreateRigidBody(params);
+    body->SetTransform(Transform(position, quat::Identity(), vec3::One()));
+    bodies_.emplace_back(std::move(body));
+  }
+
+  static constexpr float kEpsilon = 0.05f;
+  static constexpr Entity kFrontBox = Entity(1);
+  static constexpr Entity kBackSphere = Entity(2);
+  static constexpr Entity kSideBox = Entity(3);
+
+  Registry registry_;
+  std::unique_ptr<BulletPhysicsEngine> engine_;
+  std::vector<RigidBodyPtr> bodies_;
+};
+
+TEST_F(BulletPhysicsEngineTest, RaycastClosest) {
+  RaycastQuery queries[2];
+  queries[0].ray = Ray(vec3::Zero(), -vec3::ZAxis());
+  queries[0].max_distance = 20.f;
+  queries[1].ray = Ray(vec3::Zero(), vec3::YAxis());
+  queries[1].max_distance = 20.f;
+
+  SceneQueryHit results[2];
+  engine_->RaycastClosest(queries, results);
+
+  EXPECT_THAT(results[0].entity, Eq(kFrontBox));
+  EXPECT_THAT(results[0].distance, FloatNear(4.f, kEpsilon));
+  EXPECT_THAT(results[0].position, MathNear(vec3(0, 0, -4), kEpsilon));
+  EXPECT_THAT(results[0].normal, MathNear(vec3(0, 0, 1), kEpsilon));
+  EXPECT_THAT(results[1].entity, Eq(kNullEntity));
+}
+
+TEST_F(BulletPhysicsEngineTest, RaycastAll) {
+  RaycastQuery queries[2];
+  queries[0].ray = Ray(vec3::Zero(), -vec3::ZAxis());
+  queries[0].max_distance = 20.f;
+  queries[1].ray = Ray(vec3::Zero(), vec3::XAxis());
+  queries[1].max_distance = 20.f;
+
+  std::vector<SceneQueryHit> hits;
+  SceneQueryRange ranges[2];
+  engine_->RaycastAll(queries, &hits, ranges);
+
+  ASSERT_THAT(ranges[0].count, Eq(2));
+  EXPECT_THAT(hits[ranges[0].offset].entity, Eq(kFrontBox));
+  EXPECT_THAT(hits[ranges[0].offset].distance, FloatNear(4.f, kEpsilon));
+  EXPECT_THAT(hits[ranges[0].offset + 1].entity, Eq(kBackSphere));
+  EXPECT_THAT(hits[ranges[0].offset + 1].distance, FloatNear(9.f, kEpsilon));
+
+  ASSERT_THAT(ranges[1].count, Eq(1));
+  EXPECT_THAT(hits[ranges[1].offset].entity, Eq(kSideBox));
+}
+
+TEST_F(BulletPhysicsEngineTest, SweepClosest) {
+  SweepQuery queries[2];
+  queries[0].shape = MakeSphere(0.5f);
+  queries[0].from = vec3::Zero();
+  queries[0].to = vec3(0, 0, -20);
+  queries[1].shape = queries[0].shape;
+  queries[1].from = vec3::Zero();
+  queries[1].to = vec3(0, 20, 0);
+
+  SceneQueryHit results[2];
+  engine_->SweepClosest(queries, results);
+
+  EXPECT_THAT(results[0].entity, Eq(kFrontBox));
+  EXPECT_THAT(results[0].distance, FloatNear(3.5f, kEpsilon));
+  EXPECT_THAT(results[1].entity, Eq(kNullEntity));
+}
+
+TEST_F(BulletPhysicsEngineTest, OverlapBoxes) {
+  BoxOverlapQuery queries[3];
+  queries[0].box = Box(vec3(-0.5f, -0.5f, -5.5f), vec3(0.5f, 0.5f, -4.5f));
+  queries[1].box = Box(vec3(-0.5f, -0.5f, -10.5f), vec3(0.5f, 0.5f, -9.5f));
+  queries[2].box = Box(vec3(-0.5f, 4.5f, -0.5f), vec3(0.5f, 5.5f, 0.5f));
+
+  std::vector<Entity> entities;
+  SceneQueryRange ranges[3];
+  engine_->OverlapBoxes(queries, &entities, ranges);
+
+  ASSERT_THAT(ranges[0].count, Eq(1));
+  EXPECT_THAT(entities[ranges[0].offset], Eq(kFrontBox));
+  // Box against sphere contacts swap the order of the collision objects.
+  ASSERT_THAT(ranges[1].count, Eq(1));
+  EXPECT_THAT(entities[ranges[1].offset], Eq(kBackSphere));
+  EXPECT_THAT(ranges[2].count, Eq(0));
+}
+
+TEST_F(BulletPhysicsEngineTest, OverlapSpheres) {
+  SphereOverlapQuery queries[3];
+  queries[0].center = vec3(0, 0, -5);
+  queries[0].radius = 0.5f;
+  queries[1].center = vec3(4, 0, 0);
+  queries[1].radius = 1.5f;
+  queries[2].center = vec3(0, 0, -7.5f);
+  queries[2].radius = 2.f;
+
+  std::vector<Entity> entities;
+  SceneQueryRange ranges[3];
+  engine_->OverlapSpheres(queries, &entities, ranges);
+
+  ASSERT_THAT(ranges[0].count, Eq(1));
+  EXPECT_THAT(entities[ranges[0].offset], Eq(kFrontBox));
+  ASSERT_THAT(ranges[1].count, Eq(1));
+  EXPECT_THAT(entities[ranges[1].offset], Eq(kSideBox));
+
+  // A sphere between the front box and the back sphere touches both.
+  const std::vector<Entity> both(entities.begin() + ranges[2].offset,
+                                 entities.end());
+  EXPECT_THAT(both, ElementsAre(kFrontBox, kBackSphere));
+}
+
+TEST_F(BulletPhysicsEngineTest, CollisionFilter) {
+  bodies_.clear();
+  RigidBodyParams params;
+  params.entity = kFrontBox;
+  params.shape = MakeBox(vec3(1, 1, 1));
+  params.collision_group = Bits32::Nth<1>();
+  RigidBodyPtr body = engine_->CreateRigidBody(params);
+  body->SetTransform(Transform(vec3::Zero(), quat::Identity(), vec3::One()));
+  engine_->AdvanceFrame(absl::Milliseconds(20));
+
+  SphereOverlapQuery queries[2];
+  queries[0].radius = 0.5f;
+  queries[0].collision_filter = Bits32::Nth<2>();
+  queries[1].radius = 0.5f;
+  queries[1].collision_filter = Bits32::Nth<1>();
+
+  std::vector<Entity> entities;
+  SceneQueryRange ranges[2];
+  engine_->OverlapSpheres(queries, &entities, ranges);
+
+  EXPECT_THAT(ranges[0].count, Eq(0));
+  ASSERT_THAT(ranges[1].count, Eq(1));
+  EXPECT_THAT(entities[ranges[1].offset], Eq(kFrontBox));
+}
+
+TEST_F(BulletPhysicsEngineTest, ConcurrentOverlaps) {
+  // Each thread repeatedly queries a different object, so results from one
+  // query must never leak into the other.
+  auto run_queries = [this](const vec3& center, Entity expected) {
+    for (int i = 0; i < 100; ++i) {
+      SphereOverlapQuery sphere_query;
+      sphere_query.center = center;
+      sphere_query.radius = 0.5f;
+      BoxOverlapQuery box_query;
+      box_query.box = Box(center - vec3(0.5f, 0.5f, 0.5f),
+                          center + vec3(0.5f, 0.5f, 0.5f));
+
+      std::vector<Entity> entities;
+      SceneQueryRange ranges[2];
+      engine_->OverlapSpheres({&sphere_query, 1}, &entities, {&ranges[0], 1});
+      engine_->OverlapBoxes({&box_query, 1}, &entities, {&ranges[1], 1});
+      EXPECT_THAT(entities, ElementsAre(expected, expected));
+    }
+  };
+
+  std::thread front(run_queries, vec3(0, 0, -5), kFrontBox);
+  std::thread side(run_queries, vec3(5, 0, 0), kSideBox);
+  front.join();
+  side.join();
+}
+
+}  // namespace
+}  // namespace redux
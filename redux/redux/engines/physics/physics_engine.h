@@ -18,11 +18,13 @@ limitations under the License.
 #define REDUX_ENGINES_PHYSICS_PHYSICS_ENGINE_H_
 
 #include <functional>
+#include <vector>
 
 #include "absl/time/time.h"
 #include "redux/engines/physics/collision_data.h"
 #include "redux/engines/physics/collision_shape.h"
 #include "redux/engines/physics/rigid_body.h"
+#include "redux/engines/physics/scene_query.h"
 #include "redux/engines/physics/trigger_volume.h"
 #include "redux/modules/base/registry.h"
 #include "redux/modules/base/resource_manager.h"
@@ -113,6 +115,36 @@ class PhysicsEngine {
   absl::Span<const ContactPoint> GetActiveContacts(Entity entity_a,
                                                    Entity entity_b) const;
 
+  // Casts each ray in `queries` and stores the closest hit in the
+  // corresponding element of `results`, which must be the same size as
+  // `queries`. Rays that hit nothing have an invalid entity in their result.
+  void RaycastClosest(absl::Span<const RaycastQuery> queries,
+                      absl::Span<SceneQueryHit> results) const;
+
+  // Casts each ray in `queries` and appends every hit to `hits`, sorted by
+  // distance. The hits for each query are identified by the corresponding
+  // element of `ranges`, which must be the same size as `queries`.
+  void RaycastAll(absl::Span<const RaycastQuery> queries,
+                  std::vector<SceneQueryHit>* hits,
+                  absl::Span<SceneQueryRange> ranges) const;
+
+  // Sweeps each shape in `queries` and stores the closest hit in the
+  // corresponding element of `results`, which must be the same size as
+  // `queries`. Sweeps that hit nothing have an invalid entity in their result.
+  void SweepClosest(absl::Span<const SweepQuery> queries,
+                    absl::Span<SceneQueryHit> results) const;
+
+  // Appends the Entities of all physics objects overlapping each query volume
+  // to `entities`. The Entities for each query are identified by the
+  // corresponding element of `ranges`, which must be the same size as
+  // `queries`.
+  void OverlapBoxes(absl::Span<const BoxOverlapQuery> queries,
+                    std::vector<Entity>* entities,
+                    absl::Span<SceneQueryRange> ranges) const;
+  void OverlapSpheres(absl::Span<const SphereOverlapQuery> queries,
+                      std::vector<Entity>* entities,
+                      absl::Span<SceneQueryRange> ranges) const;
+
  protected:
   PhysicsEngine() = default;
 };
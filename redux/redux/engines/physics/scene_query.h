@@ -0,0 +1,91 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef REDUX_ENGINES_PHYSICS_SCENE_QUERY_H_
+#define REDUX_ENGINES_PHYSICS_SCENE_QUERY_H_
+
+#include <cstddef>
+
+#include "redux/engines/physics/collision_shape.h"
+#include "redux/modules/base/bits.h"
+#include "redux/modules/ecs/entity.h"
+#include "redux/modules/math/bounds.h"
+#include "redux/modules/math/quaternion.h"
+#include "redux/modules/math/ray.h"
+#include "redux/modules/math/vector.h"
+
+namespace redux {
+
+// Casts a ray from `ray.origin` along `ray.direction` (which must be of unit
+// length) up to `max_distance`.
+struct RaycastQuery {
+  Ray ray;
+  float max_distance = 0.f;
+
+  // Only physics objects in these groups will be hit.
+  Bits32 collision_filter = Bits32::All();
+};
+
+// Sweeps a convex shape from `from` to `to` while keeping it at `rotation`.
+// Only box and sphere shapes can be swept.
+struct SweepQuery {
+  CollisionShapePtr shape;
+  vec3 from = vec3::Zero();
+  vec3 to = vec3::Zero();
+  quat rotation = quat::Identity();
+
+  // Only physics objects in these groups will be hit.
+  Bits32 collision_filter = Bits32::All();
+};
+
+// Finds all physics objects intersecting an axis-aligned box.
+struct BoxOverlapQuery {
+  Box box;
+
+  // Only physics objects in these groups will be reported.
+  Bits32 collision_filter = Bits32::All();
+};
+
+// Finds all physics objects intersecting a sphere.
+struct SphereOverlapQuery {
+  vec3 center = vec3::Zero();
+  float radius = 0.f;
+
+  // Only physics objects in these groups will be reported.
+  Bits32 collision_filter = Bits32::All();
+};
+
+// A single hit reported by a raycast or sweep query. The `entity` is invalid if
+// nothing was hit.
+struct SceneQueryHit {
+  Entity entity;
+  vec3 position = vec3::Zero();
+  vec3 normal = vec3::Zero();
+
+  // The distance along the ray or sweep at which the hit occurred.
+  float distance = 0.f;
+};
+
+// The range of elements in a shared output array that belong to a single query
+// of a batch.
+struct SceneQueryRange {
+  size_t offset = 0;
+  size_t count = 0;
+};
+
+}  // namespace redux
+
+#endif  // REDUX_ENGINES_PHYSICS_SCENE_QUERY_H_
@@ -37,6 +37,29 @@ absl::Span<const PhysicsEngine::ContactPoint> PhysicsEngine::GetActiveContacts(
     Entity entity_a, Entity entity_b) const {
   return Upcast(this)->GetActiveContacts(entity_a, entity_b);
 }
+void PhysicsEngine::RaycastClosest(absl::Span<const RaycastQuery> queries,
+                                   absl::Span<SceneQueryHit> results) const {
+  Upcast(this)->RaycastClosest(queries, results);
+}
+void PhysicsEngine::RaycastAll(absl::Span<const RaycastQuery> queries,
+                               std::vector<SceneQueryHit>* hits,
+                               absl::Span<SceneQueryRange> ranges) const {
+  Upcast(this)->RaycastAll(queries, hits, ranges);
+}
+void PhysicsEngine::SweepClosest(absl::Span<const SweepQuery> queries,
+                                 absl::Span<SceneQueryHit> results) const {
+  Upcast(this)->SweepClosest(queries, results);
+}
+void PhysicsEngine::OverlapBoxes(absl::Span<const BoxOverlapQuery> queries,
+                                 std::vector<Entity>* entities,
+                                 absl::Span<SceneQueryRange> ranges) const {
+  Upcast(this)->OverlapBoxes(queries, entities, ranges);
+}
+void PhysicsEngine::OverlapSpheres(
+    absl::Span<const SphereOverlapQuery> queries, std::vector<Entity>* entities,
+    absl::Span<SceneQueryRange> ranges) const {
+  Upcast(this)->OverlapSpheres(queries, entities, ranges);
+}
 void PhysicsEngine::AdvanceFrame(absl::Duration timestep) {
   Upcast(this)->AdvanceFrame(timestep);
 }
@@ -0,0 +1,100 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Measures the cost of calling native functions through the ScriptEngine.
+//
+// Each benchmark script is parsed once and then run repeatedly, so the
+// reported time is dominated by argument evaluation, argument conversion and
+// returning values through ScriptValues.
+
+#include <cstdio>
+#include <memory>
+#include <string_view>
+
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "redux/engines/script/script_engine.h"
+#include "redux/modules/base/logging.h"
+#include "redux/modules/math/vector.h"
+
+ABSL_FLAG(int, iterations, 100000, "Number of times to run each script.");
+
+namespace redux {
+namespace {
+
+int AddInts(int x, int y) { return x + y; }
+
+float MulFloats(float x, float y) { return x * y; }
+
+vec3 ScaleVec3(const vec3& v, float s) { return v * s; }
+
+// Each script performs this many native function calls.
+constexpr int kCallsPerRun = 4;
+
+constexpr std::string_view kScalarScript =
+    "(add_ints (add_ints 1 2) (add_ints 3 (add_ints 4 5)))";
+constexpr std::string_view kFloatScript =
+    "(mul_floats (mul_floats 1.5f 2.0f) "
+    "(mul_floats 0.5f (mul_floats 2.0f 3.0f)))";
+constexpr std::string_view kVectorScript =
+    "(scale_vec3 (scale_vec3 (scale_vec3 (vec3 1.0f 2.0f 3.0f) 2.0f) 0.5f) "
+    "4.0f)";
+
+void RunBenchmark(ScriptEngine* engine, const char* name,
+                  std::string_view code, int iterations) {
+  std::unique_ptr<Script> script = engine->ReadScript(code, name);
+  CHECK(script != nullptr) << "Unable to read script: " << name;
+
+  // Warm up any lazily initialized state before timing.
+  script->Run();
+
+  const absl::Time start = absl::Now();
+  for (int i = 0; i < iterations; ++i) {
+    script->Run();
+  }
+  const absl::Duration elapsed = absl::Now() - start;
+
+  const double num_calls = static_cast<double>(iterations) * kCallsPerRun;
+  const double ns_per_call = absl::ToDoubleNanoseconds(elapsed) / num_calls;
+  std::printf("%-12s %10d runs %10.1f ns/call\n", name, iterations,
+              ns_per_call);
+}
+
+int RunBenchmarks() {
+  const int iterations = absl::GetFlag(FLAGS_iterations);
+
+  Registry registry;
+  ScriptEngine::Create(&registry);
+  ScriptEngine* engine = registry.Get<ScriptEngine>();
+  engine->RegisterFunction("add_ints", AddInts);
+  engine->RegisterFunction("mul_floats", MulFloats);
+  engine->RegisterFunction("scale_vec3", ScaleVec3);
+
+  RunBenchmark(engine, "scalar", kScalarScript, iterations);
+  RunBenchmark(engine, "float", kFloatScript, iterations);
+  RunBenchmark(engine, "vector", kVectorScript, iterations);
+  return 0;
+}
+
+}  // namespace
+}  // namespace redux
+
+int main(int argc, char** argv) {
+  absl::ParseCommandLine(argc, argv);
+  return redux::RunBenchmarks();
+}
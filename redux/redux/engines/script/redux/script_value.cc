@@ -19,11 +19,13 @@ limitations under the License.
 namespace redux {
 
 TypeId ScriptValue::GetTypeId() const {
-  return var_ptr_ ? var_ptr_->GetTypeId() : TypeId(0);
+  const Var* var = GetVar();
+  return var ? var->GetTypeId() : TypeId(0);
 }
 
 bool ScriptValue::IsNil() const {
-  return var_ptr_ == nullptr || var_ptr_->Empty();
+  const Var* var = GetVar();
+  return var == nullptr || var->Empty();
 }
 
 ScriptValue::operator bool() const { return !IsNil(); }
@@ -18,13 +18,30 @@ limitations under the License.
 #define REDUX_ENGINES_SCRIPT_REDUX_SCRIPT_VALUE_H_
 
 #include <memory>
+#include <type_traits>
 
+#include "absl/time/time.h"
+#include "redux/modules/base/hash.h"
 #include "redux/modules/base/typeid.h"
+#include "redux/modules/ecs/entity.h"
+#include "redux/modules/math/quaternion.h"
+#include "redux/modules/math/vector.h"
 #include "redux/modules/var/var.h"
 #include "redux/modules/var/var_convert.h"
 
 namespace redux {
 
+// Holds the result of evaluating a script expression.
+//
+// Scalars and small math types (see InlineTypes below) are stored directly in
+// the ScriptValue so that passing numbers through the ScriptStack and native
+// function bindings does not require a heap allocation. Copying such a
+// ScriptValue copies the value.
+//
+// All other values (eg. strings, arrays, tables, AST nodes) are stored in a
+// reference-counted Var that is shared between copies of the ScriptValue.
+// Script functions (eg. array-push) rely on being able to modify these values
+// in place, so the sharing is intentionally not copy-on-write.
 class ScriptValue {
  public:
   ScriptValue() = default;
@@ -54,7 +71,36 @@ class ScriptValue {
   explicit operator bool() const;
 
  private:
+  template <typename... Ts>
+  struct TypeList {
+    template <typename T>
+    static constexpr bool Contains() {
+      return (std::is_same_v<T, Ts> || ...);
+    }
+
+    static bool Contains(TypeId type) {
+      return ((type == redux::GetTypeId<Ts>()) || ...);
+    }
+  };
+
+  // Types that fit in the Var's small buffer and are cheap to copy.
+  using InlineTypes =
+      TypeList<bool, int8_t, uint8_t, int16_t, uint16_t, int32_t, uint32_t,
+               int64_t, uint64_t, float, double, HashValue, Entity,
+               absl::Duration, vec2, vec3, vec4, vec2i, vec3i, vec4i, quat>;
+
+  // Returns the Var holding the value, or null if the ScriptValue is unset.
+  Var* GetVar() {
+    return var_ptr_ ? var_ptr_.get()
+                    : (inline_var_.Empty() ? nullptr : &inline_var_);
+  }
+  const Var* GetVar() const {
+    return var_ptr_ ? var_ptr_.get()
+                    : (inline_var_.Empty() ? nullptr : &inline_var_);
+  }
+
   std::shared_ptr<Var> var_ptr_;
+  Var inline_var_;
 };
 
 template <typename T>
@@ -64,42 +110,58 @@ ScriptValue::ScriptValue(T&& value) {
 
 template <typename T>
 void ScriptValue::Set(T&& value) {
-  if constexpr (std::is_same_v<typename std::decay<T>::type, ScriptValue>) {
-    var_ptr_ = value.var_ptr_;
+  using U = std::decay_t<T>;
+  if constexpr (std::is_same_v<U, ScriptValue>) {
+    if (&value != this) {
+      var_ptr_ = value.var_ptr_;
+      inline_var_ = value.inline_var_;
+    }
+  } else if constexpr (InlineTypes::Contains<U>()) {
+    // Assign before releasing var_ptr_ in case `value` lives inside it.
+    inline_var_ = std::forward<T>(value);
+    var_ptr_.reset();
+  } else if constexpr (std::is_same_v<U, Var>) {
+    if (&value == &inline_var_) {
+      return;
+    } else if (InlineTypes::Contains(value.GetTypeId())) {
+      inline_var_ = std::forward<T>(value);
+      var_ptr_.reset();
+    } else {
+      auto ptr = std::make_shared<Var>(std::forward<T>(value));
+      inline_var_.Clear();
+      var_ptr_ = std::move(ptr);
+    }
   } else {
-    var_ptr_ = std::make_shared<Var>();
-    const bool ok = ToVar(value, var_ptr_.get());
+    auto ptr = std::make_shared<Var>();
+    const bool ok = ToVar(value, ptr.get());
     CHECK(ok);
+    inline_var_.Clear();
+    var_ptr_ = std::move(ptr);
   }
 }
 
 template <typename T>
 bool ScriptValue::Is() const {
-  return var_ptr_ ? var_ptr_->Is<T>() : false;
+  const Var* var = GetVar();
+  return var ? var->Is<T>() : false;
 }
 
 template <typename T>
 T* ScriptValue::Get() {
-  if constexpr (std::is_same_v<T, Var>) {
-    return var_ptr_ ? var_ptr_.get() : nullptr;
-  } else {
-    return var_ptr_ ? var_ptr_->Get<T>() : nullptr;
-  }
+  Var* var = GetVar();
+  return var ? var->Get<T>() : nullptr;
 }
 
 template <typename T>
 const T* ScriptValue::Get() const {
-  if constexpr (std::is_same_v<T, Var>) {
-    return var_ptr_ ? var_ptr_.get() : nullptr;
-  } else {
-    return var_ptr_ ? var_ptr_->Get<T>() : nullptr;
-  }
+  const Var* var = GetVar();
+  return var ? var->Get<T>() : nullptr;
 }
 
 template <typename T>
 bool ScriptValue::GetAs(T* out) const {
-  if (var_ptr_) {
-    return FromVar(*var_ptr_, out);
+  if (const Var* var = GetVar()) {
+    return FromVar(*var, out);
   }
   *out = T{};
   return false;
@@ -0,0 +1,126 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "redux/engines/script/redux/script_value.h"
+
+namespace redux {
+namespace {
+
+using ::testing::Eq;
+using ::testing::IsNull;
+using ::testing::NotNull;
+
+TEST(ScriptValueTest, Nil) {
+  ScriptValue value;
+  EXPECT_TRUE(value.IsNil());
+  EXPECT_FALSE(value);
+  EXPECT_THAT(value.GetTypeId(), Eq(TypeId(0)));
+  EXPECT_THAT(value.Get<Var>(), IsNull());
+
+  int out = 1;
+  EXPECT_FALSE(value.GetAs(&out));
+  EXPECT_THAT(out, Eq(0));
+}
+
+TEST(ScriptValueTest, EmptyVar) {
+  ScriptValue value(Var{});
+  EXPECT_TRUE(value.IsNil());
+  EXPECT_THAT(value.Get<Var>(), NotNull());
+}
+
+TEST(ScriptValueTest, Scalar) {
+  ScriptValue value(123);
+  EXPECT_FALSE(value.IsNil());
+  EXPECT_TRUE(value.Is<int>());
+  EXPECT_THAT(value.GetTypeId(), Eq(GetTypeId<int>()));
+  EXPECT_THAT(*value.Get<int>(), Eq(123));
+  EXPECT_THAT(value.Get<Var>()->ValueOr(0), Eq(123));
+
+  float out = 0.f;
+  EXPECT_TRUE(value.GetAs(&out));
+  EXPECT_THAT(out, Eq(123.f));
+}
+
+TEST(ScriptValueTest, ScalarCopiesAreIndependent) {
+  ScriptValue a(1.f);
+  ScriptValue b = a;
+  *a.Get<float>() = 2.f;
+  EXPECT_THAT(*a.Get<float>(), Eq(2.f));
+  EXPECT_THAT(*b.Get<float>(), Eq(1.f));
+}
+
+TEST(ScriptValueTest, MathTypes) {
+  ScriptValue value(vec3(1, 2, 3));
+  EXPECT_TRUE(value.Is<vec3>());
+  EXPECT_THAT(*value.Get<vec3>(), Eq(vec3(1, 2, 3)));
+
+  value.Set(quat::Identity());
+  EXPECT_TRUE(value.Is<quat>());
+  EXPECT_FALSE(value.Is<vec3>());
+}
+
+TEST(ScriptValueTest, LargeValuesAreShared) {
+  ScriptValue a(std::string("hello"));
+  ScriptValue b = a;
+  a.Get<std::string>()->append(" world");
+  EXPECT_THAT(*b.Get<std::string>(), Eq("hello world"));
+  EXPECT_THAT(a.Get<Var>(), Eq(b.Get<Var>()));
+}
+
+TEST(ScriptValueTest, SetFromVar) {
+  Var var = 12;
+  ScriptValue value(var);
+  EXPECT_THAT(*value.Get<int>(), Eq(12));
+
+  var = std::string("abc");
+  value.Set(var);
+  EXPECT_THAT(*value.Get<std::string>(), Eq("abc"));
+
+  // Switching back to an inline value releases the shared value.
+  value.Set(3.f);
+  EXPECT_FALSE(value.Is<std::string>());
+  EXPECT_THAT(*value.Get<float>(), Eq(3.f));
+}
+
+TEST(ScriptValueTest, SetFromSelf) {
+  ScriptValue value(7);
+  value.Set(*value.Get<Var>());
+  EXPECT_THAT(*value.Get<int>(), Eq(7));
+
+  value.Set(std::string("abc"));
+  value.Set(*value.Get<Var>());
+  EXPECT_THAT(*value.Get<std::string>(), Eq("abc"));
+
+  value.Set(value);
+  EXPECT_THAT(*value.Get<std::string>(), Eq("abc"));
+}
+
+TEST(ScriptValueTest, SetFromContainedValue) {
+  VarArray array;
+  array.PushBack(5);
+  ScriptValue value(array);
+
+  const Var* element = &(*value.Get<Var>())[0];
+  value.Set(*element);
+  EXPECT_THAT(*value.Get<int>(), Eq(5));
+}
+
+}  // namespace
+}  // namespace redux
@@ -16,10 +16,56 @@ limitations under the License.
 
 #include "redux/modules/base/choreographer.h"
 
+#include <algorithm>
 #include <cstddef>
+#include <functional>
+#include <queue>
+#include <thread>
+
+#include "absl/strings/str_format.h"
 
 namespace redux {
 
+static std::size_t GetTimingBucket(absl::Duration duration) {
+  int64_t us = absl::ToInt64Microseconds(duration);
+  std::size_t bucket = 0;
+  while (us > 0 && bucket + 1 < Choreographer::kNumTimingBuckets) {
+    us >>= 1;
+    ++bucket;
+  }
+  return bucket;
+}
+
+static const char* GetStageName(Choreographer::Stage stage) {
+  switch (stage) {
+    case Choreographer::Stage::kPrologue:
+      return "Prologue";
+    case Choreographer::Stage::kInput:
+      return "Input";
+    case Choreographer::Stage::kEvents:
+      return "Events";
+    case Choreographer::Stage::kLogic:
+      return "Logic";
+    case Choreographer::Stage::kAnimation:
+      return "Animation";
+    case Choreographer::Stage::kPhysics:
+      return "Physics";
+    case Choreographer::Stage::kPostPhysics:
+      return "PostPhysics";
+    case Choreographer::Stage::kRender:
+      return "Render";
+    case Choreographer::Stage::kEpilogue:
+      return "Epilogue";
+    case Choreographer::Stage::kNumStages:
+      break;
+  }
+  return "";
+}
+
+static double ToMicroseconds(absl::Duration duration) {
+  return absl::ToDoubleMicroseconds(duration);
+}
+
 Choreographer::Choreographer(Registry* registry) : registry_(registry) {
   constexpr std::size_t num_stages =
       static_cast<std::size_t>(Stage::kNumStages);
@@ -37,15 +83,279 @@ Choreographer::Choreographer(Registry* registry) : registry_(registry) {
 
 void Choreographer::AddDependency(Tag node, Tag dependency) {
   graph_.AddDependency(node, dependency);
+  schedule_.clear();
+}
+
+void Choreographer::SetConcurrent(Tag tag) {
+  auto iter = handlers_.find(tag);
+  if (iter != handlers_.end()) {
+    iter->second->concurrent = true;
+  }
+}
+
+void Choreographer::SetBudget(Tag tag, absl::Duration budget) {
+  auto iter = handlers_.find(tag);
+  if (iter != handlers_.end()) {
+    iter->second->timing.budget = budget;
+  }
+}
+
+void Choreographer::SetBudgetExceededCallback(BudgetExceededFn fn) {
+  budget_exceeded_fn_ = std::move(fn);
+}
+
+void Choreographer::EnableProfiling(bool enable) {
+  profiling_ = enable;
+  for (auto& iter : handlers_) {
+    iter.second->timing.Clear();
+  }
+  stage_timings_ = {};
+}
+
+void Choreographer::SetExecutionMode(ExecutionMode mode,
+                                     std::size_t num_threads) {
+#ifdef REDUX_DISABLE_THREADS
+  mode = ExecutionMode::kSerial;
+#endif
+  mode_ = mode;
+  workers_.reset();
+  if (mode_ == ExecutionMode::kParallel) {
+    if (num_threads == 0) {
+      num_threads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    workers_ = std::make_unique<AsyncProcessor<std::size_t>>(num_threads);
+  }
 }
 
 void Choreographer::Step(absl::Duration delta_time) {
-  graph_.Traverse([=](Tag tag) {
+  if (mode_ == ExecutionMode::kParallel) {
+    StepParallel(delta_time);
+  } else {
+    graph_.Traverse([=](Tag tag) {
+      auto iter = handlers_.find(tag);
+      if (iter != handlers_.end()) {
+        StepHandler(iter->second.get(), delta_time);
+      }
+    });
+  }
+
+  if (profiling_) {
+    RecordTimings();
+  }
+}
+
+void Choreographer::StepHandler(HandlerBase* handler,
+                                absl::Duration delta_time) {
+  if (!profiling_) {
+    handler->Step(registry_, delta_time);
+    return;
+  }
+
+  const absl::Time start = absl::Now();
+  handler->Step(registry_, delta_time);
+  handler->timing.last = absl::Now() - start;
+}
+
+void Choreographer::RecordTimings() {
+  stage_timings_ = {};
+  for (auto& iter : handlers_) {
+    HandlerBase* handler = iter.second.get();
+    TimingSamples& timing = handler->timing;
+    timing.Add(timing.last);
+
+    const std::size_t stage_index = static_cast<std::size_t>(handler->stage);
+    StageTiming& stage = stage_timings_[stage_index];
+    stage.last += timing.last;
+    stage.average += timing.sum / static_cast<int64_t>(timing.samples.size());
+
+    if (timing.last > timing.budget) {
+      ++timing.num_over_budget;
+      if (budget_exceeded_fn_) {
+        budget_exceeded_fn_(handler->GetName(), timing.last, timing.budget);
+      } else {
+        LOG(WARNING) << handler->GetName() << " took "
+                     << absl::FormatDuration(timing.last)
+                     << ", exceeding its budget of "
+                     << absl::FormatDuration(timing.budget);
+      }
+    }
+  }
+}
+
+void Choreographer::TimingSamples::Add(absl::Duration duration) {
+  if (samples.size() < kTimingWindow) {
+    samples.push_back(duration);
+  } else {
+    sum -= samples[next];
+    --histogram[GetTimingBucket(samples[next])];
+    samples[next] = duration;
+  }
+  next = (next + 1) % kTimingWindow;
+  sum += duration;
+  ++histogram[GetTimingBucket(duration)];
+}
+
+void Choreographer::TimingSamples::Clear() {
+  samples.clear();
+  next = 0;
+  num_over_budget = 0;
+  sum = absl::ZeroDuration();
+  last = absl::ZeroDuration();
+  histogram = {};
+}
+
+std::vector<Choreographer::HandlerTiming> Choreographer::GetHandlerTimings()
+    const {
+  std::vector<HandlerTiming> timings;
+  graph_.Traverse([&](Tag tag) {
+    auto iter = handlers_.find(tag);
+    if (iter == handlers_.end()) {
+      return;
+    }
+    const HandlerBase* handler = iter->second.get();
+    const TimingSamples& samples = handler->timing;
+
+    HandlerTiming& timing = timings.emplace_back();
+    timing.name = handler->GetName();
+    timing.stage = handler->stage;
+    timing.budget = samples.budget;
+    timing.num_samples = samples.samples.size();
+    timing.num_over_budget = samples.num_over_budget;
+    timing.histogram = samples.histogram;
+    if (!samples.samples.empty()) {
+      timing.last = samples.last;
+      timing.average =
+          samples.sum / static_cast<int64_t>(samples.samples.size());
+      timing.max =
+          *std::max_element(samples.samples.begin(), samples.samples.end());
+    }
+  });
+  return timings;
+}
+
+Choreographer::StageTiming Choreographer::GetStageTiming(Stage stage) const {
+  return stage_timings_[static_cast<std::size_t>(stage)];
+}
+
+std::string Choreographer::GetFrameCostReport() const {
+  std::string report = absl::StrFormat(
+      "%-12s %-48s %10s %10s %10s %10s %6s\n", "Stage", "Function",
+      "Last(us)", "Avg(us)", "Max(us)", "Budget(us)", "Over");
+
+  const std::vector<HandlerTiming> timings = GetHandlerTimings();
+  for (std::size_t i = 0; i < static_cast<std::size_t>(Stage::kNumStages);
+       ++i) {
+    const Stage stage = static_cast<Stage>(i);
+    for (const HandlerTiming& timing : timings) {
+      if (timing.stage != stage) {
+        continue;
+      }
+      std::string budget = "-";
+      if (timing.budget != absl::InfiniteDuration()) {
+        budget = absl::StrFormat("%.1f", ToMicroseconds(timing.budget));
+      }
+      absl::StrAppendFormat(
+          &report, "%-12s %-48s %10.1f %10.1f %10.1f %10s %6d\n",
+          GetStageName(stage), timing.name, ToMicroseconds(timing.last),
+          ToMicroseconds(timing.average), ToMicroseconds(timing.max), budget,
+          timing.num_over_budget);
+    }
+    const StageTiming& total = stage_timings_[i];
+    absl::StrAppendFormat(&report, "%-12s %-48s %10.1f %10.1f\n",
+                          GetStageName(stage), "(total)",
+                          ToMicroseconds(total.last),
+                          ToMicroseconds(total.average));
+  }
+  return report;
+}
+
+void Choreographer::BuildSchedule() {
+  absl::flat_hash_map<Tag, std::size_t> indices;
+  graph_.Traverse([&](Tag tag) {
+    indices[tag] = schedule_.size();
+    ScheduleNode& node = schedule_.emplace_back();
     auto iter = handlers_.find(tag);
     if (iter != handlers_.end()) {
-      iter->second->Step(registry_, delta_time);
+      node.handler = iter->second.get();
     }
   });
+  graph_.ForAllEdges([&](Tag dependency, Tag tag) {
+    const std::size_t index = indices[tag];
+    schedule_[indices[dependency]].dependents.push_back(index);
+    ++schedule_[index].num_dependencies;
+  });
+}
+
+void Choreographer::StepParallel(absl::Duration delta_time) {
+  if (schedule_.empty()) {
+    BuildSchedule();
+  }
+
+  std::vector<int> num_remaining(schedule_.size());
+  for (std::size_t i = 0; i < schedule_.size(); ++i) {
+    num_remaining[i] = schedule_[i].num_dependencies;
+  }
+
+  // Nodes whose dependencies have all finished, ordered by their position in
+  // the serial traversal so that the order is as close to kSerial as possible.
+  std::priority_queue<std::size_t, std::vector<std::size_t>,
+                      std::greater<std::size_t>>
+      ready;
+  for (std::size_t i = 0; i < schedule_.size(); ++i) {
+    if (num_remaining[i] == 0) {
+      ready.push(i);
+    }
+  }
+
+  std::size_t num_finished = 0;
+  std::size_t num_running = 0;
+
+  // Must be called with |step_mutex_| locked.
+  auto finish = [&](std::size_t index) {
+    ++num_finished;
+    for (const std::size_t dependent : schedule_[index].dependents) {
+      if (--num_remaining[dependent] == 0) {
+        ready.push(dependent);
+      }
+    }
+  };
+
+  std::unique_lock<std::mutex> lock(step_mutex_);
+  while (num_finished < schedule_.size()) {
+    if (!ready.empty()) {
+      const std::size_t index = ready.top();
+      HandlerBase* handler = schedule_[index].handler;
+      if (handler == nullptr) {
+        ready.pop();
+        finish(index);
+        continue;
+      } else if (handler->concurrent) {
+        ready.pop();
+        ++num_running;
+        workers_->Execute(index, [&, handler](std::size_t* node) {
+          StepHandler(handler, delta_time);
+
+          // Notify while holding the lock, since the stack variables captured
+          // here are gone as soon as Step sees the last node finish.
+          std::lock_guard<std::mutex> worker_lock(step_mutex_);
+          --num_running;
+          finish(*node);
+          step_cv_.notify_one();
+        });
+        continue;
+      } else if (num_running == 0) {
+        // Functions that aren't concurrent run on the calling thread, and only
+        // once all concurrent functions have finished.
+        ready.pop();
+        lock.unlock();
+        StepHandler(handler, delta_time);
+        lock.lock();
+        finish(index);
+        continue;
+      }
+    }
+    step_cv_.wait(lock);
+  }
 }
 
 void Choreographer::AddToStage(Tag tag, Stage stage) {
@@ -74,4 +384,12 @@ Choreographer::DependencyBuilder::DependencyBuilder(Choreographer* advancer,
                                                     Tag tag)
     : advancer_(advancer), tag_(tag) {}
 
+Choreographer::DependencyBuilder&
+Choreographer::DependencyBuilder::Concurrent() {
+  if (advancer_) {
+    advancer_->SetConcurrent(tag_);
+  }
+  return *this;
+}
+
 }  // namespace redux
@@ -17,13 +17,18 @@ limitations under the License.
 #ifndef REDUX_MODULES_BASE_CHOREOGRAPHER_H_
 #define REDUX_MODULES_BASE_CHOREOGRAPHER_H_
 
+#include <array>
+#include <condition_variable>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/time/time.h"
+#include "redux/modules/base/async_processor.h"
 #include "redux/modules/base/dependency_graph.h"
 #include "redux/modules/base/logging.h"
 #include "redux/modules/base/registry.h"
@@ -47,6 +52,14 @@ namespace redux {
 //
 // More fine-grained ordering can be specified by explicitly registering a
 // function to be called either before or after another function.
+//
+// By default, all functions are called one at a time on the thread calling
+// Step. In the kParallel execution mode, functions that are registered as
+// Concurrent are instead run on worker threads as soon as all the functions
+// they are ordered after have finished.
+//
+// The choreographer can also measure how long each function takes to step. See
+// EnableProfiling for more details.
 class Choreographer {
  public:
   explicit Choreographer(Registry* registry);
@@ -74,10 +87,90 @@ class Choreographer {
   // users of this class should not concern themselves with this Tag.
   using Tag = uintptr_t;
 
+  // Controls how Step calls the registered functions.
+  enum class ExecutionMode {
+    // Functions are called one at a time on the calling thread in a fixed
+    // order that honors all stages and dependencies.
+    kSerial,
+    // Concurrent functions are run on worker threads as soon as everything
+    // they depend on has finished. All other functions are still called on
+    // the calling thread and never overlap with any other function.
+    kParallel,
+  };
+
   // Calls all the registered functions in order, passing them the provided
   // delta_time if applicable.
   void Step(absl::Duration delta_time);
 
+  // Sets the mode used by Step. |num_threads| is the number of worker threads
+  // used by kParallel mode; 0 uses one thread per hardware core. Must not be
+  // called during Step.
+  void SetExecutionMode(ExecutionMode mode, std::size_t num_threads = 0);
+
+  // The number of steps over which timing statistics are gathered.
+  static constexpr std::size_t kTimingWindow = 120;
+
+  // The number of buckets in a timing histogram. Bucket 0 counts samples
+  // shorter than 1us, bucket i counts samples in [2^(i-1), 2^i) us, and the
+  // last bucket counts everything longer.
+  static constexpr std::size_t kNumTimingBuckets = 16;
+
+  // Timing statistics of a single registered function over the last
+  // kTimingWindow steps.
+  struct HandlerTiming {
+    std::string_view name;
+    Stage stage = Stage::kPrologue;
+    absl::Duration last;
+    absl::Duration average;
+    absl::Duration max;
+    absl::Duration budget = absl::InfiniteDuration();
+    std::size_t num_samples = 0;
+    std::size_t num_over_budget = 0;
+    std::array<int, kNumTimingBuckets> histogram = {};
+  };
+
+  // Timing statistics of all the functions in a single stage. In kParallel
+  // mode this is the sum of the time spent in each function, not wall time.
+  struct StageTiming {
+    absl::Duration last;
+    absl::Duration average;
+  };
+
+  // Called when a function takes longer than its budget to step.
+  using BudgetExceededFn = std::function<void(
+      std::string_view name, absl::Duration duration, absl::Duration budget)>;
+
+  // Enables or disables measuring the time each function takes to step.
+  // Enabling profiling clears any previously gathered statistics. When
+  // disabled, the only overhead is a single branch per function per step.
+  void EnableProfiling(bool enable);
+
+  // Returns true if profiling is enabled.
+  bool IsProfilingEnabled() const { return profiling_; }
+
+  // Sets the maximum amount of time the function is expected to take to step.
+  // Exceeding the budget while profiling is enabled invokes the callback set
+  // with SetBudgetExceededCallback, or logs a warning if there is none. The
+  // function must have already been added.
+  template <auto Fn>
+  void SetBudget(absl::Duration budget) {
+    SetBudget(GetTag<Fn>(), budget);
+  }
+
+  // Sets the function to call when a function exceeds its budget. It is always
+  // called on the thread calling Step, after all functions have been stepped.
+  void SetBudgetExceededCallback(BudgetExceededFn fn);
+
+  // Returns the timing statistics of every registered function, in serial
+  // traversal order.
+  std::vector<HandlerTiming> GetHandlerTimings() const;
+
+  // Returns the timing statistics of the given stage.
+  StageTiming GetStageTiming(Stage stage) const;
+
+  // Returns a human-readable table of the cost of each function and stage.
+  std::string GetFrameCostReport() const;
+
   // A proxy class that can be used to provide more fine-grained control over
   // update ordering. An instance of this class is returned by
   // Choreographer::Add after which the Before/After functions can be used
@@ -97,6 +190,12 @@ class Choreographer {
     template <auto Fn>
     DependencyBuilder& After();
 
+    // Declares that the function registered with Add() does not share
+    // unsynchronized state with any function it isn't ordered against (by its
+    // stage or by Before/After), so it may run on a worker thread at the same
+    // time as other concurrent functions.
+    DependencyBuilder& Concurrent();
+
    private:
     Choreographer* advancer_ = nullptr;
     Tag tag_ = 0;
@@ -116,11 +215,37 @@ class Choreographer {
  private:
   using StepFn = std::function<void(absl::Duration)>;
 
+  // A rolling window of step durations for a single function.
+  struct TimingSamples {
+    void Add(absl::Duration duration);
+    void Clear();
+
+    std::vector<absl::Duration> samples;
+    std::size_t next = 0;
+    std::size_t num_over_budget = 0;
+    absl::Duration sum;
+    absl::Duration last;
+    absl::Duration budget = absl::InfiniteDuration();
+    std::array<int, kNumTimingBuckets> histogram = {};
+  };
+
   struct HandlerBase {
     virtual ~HandlerBase() = default;
     virtual std::string_view GetName() const = 0;
     virtual void Step(Registry* registry, absl::Duration) = 0;
     static std::string_view PrettyName(std::string_view name);
+    Stage stage = Stage::kPrologue;
+    bool concurrent = false;
+    TimingSamples timing;
+  };
+
+  // A node of the dependency graph, flattened for parallel stepping. Nodes are
+  // stored in their serial traversal order.
+  struct ScheduleNode {
+    // Null for the nodes marking the start and end of each stage.
+    HandlerBase* handler = nullptr;
+    int num_dependencies = 0;
+    std::vector<std::size_t> dependents;
   };
 
   template <auto T>
@@ -171,7 +296,9 @@ class Choreographer {
     if (auto& h = handlers_[tag]; h == nullptr) {
       graph_.AddNode(tag);
       h = std::make_unique<Handler<Fn>>();
+      h->stage = stage;
       AddToStage(tag, stage);
+      schedule_.clear();
     }
     return tag;
   }
@@ -180,10 +307,31 @@ class Choreographer {
 
   void AddToStage(Tag tag, Stage stage);
 
+  void SetConcurrent(Tag tag);
+
+  void SetBudget(Tag tag, absl::Duration budget);
+
+  void StepHandler(HandlerBase* handler, absl::Duration delta_time);
+
+  void RecordTimings();
+
+  void StepParallel(absl::Duration delta_time);
+
+  void BuildSchedule();
+
   Registry* registry_;
   DependencyGraph<Tag> graph_;
   absl::flat_hash_map<Tag, std::unique_ptr<HandlerBase>> handlers_;
   std::vector<std::pair<Tag, Tag>> stage_tags_;
+  ExecutionMode mode_ = ExecutionMode::kSerial;
+  std::vector<ScheduleNode> schedule_;
+  std::unique_ptr<AsyncProcessor<std::size_t>> workers_;
+  std::mutex step_mutex_;
+  std::condition_variable step_cv_;
+  bool profiling_ = false;
+  BudgetExceededFn budget_exceeded_fn_;
+  std::array<StageTiming, static_cast<std::size_t>(Stage::kNumStages)>
+      stage_timings_ = {};
 };
 
 template <auto Fn>
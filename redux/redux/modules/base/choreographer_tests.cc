@@ -14,6 +14,12 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <utility>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "redux/modules/base/choreographer.h"
@@ -22,6 +28,7 @@ namespace redux {
 namespace {
 
 using ::testing::Eq;
+using ::testing::HasSubstr;
 
 struct Tracker {
   void Track(std::string_view name) {
@@ -45,10 +52,43 @@ struct TestObjectNoDt {
   Tracker& tracker;
 };
 
+constexpr std::size_t kNumNodes = 12;
+
+// A set of step functions that record when they start and finish.
+struct NodeRecorder {
+  template <std::size_t N>
+  void Step() {
+    const int num_running = ++running;
+    if (!concurrent[N] && num_running != 1) {
+      exclusive_overlapped = true;
+    }
+    start[N] = clock++;
+    // Give other nodes a chance to (incorrectly) run at the same time.
+    std::this_thread::yield();
+    finish[N] = clock++;
+    threads[N] = std::this_thread::get_id();
+    --running;
+  }
+
+  std::atomic<int> clock = 0;
+  std::atomic<int> running = 0;
+  std::atomic<bool> exclusive_overlapped = false;
+  std::array<int, kNumNodes> start;
+  std::array<int, kNumNodes> finish;
+  std::array<std::thread::id, kNumNodes> threads;
+  std::array<bool, kNumNodes> concurrent;
+};
+
+struct SlowObject {
+  void Step() { std::this_thread::sleep_for(std::chrono::milliseconds(2)); }
+};
+
 }  // namespace
 }  // namespace redux
 REDUX_SETUP_TYPEID(redux::TestObject);
 REDUX_SETUP_TYPEID(redux::TestObjectNoDt);
+REDUX_SETUP_TYPEID(redux::NodeRecorder);
+REDUX_SETUP_TYPEID(redux::SlowObject);
 namespace redux {
 namespace {
 
@@ -101,5 +141,207 @@ TEST(ChoreographerTest, After) {
   EXPECT_THAT(tracker.ordered_calls[1], Eq("TestObject::Step"));
 }
 
+TEST(ChoreographerTest, ProfilingDisabled) {
+  Tracker tracker;
+  Registry registry;
+  registry.Create<TestObject>(tracker);
+
+  Choreographer choreo(&registry);
+  choreo.Add<&TestObject::Step>(Choreographer::Stage::kPrologue);
+
+  choreo.Step(absl::ZeroDuration());
+  EXPECT_FALSE(choreo.IsProfilingEnabled());
+
+  const auto timings = choreo.GetHandlerTimings();
+  EXPECT_THAT(timings.size(), Eq(1));
+  EXPECT_THAT(timings[0].num_samples, Eq(0));
+}
+
+TEST(ChoreographerTest, Profiling) {
+  Tracker tracker;
+  Registry registry;
+  registry.Create<TestObject>(tracker);
+  registry.Create<SlowObject>();
+
+  Choreographer choreo(&registry);
+  choreo.Add<&TestObject::Step>(Choreographer::Stage::kInput);
+  choreo.Add<&SlowObject::Step>(Choreographer::Stage::kPhysics);
+  choreo.EnableProfiling(true);
+
+  const int kNumSteps = 5;
+  for (int i = 0; i < kNumSteps; ++i) {
+    choreo.Step(absl::ZeroDuration());
+  }
+
+  const auto timings = choreo.GetHandlerTimings();
+  EXPECT_THAT(timings.size(), Eq(2));
+  EXPECT_THAT(timings[0].name, HasSubstr("TestObject::Step"));
+  EXPECT_THAT(timings[0].stage, Eq(Choreographer::Stage::kInput));
+  EXPECT_THAT(timings[1].name, HasSubstr("SlowObject::Step"));
+  EXPECT_THAT(timings[1].stage, Eq(Choreographer::Stage::kPhysics));
+  for (const auto& timing : timings) {
+    EXPECT_THAT(timing.num_samples, Eq(kNumSteps));
+    EXPECT_THAT(timing.num_over_budget, Eq(0));
+    int num_bucketed = 0;
+    for (int count : timing.histogram) {
+      num_bucketed += count;
+    }
+    EXPECT_THAT(num_bucketed, Eq(kNumSteps));
+  }
+  EXPECT_GE(timings[1].last, absl::Milliseconds(2));
+  EXPECT_GE(timings[1].average, absl::Milliseconds(2));
+  EXPECT_GE(timings[1].max, timings[1].average);
+
+  const auto physics = choreo.GetStageTiming(Choreographer::Stage::kPhysics);
+  EXPECT_GE(physics.last, absl::Milliseconds(2));
+  const auto logic = choreo.GetStageTiming(Choreographer::Stage::kLogic);
+  EXPECT_THAT(logic.last, Eq(absl::ZeroDuration()));
+
+  const std::string report = choreo.GetFrameCostReport();
+  EXPECT_NE(report.find("SlowObject::Step"), std::string::npos);
+  EXPECT_NE(report.find("Physics"), std::string::npos);
+
+  // Re-enabling profiling clears the statistics.
+  choreo.EnableProfiling(true);
+  EXPECT_THAT(choreo.GetHandlerTimings()[1].num_samples, Eq(0));
+}
+
+TEST(ChoreographerTest, ProfilingBudget) {
+  Tracker tracker;
+  Registry registry;
+  registry.Create<TestObject>(tracker);
+  registry.Create<SlowObject>();
+
+  Choreographer choreo(&registry);
+  choreo.Add<&TestObject::Step>(Choreographer::Stage::kInput);
+  choreo.Add<&SlowObject::Step>(Choreographer::Stage::kPhysics);
+  choreo.SetBudget<&TestObject::Step>(absl::Seconds(10));
+  choreo.SetBudget<&SlowObject::Step>(absl::Milliseconds(1));
+
+  std::vector<std::string> exceeded;
+  choreo.SetBudgetExceededCallback(
+      [&](std::string_view name, absl::Duration duration,
+          absl::Duration budget) {
+        EXPECT_GT(duration, budget);
+        exceeded.emplace_back(name);
+      });
+
+  // Budgets are only checked when profiling.
+  choreo.Step(absl::ZeroDuration());
+  EXPECT_TRUE(exceeded.empty());
+
+  choreo.EnableProfiling(true);
+  choreo.Step(absl::ZeroDuration());
+  choreo.Step(absl::ZeroDuration());
+  EXPECT_THAT(exceeded.size(), Eq(2));
+  EXPECT_THAT(exceeded[0], HasSubstr("SlowObject::Step"));
+
+  const auto timings = choreo.GetHandlerTimings();
+  EXPECT_THAT(timings[0].num_over_budget, Eq(0));
+  EXPECT_THAT(timings[1].num_over_budget, Eq(2));
+  EXPECT_THAT(timings[1].budget, Eq(absl::Milliseconds(1)));
+}
+
+using Stage = Choreographer::Stage;
+
+constexpr std::array<Stage, kNumNodes> kNodeStages = {
+    Stage::kInput,   Stage::kInput,   Stage::kInput,   Stage::kLogic,
+    Stage::kLogic,   Stage::kLogic,   Stage::kLogic,   Stage::kPhysics,
+    Stage::kPhysics, Stage::kPhysics, Stage::kRender,  Stage::kRender,
+};
+
+// Every third node is not concurrent.
+constexpr bool IsConcurrent(std::size_t n) { return n % 3 != 2; }
+
+// Explicit dependencies between nodes in the same stage, as (node, dependency)
+// pairs.
+constexpr std::array<std::pair<std::size_t, std::size_t>, 5> kNodeEdges = {{
+    {1, 0},
+    {5, 3},
+    {6, 5},
+    {6, 4},
+    {9, 7},
+}};
+
+template <std::size_t... N>
+void AddNodes(Choreographer* choreo, std::index_sequence<N...>) {
+  auto add = [choreo](auto builder, std::size_t n) {
+    if (IsConcurrent(n)) {
+      builder.Concurrent();
+    }
+  };
+  (add(choreo->Add<&NodeRecorder::Step<N>>(kNodeStages[N]), N), ...);
+}
+
+template <std::size_t... I>
+void AddEdges(Choreographer* choreo, std::index_sequence<I...>) {
+  (choreo->Add<&NodeRecorder::Step<kNodeEdges[I].first>>(
+       kNodeStages[kNodeEdges[I].first])
+       .template After<&NodeRecorder::Step<kNodeEdges[I].second>>(),
+   ...);
+}
+
+void SetUpNodes(Choreographer* choreo, NodeRecorder* recorder) {
+  for (std::size_t i = 0; i < kNumNodes; ++i) {
+    recorder->concurrent[i] = IsConcurrent(i);
+  }
+  AddNodes(choreo, std::make_index_sequence<kNumNodes>());
+  AddEdges(choreo, std::make_index_sequence<kNodeEdges.size()>());
+}
+
+void ExpectOrderingHonored(const NodeRecorder& recorder) {
+  for (std::size_t a = 0; a < kNumNodes; ++a) {
+    for (std::size_t b = 0; b < kNumNodes; ++b) {
+      if (kNodeStages[a] < kNodeStages[b]) {
+        EXPECT_LT(recorder.finish[a], recorder.start[b]) << a << " " << b;
+      }
+    }
+  }
+  for (const auto& edge : kNodeEdges) {
+    EXPECT_LT(recorder.finish[edge.second], recorder.start[edge.first]);
+  }
+  EXPECT_FALSE(recorder.exclusive_overlapped);
+}
+
+TEST(ChoreographerTest, ParallelHonorsOrdering) {
+  Registry registry;
+  NodeRecorder* recorder = registry.Create<NodeRecorder>();
+
+  Choreographer choreo(&registry);
+  SetUpNodes(&choreo, recorder);
+  choreo.SetExecutionMode(Choreographer::ExecutionMode::kParallel, 4);
+
+  for (int i = 0; i < 200; ++i) {
+    recorder->clock = 0;
+    choreo.Step(absl::ZeroDuration());
+    EXPECT_THAT(recorder->clock.load(), Eq(2 * kNumNodes));
+    ExpectOrderingHonored(*recorder);
+  }
+
+  // Functions that are not concurrent always run on the calling thread.
+  for (std::size_t i = 0; i < kNumNodes; ++i) {
+    if (!IsConcurrent(i)) {
+      EXPECT_THAT(recorder->threads[i], Eq(std::this_thread::get_id()));
+    }
+  }
+}
+
+TEST(ChoreographerTest, SerialMatchesTraversal) {
+  Registry registry;
+  NodeRecorder* recorder = registry.Create<NodeRecorder>();
+
+  Choreographer choreo(&registry);
+  SetUpNodes(&choreo, recorder);
+  choreo.SetExecutionMode(Choreographer::ExecutionMode::kParallel, 4);
+  choreo.SetExecutionMode(Choreographer::ExecutionMode::kSerial);
+
+  choreo.Step(absl::ZeroDuration());
+  ExpectOrderingHonored(*recorder);
+  for (std::size_t i = 0; i < kNumNodes; ++i) {
+    EXPECT_THAT(recorder->finish[i], Eq(recorder->start[i] + 1));
+    EXPECT_THAT(recorder->threads[i], Eq(std::this_thread::get_id()));
+  }
+}
+
 }  // namespace
 }  // namespace redux
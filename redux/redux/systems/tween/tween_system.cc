@@ -130,94 +130,118 @@ TweenSystem::TweenId TweenSystem::Start(GenericTweenParams<T> params) {
 
   CHECK(params.duration > absl::ZeroDuration())
       << "Must specify a positive duration.";
-  // Our predefined splines are all 1ms in duration, so we need to slow-down or
-  // speed-up the playback to match the desired duration.
-  const float playback_rate = 1.f / absl::ToDoubleMilliseconds(params.duration);
 
   auto target_value = AsVec(params.target_value);
   using VecType = decltype(target_value);
 
-  VecType init_value(0.f);
-  if (params.init_value.has_value()) {
-    init_value = AsVec(params.init_value.value());
-  }
-
-  const TweenId tween_id = ++next_tween_id_;
-  Tween& tween = tweens_[tween_id];
-  tween.type = params.type;
-  tween.total_duration = params.duration;
-  tween.dimensions = VecType::kDims;
-  tween.on_update_callback = std::move(params.on_update_callback);
-  tween.on_completed_callback = std::move(params.on_completed_callback);
-
-  for (std::size_t i = 0; i < tween.dimensions; ++i) {
-    float init_value = 0.f;
+  vec4 init = vec4::Zero();
+  vec4 target = vec4::Zero();
+  for (int i = 0; i < VecType::kDims; ++i) {
     if (params.init_value.has_value()) {
-      init_value = AsVec(params.init_value.value())[i];
+      init.data[i] = AsVec(params.init_value.value())[i];
     }
-    float target_value = AsVec(params.target_value)[i];
-
-    AnimationPlayback& playback = tween.playback_params[i];
-    playback.playback_rate = playback_rate;
-    playback.value_offset = init_value;
-    playback.value_scale = target_value - init_value;
-
-    tween.value.data[i] = init_value;
-    tween.motivators[i] = engine_->AcquireMotivator<SplineMotivator>();
-    tween.motivators[i].SetSpline(*spline, playback);
+    target.data[i] = target_value[i];
   }
+
+  const TweenId tween_id = ++next_tween_id_;
+  index_[tween_id] = ids_.size();
+  ids_.push_back(tween_id);
+  init_values_.push_back(init);
+  deltas_.push_back(target - init);
+  target_values_.push_back(target);
+  values_.push_back(init);
+  channel_batches_.push_back(-1);
+
+  TweenInfo& info = infos_.emplace_back();
+  info.type = params.type;
+  info.dimensions = VecType::kDims;
+  info.on_update_callback = std::move(params.on_update_callback);
+  info.on_completed_callback = std::move(params.on_completed_callback);
+
+  // The motivator follows the normalized curve, from which all the dimensions
+  // of the tween are calculated in PostAnimation. Our predefined splines are
+  // all 1ms in duration, so we need to slow-down or speed-up the playback to
+  // match the desired duration.
+  info.playback.playback_rate =
+      1.f / absl::ToDoubleMilliseconds(params.duration);
+  SplineMotivator& motivator =
+      motivators_.emplace_back(engine_->AcquireMotivator<SplineMotivator>());
+  motivator.SetSpline(*spline, info.playback);
   return tween_id;
 }
 
 template <typename T>
 TweenSystem::TweenId TweenSystem::Start(Entity entity, HashValue channel,
                                         GenericTweenParams<T> params) {
-  Tween* prev_tween = GetTween(GetTweenId(entity, channel));
-  if (prev_tween) {
-    // Interrupt the previous tween.
-    if (prev_tween->on_completed_callback) {
-      prev_tween->on_completed_callback(kInterrupted);
-    }
-
+  const TweenId prev_tween_id = GetTweenId(entity, channel);
+  if (auto prev = GetIndex(prev_tween_id); prev.has_value()) {
     // Use the previous tweens current value as the initial vaule of the new
     // tween (if not provided by the caller).
     if (!params.init_value.has_value()) {
       if constexpr (std::is_same_v<T, float>) {
-        params.init_value = *prev_tween->value.data;
+        params.init_value = *values_[*prev].data;
       } else {
-        params.init_value = T(prev_tween->value.data);
+        params.init_value = T(values_[*prev].data);
       }
     }
+
+    // Interrupt the previous tween.
+    EndTween(prev_tween_id, kInterrupted);
   }
 
   // Start a new tween.
   const TweenId tween_id = Start(std::move(params));
 
   // Associate the tween with the entity and channel.
-  Tween& tween = tweens_[tween_id];
-  tween.entity = entity;
-  tween.channel = channel;
+  const std::size_t index = ids_.size() - 1;
+  infos_[index].entity = entity;
+  infos_[index].channel = channel;
+  channel_batches_[index] = GetChannelBatchIndex(channel);
   tween_components_[entity].tweens[channel] = tween_id;
   return tween_id;
 }
 
+void TweenSystem::SetChannelUpdateFn(HashValue channel, ChannelUpdateFn fn) {
+  int batch = GetChannelBatchIndex(channel);
+  if (batch < 0) {
+    if (!fn) {
+      return;
+    }
+    batch = static_cast<int>(batches_.size());
+    batches_.emplace_back();
+    channel_batch_index_[channel] = batch;
+    for (std::size_t i = 0; i < ids_.size(); ++i) {
+      if (infos_[i].channel == channel && infos_[i].entity != kNullEntity) {
+        channel_batches_[i] = batch;
+      }
+    }
+  }
+  // Batches are never removed so that the indices stored for each tween remain
+  // valid; an empty function simply disables the batch.
+  batches_[batch].fn = std::move(fn);
+}
+
+int TweenSystem::GetChannelBatchIndex(HashValue channel) const {
+  auto it = channel_batch_index_.find(channel);
+  return it != channel_batch_index_.end() ? it->second : -1;
+}
+
 void TweenSystem::Pause(TweenId tween_id) {
-  Tween* tween = GetTween(tween_id);
-  if (tween == nullptr) {
+  const auto index = GetIndex(tween_id);
+  if (!index.has_value()) {
     return;  // Invalid tween.
-  } else if (!tween->motivators[0].Valid()) {
+  }
+  SplineMotivator& motivator = motivators_[*index];
+  if (!motivator.Valid()) {
     return;  // Already paused.
   }
 
   // Our predefined splines all have a length of 1ms. We use that length in
   // order to determine how far along we are in the current spline playback and
   // use that value for when we want to resume the spline.
-  const absl::Duration spline_elapsed_time =
-      absl::Milliseconds(1) - tween->motivators[0].TimeRemaining();
-  for (std::size_t i = 0; i < tween->dimensions; ++i) {
-    tween->playback_params[i].start_time = spline_elapsed_time;
-    tween->motivators[i].Invalidate();
-  }
+  infos_[*index].playback.start_time =
+      absl::Milliseconds(1) - motivator.TimeRemaining();
+  motivator.Invalidate();
 }
 
 void TweenSystem::Pause(Entity entity) {
@@ -229,20 +253,20 @@ void TweenSystem::Pause(Entity entity) {
 }
 
 void TweenSystem::Unpause(TweenId tween_id) {
-  Tween* tween = GetTween(tween_id);
-  if (tween == nullptr) {
+  const auto index = GetIndex(tween_id);
+  if (!index.has_value()) {
     return;  // Invalild tween.
-  } else if (tween->type == kMaxNumTweenTypes) {
+  }
+  const TweenInfo& info = infos_[*index];
+  if (info.type == kMaxNumTweenTypes) {
     return;  // Already ended.
-  } else if (tween->motivators[0].Valid()) {
+  } else if (motivators_[*index].Valid()) {
     return;  // Already paused.
   }
 
-  const CompactSpline* spline = splines_[tween->type].get();
-  for (std::size_t i = 0; i < tween->dimensions; ++i) {
-    tween->motivators[i] = engine_->AcquireMotivator<SplineMotivator>();
-    tween->motivators[i].SetSpline(*spline, tween->playback_params[i]);
-  }
+  const CompactSpline* spline = splines_[info.type].get();
+  motivators_[*index] = engine_->AcquireMotivator<SplineMotivator>();
+  motivators_[*index].SetSpline(*spline, info.playback);
 }
 
 void TweenSystem::Unpause(Entity entity) {
@@ -264,27 +288,30 @@ void TweenSystem::Stop(Entity entity) {
 }
 
 void TweenSystem::EndTween(TweenId tween_id, CompletionReason reason) {
-  Tween* tween = GetTween(tween_id);
-  if (tween == nullptr) {
+  const auto index = GetIndex(tween_id);
+  if (!index.has_value()) {
     return;  // Invalid tween.
-  }
-
-  if (tween->on_completed_callback) {
-    tween->on_completed_callback(reason);
-  }
-  for (std::size_t i = 0; i < tween->dimensions; ++i) {
-    tween->motivators[i].Invalidate();
+  } else if (infos_[*index].type == kMaxNumTweenTypes) {
+    return;  // Already ended.
   }
 
   // Just invalidating the motivator is not enough (as that is also what
   // happens when a tween is paused), so also invalidate the tween type to
   // indicate that the tween has ended.
-  tween->type = kMaxNumTweenTypes;
+  motivators_[*index].Invalidate();
+  infos_[*index].type = kMaxNumTweenTypes;
 
   // We delay the actual destruction of the tween by 1 frame so that users
   // can still call GetCurrentValue one last time. (This also helps prevent
   // issues with deleting a tween inside a for-loop).
   completed_tweens_.push_back(tween_id);
+
+  // Move the callback out before invoking it since it may start new tweens,
+  // which can reallocate `infos_`.
+  auto on_completed_callback = std::move(infos_[*index].on_completed_callback);
+  if (on_completed_callback) {
+    on_completed_callback(reason);
+  }
 }
 
 void TweenSystem::OnEnable(Entity entity) { Pause(entity); }
@@ -306,58 +333,120 @@ TweenSystem::TweenId TweenSystem::GetTweenId(Entity entity,
   return it2->second;
 }
 
-TweenSystem::Tween* TweenSystem::GetTween(TweenId tween_id) {
-  auto it = tweens_.find(tween_id);
-  return it != tweens_.end() ? &it->second : nullptr;
-}
-
-const TweenSystem::Tween* TweenSystem::GetTween(TweenId tween_id) const {
-  auto it = tweens_.find(tween_id);
-  return it != tweens_.end() ? &it->second : nullptr;
+std::optional<std::size_t> TweenSystem::GetIndex(TweenId tween_id) const {
+  auto it = index_.find(tween_id);
+  if (it == index_.end()) {
+    return std::nullopt;
+  }
+  return it->second;
 }
 
 bool TweenSystem::IsTweenPlaying(TweenId tween_id) const {
-  const Tween* tween = GetTween(tween_id);
-  return tween ? tween->motivators[0].Valid() : false;
+  const auto index = GetIndex(tween_id);
+  return index.has_value() ? motivators_[*index].Valid() : false;
 }
 
 absl::Span<const float> TweenSystem::GetCurrentValue(TweenId tween_id) const {
-  const Tween* tween = GetTween(tween_id);
-  return tween ? tween->value.data : absl::Span<const float>();
+  const auto index = GetIndex(tween_id);
+  if (!index.has_value()) {
+    return {};
+  }
+  return values_[*index].data;
 }
 
 void TweenSystem::PostAnimation(absl::Duration delta_time) {
   EraseCompletedTweens();
 
-  for (auto& [tween_id, tween] : tweens_) {
-    if (!tween.motivators[0].Valid()) {
-      continue;  // Tween paused.
+  // Calculate the values of all playing tweens from the normalized curves that
+  // were evaluated by the AnimationEngine.
+  const std::size_t count = ids_.size();
+  updated_.clear();
+  finished_.clear();
+  for (std::size_t i = 0; i < count; ++i) {
+    const SplineMotivator& motivator = motivators_[i];
+    if (!motivator.Valid()) {
+      continue;  // Tween paused or ended.
     }
-
-    for (std::size_t i = 0; i < tween.dimensions; ++i) {
-      tween.value.data[i] = tween.motivators[i].Value();
+    updated_.push_back(i);
+    if (motivator.TimeRemaining() == absl::ZeroDuration()) {
+      values_[i] = target_values_[i];
+      finished_.push_back(i);
+    } else {
+      values_[i] = init_values_[i] + deltas_[i] * motivator.Value();
     }
+  }
 
-    if (tween.on_update_callback) {
-      tween.on_update_callback(tween.value.data);
+  // Gather the tweens on batched channels so that each channel is updated with
+  // a single call.
+  for (const std::size_t i : updated_) {
+    const int batch = channel_batches_[i];
+    if (batch >= 0 && batches_[batch].fn) {
+      batches_[batch].entities.push_back(infos_[i].entity);
+      batches_[batch].values.push_back(values_[i]);
     }
+  }
+  for (std::size_t i = 0; i < batches_.size(); ++i) {
+    if (batches_[i].entities.empty()) {
+      continue;
+    }
+    // Copy the function in case it is replaced while it is being called.
+    const ChannelUpdateFn fn = batches_[i].fn;
+    fn(batches_[i].entities, batches_[i].values);
+    batches_[i].entities.clear();
+    batches_[i].values.clear();
+  }
 
-    if (tween.motivators[0].TimeRemaining() == absl::ZeroDuration()) {
-      EndTween(tween_id, kCompleted);
+  // Callbacks may start or end tweens, so tweens are only referenced by index
+  // and id from here on. New tweens are only ever appended to the arrays and
+  // ended tweens are only erased in the next frame, so the indices gathered
+  // above remain valid.
+  for (const std::size_t i : updated_) {
+    if (infos_[i].on_update_callback) {
+      auto on_update_callback = std::move(infos_[i].on_update_callback);
+      const vec4 value = values_[i];
+      on_update_callback(value.data);
+      infos_[i].on_update_callback = std::move(on_update_callback);
     }
   }
+  for (const std::size_t i : finished_) {
+    EndTween(ids_[i], kCompleted);
+  }
 }
 
 void TweenSystem::EraseCompletedTweens() {
   for (const TweenId tween_id : completed_tweens_) {
-    auto it = tweens_.find(tween_id);
-    CHECK(it != tweens_.end()) << "Tween already destroyed?";
+    auto it = index_.find(tween_id);
+    CHECK(it != index_.end()) << "Tween already destroyed?";
+    const std::size_t index = it->second;
+    index_.erase(it);
+
+    const TweenInfo& info = infos_[index];
+    if (info.entity != kNullEntity && info.channel != HashValue(0) &&
+        GetTweenId(info.entity, info.channel) == tween_id) {
+      RemoveChannel(info.entity, info.channel);
+    }
 
-    Tween& tween = it->second;
-    if (tween.entity != kNullEntity && tween.channel != HashValue(0)) {
-      RemoveChannel(tween.entity, tween.channel);
+    // Move the last tween into the erased slot.
+    const std::size_t last = ids_.size() - 1;
+    if (index != last) {
+      ids_[index] = ids_[last];
+      motivators_[index] = std::move(motivators_[last]);
+      init_values_[index] = init_values_[last];
+      deltas_[index] = deltas_[last];
+      target_values_[index] = target_values_[last];
+      values_[index] = values_[last];
+      channel_batches_[index] = channel_batches_[last];
+      infos_[index] = std::move(infos_[last]);
+      index_[ids_[index]] = index;
     }
-    tweens_.erase(it);
+    ids_.pop_back();
+    motivators_.pop_back();
+    init_values_.pop_back();
+    deltas_.pop_back();
+    target_values_.pop_back();
+    values_.pop_back();
+    channel_batches_.pop_back();
+    infos_.pop_back();
   }
   completed_tweens_.clear();
 }
@@ -18,6 +18,8 @@ limitations under the License.
 #define REDUX_SYSTEMS_TWEEN_TWEEN_SYSTEM_H_
 
 #include <functional>
+#include <optional>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/time/time.h"
@@ -31,7 +33,10 @@ namespace redux {
 
 // Interpolates values between two points over time using common algorithms.
 //
-// The TweenSystem using the animation engine to drive the values.
+// The TweenSystem using the animation engine to drive the values. Each tween is
+// driven by a single motivator that follows a normalized (0 to 1) curve; the
+// tweened values are then computed for all tweens in a single pass over densely
+// packed arrays.
 class TweenSystem : public System {
  public:
   using TweenId = uint32_t;
@@ -143,6 +148,18 @@ class TweenSystem : public System {
   // if no such tween exists.
   absl::Span<const float> GetCurrentValue(TweenId tween_id) const;
 
+  // Receives the values of all tweens on a channel that were updated in a
+  // frame, where `values[i]` is the value of the tween on `entities[i]`. Only
+  // the first N components of each value are used by a tween of N dimensions.
+  using ChannelUpdateFn = std::function<void(absl::Span<const Entity> entities,
+                                             absl::Span<const vec4> values)>;
+
+  // Sets the function that receives all updates for tweens on `channel` with a
+  // single call per frame. This is much cheaper than using an
+  // `on_update_callback` per tween when many tweens share a channel. Passing an
+  // empty function removes the existing one.
+  void SetChannelUpdateFn(HashValue channel, ChannelUpdateFn fn);
+
   // Updates all the tweens, storing their current value. This function should
   // be called after updating the AnimationEngine. Note: this function is
   // automatically bound to the Choreographer if it is available.
@@ -152,17 +169,22 @@ class TweenSystem : public System {
   // Internally, we do everything with a span of floats.
   using TweenParamsSpan = GenericTweenParams<absl::Span<const float>>;
 
-  struct Tween {
-    vec4 value = vec4::Zero();
+  // Data about a tween that is not needed to calculate its values.
+  struct TweenInfo {
     Entity entity = kNullEntity;
     HashValue channel = HashValue(0);
     TweenType type = kQuadraticEaseInOut;
     std::size_t dimensions = 0;
-    absl::Duration total_duration = absl::ZeroDuration();
+    AnimationPlayback playback;
     std::function<void(absl::Span<const float>)> on_update_callback;
     std::function<void(CompletionReason)> on_completed_callback;
-    AnimationPlayback playback_params[4];
-    SplineMotivator motivators[4];
+  };
+
+  // The tweens on a channel that has a ChannelUpdateFn, gathered every frame.
+  struct ChannelBatch {
+    ChannelUpdateFn fn;
+    std::vector<Entity> entities;
+    std::vector<vec4> values;
   };
 
   struct TweenComponent {
@@ -173,8 +195,8 @@ class TweenSystem : public System {
   template <typename T>
   static TweenParamsSpan ToTweenParamsSpan(GenericTweenParams<T> params);
 
-  Tween* GetTween(TweenId tween_id);
-  const Tween* GetTween(TweenId tween_id) const;
+  // Returns the index of the tween in the arrays below, if it exists.
+  std::optional<std::size_t> GetIndex(TweenId tween_id) const;
 
   void OnEnable(Entity entity) override;
   void OnDisable(Entity entity) override;
@@ -183,13 +205,30 @@ class TweenSystem : public System {
   TweenId Start(TweenParamsSpan params);
   TweenId Start(Entity entity, HashValue channel, TweenParamsSpan params);
   void RemoveChannel(Entity entity, HashValue channel);
-  vec4 InterruptTween(TweenId tween_id);
   void EndTween(TweenId tween_id, CompletionReason reason);
   void EraseCompletedTweens();
+  int GetChannelBatchIndex(HashValue channel) const;
 
   AnimationEngine* engine_ = nullptr;
-  absl::flat_hash_map<TweenId, Tween> tweens_;
+
+  // All tweens are stored in parallel arrays, with completed tweens being
+  // swapped out of the end. Paused and completed tweens have an invalid
+  // motivator.
+  std::vector<TweenId> ids_;
+  std::vector<SplineMotivator> motivators_;
+  std::vector<vec4> init_values_;
+  std::vector<vec4> deltas_;
+  std::vector<vec4> target_values_;
+  std::vector<vec4> values_;
+  std::vector<int> channel_batches_;
+  std::vector<TweenInfo> infos_;
+  absl::flat_hash_map<TweenId, std::size_t> index_;
+
   absl::flat_hash_map<Entity, TweenComponent> tween_components_;
+  absl::flat_hash_map<HashValue, int> channel_batch_index_;
+  std::vector<ChannelBatch> batches_;
+  std::vector<std::size_t> updated_;
+  std::vector<std::size_t> finished_;
   CompactSplinePtr splines_[kMaxNumTweenTypes];
   std::vector<TweenId> completed_tweens_;
   TweenId next_tween_id_ = 1;
@@ -18,6 +18,7 @@ limitations under the License.
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
 #include "redux/systems/tween/tween_system.h"
 
 namespace redux {
@@ -483,5 +484,76 @@ TEST_F(TweenSystemTest, OnInterrupted) {
   EXPECT_THAT(result[0], Eq(0.0f));
 }
 
+
+TEST_F(TweenSystemTest, ChannelUpdateFn) {
+  static constexpr int kNumSteps = 10;
+  static constexpr int kNumEntities = 5;
+  const HashValue channel = ConstHash("test");
+
+  int num_calls = 0;
+  absl::flat_hash_map<Entity, float> values;
+  tween_system_->SetChannelUpdateFn(
+      channel, [&](absl::Span<const Entity> entities,
+                   absl::Span<const vec4> updates) {
+        ++num_calls;
+        EXPECT_THAT(entities.size(), Eq(updates.size()));
+        for (std::size_t i = 0; i < entities.size(); ++i) {
+          values[entities[i]] = updates[i].x;
+        }
+      });
+
+  TweenSystem::TweenParams1f params;
+  params.init_value = 0.0f;
+  params.duration = absl::Seconds(1);
+  for (int i = 0; i < kNumEntities; ++i) {
+    params.target_value = static_cast<float>(i + 1);
+    tween_system_->Start(Entity(i + 1), channel, params);
+  }
+
+  const auto delta_time = params.duration / static_cast<float>(kNumSteps);
+  for (int i = 0; i < kNumSteps; ++i) {
+    AdvanceFrame(delta_time);
+    EXPECT_THAT(num_calls, Eq(i + 1));
+    EXPECT_THAT(static_cast<int>(values.size()), Eq(kNumEntities));
+    for (const auto& [entity, value] : values) {
+      const TweenSystem::TweenId tween_id =
+          tween_system_->GetTweenId(entity, channel);
+      EXPECT_THAT(value, Eq(tween_system_->GetCurrentValue(tween_id)[0]));
+    }
+  }
+  for (int i = 0; i < kNumEntities; ++i) {
+    EXPECT_THAT(values[Entity(i + 1)], Eq(static_cast<float>(i + 1)));
+  }
+
+  // No more updates once all the tweens have completed.
+  AdvanceFrame(delta_time);
+  EXPECT_THAT(num_calls, Eq(kNumSteps));
+}
+
+TEST_F(TweenSystemTest, InterruptedTweenStopsUpdating) {
+  static constexpr int kNumSteps = 10;
+  const Entity entity(123);
+  const HashValue channel = ConstHash("test");
+
+  int num_updates = 0;
+  TweenSystem::TweenParams1f params;
+  params.init_value = 0.0f;
+  params.target_value = 1.0f;
+  params.duration = absl::Seconds(1);
+  params.on_update_callback = [&](absl::Span<const float>) { ++num_updates; };
+  tween_system_->Start(entity, channel, params);
+
+  const auto delta_time = params.duration / static_cast<float>(kNumSteps);
+  AdvanceFrame(delta_time);
+  EXPECT_THAT(num_updates, Eq(1));
+
+  params.on_update_callback = nullptr;
+  tween_system_->Start(entity, channel, params);
+  for (int i = 0; i < kNumSteps; ++i) {
+    AdvanceFrame(delta_time);
+  }
+  EXPECT_THAT(num_updates, Eq(1));
+}
+
 }  // namespace
 }  // namespace redux
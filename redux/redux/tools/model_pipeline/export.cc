@@ -425,6 +425,9 @@ void LogResults(const ModelAssetDefT& out, Logger& log) {
   for (size_t i = 0; i < out.lods.size(); ++i) {
     const auto& lod = out.lods[i];
     log("  ", i);
+    if (i < out.lod_screen_sizes.size()) {
+      log("    screen size: ", out.lod_screen_sizes[i]);
+    }
 
     log("    vertex format:");
     for (const auto& attrib : lod->vertices->vertex_format) {
@@ -469,7 +472,9 @@ void LogResults(const ModelAssetDefT& out, Logger& log) {
 }
 
 DataContainer ExportModel(absl::Span<const ModelPtr> lods, ModelPtr skeleton,
-                          ModelPtr collidable, Logger& log) {
+                          ModelPtr collidable,
+                          absl::Span<const float> lod_screen_sizes,
+                          Logger& log) {
   ModelAssetDefT model_def;
   model_def.version = 1;
 
@@ -503,6 +508,11 @@ DataContainer ExportModel(absl::Span<const ModelPtr> lods, ModelPtr skeleton,
     ExportModelInstance(*model, lod.get());
     model_def.lods.emplace_back(std::move(lod));
   }
+  if (!lod_screen_sizes.empty()) {
+    CHECK(lod_screen_sizes.size() == lods.size());
+    model_def.lod_screen_sizes.assign(lod_screen_sizes.begin(),
+                                      lod_screen_sizes.end());
+  }
 
   // Gather texture for export.
   absl::flat_hash_map<std::string, const TextureInfo*> textures;
@@ -25,9 +25,12 @@ limitations under the License.
 namespace redux::tool {
 
 // Generates a DataContainer storing an ModelAssetDdef binary object from the
-// provided models.
+// provided models. |lod_screen_sizes| must either be empty or contain one
+// screen-size threshold for each model in |lods|.
 DataContainer ExportModel(absl::Span<const ModelPtr> lods, ModelPtr skeleton,
-                          ModelPtr collidable, Logger& log);
+                          ModelPtr collidable,
+                          absl::Span<const float> lod_screen_sizes,
+                          Logger& log);
 
 }  // namespace redux::tool
 
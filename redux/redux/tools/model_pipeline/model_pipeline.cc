@@ -18,6 +18,7 @@ limitations under the License.
 
 #include "redux/modules/base/filepath.h"
 #include "redux/tools/model_pipeline/export.h"
+#include "redux/tools/model_pipeline/simplify.h"
 
 namespace redux::tool {
 
@@ -81,6 +82,29 @@ DataContainer ModelPipeline::Build(const Config& config) {
     renderables.emplace_back(GetImportedModel(name->c_str()));
   }
 
+  std::vector<float> lod_screen_sizes;
+  const LodGenerationConfig* lod_config = config.lod_generation();
+  if (lod_config && lod_config->count() > 1 && renderables.size() == 1) {
+    SimplifyOptions options;
+    options.target_ratio = lod_config->target_ratio();
+    options.max_error = lod_config->max_error();
+
+    std::vector<size_t> num_triangles = {GetNumTriangles(*renderables[0])};
+    for (int i = 1; i < lod_config->count(); ++i) {
+      ModelPtr lod = SimplifyModel(*renderables.back(), options);
+      const size_t count = GetNumTriangles(*lod);
+      if (count == 0 || count >= num_triangles.back()) {
+        break;
+      }
+      renderables.emplace_back(std::move(lod));
+      num_triangles.emplace_back(count);
+    }
+    if (renderables.size() > 1) {
+      lod_screen_sizes = ComputeLodScreenSizes(num_triangles,
+                                               lod_config->base_screen_size());
+    }
+  }
+
   ModelPtr skeleton;
   if (config.skeleton()) {
     skeleton = GetImportedModel(config.skeleton()->c_str());
@@ -91,7 +115,8 @@ DataContainer ModelPipeline::Build(const Config& config) {
     collidable = GetImportedModel(config.collidable()->c_str());
   }
 
-  return ExportModel(renderables, skeleton, collidable, log_);
+  return ExportModel(renderables, skeleton, collidable, lod_screen_sizes,
+                     log_);
 }
 
 }  // namespace redux::tool
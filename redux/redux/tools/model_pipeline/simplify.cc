@@ -0,0 +1,592 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "redux/tools/model_pipeline/simplify.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <queue>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+
+namespace redux::tool {
+namespace {
+
+
+constexpr uint32_t kInvalidIndex = 0xffffffff;
+
+// Collapses may not rotate any triangle by more than ~75 degrees.
+constexpr double kMinNormalCosine = 0.25;
+
+// Symmetric 4x4 matrix that measures the sum of squared distances from a point
+// to a set of planes.
+struct Quadric {
+  double xx = 0, xy = 0, xz = 0, xw = 0;
+  double yy = 0, yz = 0, yw = 0;
+  double zz = 0, zw = 0;
+  double ww = 0;
+
+  void AddPlane(double a, double b, double c, double d) {
+    xx += a * a;
+    xy += a * b;
+    xz += a * c;
+    xw += a * d;
+    yy += b * b;
+    yz += b * c;
+    yw += b * d;
+    zz += c * c;
+    zw += c * d;
+    ww += d * d;
+  }
+
+  void Add(const Quadric& rhs) {
+    xx += rhs.xx;
+    xy += rhs.xy;
+    xz += rhs.xz;
+    xw += rhs.xw;
+    yy += rhs.yy;
+    yz += rhs.yz;
+    yw += rhs.yw;
+    zz += rhs.zz;
+    zw += rhs.zw;
+    ww += rhs.ww;
+  }
+
+  double Evaluate(double x, double y, double z) const {
+    return xx * x * x + 2 * xy * x * y + 2 * xz * x * z + 2 * xw * x +
+           yy * y * y + 2 * yz * y * z + 2 * yw * y + zz * z * z +
+           2 * zw * z + ww;
+  }
+};
+
+struct Point {
+  double x = 0, y = 0, z = 0;
+};
+
+Point Subtract(const Point& a, const Point& b) {
+  Point p;
+  p.x = a.x - b.x;
+  p.y = a.y - b.y;
+  p.z = a.z - b.z;
+  return p;
+}
+
+Point Cross(const Point& a, const Point& b) {
+  Point p;
+  p.x = a.y * b.z - a.z * b.y;
+  p.y = a.z * b.x - a.x * b.z;
+  p.z = a.x * b.y - a.y * b.x;
+  return p;
+}
+
+double Dot(const Point& a, const Point& b) {
+  return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+// Simplifies an indexed triangle list by repeatedly collapsing the vertex with
+// the lowest quadric error onto one of its neighbours (a "half-edge
+// collapse"). The remaining vertices are never moved or modified, so all of
+// their attributes are preserved exactly.
+//
+// Vertices that share a position but differ in other attributes (eg. along UV
+// or normal seams) belong to the same "group". Such vertices, as well as
+// vertices on material boundaries and open borders, are never removed so that
+// seams and silhouettes stay intact. Vertices are also only collapsed onto
+// vertices that are primarily influenced by the same bone so that skinning is
+// preserved.
+class QuadricSimplifier {
+ public:
+  // |groups| holds the position group of each vertex and |bones| holds the
+  // bone that has the most influence on each vertex.  |regions| holds the
+  // material of each triangle.
+  QuadricSimplifier(std::vector<Point> positions, std::vector<uint32_t> groups,
+                    std::vector<int> bones, std::vector<uint32_t> indices,
+                    const std::vector<uint32_t>& regions)
+      : positions_(std::move(positions)),
+        groups_(std::move(groups)),
+        bones_(std::move(bones)),
+        indices_(std::move(indices)),
+        vertex_triangles_(positions_.size()),
+        removed_vertices_(positions_.size(), false),
+        locked_(positions_.size(), false),
+        versions_(positions_.size(), 0) {
+    const size_t num_triangles = indices_.size() / 3;
+    removed_triangles_.resize(num_triangles, false);
+    num_live_triangles_ = num_triangles;
+
+    uint32_t num_groups = 0;
+    for (uint32_t group : groups_) {
+      num_groups = std::max(num_groups, group + 1);
+    }
+    group_vertices_.resize(num_groups);
+    group_quadrics_.resize(num_groups);
+    for (uint32_t v = 0; v < groups_.size(); ++v) {
+      group_vertices_[groups_[v]].push_back(v);
+    }
+
+    // Accumulate the planes of all triangles around each position and count
+    // how many triangles use each edge (in position space).
+    absl::flat_hash_map<uint64_t, int> edge_counts;
+    for (uint32_t t = 0; t < num_triangles; ++t) {
+      const uint32_t* tri = &indices_[3 * t];
+      for (int i = 0; i < 3; ++i) {
+        vertex_triangles_[tri[i]].push_back(t);
+        ++edge_counts[EdgeKey(groups_[tri[i]], groups_[tri[(i + 1) % 3]])];
+      }
+
+      const Point normal = TriangleNormal(tri[0], tri[1], tri[2]);
+      const double length = std::sqrt(Dot(normal, normal));
+      if (length <= 0) {
+        continue;
+      }
+      const double a = normal.x / length;
+      const double b = normal.y / length;
+      const double c = normal.z / length;
+      const Point& p = positions_[tri[0]];
+      const double d = -(a * p.x + b * p.y + c * p.z);
+      for (int i = 0; i < 3; ++i) {
+        group_quadrics_[groups_[tri[i]]].AddPlane(a, b, c, d);
+      }
+    }
+
+    // Lock seams, material boundaries, open borders and non-manifold edges.
+    std::vector<uint32_t> group_regions(num_groups, kInvalidIndex);
+    for (uint32_t t = 0; t < num_triangles; ++t) {
+      for (int i = 0; i < 3; ++i) {
+        const uint32_t group = groups_[indices_[3 * t + i]];
+        if (group_regions[group] == kInvalidIndex) {
+          group_regions[group] = regions[t];
+        } else if (group_regions[group] != regions[t]) {
+          LockGroup(group);
+        }
+      }
+    }
+    for (uint32_t group = 0; group < num_groups; ++group) {
+      if (group_vertices_[group].size() > 1) {
+        LockGroup(group);
+      }
+    }
+    for (const auto& edge : edge_counts) {
+      if (edge.second != 2) {
+        LockGroup(static_cast<uint32_t>(edge.first >> 32));
+        LockGroup(static_cast<uint32_t>(edge.first & 0xffffffff));
+      }
+    }
+  }
+
+  // Collapses vertices until at most |target_triangles| triangles remain or
+  // until the next collapse would introduce an error larger than |max_error|.
+  // Returns the largest error introduced by any collapse.
+  double Simplify(size_t target_triangles, double max_error) {
+    const double max_cost = max_error > 0
+                                ? max_error * max_error
+                                : std::numeric_limits<double>::infinity();
+    for (uint32_t v = 0; v < positions_.size(); ++v) {
+      PushCandidate(v);
+    }
+
+    double result = 0;
+    while (num_live_triangles_ > target_triangles && !queue_.empty()) {
+      const Candidate candidate = queue_.top();
+      queue_.pop();
+      const uint32_t v = candidate.vertex;
+      if (removed_vertices_[v] || candidate.version != versions_[v]) {
+        continue;
+      }
+      if (candidate.cost > max_cost) {
+        break;
+      }
+
+      double cost = 0;
+      const uint32_t u = FindBestTarget(v, &cost);
+      if (u == kInvalidIndex) {
+        continue;
+      }
+      if (cost > candidate.cost) {
+        // The cheapest target was rejected, so try again in the right order.
+        queue_.push(Candidate{cost, v, versions_[v]});
+        continue;
+      }
+
+      Collapse(v, u);
+      result = std::max(result, cost);
+    }
+    return std::sqrt(std::max(result, 0.0));
+  }
+
+  // Returns the number of triangles that have not been removed.
+  size_t GetNumTriangles() const { return num_live_triangles_; }
+
+  // Returns whether or not the triangle |t| was removed.
+  bool IsTriangleRemoved(size_t t) const { return removed_triangles_[t]; }
+
+  // Returns the vertex indices of the triangle |t|.
+  const uint32_t* GetTriangle(size_t t) const { return &indices_[3 * t]; }
+
+ private:
+  struct Candidate {
+    double cost;
+    uint32_t vertex;
+    uint32_t version;
+
+    bool operator<(const Candidate& rhs) const { return cost > rhs.cost; }
+  };
+
+  static uint64_t EdgeKey(uint32_t a, uint32_t b) {
+    if (a > b) {
+      std::swap(a, b);
+    }
+    return (static_cast<uint64_t>(a) << 32) | b;
+  }
+
+  void LockGroup(uint32_t group) {
+    for (uint32_t v : group_vertices_[group]) {
+      locked_[v] = true;
+    }
+  }
+
+  Point TriangleNormal(uint32_t a, uint32_t b, uint32_t c) const {
+    return Cross(Subtract(positions_[b], positions_[a]),
+                 Subtract(positions_[c], positions_[a]));
+  }
+
+  bool IsCompatible(uint32_t v, uint32_t u) const {
+    return bones_[v] == bones_[u];
+  }
+
+  // Returns the cost of moving |v| onto |u|.
+  double GetCost(uint32_t v, uint32_t u) const {
+    Quadric quadric = group_quadrics_[groups_[v]];
+    quadric.Add(group_quadrics_[groups_[u]]);
+    const Point& p = positions_[u];
+    return std::max(quadric.Evaluate(p.x, p.y, p.z), 0.0);
+  }
+
+  // Collects the distinct vertices that share a live triangle with |v|.
+  void GatherNeighbors(uint32_t v, std::vector<uint32_t>* out) const {
+    out->clear();
+    for (uint32_t t : vertex_triangles_[v]) {
+      if (removed_triangles_[t]) {
+        continue;
+      }
+      for (int i = 0; i < 3; ++i) {
+        const uint32_t n = indices_[3 * t + i];
+        if (n != v && std::find(out->begin(), out->end(), n) == out->end()) {
+          out->push_back(n);
+        }
+      }
+    }
+  }
+
+  // Collects the distinct position groups that share a live triangle with any
+  // vertex in |group|.
+  void GatherNeighborGroups(uint32_t group, std::vector<uint32_t>* out) const {
+    out->clear();
+    for (uint32_t v : group_vertices_[group]) {
+      if (removed_vertices_[v]) {
+        continue;
+      }
+      for (uint32_t t : vertex_triangles_[v]) {
+        if (removed_triangles_[t]) {
+          continue;
+        }
+        for (int i = 0; i < 3; ++i) {
+          const uint32_t n = groups_[indices_[3 * t + i]];
+          if (n != group &&
+              std::find(out->begin(), out->end(), n) == out->end()) {
+            out->push_back(n);
+          }
+        }
+      }
+    }
+  }
+
+  // Returns true if collapsing |v| onto |u| keeps the mesh manifold and does
+  // not flip any of the triangles around |v|.
+  bool IsValidCollapse(uint32_t v, uint32_t u) const {
+    // The edge must be shared by exactly two triangles, ie. the two vertices
+    // must have exactly two neighbours in common.
+    std::vector<uint32_t> v_neighbors;
+    std::vector<uint32_t> u_neighbors;
+    GatherNeighborGroups(groups_[v], &v_neighbors);
+    GatherNeighborGroups(groups_[u], &u_neighbors);
+    int num_shared = 0;
+    for (uint32_t n : v_neighbors) {
+      if (std::find(u_neighbors.begin(), u_neighbors.end(), n) !=
+          u_neighbors.end()) {
+        ++num_shared;
+      }
+    }
+    if (num_shared != 2) {
+      return false;
+    }
+
+    for (uint32_t t : vertex_triangles_[v]) {
+      if (removed_triangles_[t]) {
+        continue;
+      }
+      uint32_t tri[3] = {indices_[3 * t], indices_[3 * t + 1],
+                         indices_[3 * t + 2]};
+      bool degenerate = false;
+      for (uint32_t i : tri) {
+        degenerate |= groups_[i] == groups_[u];
+      }
+      if (degenerate) {
+        continue;
+      }
+      const Point before = TriangleNormal(tri[0], tri[1], tri[2]);
+      for (uint32_t& i : tri) {
+        if (i == v) {
+          i = u;
+        }
+      }
+      // Also reject collapses that fold a triangle onto its neighbours, which
+      // shows up as a large change in the normal.
+      const Point after = TriangleNormal(tri[0], tri[1], tri[2]);
+      const double cos_angle = Dot(before, after);
+      if (cos_angle <= kMinNormalCosine * std::sqrt(Dot(before, before) *
+                                                    Dot(after, after))) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Returns the neighbour of |v| that it can be collapsed onto with the lowest
+  // cost, or kInvalidIndex if there is none.
+  uint32_t FindBestTarget(uint32_t v, double* cost) {
+    GatherNeighbors(v, &neighbors_);
+    std::sort(neighbors_.begin(), neighbors_.end(),
+              [this, v](uint32_t a, uint32_t b) {
+                return GetCost(v, a) < GetCost(v, b);
+              });
+    for (uint32_t u : neighbors_) {
+      if (IsCompatible(v, u) && IsValidCollapse(v, u)) {
+        *cost = GetCost(v, u);
+        return u;
+      }
+    }
+    return kInvalidIndex;
+  }
+
+  void PushCandidate(uint32_t v) {
+    if (removed_vertices_[v] || locked_[v]) {
+      return;
+    }
+    ++versions_[v];
+
+    // Use the cheapest compatible neighbour as an estimate. The collapse is
+    // validated once the candidate reaches the top of the queue.
+    GatherNeighbors(v, &neighbors_);
+    double best = std::numeric_limits<double>::infinity();
+    for (uint32_t u : neighbors_) {
+      if (IsCompatible(v, u)) {
+        best = std::min(best, GetCost(v, u));
+      }
+    }
+    if (best < std::numeric_limits<double>::infinity()) {
+      queue_.push(Candidate{best, v, versions_[v]});
+    }
+  }
+
+  void Collapse(uint32_t v, uint32_t u) {
+    for (uint32_t t : vertex_triangles_[v]) {
+      if (removed_triangles_[t]) {
+        continue;
+      }
+      uint32_t* tri = &indices_[3 * t];
+      bool degenerate = false;
+      for (int i = 0; i < 3; ++i) {
+        degenerate |= groups_[tri[i]] == groups_[u];
+      }
+      if (degenerate) {
+        removed_triangles_[t] = true;
+        --num_live_triangles_;
+        continue;
+      }
+      for (int i = 0; i < 3; ++i) {
+        if (tri[i] == v) {
+          tri[i] = u;
+        }
+      }
+      vertex_triangles_[u].push_back(t);
+    }
+    vertex_triangles_[v].clear();
+    removed_vertices_[v] = true;
+    group_quadrics_[groups_[u]].Add(group_quadrics_[groups_[v]]);
+
+    // The costs of all vertices around |u| depend on its quadric.
+    std::vector<uint32_t> affected;
+    GatherNeighbors(u, &affected);
+    affected.push_back(u);
+    for (uint32_t n : affected) {
+      PushCandidate(n);
+    }
+  }
+
+  std::vector<Point> positions_;
+  std::vector<uint32_t> groups_;
+  std::vector<int> bones_;
+  std::vector<uint32_t> indices_;
+  std::vector<std::vector<uint32_t>> vertex_triangles_;
+  std::vector<std::vector<uint32_t>> group_vertices_;
+  std::vector<Quadric> group_quadrics_;
+  std::vector<bool> removed_vertices_;
+  std::vector<bool> removed_triangles_;
+  std::vector<bool> locked_;
+  std::vector<uint32_t> versions_;
+  std::vector<uint32_t> neighbors_;
+  std::priority_queue<Candidate> queue_;
+  size_t num_live_triangles_ = 0;
+};
+
+// Returns the index of the bone with the largest influence on |vertex|.
+int GetPrimaryBone(const Vertex& vertex) {
+  int bone = Bone::kInvalidBoneIndex;
+  float weight = 0.0f;
+  for (const Vertex::Influence& influence : vertex.influences) {
+    if (influence.weight > weight) {
+      bone = influence.bone_index;
+      weight = influence.weight;
+    }
+  }
+  return bone;
+}
+
+}  // namespace
+
+size_t GetNumTriangles(const Model& model) {
+  size_t count = 0;
+  for (const Drawable& drawable : model.GetDrawables()) {
+    count += drawable.indices.size() / 3;
+  }
+  return count;
+}
+
+ModelPtr SimplifyModel(const Model& model, const SimplifyOptions& options) {
+  const std::vector<Vertex>& vertices = model.GetVertices();
+  const std::vector<Drawable>& drawables = model.GetDrawables();
+
+  // Vertices that only differ in attributes other than position are grouped
+  // together so that the simplifier can detect seams.
+  std::vector<uint32_t> order(vertices.size());
+  for (uint32_t i = 0; i < order.size(); ++i) {
+    order[i] = i;
+  }
+  auto less = [&vertices](uint32_t a, uint32_t b) {
+    const vec3& pa = vertices[a].position;
+    const vec3& pb = vertices[b].position;
+    if (pa.x != pb.x) {
+      return pa.x < pb.x;
+    } else if (pa.y != pb.y) {
+      return pa.y < pb.y;
+    }
+    return pa.z < pb.z;
+  };
+  std::sort(order.begin(), order.end(), less);
+
+  std::vector<uint32_t> groups(vertices.size(), 0);
+  uint32_t group = 0;
+  for (size_t i = 1; i < order.size(); ++i) {
+    if (less(order[i - 1], order[i])) {
+      ++group;
+    }
+    groups[order[i]] = group;
+  }
+
+  std::vector<Point> positions(vertices.size());
+  std::vector<int> bones(vertices.size());
+  for (size_t i = 0; i < vertices.size(); ++i) {
+    positions[i].x = vertices[i].position.x;
+    positions[i].y = vertices[i].position.y;
+    positions[i].z = vertices[i].position.z;
+    bones[i] = GetPrimaryBone(vertices[i]);
+  }
+
+  // All drawables are simplified together so that the boundaries between them
+  // stay connected.
+  std::vector<uint32_t> indices;
+  std::vector<uint32_t> regions;
+  for (size_t i = 0; i < drawables.size(); ++i) {
+    const std::vector<size_t>& drawable_indices = drawables[i].indices;
+    for (size_t j = 0; j + 2 < drawable_indices.size(); j += 3) {
+      indices.push_back(static_cast<uint32_t>(drawable_indices[j]));
+      indices.push_back(static_cast<uint32_t>(drawable_indices[j + 1]));
+      indices.push_back(static_cast<uint32_t>(drawable_indices[j + 2]));
+      regions.push_back(static_cast<uint32_t>(i));
+    }
+  }
+
+  const size_t num_triangles = regions.size();
+  const float ratio = std::clamp(options.target_ratio, 0.0f, 1.0f);
+  const size_t target_triangles =
+      static_cast<size_t>(static_cast<float>(num_triangles) * ratio);
+  const float diagonal =
+      (model.GetMaxPosition() - model.GetMinPosition()).Length();
+
+  QuadricSimplifier simplifier(std::move(positions), std::move(groups),
+                               std::move(bones), std::move(indices), regions);
+  simplifier.Simplify(target_triangles, options.max_error * diagonal);
+
+  // Rebuild the model from the remaining triangles, preserving the order of
+  // the drawables and of the triangles within them. The vertices take on the
+  // attributes of the finished model since some of their original attributes
+  // may have been stripped by the config.
+  auto result = std::make_shared<Model>(model.GetName());
+  for (const Bone& bone : model.GetBones()) {
+    result->AppendBone(bone);
+  }
+
+  size_t triangle = 0;
+  for (size_t i = 0; i < drawables.size(); ++i) {
+    result->BindDrawable(drawables[i].material, false);
+    for (; triangle < num_triangles && regions[triangle] == i; ++triangle) {
+      if (simplifier.IsTriangleRemoved(triangle)) {
+        continue;
+      }
+      const uint32_t* tri = simplifier.GetTriangle(triangle);
+      for (int j = 0; j < 3; ++j) {
+        Vertex vertex = vertices[tri[j]];
+        vertex.attribs = model.GetAttribs();
+        result->AddVertex(vertex);
+      }
+    }
+  }
+  return result;
+}
+
+std::vector<float> ComputeLodScreenSizes(absl::Span<const size_t> num_triangles,
+                                         float base_screen_size) {
+  std::vector<float> sizes(num_triangles.size(), 0.0f);
+  if (num_triangles.empty() || num_triangles[0] == 0) {
+    return sizes;
+  }
+
+  // Switching to a LOD with a fraction f of the triangles keeps the density on
+  // screen constant once the model's area has shrunk by f, ie. its height by
+  // sqrt(f).
+  const float base_count = static_cast<float>(num_triangles[0]);
+  for (size_t i = 0; i + 1 < num_triangles.size(); ++i) {
+    const float ratio = static_cast<float>(num_triangles[i]) / base_count;
+    sizes[i] = base_screen_size * std::sqrt(ratio);
+  }
+  return sizes;
+}
+
+}  // namespace redux::tool
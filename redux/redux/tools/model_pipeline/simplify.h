@@ -0,0 +1,59 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef REDUX_TOOLS_MODEL_PIPELINE_SIMPLIFY_H_
+#define REDUX_TOOLS_MODEL_PIPELINE_SIMPLIFY_H_
+
+#include <vector>
+
+#include "absl/types/span.h"
+#include "redux/tools/model_pipeline/model.h"
+
+namespace redux::tool {
+
+// Options that control how much a model is simplified.
+struct SimplifyOptions {
+  // The fraction of triangles to keep.
+  float target_ratio = 0.5f;
+
+  // The maximum distance any surface is allowed to move, relative to the
+  // diagonal of the model's bounding box. Simplification stops early if the
+  // target ratio cannot be reached without exceeding this error. A value of
+  // zero means the error is unbounded.
+  float max_error = 0.0f;
+};
+
+// Returns a simplified copy of |model| generated using quadric error metric
+// edge collapses. The remaining vertices are a subset of the original vertices,
+// so all of their attributes (including skin weights) are preserved. UV/normal
+// seams, material boundaries and open borders are never collapsed.
+ModelPtr SimplifyModel(const Model& model, const SimplifyOptions& options);
+
+// Returns the number of triangles in all the drawables of |model|.
+size_t GetNumTriangles(const Model& model);
+
+// Calculates the screen-size thresholds for a chain of LODs given the number
+// of triangles in each LOD. The screen size is the fraction of the viewport
+// height covered by the model's bounds. LOD i should be used while the model's
+// screen size is greater than or equal to the i-th threshold, which results in
+// a roughly constant triangle density on screen. The first threshold is
+// |base_screen_size| and the last one is always 0.
+std::vector<float> ComputeLodScreenSizes(absl::Span<const size_t> num_triangles,
+                                         float base_screen_size);
+
+}  // namespace redux::tool
+
+#endif  // REDUX_TOOLS_MODEL_PIPELINE_SIMPLIFY_H_
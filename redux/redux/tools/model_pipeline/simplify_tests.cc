@@ -0,0 +1,114 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "redux/tools/model_pipeline/simplify.h"
+
+namespace redux::tool {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::FloatEq;
+
+constexpr int kGridSize = 17;
+constexpr int kSeamColumn = 8;
+
+// Creates a flat, square grid of quads. Vertices on either side of the seam
+// column have different uvs, which splits them into two distinct vertices.
+ModelPtr CreateGrid(bool with_seam) {
+  auto model = std::make_shared<Model>("grid");
+  model->BindDrawable(Material());
+
+  auto add_vertex = [&](int x, int y, int quad_x) {
+    Vertex vertex;
+    vertex.attribs.Set(Vertex::kAttribBit_Position);
+    vertex.attribs.Set(Vertex::kAttribBit_Uv0);
+    vertex.position = vec3(static_cast<float>(x), static_cast<float>(y), 0.0f);
+    vertex.uv0 = vec2(static_cast<float>(x), static_cast<float>(y));
+    if (with_seam && x == kSeamColumn && quad_x >= kSeamColumn) {
+      vertex.uv0.x += 100.0f;
+    }
+    model->AddVertex(vertex);
+  };
+
+  for (int y = 0; y + 1 < kGridSize; ++y) {
+    for (int x = 0; x + 1 < kGridSize; ++x) {
+      add_vertex(x, y, x);
+      add_vertex(x + 1, y, x);
+      add_vertex(x + 1, y + 1, x);
+      add_vertex(x, y, x);
+      add_vertex(x + 1, y + 1, x);
+      add_vertex(x, y + 1, x);
+    }
+  }
+  return model;
+}
+
+TEST(Simplify, ReducesTriangles) {
+  ModelPtr model = CreateGrid(false);
+  const size_t num_triangles = GetNumTriangles(*model);
+  EXPECT_EQ(num_triangles, 2 * (kGridSize - 1) * (kGridSize - 1));
+
+  SimplifyOptions options;
+  options.target_ratio = 0.25f;
+  ModelPtr simplified = SimplifyModel(*model, options);
+
+  EXPECT_LE(GetNumTriangles(*simplified), num_triangles / 4);
+  EXPECT_GT(GetNumTriangles(*simplified), 0u);
+  EXPECT_LT(simplified->GetVertices().size(), model->GetVertices().size());
+
+  // The borders are locked, so the bounds do not change.
+  EXPECT_EQ(simplified->GetMinPosition(), model->GetMinPosition());
+  EXPECT_EQ(simplified->GetMaxPosition(), model->GetMaxPosition());
+}
+
+TEST(Simplify, PreservesSeams) {
+  ModelPtr model = CreateGrid(true);
+  SimplifyOptions options;
+  options.target_ratio = 0.0f;
+  ModelPtr simplified = SimplifyModel(*model, options);
+  EXPECT_LT(GetNumTriangles(*simplified), GetNumTriangles(*model));
+
+  int num_seam_vertices = 0;
+  for (const Vertex& vertex : simplified->GetVertices()) {
+    if (vertex.position.x == static_cast<float>(kSeamColumn)) {
+      ++num_seam_vertices;
+    }
+  }
+  EXPECT_EQ(num_seam_vertices, 2 * kGridSize);
+}
+
+TEST(Simplify, MaxErrorOnFlatSurface) {
+  // Collapsing vertices on a flat surface introduces no error, so a tiny error
+  // bound does not prevent simplification.
+  ModelPtr model = CreateGrid(false);
+  SimplifyOptions options;
+  options.target_ratio = 0.5f;
+  options.max_error = 0.001f;
+  ModelPtr simplified = SimplifyModel(*model, options);
+  EXPECT_LE(GetNumTriangles(*simplified), GetNumTriangles(*model) / 2);
+}
+
+TEST(Simplify, LodScreenSizes) {
+  const std::vector<size_t> num_triangles = {400, 100, 25};
+  EXPECT_THAT(ComputeLodScreenSizes(num_triangles, 0.5f),
+              ElementsAre(FloatEq(0.5f), FloatEq(0.25f), FloatEq(0.0f)));
+  EXPECT_THAT(ComputeLodScreenSizes({}, 0.5f), ElementsAre());
+}
+
+}  // namespace
+}  // namespace redux::tool
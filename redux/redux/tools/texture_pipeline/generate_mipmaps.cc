@@ -14,20 +14,368 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 
+
 #include "redux/tools/texture_pipeline/generate_mipmaps.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <thread>
 #include <vector>
+
 #include "redux/modules/base/logging.h"
 #include "redux/modules/graphics/image_utils.h"
+#include "redux/modules/math/constants.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define REDUX_MIPMAP_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define REDUX_MIPMAP_NEON 1
+#endif
 
 namespace redux::tool {
+namespace {
+
+constexpr int kMaxChannels = 4;
+
+// The number of entries in the table used to convert linear values back to
+// sRGB.  This is enough for the steepest part of the sRGB curve (near black) to
+// map to distinct 8-bit values.
+constexpr int kLinearToSrgbTableSize = 4096;
+
+// The radius of the Kaiser filter, in destination pixels, and the alpha value
+// controlling the shape of its window.
+constexpr float kKaiserRadius = 3.f;
+constexpr float kKaiserAlpha = 4.f;
+
+// Levels with fewer destination pixels per thread than this are filtered on
+// fewer threads, since the cost of starting a thread would dominate.
+constexpr int kMinPixelsPerThread = 128 * 128;
+
+// The weights used to compute each destination pixel along one axis.  The
+// destination pixel |i| is the weighted sum of the |count[i]| source pixels
+// starting at |first[i]|, using the weights starting at |i * max_taps|.
+struct FilterKernel {
+  std::vector<int> first;
+  std::vector<int> count;
+  std::vector<float> weights;
+  int max_taps = 0;
+};
+
+// Lookup tables to convert between 8-bit encoded values and linear floats.
+struct ColorTables {
+  float srgb_to_linear[256];
+  float identity[256];
+  uint8_t linear_to_srgb[kLinearToSrgbTableSize + 1];
+};
+
+float SrgbToLinear(float value) {
+  return value <= 0.04045f ? value / 12.92f
+                           : std::pow((value + 0.055f) / 1.055f, 2.4f);
+}
 
-static int UvAndChannelToIndex(const ImageData& image, int u, int v, int c) {
-  const int channel_count = GetChannelCountForFormat(image.GetFormat());
-  return (v * image.GetSize().x + u) * channel_count + c;
+float LinearToSrgb(float value) {
+  return value <= 0.0031308f ? value * 12.92f
+                             : 1.055f * std::pow(value, 1.f / 2.4f) - 0.055f;
 }
 
+const ColorTables& GetColorTables() {
+  static const ColorTables* tables = []() {
+    auto* tables = new ColorTables();
+    for (int i = 0; i < 256; ++i) {
+      tables->identity[i] = static_cast<float>(i) / 255.f;
+      tables->srgb_to_linear[i] = SrgbToLinear(tables->identity[i]);
+    }
+    for (int i = 0; i <= kLinearToSrgbTableSize; ++i) {
+      const float linear = static_cast<float>(i) / kLinearToSrgbTableSize;
+      tables->linear_to_srgb[i] =
+          static_cast<uint8_t>(LinearToSrgb(linear) * 255.f + 0.5f);
+    }
+    return tables;
+  }();
+  return *tables;
+}
+
+// Returns the index of the alpha channel in |format|, or -1 if it has none.
+int GetAlphaChannel(ImageFormat format) {
+  switch (format) {
+    case ImageFormat::Alpha8:
+      return 0;
+    case ImageFormat::LuminanceAlpha88:
+      return 1;
+    case ImageFormat::Rgba8888:
+      return 3;
+    default:
+      return -1;
+  }
+}
+
+// The zeroth-order modified Bessel function of the first kind.
+float BesselI0(float x) {
+  const float half_x_squared = 0.25f * x * x;
+  float sum = 1.f;
+  float term = 1.f;
+  for (int k = 1; k < 32 && term > 1e-7f * sum; ++k) {
+    term *= half_x_squared / static_cast<float>(k * k);
+    sum += term;
+  }
+  return sum;
+}
+
+float Sinc(float x) {
+  if (std::fabs(x) < 1e-6f) {
+    return 1.f;
+  }
+  return std::sin(kPi * x) / (kPi * x);
+}
+
+float Kaiser(float x) {
+  const float t = x / kKaiserRadius;
+  if (t <= -1.f || t >= 1.f) {
+    return 0.f;
+  }
+  return BesselI0(kKaiserAlpha * std::sqrt(1.f - t * t)) /
+         BesselI0(kKaiserAlpha);
+}
+
+// Builds the kernel to resample |src_size| pixels down to |dst_size| pixels.
+// Source pixels outside the image are clamped to the nearest edge pixel.
+FilterKernel BuildFilterKernel(MipmapFilter filter, int src_size,
+                               int dst_size) {
+  const float scale = static_cast<float>(src_size) / dst_size;
+  const float support =
+      filter == MipmapFilter::kBox ? 0.5f * scale : kKaiserRadius * scale;
+
+  FilterKernel kernel;
+  kernel.max_taps = std::min(src_size, static_cast<int>(2.f * support) + 2);
+  kernel.first.resize(dst_size);
+  kernel.count.resize(dst_size);
+  kernel.weights.assign(dst_size * kernel.max_taps, 0.f);
+
+  std::vector<float> weights(src_size, 0.f);
+  for (int i = 0; i < dst_size; ++i) {
+    const float center = (static_cast<float>(i) + 0.5f) * scale;
+    const int begin = static_cast<int>(std::floor(center - support));
+    const int end = static_cast<int>(std::ceil(center + support));
+
+    int first = src_size;
+    int last = -1;
+    float total = 0.f;
+    for (int j = begin; j < end; ++j) {
+      float weight = 0.f;
+      if (filter == MipmapFilter::kBox) {
+        // The fraction of the source pixel covered by the destination pixel.
+        const float lo = std::max(static_cast<float>(j), center - support);
+        const float hi = std::min(static_cast<float>(j + 1), center + support);
+        weight = std::max(hi - lo, 0.f);
+      } else {
+        const float x = (static_cast<float>(j) + 0.5f - center) / scale;
+        weight = Sinc(x) * Kaiser(x);
+      }
+      if (weight == 0.f) {
+        continue;
+      }
+
+      const int index = std::max(0, std::min(j, src_size - 1));
+      weights[index] += weight;
+      first = std::min(first, index);
+      last = std::max(last, index);
+      total += weight;
+    }
+
+    const int count = last - first + 1;
+    DCHECK(count > 0 && count <= kernel.max_taps);
+    kernel.first[i] = first;
+    kernel.count[i] = count;
+    float* dst = &kernel.weights[i * kernel.max_taps];
+    for (int k = 0; k < count; ++k) {
+      dst[k] = weights[first + k] / total;
+      weights[first + k] = 0.f;
+    }
+  }
+  return kernel;
+}
+
+// Adds |weight| * |src| to |dst|.
+void MultiplyAdd(float* dst, const float* src, float weight, int count) {
+  int i = 0;
+#if defined(REDUX_MIPMAP_SSE2)
+  const __m128 w = _mm_set1_ps(weight);
+  for (; i + 4 <= count; i += 4) {
+    const __m128 sum =
+        _mm_add_ps(_mm_loadu_ps(dst + i), _mm_mul_ps(_mm_loadu_ps(src + i), w));
+    _mm_storeu_ps(dst + i, sum);
+  }
+#elif defined(REDUX_MIPMAP_NEON)
+  const float32x4_t w = vdupq_n_f32(weight);
+  for (; i + 4 <= count; i += 4) {
+    vst1q_f32(dst + i, vmlaq_f32(vld1q_f32(dst + i), vld1q_f32(src + i), w));
+  }
+#endif
+  for (; i < count; ++i) {
+    dst[i] += src[i] * weight;
+  }
+}
+
+// Resamples a row of |num_channels| interleaved pixels using |kernel|.
+void FilterRow(const FilterKernel& kernel, const float* src, int num_channels,
+               float* dst) {
+  const int dst_size = static_cast<int>(kernel.first.size());
+  const float* weights = kernel.weights.data();
+#if defined(REDUX_MIPMAP_SSE2) || defined(REDUX_MIPMAP_NEON)
+  if (num_channels == kMaxChannels) {
+    for (int i = 0; i < dst_size; ++i, weights += kernel.max_taps) {
+      const float* pixel = src + kernel.first[i] * kMaxChannels;
+#if defined(REDUX_MIPMAP_SSE2)
+      __m128 sum = _mm_setzero_ps();
+      for (int k = 0; k < kernel.count[i]; ++k, pixel += kMaxChannels) {
+        sum = _mm_add_ps(
+            sum, _mm_mul_ps(_mm_loadu_ps(pixel), _mm_set1_ps(weights[k])));
+      }
+      _mm_storeu_ps(dst + i * kMaxChannels, sum);
+#else
+      float32x4_t sum = vdupq_n_f32(0.f);
+      for (int k = 0; k < kernel.count[i]; ++k, pixel += kMaxChannels) {
+        sum = vmlaq_n_f32(sum, vld1q_f32(pixel), weights[k]);
+      }
+      vst1q_f32(dst + i * kMaxChannels, sum);
+#endif
+    }
+    return;
+  }
+#endif
+
+  for (int i = 0; i < dst_size; ++i, weights += kernel.max_taps) {
+    const float* pixel = src + kernel.first[i] * num_channels;
+    float sum[kMaxChannels] = {0.f, 0.f, 0.f, 0.f};
+    for (int k = 0; k < kernel.count[i]; ++k, pixel += num_channels) {
+      for (int c = 0; c < num_channels; ++c) {
+        sum[c] += pixel[c] * weights[k];
+      }
+    }
+    std::copy(sum, sum + num_channels, dst + i * num_channels);
+  }
+}
+
+// Downsamples one image into the next mipmap level.
+class LevelFilter {
+ public:
+  LevelFilter(const ImageData& src, const ImageData& dst,
+              const MipmapOptions& options)
+      : src_(src),
+        dst_(dst),
+        num_channels_(
+            static_cast<int>(GetChannelCountForFormat(src.GetFormat()))),
+        horizontal_(BuildFilterKernel(options.filter, src.GetSize().x,
+                                      dst.GetSize().x)),
+        vertical_(BuildFilterKernel(options.filter, src.GetSize().y,
+                                    dst.GetSize().y)) {
+    const ColorTables& tables = GetColorTables();
+    const int alpha = GetAlphaChannel(src.GetFormat());
+    for (int c = 0; c < num_channels_; ++c) {
+      srgb_[c] = options.srgb && c != alpha;
+      decode_[c] = srgb_[c] ? tables.srgb_to_linear : tables.identity;
+    }
+  }
+
+  // Filters the destination rows [begin, end).
+  void FilterRows(int begin, int end) const {
+    const int src_row_size = src_.GetSize().x * num_channels_;
+    const int dst_row_size = dst_.GetSize().x * num_channels_;
+
+    // Decoded source rows are cached in a ring indexed by the row number.
+    // Consecutive destination rows share most of their source rows, and the
+    // rows needed by any one destination row never share a slot.
+    const int num_cached_rows = vertical_.max_taps;
+    std::vector<float> cache(num_cached_rows * src_row_size);
+    std::vector<int> cached_rows(num_cached_rows, -1);
+
+    std::vector<float> column(src_row_size);
+    std::vector<float> row(dst_row_size);
+    for (int y = begin; y < end; ++y) {
+      std::fill(column.begin(), column.end(), 0.f);
+      const float* weights = &vertical_.weights[y * vertical_.max_taps];
+      for (int k = 0; k < vertical_.count[y]; ++k) {
+        const int src_y = vertical_.first[y] + k;
+        const int slot = src_y % num_cached_rows;
+        float* cached = &cache[slot * src_row_size];
+        if (cached_rows[slot] != src_y) {
+          DecodeRow(src_y, cached);
+          cached_rows[slot] = src_y;
+        }
+        MultiplyAdd(column.data(), cached, weights[k], src_row_size);
+      }
+
+      FilterRow(horizontal_, column.data(), num_channels_, row.data());
+      EncodeRow(row.data(), y);
+    }
+  }
+
+ private:
+  void DecodeRow(int y, float* out) const {
+    const auto* bytes =
+        reinterpret_cast<const uint8_t*>(src_.GetData()) + y * src_.GetStride();
+    const int width = src_.GetSize().x;
+    for (int x = 0; x < width; ++x) {
+      for (int c = 0; c < num_channels_; ++c) {
+        *out++ = decode_[c][*bytes++];
+      }
+    }
+  }
+
+  void EncodeRow(const float* row, int y) const {
+    const ColorTables& tables = GetColorTables();
+    // ImageData has no mutable accessor; each row is only written by the
+    // thread that filters it.
+    const std::byte* row_start = dst_.GetData() + y * dst_.GetStride();
+    auto* bytes = reinterpret_cast<uint8_t*>(const_cast<std::byte*>(row_start));
+    const int width = dst_.GetSize().x;
+    for (int x = 0; x < width; ++x) {
+      for (int c = 0; c < num_channels_; ++c) {
+        // The Kaiser filter can overshoot, so clamp before quantizing.
+        const float value = std::max(0.f, std::min(*row++, 1.f));
+        if (srgb_[c]) {
+          *bytes++ = tables.linear_to_srgb[static_cast<int>(
+              value * kLinearToSrgbTableSize + 0.5f)];
+        } else {
+          *bytes++ = static_cast<uint8_t>(value * 255.f + 0.5f);
+        }
+      }
+    }
+  }
+
+  const ImageData& src_;
+  const ImageData& dst_;
+  const int num_channels_;
+  const FilterKernel horizontal_;
+  const FilterKernel vertical_;
+  bool srgb_[kMaxChannels];
+  const float* decode_[kMaxChannels];
+};
+
+int GetNumThreads(const MipmapOptions& options, const vec2i& size) {
+  int num_threads = options.num_threads;
+  if (num_threads <= 0) {
+    num_threads = static_cast<int>(std::thread::hardware_concurrency());
+    if (num_threads <= 0) {
+      // Assume systems running the pipeline have at least a few cores.
+      num_threads = 4;
+    }
+  }
+  const int max_threads = std::max(1, size.x * size.y / kMinPixelsPerThread);
+  return std::max(1, std::min({num_threads, max_threads, size.y}));
+}
+
+}  // namespace
+
 std::vector<ImageData> GenerateMipmaps(ImageData image) {
+  return GenerateMipmaps(std::move(image), MipmapOptions());
+}
+
+std::vector<ImageData> GenerateMipmaps(ImageData image,
+                                       const MipmapOptions& options) {
   const ImageFormat format = image.GetFormat();
   const int chan_count = GetChannelCountForFormat(format);
   CHECK_NE(chan_count, 0) << "Unsupported format";
@@ -39,35 +387,33 @@ std::vector<ImageData> GenerateMipmaps(ImageData image) {
   images.push_back(std::move(image));
   ImageData const* src = &images.front();
 
-  while (src->GetSize().x > 1 && src->GetSize().y > 1) {
+  while (src->GetSize().x > 1 || src->GetSize().y > 1) {
     const vec2i src_size = src->GetSize();
-    const vec2i dst_size = src_size / 2;
+    const vec2i dst_size(std::max(src_size.x / 2, 1),
+                         std::max(src_size.y / 2, 1));
     const size_t dst_data_size = CalculateDataSize(format, dst_size);
 
     DataContainer dst_data = DataContainer::Allocate(dst_data_size);
     ImageData dst = ImageData(format, dst_size, std::move(dst_data));
-    const std::byte* src_bytes = src->GetData();
-    std::byte* dst_bytes = const_cast<std::byte*>(dst.GetData());
-
-    for (int yy = 0; yy < dst_size.y; ++yy) {
-      for (int xx = 0; xx < dst_size.x; ++xx) {
-        for (int cc = 0; cc < chan_count; ++cc) {
-          // Simple box filter, and this does not correctly account for non-
-          // power-of-two textures, but instead behaves as nearest-neighbor.  A
-          // better implementation of box would use bilinear interpolation to
-          // help with pixel siting in non-POT cases.
-          const int xx2 = xx * 2, yy2 = yy * 2;
-          const int p00 = UvAndChannelToIndex(*src, xx2 + 0, yy2 + 0, cc);
-          const int p01 = UvAndChannelToIndex(*src, xx2 + 1, yy2 + 0, cc);
-          const int p10 = UvAndChannelToIndex(*src, xx2 + 0, yy2 + 1, cc);
-          const int p11 = UvAndChannelToIndex(*src, xx2 + 1, yy2 + 1, cc);
-          const int total = static_cast<int>(src_bytes[p00]) +
-                            static_cast<int>(src_bytes[p10]) +
-                            static_cast<int>(src_bytes[p01]) +
-                            static_cast<int>(src_bytes[p11]);
-          dst_bytes[UvAndChannelToIndex(dst, xx, yy, cc)] =
-              static_cast<std::byte>(total / 4);
-        }
+
+    const LevelFilter filter(*src, dst, options);
+    const int num_threads = GetNumThreads(options, dst_size);
+    if (num_threads == 1) {
+      filter.FilterRows(0, dst_size.y);
+    } else {
+      // Each thread filters a contiguous slice of rows so that it can reuse
+      // the source rows it has already decoded.
+      std::vector<std::thread> threads;
+      threads.reserve(num_threads);
+      const int slice_rows = (dst_size.y + num_threads - 1) / num_threads;
+      for (int row = 0; row < dst_size.y; row += slice_rows) {
+        const int end = std::min(row + slice_rows, dst_size.y);
+        threads.emplace_back([&filter, row, end]() {
+          filter.FilterRows(row, end);
+        });
+      }
+      for (std::thread& thread : threads) {
+        thread.join();
       }
     }
 
@@ -23,9 +23,38 @@ limitations under the License.
 
 namespace redux::tool {
 
+// The filter used to downsample each mipmap level.
+enum class MipmapFilter {
+  // Averages the source pixels covered by each destination pixel.  Cheap and
+  // free of ringing, but slightly blurry.
+  kBox,
+  // Kaiser-windowed sinc filter.  Sharper than a box filter, at the cost of a
+  // wider kernel.
+  kKaiser,
+};
+
+// Options that control how mipmap levels are generated.
+struct MipmapOptions {
+  // The filter to use when downsampling.
+  MipmapFilter filter = MipmapFilter::kBox;
+
+  // If true, the color channels are treated as sRGB encoded and are filtered
+  // in linear space.  Alpha is always filtered as linear data.
+  bool srgb = false;
+
+  // The number of threads to use for each level.  A value of 0 uses one thread
+  // per hardware core.
+  int num_threads = 0;
+};
+
 // Generates a vector of mipmap levels for the given image.  The top level
-// image will also be included in the vector.
+// image will also be included in the vector.  Each level is half the size of
+// the previous level (rounded down, but never less than 1) in each dimension,
+// and the chain ends with a 1x1 level.  Only 8-bit per channel images are
+// supported.
 std::vector<ImageData> GenerateMipmaps(ImageData image);
+std::vector<ImageData> GenerateMipmaps(ImageData image,
+                                       const MipmapOptions& options);
 
 }  // namespace redux::tool
 
@@ -0,0 +1,132 @@
+/*
+Copyright 2017-2022 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <cstring>
+#include <functional>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "redux/modules/graphics/image_utils.h"
+#include "redux/tools/texture_pipeline/generate_mipmaps.h"
+
+namespace redux::tool {
+namespace {
+
+ImageData CreateImage(ImageFormat format, const vec2i& size,
+                      const std::function<int(int, int, int)>& fn) {
+  const int num_channels = GetChannelCountForFormat(format);
+  DataContainer data = DataContainer::Allocate(CalculateDataSize(format, size));
+  auto* bytes = const_cast<std::byte*>(data.GetBytes());
+  for (int y = 0; y < size.y; ++y) {
+    for (int x = 0; x < size.x; ++x) {
+      for (int c = 0; c < num_channels; ++c) {
+        *bytes++ = static_cast<std::byte>(fn(x, y, c));
+      }
+    }
+  }
+  return ImageData(format, size, std::move(data));
+}
+
+int GetByte(const ImageData& image, int x, int y, int c) {
+  const int num_channels = GetChannelCountForFormat(image.GetFormat());
+  const std::byte* row = image.GetData() + y * image.GetStride();
+  return static_cast<int>(row[x * num_channels + c]);
+}
+
+TEST(GenerateMipmaps, NonSquareChain) {
+  ImageData image = CreateImage(ImageFormat::Rgba8888, {13, 5},
+                                [](int, int, int) { return 100; });
+  const std::vector<ImageData> levels = GenerateMipmaps(std::move(image));
+  ASSERT_EQ(levels.size(), 4u);
+  EXPECT_EQ(levels[1].GetSize(), vec2i(6, 2));
+  EXPECT_EQ(levels[2].GetSize(), vec2i(3, 1));
+  EXPECT_EQ(levels[3].GetSize(), vec2i(1, 1));
+  EXPECT_EQ(GetByte(levels[3], 0, 0, 0), 100);
+}
+
+TEST(GenerateMipmaps, PreservesConstantColor) {
+  for (MipmapFilter filter : {MipmapFilter::kBox, MipmapFilter::kKaiser}) {
+    for (bool srgb : {false, true}) {
+      MipmapOptions options;
+      options.filter = filter;
+      options.srgb = srgb;
+      options.num_threads = 3;
+
+      ImageData image =
+          CreateImage(ImageFormat::Rgb888, {37, 300},
+                      [](int, int, int c) { return 77 + c; });
+      const std::vector<ImageData> levels =
+          GenerateMipmaps(std::move(image), options);
+      for (const ImageData& level : levels) {
+        for (int y = 0; y < level.GetSize().y; ++y) {
+          for (int x = 0; x < level.GetSize().x; ++x) {
+            for (int c = 0; c < 3; ++c) {
+              EXPECT_EQ(GetByte(level, x, y, c), 77 + c);
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST(GenerateMipmaps, FiltersInLinearSpace) {
+  auto checkerboard = [](int x, int y, int c) {
+    return c == 3 ? 255 : ((x + y) % 2) * 255;
+  };
+
+  MipmapOptions options;
+  options.srgb = false;
+  std::vector<ImageData> levels = GenerateMipmaps(
+      CreateImage(ImageFormat::Rgba8888, {8, 8}, checkerboard), options);
+  EXPECT_EQ(GetByte(levels[1], 0, 0, 0), 128);
+  EXPECT_EQ(GetByte(levels[1], 0, 0, 3), 255);
+
+  // Half of the light in linear space is 188 in sRGB.  Alpha stays linear.
+  options.srgb = true;
+  levels = GenerateMipmaps(
+      CreateImage(ImageFormat::Rgba8888, {8, 8}, checkerboard), options);
+  EXPECT_EQ(GetByte(levels[1], 0, 0, 0), 188);
+  EXPECT_EQ(GetByte(levels[1], 0, 0, 3), 255);
+}
+
+TEST(GenerateMipmaps, ThreadsProduceSameResult) {
+  auto pattern = [](int x, int y, int c) {
+    return (x * 7 + y * 13 + c * 31 + (x * y) % 17) % 256;
+  };
+
+  MipmapOptions options;
+  options.filter = MipmapFilter::kKaiser;
+  options.srgb = true;
+  options.num_threads = 1;
+  const std::vector<ImageData> expected = GenerateMipmaps(
+      CreateImage(ImageFormat::Rgb888, {500, 377}, pattern), options);
+
+  options.num_threads = 8;
+  const std::vector<ImageData> actual = GenerateMipmaps(
+      CreateImage(ImageFormat::Rgb888, {500, 377}, pattern), options);
+
+  ASSERT_EQ(actual.size(), expected.size());
+  for (size_t i = 0; i < actual.size(); ++i) {
+    ASSERT_EQ(actual[i].GetNumBytes(), expected[i].GetNumBytes());
+    EXPECT_EQ(memcmp(actual[i].GetData(), expected[i].GetData(),
+                     actual[i].GetNumBytes()),
+              0);
+  }
+}
+
+}  // namespace
+}  // namespace redux::tool
@@ -30,6 +30,14 @@ ABSL_FLAG(std::vector<std::string>, input, std::vector<std::string>{},
           "Input image(s).");
 ABSL_FLAG(std::string, output, "", "Output image.");
 ABSL_FLAG(bool, generate_mipmaps, false, "Generates MipMap levels for image.");
+ABSL_FLAG(std::string, mipmap_filter, "box",
+          "Filter used to generate MipMap levels: box or kaiser.");
+ABSL_FLAG(bool, srgb, false,
+          "Filters MipMap levels in linear space, treating the color channels "
+          "as sRGB encoded.");
+ABSL_FLAG(int, threads, 0,
+          "Number of threads used to generate MipMap levels. Defaults to the "
+          "number of cores.");
 
 namespace redux::tool {
 
@@ -55,7 +63,16 @@ static int RunTexturePipeline() {
   if (absl::GetFlag(FLAGS_generate_mipmaps)) {
     CHECK_EQ(decoded_images.size(), 1)
         << "Can only generate mipmaps for a single image";
-    decoded_images = GenerateMipmaps(std::move(decoded_images[0]));
+    MipmapOptions options;
+    const std::string filter = absl::GetFlag(FLAGS_mipmap_filter);
+    if (filter == "kaiser") {
+      options.filter = MipmapFilter::kKaiser;
+    } else {
+      CHECK_EQ(filter, "box") << "Unknown mipmap filter: " << filter;
+    }
+    options.srgb = absl::GetFlag(FLAGS_srgb);
+    options.num_threads = absl::GetFlag(FLAGS_threads);
+    decoded_images = GenerateMipmaps(std::move(decoded_images[0]), options);
   }
 
   DataContainer out;